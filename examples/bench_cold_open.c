@@ -0,0 +1,145 @@
+/*
+ * File: bench_cold_open.c
+ *
+ * Description: Measures how long it takes to open and walk the headers of
+ * 	files which are not in the page cache. Meant to compare the
+ * 	mapping policies: default, ELFP_OPEN_NO_HINTS and ELFP_OPEN_POPULATE.
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./bench_cold_open <default|nohints|populate> <elf-file-path> ...
+ *
+ * Result: Time taken to go through all the files.
+ * 	* Every file is dropped from the page cache before it is opened.
+ * 	That works only for pages nobody else has mapped - files in use by
+ * 	running processes stay warm.
+ * 	* For every file, the ELF header, PHT, Section Header Table and the
+ * 	section names are read.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <elf.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+/* Drops a file's pages from the page cache */
+static void
+drop_cache(const char *path)
+{
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if(fd == -1)
+		return;
+
+	fdatasync(fd);
+	posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	close(fd);
+}
+
+/* Reads everything a header walk would read. Returns a checksum so
+ * that none of it is optimized away */
+static unsigned long int
+walk(int handle)
+{
+	Elf64_Ehdr *ehdr = NULL;
+	Elf64_Phdr *phdr = NULL;
+	Elf64_Shdr *shdr = NULL;
+	unsigned char *base = NULL;
+	const char *names = NULL;
+	unsigned long int sum = 0;
+	unsigned long int i;
+
+	ehdr = elfp_ehdr_get(handle);
+	if(ehdr == NULL || ehdr->e_ident[EI_CLASS] != ELFCLASS64)
+		return 0;
+
+	phdr = elfp_pht_get(handle);
+	for(i = 0; phdr != NULL && i < ehdr->e_phnum; i++)
+		sum = sum + phdr[i].p_type;
+
+	/* The whole file is mapped, the ELF header being at its start */
+	base = (unsigned char *)ehdr;
+	if(ehdr->e_shoff == 0 || ehdr->e_shstrndx >= ehdr->e_shnum)
+		return sum;
+
+	shdr = (Elf64_Shdr *)(base + ehdr->e_shoff);
+	names = (const char *)(base + shdr[ehdr->e_shstrndx].sh_offset);
+	for(i = 0; i < ehdr->e_shnum; i++)
+		sum = sum + shdr[i].sh_type + strlen(names + shdr[i].sh_name);
+
+	return sum;
+}
+
+int main(int argc, char **argv)
+{
+	if(argc < 3)
+	{
+		fprintf(stdout, "Usage: $ %s <default|nohints|populate> "
+				"<elf-file-path> ...\n", argv[0]);
+		return -1;
+	}
+
+	int ret;
+	int i;
+	int handle;
+	int n_opened = 0;
+	unsigned int flags;
+	unsigned long int sum = 0;
+	struct timespec t0, t1;
+	double total = 0;
+
+	if(strcmp(argv[1], "default") == 0)
+		flags = 0;
+	else if(strcmp(argv[1], "nohints") == 0)
+		flags = ELFP_OPEN_NO_HINTS;
+	else if(strcmp(argv[1], "populate") == 0)
+		flags = ELFP_OPEN_POPULATE;
+	else
+	{
+		fprintf(stdout, "Unknown policy: %s\n", argv[1]);
+		return -1;
+	}
+
+	/* Init the library */
+	ret = elfp_init();
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+
+	for(i = 2; i < argc; i++)
+	{
+		drop_cache(argv[i]);
+
+		/* Only the library's work is timed */
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		handle = elfp_open_flags(argv[i], flags);
+		if(handle != -1)
+		{
+			sum = sum + walk(handle);
+			elfp_close(handle);
+			n_opened = n_opened + 1;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+
+		total = total + (t1.tv_sec - t0.tv_sec) * 1e3 +
+					(t1.tv_nsec - t0.tv_nsec) / 1e6;
+	}
+
+	printf("%s: %d files, %.2f ms (checksum %lu)\n", argv[1], n_opened,
+								total, sum);
+
+	/* Close the library */
+	elfp_fini();
+
+	return 0;
+}
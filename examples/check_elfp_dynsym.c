@@ -0,0 +1,190 @@
+/*
+ * File: check_elfp_dynsym.c
+ *
+ * Description: To test elfp_dynsym_lookup(), through both the hash tables
+ * 	- DT_GNU_HASH and DT_HASH.
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./check_elfp_dynsym <elf-file-path> [<elf-file-path> ...]
+ * 	$ ./check_elfp_dynsym <elf-file-path> -s <symbol-name>
+ *
+ * Result: Every symbol the file defines in .dynsym is looked up by name.
+ * 	The lookup should find a definition of that name which is not a
+ * 	hidden version (name@VERSION) - the default one (name@@VERSION).
+ * 	A name which only has hidden versions should not be found.
+ * 	It says which hash table it went through. To check DT_HASH, give it
+ * 	a library linked with -Wl,--hash-style=sysv.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <elf.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+/* Symbols ld.so would bind a reference to */
+static int
+is_definition(const elfp_sym *sym)
+{
+	if(sym->shndx == SHN_UNDEF)
+		return 0;
+
+	switch(sym->type)
+	{
+		case STT_NOTYPE:
+		case STT_OBJECT:
+		case STT_FUNC:
+		case STT_COMMON:
+		case STT_TLS:
+		case STT_GNU_IFUNC:
+			return 1;
+
+		default:
+			return 0;
+	}
+}
+
+/* 1 if the symbol is a hidden version. 0 if not / the file has no versions */
+static int
+is_hidden(int fd, unsigned long int index)
+{
+	elfp_versym versym;
+
+	if(elfp_versym_get(fd, index, &versym) == -1)
+		return 0;
+
+	return versym.hidden;
+}
+
+/*
+ * check_file: Looks up every defined dynamic symbol of a file.
+ *
+ * @return: 0 if every lookup is right, -1 otherwise.
+ */
+static int
+check_file(const char *path)
+{
+	int fd;
+	const elfp_dynamic *dynamic = NULL;
+	unsigned long int count, i, n_checked = 0, n_wrong = 0;
+	elfp_sym sym, found;
+	int ret;
+
+	fd = elfp_open(path);
+	if(fd == -1)
+	{
+		printf("%s: elfp_open() failed\n", path);
+		return -1;
+	}
+
+	dynamic = elfp_dyn_get(fd);
+	if(dynamic == NULL ||
+		(dynamic->gnu_hash.offset == 0 && dynamic->hash.offset == 0))
+	{
+		printf("%s: No symbol hash table\n", path);
+		elfp_close(fd);
+		return -1;
+	}
+
+	count = elfp_sym_count(fd, ELFP_SYMTAB_DYNAMIC);
+	for(i = 1; i < count; i++)
+	{
+		if(elfp_sym_get(fd, ELFP_SYMTAB_DYNAMIC, i, &sym) == -1 ||
+			is_definition(&sym) == 0 || sym.name[0] == '\0')
+			continue;
+
+		n_checked++;
+		ret = elfp_dynsym_lookup(fd, sym.name, &found);
+
+		/* A hidden version may or may not have a default one */
+		if(is_hidden(fd, i) == 1)
+		{
+			if(ret == -1 || is_hidden(fd, found.index) == 0)
+				continue;
+		}
+		else if(ret == 0 && strcmp(found.name, sym.name) == 0 &&
+				is_definition(&found) == 1 &&
+				is_hidden(fd, found.index) == 0)
+			continue;
+
+		printf("%s: Wrong lookup of %s (index %lu)\n", path, sym.name, i);
+		n_wrong++;
+	}
+
+	printf("%s: %s, %lu symbols looked up, %lu wrong\n", path,
+			dynamic->gnu_hash.offset != 0 ? "DT_GNU_HASH" : "DT_HASH",
+			n_checked, n_wrong);
+
+	elfp_close(fd);
+
+	return (n_wrong == 0 && n_checked != 0) ? 0 : -1;
+}
+
+int main(int argc, char **argv)
+{
+	if(argc < 2)
+	{
+		fprintf(stdout, "Usage: $ %s <elf-file-path> [<elf-file-path> ...]\n", argv[0]);
+		fprintf(stdout, "       $ %s <elf-file-path> -s <symbol-name>\n", argv[0]);
+		return -1;
+	}
+
+	int ret;
+	int fd, i;
+	int failed = 0;
+	elfp_sym sym;
+	elfp_versym versym;
+
+	/* Init the library */
+	ret = elfp_init();
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+
+	if(argc == 4 && strcmp(argv[2], "-s") == 0)
+	{
+		fd = elfp_open(argv[1]);
+		if(fd == -1)
+		{
+			elfp_err_exit("main", "elfp_open() failed");
+		}
+
+		ret = elfp_dynsym_lookup(fd, argv[3], &sym);
+		if(ret == -1)
+		{
+			printf("%s is not defined\n", argv[3]);
+			failed = 1;
+		}
+		else
+		{
+			printf("%s: value 0x%lx, size %lu, index %lu", sym.name,
+					sym.value, sym.size, sym.index);
+			if(elfp_versym_get(fd, sym.index, &versym) == 0 &&
+						versym.name != NULL)
+				printf(", version %s%s", versym.hidden ? "@" : "@@",
+							versym.name);
+			printf("\n");
+		}
+
+		elfp_close(fd);
+	}
+	else
+	{
+		for(i = 1; i < argc; i++)
+		{
+			if(check_file(argv[i]) == -1)
+				failed = 1;
+		}
+	}
+
+	/* Close the library */
+	elfp_fini();
+
+	return failed;
+}
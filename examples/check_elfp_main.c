@@ -89,7 +89,7 @@ int main(int argc, char **argv)
 	int ret;
 	const char *file_path = argv[1];
 
-	main = elfp_main_create(file_path);
+	main = elfp_main_create(file_path, 0);
 	if(main == NULL)
 	{
 		elfp_err_warn("main", "elfp_main_create() failed");
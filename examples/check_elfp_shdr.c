@@ -0,0 +1,80 @@
+/*
+ * File: check_elfp_shdr.c
+ *
+ * Description: To test elfp_shdr's API: elfp_sht_dump() and
+ * 	elfp_section_by_name()
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./check_elfp_shdr <elf-file-path> [section-name]
+ *
+ * Result: It prints all the Section Headers present. If a section name
+ * 	is given, only that section's header.
+ */
+
+#include <stdio.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+int main(int argc, char **argv)
+{
+	if(argc != 2 && argc != 3)
+	{
+		fprintf(stdout, "Usage: $ %s <elf-file-path> [section-name]\n", argv[0]);
+		return -1;
+	}
+
+	int ret;
+	const char *path = argv[1];
+	int fd;
+	unsigned long int i, count;
+	void *shdr = NULL;
+
+	/* Init the library */
+	ret = elfp_init();
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+	
+	/* Lets open up the file */
+	fd = elfp_open(path);
+	if(fd == -1)
+	{
+		elfp_err_exit("main", "elfp_open() failed");
+	}
+
+	if(argc == 2)
+	{
+		elfp_sht_dump(fd);
+	}
+	else
+	{
+		/* Look it up by name. Get the index out of the pointer */
+		shdr = elfp_section_by_name(fd, argv[2]);
+		if(shdr == NULL)
+		{
+			printf("There is no section named %s\n", argv[2]);
+		}
+		else
+		{
+			count = elfp_sht_count(fd);
+			for(i = 0; i < count; i++)
+			{
+				if(elfp_shdr_get(fd, i) == shdr)
+					elfp_shdr_dump(fd, i);
+			}
+		}
+	}
+
+	/* Close the file */
+	elfp_close(fd);
+
+	/* Close the library */
+	elfp_fini();
+
+	return 0;
+}
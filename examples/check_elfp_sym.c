@@ -0,0 +1,167 @@
+/*
+ * File: check_elfp_sym.c
+ *
+ * Description: To test elfp_sym's API: elfp_sym_dump(), elfp_sym_by_name()
+ * 	and elfp_sym_by_addr()
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./check_elfp_sym <elf-file-path> [symbol-name / 0xaddress / --empty]
+ *
+ * Result: It prints the symbol table (.symtab if present, else .dynsym).
+ * 	If a name is given, that symbol. If an address is given, the symbol
+ * 	it falls in.
+ * 	With --empty, the file is opened with elfp_open_mem() with its symbol
+ * 	tables cut down to 0 and to 10 bytes - less than one symbol. Both
+ * 	should have no symbols, and no symbol should be found.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+/*
+ * check_empty: Opens an image of the file with sh_size of its symbol
+ * 	tables set to size, and looks up a symbol by name and by address.
+ * 	Neither should be found.
+ */
+static void
+check_empty(unsigned char *image, unsigned long int len, unsigned long int size)
+{
+	Elf64_Ehdr *e64hdr = (Elf64_Ehdr *)image;
+	Elf32_Ehdr *e32hdr = (Elf32_Ehdr *)image;
+	Elf64_Shdr *s64hdr = NULL;
+	Elf32_Shdr *s32hdr = NULL;
+	unsigned long int i;
+	elfp_sym sym;
+	int fd;
+
+	if(image[EI_CLASS] == ELFCLASS64)
+	{
+		if(e64hdr->e_shoff > len || e64hdr->e_shnum >
+				(len - e64hdr->e_shoff) / sizeof(Elf64_Shdr))
+			return;
+
+		s64hdr = (Elf64_Shdr *)(image + e64hdr->e_shoff);
+		for(i = 0; i < e64hdr->e_shnum; i++)
+			if(s64hdr[i].sh_type == SHT_SYMTAB ||
+					s64hdr[i].sh_type == SHT_DYNSYM)
+				s64hdr[i].sh_size = size;
+	}
+	else
+	{
+		if(e32hdr->e_shoff > len || e32hdr->e_shnum >
+				(len - e32hdr->e_shoff) / sizeof(Elf32_Shdr))
+			return;
+
+		s32hdr = (Elf32_Shdr *)(image + e32hdr->e_shoff);
+		for(i = 0; i < e32hdr->e_shnum; i++)
+			if(s32hdr[i].sh_type == SHT_SYMTAB ||
+					s32hdr[i].sh_type == SHT_DYNSYM)
+				s32hdr[i].sh_size = size;
+	}
+
+	fd = elfp_open_mem(image, len, 0);
+	if(fd == -1)
+	{
+		elfp_err_warn("check_empty", "elfp_open_mem() failed");
+		return;
+	}
+
+	printf("sh_size %lu: %lu symbols, by name %s, by address %s\n", size,
+		elfp_sym_count(fd, ELFP_SYMTAB_DEFAULT),
+		elfp_sym_by_name(fd, ELFP_SYMTAB_DEFAULT, "main", &sym) == -1 ?
+							"none" : "found",
+		elfp_sym_by_addr(fd, ELFP_SYMTAB_DEFAULT, 0x1000, &sym) == -1 ?
+							"none" : "found");
+
+	elfp_close(fd);
+}
+
+int main(int argc, char **argv)
+{
+	if(argc != 2 && argc != 3)
+	{
+		fprintf(stdout, "Usage: $ %s <elf-file-path> [symbol-name / 0xaddress / --empty]\n", argv[0]);
+		return -1;
+	}
+
+	int ret;
+	const char *path = argv[1];
+	int fd;
+	unsigned long int addr;
+	elfp_sym sym;
+	unsigned char *image = NULL;
+	unsigned long int len;
+	FILE *fp = NULL;
+
+	/* Init the library */
+	ret = elfp_init();
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+	
+	/* Lets open up the file */
+	fd = elfp_open(path);
+	if(fd == -1)
+	{
+		elfp_err_exit("main", "elfp_open() failed");
+	}
+
+	if(argc == 2)
+	{
+		elfp_sym_dump(fd, ELFP_SYMTAB_DEFAULT);
+	}
+	else if(strcmp(argv[2], "--empty") == 0)
+	{
+		/* The file's own mapping is read-only. Patch a copy */
+		fp = fopen(path, "rb");
+		if(fp == NULL || fseek(fp, 0, SEEK_END) == -1 ||
+			(len = ftell(fp)) < sizeof(Elf64_Ehdr) ||
+			(image = malloc(len)) == NULL ||
+			fseek(fp, 0, SEEK_SET) == -1 ||
+			fread(image, 1, len, fp) != len)
+		{
+			elfp_err_exit("main", "Reading the file failed");
+		}
+		fclose(fp);
+
+		check_empty(image, len, 0);
+		check_empty(image, len, 10);
+		free(image);
+	}
+	else if(strncmp(argv[2], "0x", 2) == 0)
+	{
+		addr = strtoul(argv[2], NULL, 16);
+		ret = elfp_sym_by_addr(fd, ELFP_SYMTAB_DEFAULT, addr, &sym);
+		if(ret == -1)
+			printf("No symbol covers 0x%lx\n", addr);
+		else
+			printf("0x%lx: %s+0x%lx\n", addr, sym.name, addr - sym.value);
+	}
+	else
+	{
+		ret = elfp_sym_by_name(fd, ELFP_SYMTAB_DEFAULT, argv[2], &sym);
+		if(ret == -1)
+			printf("There is no symbol named %s\n", argv[2]);
+		else
+			printf("%s: value 0x%lx, size %lu, %s %s, index %lu\n",
+				sym.name, sym.value, sym.size,
+				elfp_sym_decode_bind(sym.bind),
+				elfp_sym_decode_type(sym.type), sym.index);
+	}
+
+	/* Close the file */
+	elfp_close(fd);
+
+	/* Close the library */
+	elfp_fini();
+
+	return 0;
+}
@@ -27,7 +27,8 @@ int main(int argc, char **argv)
 	}
 
 	unsigned long int i;
-	int handle;
+	int handle, first;
+	unsigned long int valid_again;
 	const char *file_path = "/bin/bash";
 	elfp_main *main = NULL;
 
@@ -36,7 +37,7 @@ int main(int argc, char **argv)
 
 	for(i = 0; i < atoi(argv[1]); i++)
 	{
-		main = elfp_main_create(file_path);
+		main = elfp_main_create(file_path, 0);
 		if(main == NULL)
 		{
 			elfp_err_warn("main", "elfp_main_create() failed");
@@ -56,12 +57,54 @@ int main(int argc, char **argv)
 	}
 
 	/* Let us check the members */
-	for(i = 0; i < main_vec.latest; i++)
+	for(i = 0; i < main_vec.used; i++)
 	{
-		printf("%lu. %p, %d, %p\n", i, main_vec.vec[i], main_vec.vec[i]->fd, main_vec.vec[i]->start_addr);
+		main = elfp_main_vec_get_em((int)i);
+		printf("%lu. %p, %d, %p\n", i, main, main->fd, main->start_addr);
+		elfp_main_vec_put_em((int)i);
 	}
-	printf("total = %lu\n", main_vec.total);
-	printf("latest = %lu\n", main_vec.latest);
+	printf("used = %lu\n", main_vec.used);
+
+	/* Close every other handle and open them again.
+	 * The slots should be reused, with a new generation */
+	for(i = 0; i < main_vec.used; i = i + 2)
+		elfp_main_vec_remove((int)i);
+
+	while(main_vec.free_head != -1)
+	{
+		main = elfp_main_create(file_path, 0);
+		if(main == NULL)
+			break;
+
+		handle = elfp_main_vec_add(main);
+		elfp_main_update_handle(main, handle);
+		printf("reopened: handle = %d\n", handle);
+	}
+	printf("used = %lu, live = %lu\n", main_vec.used, main_vec.live);
+
+	/* Take one slot through all its generations. The first handle
+	 * should never be valid again, and the slot should be retired
+	 * in the end - used goes up by 1 */
+	first = -1;
+	valid_again = 0;
+	for(i = 0; i <= ELFP_HANDLE_GEN_MASK + 1; i++)
+	{
+		main = elfp_main_create(file_path, 0);
+		if(main == NULL)
+			break;
+
+		handle = elfp_main_vec_add(main);
+		if(first == -1)
+			first = handle;
+		else if(elfp_main_vec_get_em(first) != NULL)
+		{
+			elfp_main_vec_put_em(first);
+			valid_again++;
+		}
+		elfp_main_vec_remove(handle);
+	}
+	printf("stale handle %d valid again = %lu times, used = %lu\n",
+					first, valid_again, main_vec.used);
 
 	/* Free the vector in the end */
 	elfp_main_vec_fini();
@@ -0,0 +1,79 @@
+/*
+ * File: check_open_many.c
+ *
+ * Description: To test the batch open API: elfp_open_many()
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./check_open_many [-f flags] <elf-file-path> <elf-file-path> ...
+ *
+ * 	* flags is a bitwise OR of ELFP_OPEN_* values, 0x1 for
+ * 	ELFP_OPEN_HEADERS_ONLY for example. Passed to elfp_open_many_flags().
+ *
+ * Result: It prints the handle / error for every path.
+ * 	* Pass a few non-existent files and non-ELF files in between.
+ * 	They should fail without stopping the rest from opening.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+int main(int argc, char **argv)
+{
+	if(argc < 2)
+	{
+		fprintf(stdout, "Usage: $ %s [-f flags] <elf-file-path> ...\n",
+								argv[0]);
+		return -1;
+	}
+
+	int ret;
+	unsigned int flags = 0;
+	unsigned long int n = argc - 1;
+	const char **paths = (const char **)(argv + 1);
+	unsigned long int i;
+
+	if(argc > 3 && strcmp(argv[1], "-f") == 0)
+	{
+		flags = strtoul(argv[2], NULL, 0);
+		n = argc - 3;
+		paths = (const char **)(argv + 3);
+	}
+
+	int handles[n];
+	int errs[n];
+
+	/* Init the library */
+	ret = elfp_init();
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+
+	/* Open them all at once */
+	ret = elfp_open_many_flags(paths, n, flags, handles, errs);
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_open_many_flags() failed");
+	}
+	printf("Opened %d out of %lu files\n", ret, n);
+
+	for(i = 0; i < n; i++)
+	{
+		if(handles[i] == -1)
+			printf("%s: failed (%s)\n", paths[i], strerror(errs[i]));
+		else
+			printf("%s: handle = %d\n", paths[i], handles[i]);
+	}
+
+	/* Close the library */
+	elfp_fini();
+
+	return 0;
+}
@@ -0,0 +1,141 @@
+/*
+ * File: check_open_variants.c
+ *
+ * Description: To test the ways a file can be opened: elfp_open(),
+ * 	elfp_open_fd(), elfp_openat() and elfp_open_mem()
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./check_open_variants <elf-file-path>
+ *
+ * Result: The file is opened every way. For every handle, it prints the
+ * 	class, the number of sections and symbols, and the build-id. All
+ * 	the lines should be the same.
+ * 	* elfp_open_mem() is also given images too small for an ELF header.
+ * 	It should refuse them.
+ * 	* The offset of a descriptor opened with ELFP_OPEN_DUP_FD should be
+ * 	left alone at 10.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <elf.h>
+#include <sys/stat.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+/*
+ * show: Prints what a handle parses the file into, and closes it.
+ */
+static void
+show(const char *how, int fd)
+{
+	unsigned long int i, size = 0;
+	const unsigned char *build_id = NULL;
+
+	if(fd == -1)
+	{
+		printf("%-24s: open failed\n", how);
+		return;
+	}
+
+	printf("%-24s: class %lu, %lu sections, %lu + %lu symbols, build-id ",
+			how, elfp_ehdr_class_get(fd), elfp_sht_count(fd),
+			elfp_sym_count(fd, ELFP_SYMTAB_STATIC),
+			elfp_sym_count(fd, ELFP_SYMTAB_DYNAMIC));
+
+	build_id = elfp_note_build_id(fd, &size);
+	for(i = 0; i < size; i++)
+		printf("%02x", build_id[i]);
+	printf("%s\n", build_id == NULL ? "none" : "");
+
+	elfp_close(fd);
+}
+
+int main(int argc, char **argv)
+{
+	if(argc != 2)
+	{
+		fprintf(stdout, "Usage: $ %s <elf-file-path>\n", argv[0]);
+		return -1;
+	}
+
+	int ret;
+	const char *path = argv[1];
+	char *dir_copy = NULL, *base_copy = NULL;
+	int fd, file_fd, dir_fd;
+	unsigned long int i;
+	unsigned char *image = NULL;
+	unsigned long int small[] = {4, EI_NIDENT, sizeof(Elf32_Ehdr) - 1};
+	struct stat st;
+
+	/* Init the library */
+	ret = elfp_init();
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+
+	/* 1. The usual way */
+	show("elfp_open()", elfp_open(path));
+
+	/* 2. A descriptor the library takes over */
+	file_fd = open(path, O_RDONLY);
+	show("elfp_open_fd()", elfp_open_fd(file_fd, 0));
+
+	/* 3. A descriptor the caller keeps. Its offset should not move */
+	file_fd = open(path, O_RDONLY);
+	lseek(file_fd, 10, SEEK_SET);
+	show("elfp_open_fd(DUP_FD)", elfp_open_fd(file_fd, ELFP_OPEN_DUP_FD));
+	printf("%-24s: offset %ld\n", "Caller's descriptor",
+					(long int)lseek(file_fd, 0, SEEK_CUR));
+	close(file_fd);
+
+	/* 4. Relative to the file's directory */
+	dir_copy = strdup(path);
+	base_copy = strdup(path);
+	dir_fd = open(dirname(dir_copy), O_RDONLY | O_DIRECTORY);
+	show("elfp_openat()", elfp_openat(dir_fd, basename(base_copy), 0));
+	close(dir_fd);
+	free(dir_copy);
+	free(base_copy);
+
+	/* 5. The whole file, read into memory */
+	if(stat(path, &st) == -1)
+	{
+		elfp_err_exit("main", "stat() failed");
+	}
+	image = malloc(st.st_size);
+	file_fd = open(path, O_RDONLY);
+	if(image == NULL || file_fd == -1 ||
+			read(file_fd, image, st.st_size) != st.st_size)
+	{
+		elfp_err_exit("main", "Reading the file failed");
+	}
+	close(file_fd);
+
+	show("elfp_open_mem()", elfp_open_mem(image, st.st_size, 0));
+
+	/* 6. Images which can't even hold the ELF header */
+	for(i = 0; i < sizeof(small) / sizeof(small[0]); i++)
+	{
+		fd = elfp_open_mem(image, small[i], 0);
+		printf("elfp_open_mem() of %lu bytes: %s\n", small[i],
+				fd == -1 ? "refused" : "opened");
+		if(fd != -1)
+			elfp_close(fd);
+	}
+	free(image);
+
+	/* Close the library */
+	elfp_fini();
+
+	return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * File: check_shared.c
+ *
+ * Description: To test ELFP_OPEN_SHARED - handles of the same file
+ * 	sharing one elfp_main object.
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./check_shared <elf-file-path> <another-path-to-it>
+ *
+ * 	* The other path can be a symlink / hardlink to the file.
+ *
+ * Result: It prints the object and its references behind every handle.
+ * 	* The file is opened twice through the first path and once through
+ * 	the second, all with ELFP_OPEN_SHARED. The 3 handles should have
+ * 	the same object, with 3 references.
+ * 	* An open without the flag should have an object of its own.
+ * 	* The first handle is closed. The others should be left with 2
+ * 	references, and the ELF header dumped through them should be fine.
+ */
+
+#include <stdio.h>
+
+#include "../src/include/elfp_int.h"
+#include "../src/include/elfp_err.h"
+#include "../src/include/elfp.h"
+
+/* The object behind a handle. The handle keeps it alive, not this */
+static elfp_main*
+object_of(int handle)
+{
+	elfp_main *main = NULL;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main != NULL)
+		elfp_main_vec_put_em(handle);
+
+	return main;
+}
+
+static void
+show(const char *what, int handle)
+{
+	elfp_main *main = NULL;
+
+	main = object_of(handle);
+	if(main == NULL)
+	{
+		printf("%-24s: handle %d is closed\n", what, handle);
+		return;
+	}
+
+	printf("%-24s: handle %d, object %p, refs %lu\n", what, handle,
+						(void *)main, main->refs);
+}
+
+int main(int argc, char **argv)
+{
+	if(argc != 3)
+	{
+		fprintf(stdout, "Usage: $ %s <elf-file-path> <another-path-to-it>\n",
+								argv[0]);
+		return -1;
+	}
+
+	int h1, h2, h3, h4;
+
+	if(elfp_init() == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+
+	h1 = elfp_open_flags(argv[1], ELFP_OPEN_SHARED);
+	h2 = elfp_open_flags(argv[1], ELFP_OPEN_SHARED);
+	h3 = elfp_open_flags(argv[2], ELFP_OPEN_SHARED);
+	h4 = elfp_open(argv[1]);
+	if(h1 == -1 || h2 == -1 || h3 == -1 || h4 == -1)
+	{
+		elfp_err_exit("main", "Opening the file failed");
+	}
+
+	show("Shared", h1);
+	show("Shared", h2);
+	show("Shared, other path", h3);
+	show("Not shared", h4);
+
+	/* The rest keep it */
+	elfp_close(h1);
+	printf("\nClosed handle %d\n\n", h1);
+
+	show("Closed", h1);
+	show("Shared", h2);
+	show("Shared, other path", h3);
+
+	printf("\nELF header through handle %d:\n", h3);
+	elfp_ehdr_dump(h3);
+
+	elfp_close(h2);
+	elfp_close(h3);
+	elfp_close(h4);
+	elfp_fini();
+
+	return 0;
+}
@@ -0,0 +1,229 @@
+/*
+ * File: check_windowed.c
+ *
+ * Description: To test ELFP_OPEN_WINDOWED - elfp_main_read() going
+ * 	window by window.
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./check_windowed <elf-file-path>
+ *
+ * Result: The whole file is read through the windows, in pieces which
+ * 	don't line up with them, and compared with pread().
+ * 	* It prints how many pieces differed - it should be 0 - and the
+ * 	most windows that were mapped at a time. That should never be
+ * 	more than ELFP_MAIN_WINDOWS_MAX.
+ * 	* Pass a file bigger than ELFP_MAIN_WINDOWS_MAX windows to see them
+ * 	getting reused.
+ * 	* Then the file is mapped range by range with elfp_main_get_range(),
+ * 	letting go of every range right after it is compared. The most bytes
+ * 	mapped at a time should stay under ELFP_MAIN_MAPS_MAX, however big
+ * 	the file is. Pass a file bigger than that to see old ranges being
+ * 	unmapped.
+ * 	* Ranges which are held are not unmapped. Asking for more than
+ * 	ELFP_MAIN_MAPS_MAX of them should fail.
+ * 	* The ELF header and PHT through elfp_open_flags(ELFP_OPEN_WINDOWED)
+ * 	should be the same as through elfp_open(). So should the PT_LOAD
+ * 	segments, read with elfp_read(). elfp_seg_get() of them works only
+ * 	if they fit in ELFP_MAIN_MAPS_MAX.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "../src/include/elfp_int.h"
+#include "../src/include/elfp_err.h"
+#include "../src/include/elfp.h"
+
+/* Doesn't divide the window size. Most pieces cross a boundary */
+#define PIECE_SIZE 65521
+
+/* Ranges mapped on demand. Bigger than a window */
+#define RANGE_SIZE (16 * PIECE_SIZE)
+
+int main(int argc, char **argv)
+{
+	if(argc != 2)
+	{
+		fprintf(stdout, "Usage: $ %s <elf-file-path>\n", argv[0]);
+		return -1;
+	}
+
+	const char *path = argv[1];
+	elfp_main *main = NULL;
+	unsigned char got[PIECE_SIZE], want[PIECE_SIZE];
+	unsigned long int offset, size, differ = 0, pieces = 0;
+	unsigned int most = 0;
+	unsigned long int ehsize, phsize;
+	unsigned long int most_mapped = 0, held = 0, n_loads = 0, i;
+	unsigned char *range = NULL, *copy = NULL;
+	Elf64_Phdr *ph64 = NULL;
+	Elf32_Phdr *ph32 = NULL;
+	void **loads = NULL;
+	int fd, windowed, plain;
+
+	main = elfp_main_create(path, ELFP_OPEN_WINDOWED);
+	fd = open(path, O_RDONLY);
+	if(main == NULL || fd == -1)
+	{
+		elfp_err_exit("main", "Opening the file failed");
+	}
+
+	/* 1. The whole file, piece by piece */
+	for(offset = 0; offset < main->file_size; offset = offset + size)
+	{
+		size = main->file_size - offset;
+		if(size > PIECE_SIZE)
+			size = PIECE_SIZE;
+
+		if(elfp_main_read(main, offset, size, got) == -1 ||
+			pread(fd, want, size, offset) != (ssize_t)size ||
+			memcmp(got, want, size) != 0)
+			differ++;
+
+		if(main->n_windows > most)
+			most = main->n_windows;
+		pieces++;
+	}
+
+	printf("File size = %lu\n", main->file_size);
+	printf("Pieces read = %lu, differed = %lu\n", pieces, differ);
+	printf("Most windows mapped = %u (limit %d)\n", most,
+						ELFP_MAIN_WINDOWS_MAX);
+
+	/* 2. Range by range, let go of right after */
+	range = malloc(RANGE_SIZE);
+	if(range == NULL)
+	{
+		elfp_err_exit("main", "malloc() failed");
+	}
+
+	differ = 0;
+	pieces = 0;
+	for(offset = main->hdr_size; offset < main->file_size; offset = offset + size)
+	{
+		size = main->file_size - offset;
+		if(size > RANGE_SIZE)
+			size = RANGE_SIZE;
+
+		copy = elfp_main_get_range(main, offset, size);
+		if(copy == NULL ||
+			pread(fd, range, size, offset) != (ssize_t)size ||
+			memcmp(copy, range, size) != 0)
+			differ++;
+
+		if(main->maps_size > most_mapped)
+			most_mapped = main->maps_size;
+		if(copy != NULL)
+			elfp_main_put_range(main, copy);
+		pieces++;
+	}
+
+	printf("Ranges mapped = %lu, differed = %lu\n", pieces, differ);
+	printf("Most bytes mapped = %lu (limit %d)\n", most_mapped,
+						ELFP_MAIN_MAPS_MAX);
+
+	/* 3. Held ranges stay. There is room for only so many */
+	for(offset = main->hdr_size; offset < main->file_size; offset = offset + size)
+	{
+		size = main->file_size - offset;
+		if(size > RANGE_SIZE)
+			size = RANGE_SIZE;
+
+		if(elfp_main_get_range(main, offset, size) == NULL)
+			break;
+		held++;
+	}
+
+	printf("Ranges held at a time = %lu of %lu, bytes mapped = %lu\n",
+					held, pieces, main->maps_size);
+
+	free(range);
+	close(fd);
+	elfp_main_fini(main);
+
+	/* 4. Through the API */
+	if(elfp_init() == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+
+	windowed = elfp_open_flags(path, ELFP_OPEN_WINDOWED);
+	plain = elfp_open(path);
+	if(windowed == -1 || plain == -1)
+	{
+		elfp_err_exit("main", "elfp_open_flags() / elfp_open() failed");
+	}
+
+	if(elfp_ehdr_class_get(plain) == ELFCLASS32)
+	{
+		ehsize = sizeof(Elf32_Ehdr);
+		phsize = ((Elf32_Ehdr *)elfp_ehdr_get(plain))->e_phnum *
+							sizeof(Elf32_Phdr);
+	}
+	else
+	{
+		ehsize = sizeof(Elf64_Ehdr);
+		phsize = ((Elf64_Ehdr *)elfp_ehdr_get(plain))->e_phnum *
+							sizeof(Elf64_Phdr);
+	}
+
+	printf("ELF header is the same = %s\n",
+		memcmp(elfp_ehdr_get(windowed), elfp_ehdr_get(plain), ehsize) == 0 ?
+							"yes" : "no");
+	printf("PHT is the same = %s\n",
+		phsize == 0 ||
+		memcmp(elfp_pht_get(windowed), elfp_pht_get(plain), phsize) == 0 ?
+							"yes" : "no");
+
+	/* The PT_LOADs, copied out */
+	differ = 0;
+	ph64 = elfp_pht_get(plain);
+	ph32 = elfp_pht_get(plain);
+	for(i = 0; i < phsize / (ehsize == sizeof(Elf32_Ehdr) ?
+			sizeof(Elf32_Phdr) : sizeof(Elf64_Phdr)); i++)
+	{
+		if(ehsize == sizeof(Elf32_Ehdr))
+		{
+			if(ph32[i].p_type != PT_LOAD)
+				continue;
+			offset = ph32[i].p_offset;
+			size = ph32[i].p_filesz;
+		}
+		else
+		{
+			if(ph64[i].p_type != PT_LOAD)
+				continue;
+			offset = ph64[i].p_offset;
+			size = ph64[i].p_filesz;
+		}
+
+		copy = malloc(size + 1);
+		if(copy == NULL || elfp_read(windowed, offset, size, copy) == -1 ||
+			memcmp(copy, (unsigned char *)elfp_ehdr_get(plain) + offset,
+								size) != 0)
+			differ++;
+		free(copy);
+		n_loads++;
+	}
+	printf("PT_LOADs through elfp_read() = %lu, differed = %lu\n",
+							n_loads, differ);
+
+	loads = elfp_seg_get(windowed, "LOAD", &n_loads);
+	main = elfp_main_vec_get_em(windowed);
+	printf("PT_LOADs through elfp_seg_get() = %s, bytes mapped = %lu\n",
+				loads != NULL ? "mapped" : "refused",
+				main->maps_size);
+	elfp_main_vec_put_em(windowed);
+
+	elfp_close(windowed);
+	elfp_close(plain);
+	elfp_fini();
+
+	return 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * File: dump_accel.c
+ *
+ * Description: To test elfp_accel's API: elfp_accel_available(),
+ * 	elfp_accel_lookup_name(), elfp_accel_lookup_addr() and
+ * 	elfp_accel_dump()
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./dump_accel <elf-file-path> [name | 0xaddress ...]
+ *
+ * Result: It prints the acceleration tables the file has, then the DIEs
+ * 	every name given is defined at / the unit every address given is
+ * 	in.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+/* Most entries printed for a name */
+#define MAX_ENTRIES 32
+
+static const char *kinds[] = {"none", "type", "variable", "function", "other"};
+
+int main(int argc, char **argv)
+{
+	if(argc < 2)
+	{
+		fprintf(stdout, "Usage: $ %s <elf-file-path> [name | 0xaddress ...]\n", argv[0]);
+		return -1;
+	}
+
+	int ret;
+	const char *path = argv[1];
+	int fd;
+	long int n, j;
+	int i;
+	unsigned long int addr, unit;
+	elfp_accel_entry entries[MAX_ENTRIES];
+
+	/* Init the library */
+	ret = elfp_init();
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+
+	/* Lets open up the file */
+	fd = elfp_open(path);
+	if(fd == -1)
+	{
+		elfp_err_exit("main", "elfp_open() failed");
+	}
+
+	elfp_accel_dump(fd);
+
+	for(i = 2; i < argc; i++)
+	{
+		/* An address */
+		if(argv[i][0] == '0' && argv[i][1] == 'x')
+		{
+			addr = strtoul(argv[i], NULL, 16);
+			if(elfp_accel_lookup_addr(fd, addr, &unit) == 0)
+				printf("0x%lx: unit at 0x%lx\n", addr, unit);
+			else
+				printf("0x%lx: ??\n", addr);
+			continue;
+		}
+
+		/* A name */
+		n = elfp_accel_lookup_name(fd, argv[i], entries, MAX_ENTRIES);
+		printf("%s: %ld entries\n", argv[i], n);
+		for(j = 0; j < n && j < MAX_ENTRIES; j++)
+		{
+			printf("\t%s, %sunit at 0x%lx", (entries[j].kind <= ELFP_ACCEL_OTHER) ?
+				kinds[entries[j].kind] : "?", (entries[j].type_unit != 0) ?
+				"type " : "", entries[j].unit);
+			if(entries[j].die != 0)
+				printf(", DIE at 0x%lx", entries[j].die);
+			if(entries[j].is_static != 0)
+				printf(", static");
+			printf("\n");
+		}
+	}
+
+	/* Close the file */
+	elfp_close(fd);
+
+	/* Close the library */
+	elfp_fini();
+
+	return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * File: dump_build_id.c
+ *
+ * Description: To test elfp_note's API: elfp_note_build_id_path(),
+ * 	elfp_note_build_id(), elfp_note_package() and elfp_note_dump()
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./dump_build_id <elf-file-path> [-v]
+ *
+ * Result: It prints the file's build-id, read without opening the file
+ * 	through the library. With -v, all its notes as well.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+int main(int argc, char **argv)
+{
+	if(argc != 2 && (argc != 3 || strcmp(argv[2], "-v") != 0))
+	{
+		fprintf(stdout, "Usage: $ %s <elf-file-path> [-v]\n", argv[0]);
+		return -1;
+	}
+
+	int ret;
+	const char *path = argv[1];
+	int fd;
+	unsigned char id[64];
+	long int size;
+	unsigned long int i;
+	elfp_package package;
+
+	/* No handle needed for this one */
+	size = elfp_note_build_id_path(path, id, sizeof(id));
+	if(size == -1)
+	{
+		elfp_err_exit("main", "elfp_note_build_id_path() failed");
+	}
+
+	printf("Build ID: ");
+	for(i = 0; i < (unsigned long int)size; i++)
+		printf("%02x", id[i]);
+	printf("%s\n", (size == 0) ? "none" : "");
+
+	if(argc == 2)
+		return 0;
+
+	/* Init the library */
+	ret = elfp_init();
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+
+	/* Only the headers and the notes get read */
+	fd = elfp_open_flags(path, ELFP_OPEN_HEADERS_ONLY);
+	if(fd == -1)
+	{
+		elfp_err_exit("main", "elfp_open_flags() failed");
+	}
+
+	elfp_note_dump(fd, ELFP_NOTES_DEFAULT);
+
+	ret = elfp_note_package(fd, &package);
+	if(ret == 0)
+	{
+		printf("Package: %s %s (%s)\n",
+			(package.name != NULL) ? package.name : "?",
+			(package.version != NULL) ? package.version : "?",
+			(package.os != NULL) ? package.os : "?");
+	}
+
+	/* Close the file */
+	elfp_close(fd);
+
+	/* Close the library */
+	elfp_fini();
+
+	return 0;
+}
@@ -0,0 +1,48 @@
+/*
+ * File: dump_deps.c
+ *
+ * Description: To test elfp_deps' API: elfp_deps_resolve() and
+ * 	elfp_deps_dump()
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./dump_deps <elf-file-path> [elf-file-path ...]
+ *
+ * Result: Like ldd, it prints the libraries each file needs and where
+ * 	they are. The files are resolved together, so a library needed by
+ * 	many of them is parsed once.
+ */
+
+#include <stdio.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+int main(int argc, char **argv)
+{
+	if(argc < 2)
+	{
+		fprintf(stdout, "Usage: $ %s <elf-file-path> [elf-file-path ...]\n", argv[0]);
+		return -1;
+	}
+
+	elfp_deps *deps = NULL;
+	unsigned long int i;
+
+	deps = elfp_deps_resolve((const char **)(argv + 1), argc - 1, 0);
+	if(deps == NULL)
+	{
+		elfp_err_exit("main", "elfp_deps_resolve() failed");
+	}
+
+	for(i = 0; i < (unsigned long int)(argc - 1); i++)
+		elfp_deps_dump(deps, i);
+
+	printf("%lu unique files\n", elfp_deps_count(deps));
+
+	elfp_deps_free(deps);
+
+	return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * File: dump_dynamic.c
+ *
+ * Description: To test elfp_dyn_get() - the decoded DYNAMIC segment.
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./dump_dynamic <elf-file-path>
+ *
+ * Result: It prints the libraries the file needs, its soname, search
+ * 	paths, flags and where its relocation tables are.
+ */
+
+#include <stdio.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+int main(int argc, char **argv)
+{
+	if(argc != 2)
+	{
+		fprintf(stdout, "Usage: $ %s <elf-file-path>\n", argv[0]);
+		return -1;
+	}
+
+	int ret;
+	const char *path = argv[1];
+	int fd;
+	unsigned long int i;
+	const elfp_dynamic *dyn = NULL;
+
+	/* Init the library */
+	ret = elfp_init();
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+	
+	/* Lets open up the file */
+	fd = elfp_open(path);
+	if(fd == -1)
+	{
+		elfp_err_exit("main", "elfp_open() failed");
+	}
+
+	dyn = elfp_dyn_get(fd);
+	if(dyn == NULL)
+	{
+		printf("%s is not dynamically linked\n", path);
+		goto out;
+	}
+
+	for(i = 0; i < dyn->n_needed; i++)
+		printf("NEEDED: %s\n", dyn->needed[i]);
+
+	if(dyn->soname != NULL)
+		printf("SONAME: %s\n", dyn->soname);
+	if(dyn->rpath != NULL)
+		printf("RPATH: %s\n", dyn->rpath);
+	if(dyn->runpath != NULL)
+		printf("RUNPATH: %s\n", dyn->runpath);
+
+	printf("FLAGS: 0x%lx, FLAGS_1: 0x%lx\n", dyn->flags, dyn->flags_1);
+	printf("RELA: offset 0x%lx, %lu bytes\n", dyn->rela.offset, dyn->rela.size);
+	printf("REL: offset 0x%lx, %lu bytes\n", dyn->rel.offset, dyn->rel.size);
+	printf("RELR: offset 0x%lx, %lu bytes\n", dyn->relr.offset, dyn->relr.size);
+	printf("JMPREL: offset 0x%lx, %lu bytes\n", dyn->jmprel.offset, dyn->jmprel.size);
+	printf("INIT_ARRAY: offset 0x%lx, %lu bytes\n", dyn->init_array.offset,
+							dyn->init_array.size);
+
+out:
+	/* Close the file */
+	elfp_close(fd);
+
+	/* Close the library */
+	elfp_fini();
+
+	return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * File: dump_fde.c
+ *
+ * Description: To test elfp_frame's API: elfp_fde_lookup() and
+ * 	elfp_fde_dump()
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./dump_fde <elf-file-path> [address ...]
+ *
+ * Result: It prints the FDE which covers every address given. With no
+ * 	addresses, the whole .eh_frame_hdr table.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+int main(int argc, char **argv)
+{
+	if(argc < 2)
+	{
+		fprintf(stdout, "Usage: $ %s <elf-file-path> [address ...]\n", argv[0]);
+		return -1;
+	}
+
+	int ret;
+	const char *path = argv[1];
+	int fd;
+	int i;
+	unsigned long int addr;
+	elfp_fde fde;
+
+	/* Init the library */
+	ret = elfp_init();
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+
+	/* Lets open up the file */
+	fd = elfp_open(path);
+	if(fd == -1)
+	{
+		elfp_err_exit("main", "elfp_open() failed");
+	}
+
+	if(argc == 2)
+	{
+		elfp_fde_dump(fd);
+		elfp_close(fd);
+		elfp_fini();
+		return 0;
+	}
+
+	for(i = 2; i < argc; i++)
+	{
+		addr = strtoul(argv[i], NULL, 16);
+		if(elfp_fde_lookup(fd, addr, &fde) == -1)
+		{
+			printf("0x%lx: no FDE\n", addr);
+			continue;
+		}
+
+		printf("0x%lx: [0x%lx, 0x%lx), FDE at file offset 0x%lx (%lu bytes), CIE at 0x%lx\n",
+			addr, fde.pc_begin, fde.pc_end, fde.fde_offset,
+			fde.fde_size, fde.cie_offset);
+		printf("\taugmentation \"%s\", code align %lu, data align %ld, return address in r%lu%s\n",
+			fde.augmentation, fde.code_align, fde.data_align,
+			fde.ra_register, (fde.signal_frame != 0) ? ", signal frame" : "");
+		printf("\t%lu bytes of initial instructions, %lu bytes of instructions\n",
+			fde.cie_insns_size, fde.insns_size);
+	}
+
+	/* Close the file */
+	elfp_close(fd);
+
+	/* Close the library */
+	elfp_fini();
+
+	return 0;
+}
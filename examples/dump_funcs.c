@@ -0,0 +1,107 @@
+/*
+ * File: dump_funcs.c
+ *
+ * Description: To test elfp_die's API: elfp_func_lookup(), elfp_cu_lookup()
+ * 	and elfp_func_dump()
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./dump_funcs <elf-file-path> [address ...]
+ *
+ * Result: It prints the function every address given is in, with the
+ * 	functions inlined there, the way addr2line -fi does. With no
+ * 	addresses, every function range of the file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+/* Deepest inlining printed */
+#define MAX_FRAMES 64
+
+int main(int argc, char **argv)
+{
+	if(argc < 2)
+	{
+		fprintf(stdout, "Usage: $ %s <elf-file-path> [address ...]\n", argv[0]);
+		return -1;
+	}
+
+	int ret;
+	const char *path = argv[1];
+	int fd;
+	long int n, j;
+	int i;
+	unsigned long int addr;
+	elfp_func frames[MAX_FRAMES];
+	elfp_line line;
+	elfp_cu cu;
+
+	/* Init the library */
+	ret = elfp_init();
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+
+	/* Lets open up the file */
+	fd = elfp_open(path);
+	if(fd == -1)
+	{
+		elfp_err_exit("main", "elfp_open() failed");
+	}
+
+	if(argc == 2)
+	{
+		elfp_func_dump(fd);
+		elfp_close(fd);
+		elfp_fini();
+		return 0;
+	}
+
+	for(i = 2; i < argc; i++)
+	{
+		addr = strtoul(argv[i], NULL, 16);
+		printf("0x%lx", addr);
+		if(elfp_cu_lookup(fd, addr, &cu) == 0 && cu.name != NULL)
+			printf(" (%s)", cu.name);
+		printf("\n");
+
+		n = elfp_func_lookup(fd, addr, frames, MAX_FRAMES);
+		if(n <= 0)
+		{
+			printf("\t??\n");
+			continue;
+		}
+
+		/* The innermost frame is at the address's own line, the
+		 * others where the one before them was inlined */
+		elfp_line_lookup(fd, addr, &line);
+		for(j = 0; j < n; j++)
+		{
+			printf("\t%s at ", (frames[j].name != NULL) ?
+						frames[j].name : "??");
+			if(line.dir != NULL)
+				printf("%s/", line.dir);
+			printf("%s:%lu\n", (line.file != NULL) ? line.file : "??",
+								line.line);
+
+			line.dir = frames[j].call_dir;
+			line.file = frames[j].call_file;
+			line.line = frames[j].call_line;
+		}
+	}
+
+	/* Close the file */
+	elfp_close(fd);
+
+	/* Close the library */
+	elfp_fini();
+
+	return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ * File: dump_ldcache.c
+ *
+ * Description: To test elfp_ldcache's API: elfp_ldcache_dump() and
+ * 	elfp_ldcache_lookup()
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./dump_ldcache [soname]
+ *
+ * Result: It prints /etc/ld.so.cache, the way ldconfig -p does. If a
+ * 	soname is given, only the path of that library.
+ */
+
+#include <stdio.h>
+#include <elf.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+int main(int argc, char **argv)
+{
+	if(argc != 1 && argc != 2)
+	{
+		fprintf(stdout, "Usage: $ %s [soname]\n", argv[0]);
+		return -1;
+	}
+
+	elfp_ldcache *cache = NULL;
+	const char *path = NULL;
+
+	cache = elfp_ldcache_open(NULL);
+	if(cache == NULL)
+	{
+		elfp_err_exit("main", "elfp_ldcache_open() failed");
+	}
+
+	if(argc == 1)
+	{
+		elfp_ldcache_dump(cache);
+	}
+	else
+	{
+		/* Libraries of the machine this runs on */
+#if defined(__x86_64__)
+		path = elfp_ldcache_lookup(cache, argv[1],
+				elfp_ldcache_flags(ELFCLASS64, EM_X86_64), 0);
+#else
+		path = elfp_ldcache_lookup(cache, argv[1], 0, 0);
+#endif
+		if(path == NULL)
+			printf("%s is not in the cache\n", argv[1]);
+		else
+			printf("%s => %s\n", argv[1], path);
+	}
+
+	elfp_ldcache_close(cache);
+
+	return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * File: dump_lines.c
+ *
+ * Description: To test elfp_line's API: elfp_line_lookup_many() and
+ * 	elfp_line_dump()
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./dump_lines <elf-file-path> [address ...]
+ *
+ * Result: It prints the file:line of every address given, the way
+ * 	addr2line does. With no addresses, the whole line table.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+static int cmp_addr(const void *p1, const void *p2)
+{
+	unsigned long int a1 = *(const unsigned long int *)p1;
+	unsigned long int a2 = *(const unsigned long int *)p2;
+
+	return (a1 > a2) - (a1 < a2);
+}
+
+int main(int argc, char **argv)
+{
+	if(argc < 2)
+	{
+		fprintf(stdout, "Usage: $ %s <elf-file-path> [address ...]\n", argv[0]);
+		return -1;
+	}
+
+	int ret;
+	const char *path = argv[1];
+	int fd;
+	unsigned long int n, i;
+	unsigned long int *addrs = NULL;
+	elfp_line *lines = NULL;
+
+	/* Init the library */
+	ret = elfp_init();
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+
+	/* Lets open up the file */
+	fd = elfp_open(path);
+	if(fd == -1)
+	{
+		elfp_err_exit("main", "elfp_open() failed");
+	}
+
+	if(argc == 2)
+	{
+		elfp_line_dump(fd);
+		elfp_close(fd);
+		elfp_fini();
+		return 0;
+	}
+
+	n = argc - 2;
+	addrs = calloc(n, sizeof(unsigned long int));
+	lines = calloc(n, sizeof(elfp_line));
+	if(addrs == NULL || lines == NULL)
+	{
+		elfp_err_exit("main", "calloc() failed");
+	}
+
+	for(i = 0; i < n; i++)
+		addrs[i] = strtoul(argv[i + 2], NULL, 16);
+
+	/* Sorted addresses are looked up in one walk */
+	qsort(addrs, n, sizeof(unsigned long int), cmp_addr);
+
+	if(elfp_line_lookup_many(fd, addrs, n, lines) == -1)
+	{
+		elfp_err_exit("main", "elfp_line_lookup_many() failed");
+	}
+
+	for(i = 0; i < n; i++)
+	{
+		printf("0x%lx: ", addrs[i]);
+		if(lines[i].file == NULL)
+		{
+			printf("??:%lu\n", lines[i].line);
+			continue;
+		}
+
+		if(lines[i].dir != NULL)
+			printf("%s/", lines[i].dir);
+		printf("%s:%lu\n", lines[i].file, lines[i].line);
+	}
+
+	free(addrs);
+	free(lines);
+
+	/* Close the file */
+	elfp_close(fd);
+
+	/* Close the library */
+	elfp_fini();
+
+	return 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * File: dump_relocs.c
+ *
+ * Description: To test elfp_reloc's API: elfp_reloc_stats_get() and
+ * 	elfp_reloc_dump()
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./dump_relocs <elf-file-path> [-v]
+ *
+ * Result: It prints how many relocations the file has, of what type and
+ * 	how well the relative ones are packed. With -v, all of them.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <elf.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+int main(int argc, char **argv)
+{
+	if(argc != 2 && (argc != 3 || strcmp(argv[2], "-v") != 0))
+	{
+		fprintf(stdout, "Usage: $ %s <elf-file-path> [-v]\n", argv[0]);
+		return -1;
+	}
+
+	int ret;
+	const char *path = argv[1];
+	int fd;
+	unsigned long int type;
+	Elf64_Ehdr *ehdr = NULL;
+	elfp_reloc_stats stats;
+
+	/* Init the library */
+	ret = elfp_init();
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+
+	/* Lets open up the file */
+	fd = elfp_open(path);
+	if(fd == -1)
+	{
+		elfp_err_exit("main", "elfp_open() failed");
+	}
+
+	ret = elfp_reloc_stats_get(fd, ELFP_RELOC_DEFAULT, &stats);
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_reloc_stats_get() failed");
+	}
+
+	printf("Relocations: %lu\n", stats.total);
+	printf("Relative: %lu (%lu packed in %lu RELR words)\n",
+			stats.relative, stats.relr, stats.relr_words);
+	printf("PLT: %lu, Need a symbol: %lu\n", stats.plt, stats.symbolic);
+
+	/* e_machine is at the same place in both classes */
+	ehdr = elfp_ehdr_get(fd);
+	for(type = 0; type < ELFP_RELOC_TYPES_MAX && ehdr != NULL; type++)
+	{
+		if(stats.types[type] != 0)
+			printf("\t%-24s %lu\n",
+				elfp_reloc_decode_type(ehdr->e_machine, type),
+				stats.types[type]);
+	}
+
+	if(argc == 3)
+		elfp_reloc_dump(fd, ELFP_RELOC_DEFAULT);
+
+	/* Close the file */
+	elfp_close(fd);
+
+	/* Close the library */
+	elfp_fini();
+
+	return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * File: dump_stream.c
+ *
+ * Description: To test the push parser: elfp_stream_*()
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ cat <elf-file-path> | ./dump_stream
+ *
+ * Result: It prints every structure as soon as it is parsed, along with
+ * 	how many bytes had been read by then.
+ * 	* Input is read in small pieces, like it would arrive from a pipe.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+/* Small on purpose */
+#define READ_SIZE 512
+
+static const char*
+event_name(int type)
+{
+	switch(type)
+	{
+		case ELFP_STREAM_EHDR:
+			return "ELF header";
+		case ELFP_STREAM_PHT:
+			return "PHT";
+		case ELFP_STREAM_SEGMENT:
+			return "Segment";
+		case ELFP_STREAM_SHT:
+			return "SHT";
+		case ELFP_STREAM_SKIPPED:
+			return "Skipped";
+		default:
+			return "Unknown";
+	}
+}
+
+int main(int argc, char **argv)
+{
+	elfp_stream *stream = NULL;
+	elfp_stream_event event;
+	unsigned char buf[READ_SIZE];
+	unsigned long int total = 0;
+	ssize_t n;
+	int ret;
+	int type;
+
+	/* Create the parser */
+	stream = elfp_stream_new();
+	if(stream == NULL)
+	{
+		elfp_err_exit("main", "elfp_stream_new() failed");
+	}
+
+	while(1)
+	{
+		/* Report whatever is ready */
+		while(1)
+		{
+			type = elfp_stream_poll(stream, &event);
+			if(type == ELFP_STREAM_NEED_MORE || type == ELFP_STREAM_DONE ||
+						type == ELFP_STREAM_ERROR)
+				break;
+
+			printf("%-10s offset = %-8lu size = %-8lu", event_name(type),
+						event.offset, event.size);
+			if(type == ELFP_STREAM_SEGMENT || type == ELFP_STREAM_SKIPPED)
+				printf(" type = %s", elfp_phdr_decode_type(event.seg_type));
+			printf(" (read %lu bytes)\n", total);
+
+			if(type == ELFP_STREAM_SEGMENT && event.seg_type == PT_INTERP)
+				printf("           Interpreter: %.*s\n", (int)event.size,
+							(const char *)event.data);
+		}
+
+		if(type == ELFP_STREAM_DONE)
+		{
+			printf("Done after reading %lu bytes\n", total);
+			break;
+		}
+
+		if(type == ELFP_STREAM_ERROR)
+		{
+			printf("Not a valid ELF file\n");
+			break;
+		}
+
+		/* Need more */
+		n = read(0, buf, sizeof(buf));
+		if(n <= 0)
+		{
+			printf("Input ended after %lu bytes\n", total);
+			break;
+		}
+		total = total + n;
+
+		ret = elfp_stream_feed(stream, buf, n);
+		if(ret == -1)
+			continue;
+	}
+
+	/* Clean up */
+	elfp_stream_free(stream);
+
+	return 0;
+}
@@ -0,0 +1,137 @@
+/*
+ * File: dump_unwind.c
+ *
+ * Description: To test elfp_unwind's API: elfp_unwind_dump(),
+ * 	elfp_unwind_save(), elfp_unwind_open() and elfp_unwind_table_lookup()
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./dump_unwind <elf-file-path> [table-path address ...]
+ *
+ * Result: With only the file, it dumps its unwind table. With a table
+ * 	path, it saves the table there, maps it back and prints the rules
+ * 	at every address given.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+static void
+print_rule(const char *name, unsigned int rule, long int offset)
+{
+	switch(rule)
+	{
+		case ELFP_UNWIND_UNDEFINED:
+			printf(" %s=undefined", name);
+			break;
+
+		case ELFP_UNWIND_SAME:
+			printf(" %s=same", name);
+			break;
+
+		case ELFP_UNWIND_OFFSET:
+			printf(" %s=[CFA%+ld]", name, offset);
+			break;
+
+		case ELFP_UNWIND_VAL_OFFSET:
+			printf(" %s=CFA%+ld", name, offset);
+			break;
+
+		case ELFP_UNWIND_REGISTER:
+			printf(" %s=r%ld", name, offset);
+			break;
+
+		default:
+			printf(" %s=expr", name);
+			break;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if(argc < 2)
+	{
+		fprintf(stdout, "Usage: $ %s <elf-file-path> [table-path address ...]\n", argv[0]);
+		return -1;
+	}
+
+	int ret;
+	const char *path = argv[1];
+	int fd;
+	int i;
+	unsigned long int addr, size, j;
+	const unsigned char *build_id = NULL;
+	elfp_unwind *table = NULL;
+	elfp_unwind_row row;
+
+	/* Init the library */
+	ret = elfp_init();
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+
+	/* Lets open up the file */
+	fd = elfp_open(path);
+	if(fd == -1)
+	{
+		elfp_err_exit("main", "elfp_open() failed");
+	}
+
+	if(argc == 2)
+	{
+		elfp_unwind_dump(fd);
+		elfp_close(fd);
+		elfp_fini();
+		return 0;
+	}
+
+	/* Save it, and read it back. The file isn't needed after that */
+	if(elfp_unwind_save(fd, argv[2]) == -1)
+	{
+		elfp_err_exit("main", "elfp_unwind_save() failed");
+	}
+	elfp_close(fd);
+	elfp_fini();
+
+	table = elfp_unwind_open(argv[2]);
+	if(table == NULL)
+	{
+		elfp_err_exit("main", "elfp_unwind_open() failed");
+	}
+
+	build_id = elfp_unwind_table_build_id(table, &size);
+	printf("%s: build-id ", argv[2]);
+	for(j = 0; build_id != NULL && j < size; j++)
+		printf("%02x", build_id[j]);
+	printf("%s\n", (build_id == NULL) ? "none" : "");
+
+	for(i = 3; i < argc; i++)
+	{
+		addr = strtoul(argv[i], NULL, 16);
+		if(elfp_unwind_table_lookup(table, addr, &row) == -1)
+		{
+			printf("0x%lx: no FDE\n", addr);
+			continue;
+		}
+
+		printf("0x%lx: [0x%lx, 0x%lx)", addr, row.pc_begin, row.pc_end);
+		if(row.cfa_rule == ELFP_UNWIND_CFA_REGISTER)
+			printf(" CFA=r%u%+ld", row.cfa_register, row.cfa_offset);
+		else
+			printf(" CFA=expr");
+		print_rule("RA", row.ra_rule, row.ra_offset);
+		print_rule("FP", row.fp_rule, row.fp_offset);
+		printf("\n");
+	}
+
+	/* Close the table */
+	elfp_unwind_close(table);
+
+	return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * File: dump_versions.c
+ *
+ * Description: To test elfp_version's API: elfp_version_max(),
+ * 	elfp_version_cmp() and elfp_version_dump()
+ *
+ * Compilation:
+ * 	1. Install the library using "make install"
+ * 	2. Do "make examples" in 'src' directory.
+ *
+ * Usage: $ ./dump_versions <elf-file-path> [highest-version-allowed]
+ *
+ * Result: It dumps the version tables. With a version (GLIBC_2.31, say),
+ * 	it prints the versions of that family the file needs which are
+ * 	newer than it, and fails if there is any.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/include/elfp.h"
+#include "../src/include/elfp_err.h"
+
+int main(int argc, char **argv)
+{
+	if(argc < 2)
+	{
+		fprintf(stdout, "Usage: $ %s <elf-file-path> [highest-version-allowed]\n", argv[0]);
+		return -1;
+	}
+
+	int ret;
+	const char *path = argv[1];
+	int fd;
+	long int count, i;
+	elfp_version_family *maxes = NULL;
+	int too_new = 0;
+
+	/* Init the library */
+	ret = elfp_init();
+	if(ret == -1)
+	{
+		elfp_err_exit("main", "elfp_init() failed");
+	}
+
+	/* Lets open up the file */
+	fd = elfp_open(path);
+	if(fd == -1)
+	{
+		elfp_err_exit("main", "elfp_open() failed");
+	}
+
+	if(argc == 2)
+	{
+		elfp_version_dump(fd);
+		elfp_close(fd);
+		elfp_fini();
+		return 0;
+	}
+
+	/* How many, then all of them */
+	count = elfp_version_max(fd, NULL, 0);
+	if(count == -1)
+	{
+		elfp_err_exit("main", "elfp_version_max() failed");
+	}
+
+	maxes = calloc(count + 1, sizeof(elfp_version_family));
+	if(maxes == NULL)
+	{
+		elfp_err_exit("main", "calloc() failed");
+	}
+	count = elfp_version_max(fd, maxes, count);
+
+	for(i = 0; i < count; i++)
+	{
+		if(strncmp(maxes[i].name, argv[2], maxes[i].family_len) != 0 ||
+			elfp_version_cmp(maxes[i].name, argv[2]) <= 0)
+			continue;
+
+		printf("%s: needs %s from %s\n", path, maxes[i].name, maxes[i].file);
+		too_new = 1;
+	}
+
+	free(maxes);
+
+	/* Close the file */
+	elfp_close(fd);
+
+	/* Close the library */
+	elfp_fini();
+
+	return too_new;
+}
@@ -0,0 +1,1028 @@
+/*
+ * File: elfp_accel.c
+ *
+ * Description: Name -> DIE and address -> unit, from the acceleration
+ * 	tables compilers and linkers leave in the file - .gdb_index (gdb,
+ * 	gold, lld), .debug_names (DWARF 5) and .debug_aranges.
+ *
+ * 	* Nothing is built. The headers are read the first time a table is
+ * 	asked for, and every lookup reads the tables in place - a hash
+ * 	table probe for names, a binary search for addresses.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#include "./include/elfp_accel.h"
+#include "./include/elfp_dwarf.h"
+#include "./include/elfp_shdr.h"
+#include "./include/elfp_int.h"
+#include "./include/elfp_err.h"
+#include "./include/elfp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <elf.h>
+
+/* Size of a .gdb_index address area entry - low, high, unit number */
+#define ELFP_ACCEL_GDB_ADDR_SIZE 20
+
+/* Most attributes a .debug_names abbreviation is read with */
+#define ELFP_ACCEL_IDX_MAX 16
+
+/* What one of a lookup's callers collects matches into */
+typedef struct elfp_accel_out
+{
+	elfp_accel_entry *entries;
+	unsigned long int max;
+	unsigned long int count;
+
+} elfp_accel_out;
+
+/*
+ * elfp_accel_u32, elfp_accel_u64: Read a value at any alignment.
+ */
+static unsigned int
+elfp_accel_u32(const unsigned char *p)
+{
+	uint32_t value;
+
+	memcpy(&value, p, 4);
+	return value;
+}
+
+static unsigned long int
+elfp_accel_u64(const unsigned char *p)
+{
+	uint64_t value;
+
+	memcpy(&value, p, 8);
+	return value;
+}
+
+/* An offset of 4 / 8 bytes */
+static unsigned long int
+elfp_accel_offset(const unsigned char *p, unsigned int size)
+{
+	return (size == 8) ? elfp_accel_u64(p) : elfp_accel_u32(p);
+}
+
+/*
+ * elfp_accel_name_is: Checks if the string at p, which has at most avail
+ * 	bytes to it, is name.
+ */
+static int
+elfp_accel_name_is(const unsigned char *p, unsigned long int avail,
+			const char *name, unsigned long int length)
+{
+	return avail > length && memcmp(p, name, length) == 0 &&
+					p[length] == '\0';
+}
+
+/*
+ * elfp_accel_add: Adds a match to the output, if there is room for it.
+ * 	Counts it either way.
+ */
+static void
+elfp_accel_add(elfp_accel_out *out, const elfp_accel_entry *entry)
+{
+	if(out->count < out->max)
+		out->entries[out->count] = *entry;
+	out->count = out->count + 1;
+}
+
+/*
+ * elfp_accel_kind: What kind of thing a DIE of a tag names.
+ */
+static unsigned int
+elfp_accel_kind(unsigned int tag)
+{
+	switch(tag)
+	{
+		case DW_TAG_subprogram:
+		case DW_TAG_inlined_subroutine:
+			return ELFP_ACCEL_FUNCTION;
+
+		case DW_TAG_variable:
+			return ELFP_ACCEL_VARIABLE;
+
+		case DW_TAG_base_type:
+		case DW_TAG_typedef:
+		case DW_TAG_class_type:
+		case DW_TAG_structure_type:
+		case DW_TAG_union_type:
+		case DW_TAG_enumeration_type:
+			return ELFP_ACCEL_TYPE;
+
+		default:
+			return ELFP_ACCEL_OTHER;
+	}
+}
+
+/*
+ * elfp_accel_gdb_read: Reads the header of .gdb_index.
+ *
+ * @return: 0 if the file has a usable one, -1 otherwise.
+ */
+static int
+elfp_accel_gdb_read(elfp_main *main, elfp_accel_gdb *gdb)
+{
+	elfp_dwarf_cursor section;
+	const unsigned char *start = NULL;
+	unsigned long int size, cus, tus, addrs, slots, slots_end, pool, i;
+	unsigned int n_words;
+
+	if(elfp_dwarf_section_get(main, ".gdb_index", &section) == -1)
+		return -1;
+
+	start = section.p;
+	size = section.end - section.p;
+	if(size < 4)
+		return -1;
+
+	/* 7 is what gdb reads today. 8 and 9 only add to it - 9 a table
+	 * between the symbol table and the pool */
+	gdb->version = elfp_accel_u32(start);
+	if(gdb->version < 7 || gdb->version > 9)
+	{
+		elfp_err_warn("elfp_accel_gdb_read", "Unsupported .gdb_index version");
+		return -1;
+	}
+
+	n_words = (gdb->version >= 9) ? 7 : 6;
+	if(size < n_words * 4)
+		return -1;
+
+	cus = elfp_accel_u32(start + 4);
+	tus = elfp_accel_u32(start + 8);
+	addrs = elfp_accel_u32(start + 12);
+	slots = elfp_accel_u32(start + 16);
+	slots_end = elfp_accel_u32(start + 20);
+	pool = elfp_accel_u32(start + (n_words - 1) * 4);
+
+	if(cus < n_words * 4 || tus < cus || addrs < tus || slots < addrs ||
+		slots_end < slots || pool < slots_end || pool > size)
+	{
+		elfp_err_warn("elfp_accel_gdb_read", "Broken .gdb_index header");
+		return -1;
+	}
+
+	gdb->cus = start + cus;
+	gdb->n_cus = (tus - cus) / 16;
+	gdb->tus = start + tus;
+	gdb->n_tus = (addrs - tus) / 24;
+	gdb->addrs = start + addrs;
+	gdb->n_addrs = (slots - addrs) / ELFP_ACCEL_GDB_ADDR_SIZE;
+	gdb->slots = start + slots;
+	gdb->n_slots = (slots_end - slots) / 8;
+	gdb->pool = start + pool;
+	gdb->pool_size = size - pool;
+
+	/* The probe sequence needs a power of 2 */
+	if((gdb->n_slots & (gdb->n_slots - 1)) != 0)
+	{
+		elfp_err_warn("elfp_accel_gdb_read", "Broken .gdb_index symbol table");
+		gdb->n_slots = 0;
+	}
+
+	gdb->sorted = 1;
+	for(i = 1; i < gdb->n_addrs; i++)
+	{
+		if(elfp_accel_u64(gdb->addrs + i * ELFP_ACCEL_GDB_ADDR_SIZE) <
+			elfp_accel_u64(gdb->addrs + (i - 1) * ELFP_ACCEL_GDB_ADDR_SIZE))
+		{
+			gdb->sorted = 0;
+			break;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * elfp_accel_names_read: Reads the headers of the name indexes of
+ * 	.debug_names.
+ *
+ * @return: 0 on success, -1 on failure. A file without .debug_names is
+ * 	not a failure - it has no indexes.
+ */
+static int
+elfp_accel_names_read(elfp_main *main, elfp_main_accel *accel)
+{
+	elfp_dwarf_cursor section, set;
+	elfp_accel_names *list = NULL, *names = NULL;
+	unsigned long int count, max, length, abbrevs_size, aug_size;
+	unsigned int offset_size;
+
+	if(elfp_dwarf_section_get(main, ".debug_names", &section) == -1)
+		return 0;
+
+	count = 0;
+	max = 0;
+	while(section.p < section.end)
+	{
+		length = elfp_dwarf_unit_length(&section, &offset_size);
+		if(section.error != 0)
+			break;
+
+		set = section;
+		set.end = section.p + length;
+		elfp_dwarf_skip(&section, length);
+
+		if(elfp_dwarf_u16(&set) != 5)
+			continue;
+		elfp_dwarf_u16(&set);
+
+		if(count == max)
+		{
+			max = (max == 0) ? 4 : max * 2;
+			names = realloc(list, max * sizeof(elfp_accel_names));
+			if(names == NULL)
+			{
+				elfp_err_warn("elfp_accel_names_read", "realloc() failed");
+				free(list);
+				return -1;
+			}
+			list = names;
+		}
+
+		names = list + count;
+		memset(names, 0, sizeof(elfp_accel_names));
+		names->offset_size = offset_size;
+		names->n_cus = elfp_dwarf_u32(&set);
+		names->n_local_tus = elfp_dwarf_u32(&set);
+		names->n_foreign_tus = elfp_dwarf_u32(&set);
+		names->n_buckets = elfp_dwarf_u32(&set);
+		names->n_names = elfp_dwarf_u32(&set);
+		abbrevs_size = elfp_dwarf_u32(&set);
+		aug_size = elfp_dwarf_u32(&set);
+		elfp_dwarf_skip(&set, (aug_size + 3) & ~3UL);
+
+		/* The arrays, one after the other. Hashes are there only
+		 * with the buckets */
+		names->cus = set.p;
+		elfp_dwarf_skip(&set, (names->n_cus + names->n_local_tus) *
+							offset_size);
+		elfp_dwarf_skip(&set, names->n_foreign_tus * 8);
+		names->buckets = set.p;
+		elfp_dwarf_skip(&set, names->n_buckets * 4);
+		names->hashes = set.p;
+		if(names->n_buckets != 0)
+			elfp_dwarf_skip(&set, names->n_names * 4);
+		names->str_offsets = set.p;
+		elfp_dwarf_skip(&set, names->n_names * offset_size);
+		names->entry_offsets = set.p;
+		elfp_dwarf_skip(&set, names->n_names * offset_size);
+		names->abbrevs = set.p;
+		elfp_dwarf_skip(&set, abbrevs_size);
+		names->abbrevs_end = set.p;
+		names->pool = set.p;
+		names->end = set.end;
+
+		if(set.error != 0)
+		{
+			elfp_err_warn("elfp_accel_names_read", "Broken .debug_names index");
+			continue;
+		}
+		count = count + 1;
+	}
+
+	if(count != 0)
+	{
+		accel->names = elfp_main_alloc(main,
+					count * sizeof(elfp_accel_names));
+		if(accel->names == NULL)
+		{
+			elfp_err_warn("elfp_accel_names_read", "elfp_main_alloc() failed");
+			free(list);
+			return -1;
+		}
+		memcpy(accel->names, list, count * sizeof(elfp_accel_names));
+	}
+	accel->n_names = count;
+	free(list);
+
+	return 0;
+}
+
+/*
+ * elfp_accel_read: Reads the headers of the acceleration tables of a file.
+ *
+ * 	* Called with index_lock held. The section index is built already.
+ *
+ * @return: NULL on failure, the tables on success.
+ */
+static elfp_main_accel*
+elfp_accel_read(elfp_main *main)
+{
+	elfp_main_accel *accel = NULL;
+	unsigned short int type;
+
+	accel = elfp_main_alloc(main, sizeof(elfp_main_accel));
+	if(accel == NULL)
+	{
+		elfp_err_warn("elfp_accel_read", "elfp_main_alloc() failed");
+		return NULL;
+	}
+
+	type = ET_NONE;
+	elfp_main_read(main, EI_NIDENT, sizeof(type), &type);
+	accel->relocatable = (type == ET_REL);
+
+	if(elfp_accel_gdb_read(main, &accel->gdb) == 0)
+		accel->available = accel->available | ELFP_ACCEL_GDB_INDEX;
+
+	if(elfp_accel_names_read(main, accel) == -1)
+		return NULL;
+	if(accel->n_names != 0)
+		accel->available = accel->available | ELFP_ACCEL_DEBUG_NAMES;
+	elfp_dwarf_section_get(main, ".debug_str", &accel->str);
+
+	if(elfp_shdr_find(main, ".debug_aranges") != NULL)
+		accel->available = accel->available | ELFP_ACCEL_ARANGES;
+
+	return accel;
+}
+
+elfp_main_accel*
+elfp_accel_get(elfp_main *main)
+{
+	/* Basic check */
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_accel_get", "NULL argument passed");
+		return NULL;
+	}
+
+	elfp_main_accel *accel = NULL;
+
+	/* Read already? */
+	accel = __atomic_load_n(&main->accel, __ATOMIC_ACQUIRE);
+	if(accel != NULL)
+		return accel;
+
+	/* The section index takes index_lock itself. Get that out of the
+	 * way first */
+	if(elfp_shdr_index_get(main) == NULL)
+	{
+		elfp_err_warn("elfp_accel_get", "elfp_shdr_index_get() failed");
+		return NULL;
+	}
+
+	/* Only one thread reads them. Others wait and use them */
+	pthread_mutex_lock(&main->index_lock);
+	accel = main->accel;
+	if(accel == NULL)
+	{
+		accel = elfp_accel_read(main);
+		if(accel != NULL)
+			__atomic_store_n(&main->accel, accel, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&main->index_lock);
+
+	if(accel == NULL)
+		elfp_err_warn("elfp_accel_get", "elfp_accel_read() failed");
+
+	return accel;
+}
+
+/*
+ * elfp_accel_gdb_hash: The hash .gdb_index (version 5 on) hashes names
+ * 	with. Case-insensitive.
+ */
+static unsigned int
+elfp_accel_gdb_hash(const char *name)
+{
+	const unsigned char *p = (const unsigned char *)name;
+	unsigned int hash = 0;
+	unsigned int c;
+
+	for(; *p != '\0'; p++)
+	{
+		c = *p;
+		if(c >= 'A' && c <= 'Z')
+			c = c - 'A' + 'a';
+		hash = hash * 67 + c - 113;
+	}
+
+	return hash;
+}
+
+/*
+ * elfp_accel_gdb_name: Looks a name up in .gdb_index.
+ */
+static void
+elfp_accel_gdb_name(const elfp_accel_gdb *gdb, const char *name,
+					elfp_accel_out *out)
+{
+	elfp_accel_entry entry;
+	unsigned long int mask, index, step, probe, length, count, i, unit;
+	unsigned int hash, name_offset, vector_offset, value;
+	const unsigned char *vector = NULL;
+
+	if(gdb->n_slots == 0)
+		return;
+
+	length = strlen(name);
+	hash = elfp_accel_gdb_hash(name);
+	mask = gdb->n_slots - 1;
+	index = hash & mask;
+	step = ((hash * 17) & mask) | 1;
+
+	for(probe = 0; probe < gdb->n_slots; probe++)
+	{
+		name_offset = elfp_accel_u32(gdb->slots + index * 8);
+		vector_offset = elfp_accel_u32(gdb->slots + index * 8 + 4);
+
+		/* An empty slot ends the probe */
+		if(name_offset == 0 && vector_offset == 0)
+			return;
+
+		if(name_offset < gdb->pool_size &&
+			elfp_accel_name_is(gdb->pool + name_offset,
+			gdb->pool_size - name_offset, name, length))
+			break;
+
+		index = (index + step) & mask;
+	}
+
+	if(probe == gdb->n_slots || gdb->pool_size < 4 ||
+				vector_offset > gdb->pool_size - 4)
+		return;
+
+	/* The CU vector: a count, then a word per unit the name is in -
+	 * unit number in bits 0 - 23, kind in 28 - 30, static in 31 */
+	vector = gdb->pool + vector_offset;
+	count = elfp_accel_u32(vector);
+	if(count > (gdb->pool_size - vector_offset) / 4 - 1)
+		return;
+
+	for(i = 0; i < count; i++)
+	{
+		value = elfp_accel_u32(vector + 4 + i * 4);
+		unit = value & 0xffffff;
+
+		memset(&entry, 0, sizeof(entry));
+		entry.source = ELFP_ACCEL_GDB_INDEX;
+		entry.kind = (value >> 28) & 0x7;
+		entry.is_static = (value >> 31) & 0x1;
+
+		if(unit < gdb->n_cus)
+			entry.unit = elfp_accel_u64(gdb->cus + unit * 16);
+		else if(unit - gdb->n_cus < gdb->n_tus)
+		{
+			entry.unit = elfp_accel_u64(gdb->tus +
+					(unit - gdb->n_cus) * 24);
+			entry.type_unit = 1;
+		}
+		else
+			continue;
+
+		elfp_accel_add(out, &entry);
+	}
+}
+
+/*
+ * elfp_accel_names_hash: The hash .debug_names hashes names with - DJB's,
+ * 	over the name with its letters in lower case.
+ */
+static unsigned int
+elfp_accel_names_hash(const char *name)
+{
+	const unsigned char *p = (const unsigned char *)name;
+	unsigned int hash = 5381;
+	unsigned int c;
+
+	for(; *p != '\0'; p++)
+	{
+		c = *p;
+		if(c >= 'A' && c <= 'Z')
+			c = c - 'A' + 'a';
+		hash = hash * 33 + c;
+	}
+
+	return hash;
+}
+
+/*
+ * elfp_accel_names_abbrev: Finds an abbreviation of a name index.
+ *
+ * @arg3: Reference to a cursor. Set up to cover its attributes.
+ *
+ * @return: Its tag, 0 if there is no such abbreviation.
+ */
+static unsigned int
+elfp_accel_names_abbrev(const elfp_accel_names *names, unsigned long int code,
+					elfp_dwarf_cursor *attrs)
+{
+	elfp_dwarf_cursor cursor;
+	unsigned long int this_code;
+	unsigned int tag, idx, form;
+
+	cursor.p = names->abbrevs;
+	cursor.end = names->abbrevs_end;
+	cursor.error = 0;
+
+	while(cursor.error == 0)
+	{
+		this_code = elfp_dwarf_uleb(&cursor);
+		if(this_code == 0)
+			return 0;
+
+		tag = elfp_dwarf_uleb(&cursor);
+		*attrs = cursor;
+
+		do
+		{
+			idx = elfp_dwarf_uleb(&cursor);
+			form = elfp_dwarf_uleb(&cursor);
+			if(form == DW_FORM_implicit_const)
+				elfp_dwarf_sleb(&cursor);
+		} while((idx != 0 || form != 0) && cursor.error == 0);
+
+		if(this_code == code)
+			return tag;
+	}
+
+	return 0;
+}
+
+/*
+ * elfp_accel_names_entries: Reads the entries of a name of a name index.
+ */
+static void
+elfp_accel_names_entries(const elfp_accel_names *names, unsigned long int i,
+					elfp_accel_out *out)
+{
+	elfp_dwarf_cursor cursor, attrs;
+	elfp_dwarf_format format;
+	elfp_dwarf_value value;
+	elfp_accel_entry entry;
+	unsigned long int offset, code, cu, tu, die;
+	unsigned int tag, idx, form;
+	int has_cu, has_tu;
+
+	offset = elfp_accel_offset(names->entry_offsets +
+				i * names->offset_size, names->offset_size);
+	if(offset >= (unsigned long int)(names->end - names->pool))
+		return;
+
+	format.version = 5;
+	format.offset_size = names->offset_size;
+	format.addr_size = 8;
+
+	cursor.p = names->pool + offset;
+	cursor.end = names->end;
+	cursor.error = 0;
+
+	while(cursor.error == 0)
+	{
+		code = elfp_dwarf_uleb(&cursor);
+		if(code == 0)
+			return;
+
+		tag = elfp_accel_names_abbrev(names, code, &attrs);
+		if(tag == 0)
+			return;
+
+		has_cu = 0;
+		has_tu = 0;
+		cu = 0;
+		tu = 0;
+		die = 0;
+		while(attrs.error == 0)
+		{
+			idx = elfp_dwarf_uleb(&attrs);
+			form = elfp_dwarf_uleb(&attrs);
+			if(idx == 0 && form == 0)
+				break;
+
+			if(form == DW_FORM_implicit_const)
+				value.u = elfp_dwarf_sleb(&attrs);
+			else if(elfp_dwarf_form_read(&cursor, form, &format,
+								&value) == -1)
+				return;
+
+			if(idx == DW_IDX_compile_unit)
+			{
+				cu = value.u;
+				has_cu = 1;
+			}
+			else if(idx == DW_IDX_type_unit)
+			{
+				tu = value.u;
+				has_tu = 1;
+			}
+			else if(idx == DW_IDX_die_offset)
+				die = value.u;
+		}
+
+		memset(&entry, 0, sizeof(entry));
+		entry.source = ELFP_ACCEL_DEBUG_NAMES;
+		entry.tag = tag;
+		entry.kind = elfp_accel_kind(tag);
+
+		/* A single unit needs no DW_IDX_compile_unit. Units of other
+		 * files (foreign type units) can't be pointed at */
+		if(has_tu != 0)
+		{
+			if(tu >= names->n_local_tus)
+				continue;
+			entry.unit = elfp_accel_offset(names->cus +
+				(names->n_cus + tu) * names->offset_size,
+				names->offset_size);
+			entry.type_unit = 1;
+		}
+		else if(has_cu != 0 || names->n_cus == 1)
+		{
+			if(cu >= names->n_cus)
+				continue;
+			entry.unit = elfp_accel_offset(names->cus +
+				cu * names->offset_size, names->offset_size);
+		}
+		else
+			continue;
+
+		entry.die = entry.unit + die;
+		elfp_accel_add(out, &entry);
+	}
+}
+
+/*
+ * elfp_accel_names_name: Looks a name up in a name index of .debug_names.
+ */
+static void
+elfp_accel_names_name(const elfp_main_accel *accel,
+	const elfp_accel_names *names, const char *name, elfp_accel_out *out)
+{
+	unsigned long int length, bucket, i, offset, avail;
+	unsigned int hash, this_hash;
+
+	length = strlen(name);
+	avail = accel->str.end - accel->str.p;
+
+	/* Without a hash table, every name is looked at */
+	if(names->n_buckets == 0)
+	{
+		for(i = 0; i < names->n_names; i++)
+		{
+			offset = elfp_accel_offset(names->str_offsets +
+				i * names->offset_size, names->offset_size);
+			if(offset < avail && elfp_accel_name_is(accel->str.p +
+					offset, avail - offset, name, length))
+			{
+				elfp_accel_names_entries(names, i, out);
+				return;
+			}
+		}
+		return;
+	}
+
+	/* The names of a bucket are one after the other, numbered from 1 */
+	hash = elfp_accel_names_hash(name);
+	bucket = hash % names->n_buckets;
+	i = elfp_accel_u32(names->buckets + bucket * 4);
+	if(i == 0)
+		return;
+
+	for(i = i - 1; i < names->n_names; i++)
+	{
+		this_hash = elfp_accel_u32(names->hashes + i * 4);
+		if(this_hash % names->n_buckets != bucket)
+			return;
+		if(this_hash != hash)
+			continue;
+
+		offset = elfp_accel_offset(names->str_offsets +
+				i * names->offset_size, names->offset_size);
+		if(offset < avail && elfp_accel_name_is(accel->str.p + offset,
+						avail - offset, name, length))
+		{
+			elfp_accel_names_entries(names, i, out);
+			return;
+		}
+	}
+}
+
+/*
+ * elfp_accel_gdb_addr: Looks an address up in .gdb_index's address area.
+ *
+ * @return: 0 if a unit covers it, -1 otherwise.
+ */
+static int
+elfp_accel_gdb_addr(const elfp_accel_gdb *gdb, unsigned long int addr,
+						unsigned long int *unit)
+{
+	const unsigned char *entry = NULL;
+	unsigned long int low, high, middle, i;
+	unsigned int number;
+
+	if(gdb->sorted != 0)
+	{
+		low = 0;
+		high = gdb->n_addrs;
+		while(low < high)
+		{
+			middle = low + (high - low) / 2;
+			if(elfp_accel_u64(gdb->addrs + middle *
+					ELFP_ACCEL_GDB_ADDR_SIZE) <= addr)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+
+		if(low == 0)
+			return -1;
+		entry = gdb->addrs + (low - 1) * ELFP_ACCEL_GDB_ADDR_SIZE;
+		if(addr >= elfp_accel_u64(entry + 8))
+			return -1;
+	}
+	else
+	{
+		for(i = 0; i < gdb->n_addrs; i++)
+		{
+			entry = gdb->addrs + i * ELFP_ACCEL_GDB_ADDR_SIZE;
+			if(elfp_accel_u64(entry) <= addr &&
+					addr < elfp_accel_u64(entry + 8))
+				break;
+		}
+		if(i == gdb->n_addrs)
+			return -1;
+	}
+
+	number = elfp_accel_u32(entry + 16);
+	if(number >= gdb->n_cus)
+		return -1;
+
+	*unit = elfp_accel_u64(gdb->cus + number * 16);
+	return 0;
+}
+
+/*
+ * elfp_accel_aranges_addr: Looks an address up in .debug_aranges - a walk
+ * 	over the whole section.
+ *
+ * 	* Ranges of code the linker threw away are skipped. Linkers point
+ * 	those at 0 or at the highest address.
+ *
+ * @return: 0 if a unit covers it, -1 otherwise.
+ */
+static int
+elfp_accel_aranges_addr(elfp_main *main, const elfp_main_accel *accel,
+			unsigned long int addr, unsigned long int *unit)
+{
+	elfp_dwarf_cursor section, set;
+	const unsigned char *start = NULL;
+	unsigned long int length, offset, low, size, align, max_addr;
+	unsigned int offset_size, addr_size;
+	const unsigned char *data = NULL;
+	int ret = -1;
+
+	if(elfp_dwarf_section_get(main, ".debug_aranges", &section) == -1)
+		return -1;
+
+	/* Only looked at for this lookup */
+	data = section.p;
+
+	while(section.p < section.end)
+	{
+		start = section.p;
+		length = elfp_dwarf_unit_length(&section, &offset_size);
+		if(section.error != 0)
+			break;
+
+		set = section;
+		set.end = section.p + length;
+		elfp_dwarf_skip(&section, length);
+
+		elfp_dwarf_u16(&set);
+		offset = elfp_dwarf_uint(&set, offset_size);
+		addr_size = elfp_dwarf_u8(&set);
+		elfp_dwarf_u8(&set);
+		if(set.error != 0 || (addr_size != 4 && addr_size != 8))
+			continue;
+
+		max_addr = (addr_size == 4) ? 0xffffffffUL : ~0UL;
+
+		/* Tuples start at a multiple of their size */
+		align = (set.p - start) % (2 * addr_size);
+		if(align != 0)
+			elfp_dwarf_skip(&set, 2 * addr_size - align);
+
+		while(set.error == 0)
+		{
+			low = elfp_dwarf_uint(&set, addr_size);
+			size = elfp_dwarf_uint(&set, addr_size);
+			if(set.error != 0 || (low == 0 && size == 0))
+				break;
+
+			if((low == 0 && accel->relocatable == 0) ||
+							low >= max_addr - 1)
+				continue;
+
+			if(low <= addr && addr - low < size)
+			{
+				*unit = offset;
+				ret = 0;
+				break;
+			}
+		}
+
+		if(ret == 0)
+			break;
+	}
+
+	elfp_main_put_range(main, data);
+	return ret;
+}
+
+/*
+ * All functions defined below are exposed to programmers.
+ *
+ * Refer to elfp.h for more details.
+ */
+
+int
+elfp_accel_available(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_accel_available", "Handle failed the sanity test");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_accel *accel = NULL;
+	int available = -1;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_accel_available", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	accel = elfp_accel_get(main);
+	if(accel != NULL)
+		available = accel->available;
+	elfp_main_vec_put_em(handle);
+
+	return available;
+}
+
+long int
+elfp_accel_lookup_name(int handle, const char *name,
+		elfp_accel_entry *entries, unsigned long int max)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || name == NULL ||
+					(max != 0 && entries == NULL))
+	{
+		elfp_err_warn("elfp_accel_lookup_name", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_accel *accel = NULL;
+	elfp_accel_out out;
+	unsigned long int i;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_accel_lookup_name", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	accel = elfp_accel_get(main);
+	if(accel == NULL)
+	{
+		elfp_err_warn("elfp_accel_lookup_name", "elfp_accel_get() failed");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	out.entries = entries;
+	out.max = max;
+	out.count = 0;
+
+	/* .debug_names says which DIE. .gdb_index only which unit */
+	if((accel->available & ELFP_ACCEL_DEBUG_NAMES) != 0)
+	{
+		for(i = 0; i < accel->n_names; i++)
+			elfp_accel_names_name(accel, accel->names + i, name, &out);
+	}
+	else if((accel->available & ELFP_ACCEL_GDB_INDEX) != 0)
+		elfp_accel_gdb_name(&accel->gdb, name, &out);
+
+	elfp_main_vec_put_em(handle);
+
+	return out.count;
+}
+
+int
+elfp_accel_lookup_addr(int handle, unsigned long int addr,
+					unsigned long int *unit)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || unit == NULL)
+	{
+		elfp_err_warn("elfp_accel_lookup_addr", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_accel *accel = NULL;
+	int ret = -1;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_accel_lookup_addr", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	accel = elfp_accel_get(main);
+	if(accel != NULL)
+	{
+		if((accel->available & ELFP_ACCEL_GDB_INDEX) != 0)
+			ret = elfp_accel_gdb_addr(&accel->gdb, addr, unit);
+		else if((accel->available & ELFP_ACCEL_ARANGES) != 0)
+			ret = elfp_accel_aranges_addr(main, accel, addr,
+								unit);
+	}
+	elfp_main_vec_put_em(handle);
+
+	return ret;
+}
+
+int
+elfp_accel_dump(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_accel_dump", "Handle failed the sanity test");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_accel *accel = NULL;
+	const elfp_accel_names *names = NULL;
+	unsigned long int i;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_accel_dump", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	accel = elfp_accel_get(main);
+	if(accel == NULL)
+	{
+		elfp_err_warn("elfp_accel_dump", "elfp_accel_get() failed");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	printf("Acceleration tables:\n");
+	if((accel->available & ELFP_ACCEL_GDB_INDEX) != 0)
+		printf("\t.gdb_index: version %u, %lu units, %lu type units, %lu address ranges%s, %lu symbol slots\n",
+			accel->gdb.version, accel->gdb.n_cus, accel->gdb.n_tus,
+			accel->gdb.n_addrs, (accel->gdb.sorted != 0) ?
+			"" : " (unsorted)", accel->gdb.n_slots);
+
+	for(i = 0; i < accel->n_names; i++)
+	{
+		names = accel->names + i;
+		printf("\t.debug_names [%lu]: %lu units, %lu type units, %lu names, %lu buckets\n",
+			i, names->n_cus, names->n_local_tus +
+			names->n_foreign_tus, names->n_names, names->n_buckets);
+	}
+
+	if((accel->available & ELFP_ACCEL_ARANGES) != 0)
+		printf("\t.debug_aranges\n");
+
+	if(accel->available == 0)
+		printf("\t(none)\n");
+
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
@@ -6,6 +6,10 @@
  * 	> elfp_open
  * 	> elfp_close
  * 	> elfp_fini
+ *
+ * 	and its variants: elfp_open_flags, elfp_openat, elfp_open_fd,
+ * 	elfp_open_mem, elfp_open_many and elfp_open_many_flags. elfp_read
+ * 	copies out any part of an open file.
  * License: 
  *
  *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
@@ -25,8 +29,31 @@
 
 #include "./include/elfp_err.h"
 #include "./include/elfp_int.h"
+#include "./include/elfp_pool.h"
 #include "./include/elfp.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+ * Opening a file is mostly waiting for the filesystem. So, more threads
+ * than CPUs are used to keep the lookups overlapped.
+ */
+#define ELFP_OPEN_MANY_THREADS 16
+
+/*
+ * Everything elfp_open_many() workers need.
+ */
+typedef struct elfp_open_many_state
+{
+	const char **paths;
+	unsigned int flags;
+	elfp_main **mains;
+	int *errs;
+
+} elfp_open_many_state;
+
 /*
  * Refer elfp.h for functions' description.
  */
@@ -47,6 +74,39 @@ elfp_init()
 	return 0;
 }
 
+/*
+ * elfp_open_main: Adds a newly created elfp_main object to main_vec
+ * 	and returns its handle.
+ *
+ * 	* The object is released if it couldn't be added.
+ */
+static int
+elfp_open_main(elfp_main *main)
+{
+	int handle;
+
+	/* Once created, it needs to be added to main_vec */
+	handle = elfp_main_vec_add(main);
+	if(handle == -1)
+	{
+		elfp_err_warn("elfp_open_main", "elfp_main_vec_add() failed");
+		elfp_main_release(main);
+		return -1;
+	}
+
+	/* Update the handle */
+	elfp_main_update_handle(main, handle);
+
+	/* At this point, the file is opened, elfp_main object
+	 * for that file is created and is added into the vector.
+	 * We also have the handle. 
+	 * 
+	 * At this point, the library should be able to handle
+	 * any other parse requests.
+	 */
+	return handle;
+}
+
 int
 elfp_open(const char *elfp_elf_path)
 {
@@ -57,73 +117,288 @@ elfp_open(const char *elfp_elf_path)
 		return -1;
 	}
 
-	int ret;
-	int handle;
+	return elfp_open_flags(elfp_elf_path, 0);
+}
+
+int
+elfp_open_flags(const char *elfp_elf_path, unsigned int flags)
+{
+	/* Basic check */
+	if(elfp_elf_path == NULL || (flags & ~ELFP_OPEN_ALL_FLAGS) != 0)
+	{
+		elfp_err_warn("elfp_open_flags", "Invalid argument(s) passed");
+		return -1;
+	}
+
 	elfp_main *main = NULL;
 
 	/* Create the elfp_main object */
-	main = elfp_main_create(elfp_elf_path);
+	main = elfp_main_create(elfp_elf_path, flags);
 	if(main == NULL)
 	{
-		elfp_err_warn("elfp_open", "elfp_main_create() failed");
+		elfp_err_warn("elfp_open_flags", "elfp_main_create() failed");
 		return -1;
 	}
 
-	/* Once created, it needs to be added to main_vec */
-	ret = elfp_main_vec_add(main);
+	return elfp_open_main(main);
+}
+
+int
+elfp_openat(int dirfd, const char *elfp_elf_path, unsigned int flags)
+{
+	/* Basic check */
+	if(elfp_elf_path == NULL || (flags & ~ELFP_OPEN_ALL_FLAGS) != 0)
+	{
+		elfp_err_warn("elfp_openat", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+
+	/* Create the elfp_main object */
+	main = elfp_main_create_at(dirfd, elfp_elf_path, flags);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_openat", "elfp_main_create_at() failed");
+		return -1;
+	}
+
+	return elfp_open_main(main);
+}
+
+int
+elfp_open_fd(int fd, unsigned int flags)
+{
+	/* Basic check */
+	if(fd < 0 || (flags & ~ELFP_OPEN_ALL_FLAGS) != 0)
+	{
+		elfp_err_warn("elfp_open_fd", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	int our_fd = fd;
+	int saved_errno;
+
+	/* Work on a copy if the caller wants to keep theirs */
+	if(flags & ELFP_OPEN_DUP_FD)
+	{
+		our_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+		if(our_fd == -1)
+		{
+			elfp_err_warn("elfp_open_fd", "fcntl() failed");
+			return -1;
+		}
+	}
+
+	/* Create the elfp_main object */
+	main = elfp_main_create_fd(our_fd, flags);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_open_fd", "elfp_main_create_fd() failed");
+
+		/* The duplicate is ours to close. The original never is */
+		if(our_fd != fd)
+		{
+			saved_errno = errno;
+			close(our_fd);
+			errno = saved_errno;
+		}
+		return -1;
+	}
+
+	return elfp_open_main(main);
+}
+
+int
+elfp_open_mem(const void *buf, unsigned long int size, unsigned int flags)
+{
+	/* Basic check */
+	if(buf == NULL || (flags & ~ELFP_OPEN_ALL_FLAGS) != 0)
+	{
+		elfp_err_warn("elfp_open_mem", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+
+	/* Create the elfp_main object. The buffer is not copied */
+	main = elfp_main_create_mem(buf, size, flags);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_open_mem", "elfp_main_create_mem() failed");
+		return -1;
+	}
+
+	return elfp_open_main(main);
+}
+
+static void
+elfp_open_many_task(void *arg, unsigned long int i)
+{
+	elfp_open_many_state *state = arg;
+
+	/* Only elfp_main objects are created here. They are added to
+	 * main_vec by the caller once all the workers are done. */
+	errno = 0;
+	state->mains[i] = elfp_main_create(state->paths[i], state->flags);
+	if(state->mains[i] == NULL)
+		state->errs[i] = (errno != 0) ? errno : EINVAL;
+	else
+		state->errs[i] = 0;
+}
+
+int
+elfp_open_many(const char **paths, unsigned long int n,
+			int *handles_out, int *errs_out)
+{
+	/* Basic check */
+	if(paths == NULL || handles_out == NULL || n == 0)
+	{
+		elfp_err_warn("elfp_open_many", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	return elfp_open_many_flags(paths, n, 0, handles_out, errs_out);
+}
+
+int
+elfp_open_many_flags(const char **paths, unsigned long int n,
+		unsigned int flags, int *handles_out, int *errs_out)
+{
+	/* Basic check */
+	if(paths == NULL || handles_out == NULL || n == 0 ||
+				(flags & ~ELFP_OPEN_ALL_FLAGS) != 0)
+	{
+		elfp_err_warn("elfp_open_many_flags", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_open_many_state state;
+	unsigned long int i;
+	int ret;
+	int n_opened;
+
+	/* Allocate memory */
+	state.paths = paths;
+	state.flags = flags;
+	state.mains = calloc(n, sizeof(elfp_main *));
+	state.errs = calloc(n, sizeof(int));
+	if(state.mains == NULL || state.errs == NULL)
+	{
+		elfp_err_warn("elfp_open_many_flags", "calloc() failed");
+		free(state.mains);
+		free(state.errs);
+		return -1;
+	}
+
+	/* 1. Create all the elfp_main objects in parallel.
+	 * This is where all the syscalls are */
+	ret = elfp_pool_run(n, ELFP_OPEN_MANY_THREADS, elfp_open_many_task, &state);
 	if(ret == -1)
 	{
-		elfp_err_warn("elfp_open", "elfp_main_vec_add() failed");
+		elfp_err_warn("elfp_open_many_flags", "elfp_pool_run() failed");
+		free(state.mains);
+		free(state.errs);
 		return -1;
 	}
 
-	handle = ret;
+	/* 2. Add them all to main_vec in one go */
+	n_opened = elfp_main_vec_add_many(state.mains, n, handles_out);
+	for(i = 0; i < n; i++)
+	{
+		if(state.mains[i] == NULL)
+			continue;
+
+		if(handles_out[i] == -1)
+		{
+			elfp_err_warn("elfp_open_many_flags",
+					"elfp_main_vec_add_many() failed");
+			elfp_main_release(state.mains[i]);
+			state.errs[i] = ENOMEM;
+			continue;
+		}
+
+		elfp_main_update_handle(state.mains[i], handles_out[i]);
+	}
+
+	if(errs_out != NULL)
+	{
+		for(i = 0; i < n; i++)
+			errs_out[i] = state.errs[i];
+	}
 
-	/* Update the handle */
-	elfp_main_update_handle(main, handle);
+	free(state.mains);
+	free(state.errs);
 
-	/* At this point, the file is opened, elfp_main object
-	 * for that file is created and is added into the vector.
-	 * We also have the handle. 
-	 * 
-	 * At this point, the library should be able to handle
-	 * any other parse requests.
-	 */
-	return handle;
+	return n_opened;
 }
 
 int
 elfp_close(int handle)
 {
-	
+	int ret;
+
+	/* The handle becomes invalid right away. The object itself is
+	 * cleaned up once nobody else is using it */
+	ret = elfp_main_vec_remove(handle);
+	if(ret == -1)
+	{
+		elfp_err_warn("elfp_close", "Invalid handle / handle already closed");
+		return -1;
+	}
+
+	/* All good */
+	return 0;
+}
+
+int
+elfp_read(int handle, unsigned long int offset, unsigned long int size,
+								void *buf)
+{
+	/* Sanity check */
 	if(elfp_sanitize_handle(handle) == -1)
 	{
-		elfp_err_warn("elfp_close", "elfp_sanitize_handle() failed");
+		elfp_err_warn("elfp_read", "Handle failed the sanity test");
+		return -1;
+	}
+
+	/* Basic check */
+	if(buf == NULL && size != 0)
+	{
+		elfp_err_warn("elfp_read", "NULL argument passed");
 		return -1;
 	}
 
 	elfp_main *main = NULL;
 	int ret;
-	
-	/* Get the elfp_main object corresponding to the handle */
+
 	main = elfp_main_vec_get_em(handle);
-	
-	/* If it has already been freed, then its cool! */
 	if(main == NULL)
-		return 0;
+	{
+		elfp_err_warn("elfp_read", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
 
-	/* Else, let us free it now */
-	ret = elfp_main_fini(main);
+	/* Through the windows, if the file is not mapped whole */
+	ret = elfp_main_read(main, offset, size, buf);
+	elfp_main_vec_put_em(handle);
 	if(ret == -1)
 	{
-		elfp_err_warn("elfp_close", "elfp_main_fini() failed");
+		elfp_err_warn("elfp_read", "elfp_main_read() failed");
 		return -1;
 	}
 
-	/* All good */
 	return 0;
 }
 
+void
+elfp_set_allocator(void* (*malloc_fn)(unsigned long int size),
+			void (*free_fn)(void *addr))
+{
+	elfp_ds_set_allocator(malloc_fn, free_fn);
+}
+
 void
 elfp_fini()
 {
@@ -0,0 +1,971 @@
+/*
+ * File: elfp_deps.c
+ *
+ * Description: Resolving shared library dependencies - an ldd which
+ * 	doesn't run anything.
+ *
+ * 	* The graph is built a level at a time. All files of a level are
+ * 	parsed and their DT_NEEDED entries searched for in parallel. The
+ * 	results are then merged into the graph by the calling thread,
+ * 	which gives the next level - files never seen before.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#include "./include/elfp_int.h"
+#include "./include/elfp_dyn.h"
+#include "./include/elfp_shdr.h"
+#include "./include/elfp_deps.h"
+#include "./include/elfp_pool.h"
+#include "./include/elfp_err.h"
+#include "./include/elfp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <elf.h>
+
+/*
+ * Files of one level of the graph, parsed together.
+ */
+typedef struct elfp_deps_level
+{
+	elfp_deps *deps;
+	elfp_deps_node **nodes;
+	unsigned long int count;
+	unsigned long int total;
+
+} elfp_deps_level;
+
+/*
+ * elfp_deps_alloc: Allocates zeroed memory from the graph's arena.
+ * 	Workers use it too.
+ */
+static void*
+elfp_deps_alloc(elfp_deps *deps, unsigned long int size)
+{
+	void *addr = NULL;
+
+	pthread_mutex_lock(&deps->lock);
+	addr = elfp_ds_arena_alloc(&deps->arena, size);
+	pthread_mutex_unlock(&deps->lock);
+
+	if(addr == NULL)
+		elfp_err_warn("elfp_deps_alloc", "elfp_ds_arena_alloc() failed");
+
+	return addr;
+}
+
+static const char*
+elfp_deps_strdup(elfp_deps *deps, const char *str)
+{
+	char *copy = NULL;
+	unsigned long int len;
+
+	len = strlen(str);
+	copy = elfp_deps_alloc(deps, len + 1);
+	if(copy != NULL)
+		memcpy(copy, str, len + 1);
+
+	return copy;
+}
+
+/*
+ * elfp_deps_multiarch: Debian style multiarch directory name of a
+ * 	machine. NULL if it is not known.
+ */
+static const char*
+elfp_deps_multiarch(int class, unsigned int machine)
+{
+	switch(machine)
+	{
+		case EM_X86_64:
+			return "x86_64-linux-gnu";
+
+		case EM_386:
+			return "i386-linux-gnu";
+
+		case EM_AARCH64:
+			return "aarch64-linux-gnu";
+
+		case EM_ARM:
+			return "arm-linux-gnueabihf";
+
+		case EM_RISCV:
+			return (class == ELFCLASS64) ? "riscv64-linux-gnu" : NULL;
+
+		default:
+			return NULL;
+	}
+}
+
+/*
+ * elfp_deps_try: Checks if a file can be the library asked for - an ELF
+ * 	file of the same class and machine as the one needing it.
+ *
+ * 	* Only its ELF header is read. It is parsed later, if it turns out
+ * 	to be a file not seen before.
+ *
+ * @return: 0 if it can, -1 if not.
+ */
+static int
+elfp_deps_try(elfp_deps *deps, const char *path, int class,
+			unsigned int machine, elfp_deps_found *found)
+{
+	unsigned char ehdr[EI_NIDENT + 4];
+	uint16_t e_machine;
+	struct stat st;
+	ssize_t nread;
+	int fd;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if(fd == -1)
+		return -1;
+
+	if(fstat(fd, &st) == -1 || S_ISREG(st.st_mode) == 0)
+	{
+		close(fd);
+		return -1;
+	}
+
+	nread = pread(fd, ehdr, sizeof(ehdr), 0);
+	close(fd);
+	if(nread != sizeof(ehdr) || memcmp(ehdr, ELFMAG, SELFMAG) != 0 ||
+						ehdr[EI_CLASS] != class)
+		return -1;
+
+	/* e_machine comes right after e_type, in both classes */
+	memcpy(&e_machine, ehdr + EI_NIDENT + 2, sizeof(e_machine));
+	if(e_machine != machine)
+		return -1;
+
+	found->path = elfp_deps_strdup(deps, path);
+	if(found->path == NULL)
+		return -1;
+
+	found->dev = st.st_dev;
+	found->ino = st.st_ino;
+	found->err = 0;
+
+	return 0;
+}
+
+/*
+ * elfp_deps_expand: Expands a directory of a search path.
+ *
+ * 	* $ORIGIN is the directory of the file needing the library. $LIB
+ * 	is lib64 or lib. An empty directory is the current one.
+ *
+ * @return: 0 on success, -1 if it can't be expanded.
+ */
+static int
+elfp_deps_expand(const char *dir, unsigned long int len, const char *origin,
+		int class, char *buf, unsigned long int size)
+{
+	const char *value = NULL;
+	unsigned long int i, out, skip, value_len;
+
+	out = 0;
+	i = 0;
+	while(i < len)
+	{
+		if(dir[i] != '$')
+		{
+			if(out + 1 >= size)
+				return -1;
+			buf[out++] = dir[i++];
+			continue;
+		}
+
+		if(len - i >= 7 && strncmp(dir + i, "$ORIGIN", 7) == 0)
+		{
+			value = origin;
+			skip = 7;
+		}
+		else if(len - i >= 9 && strncmp(dir + i, "${ORIGIN}", 9) == 0)
+		{
+			value = origin;
+			skip = 9;
+		}
+		else if(len - i >= 4 && strncmp(dir + i, "$LIB", 4) == 0)
+		{
+			value = (class == ELFCLASS64) ? "lib64" : "lib";
+			skip = 4;
+		}
+		else if(len - i >= 6 && strncmp(dir + i, "${LIB}", 6) == 0)
+		{
+			value = (class == ELFCLASS64) ? "lib64" : "lib";
+			skip = 6;
+		}
+		else
+		{
+			/* $PLATFORM and friends depend on the machine it runs on */
+			return -1;
+		}
+
+		value_len = strlen(value);
+		if(out + value_len >= size)
+			return -1;
+		memcpy(buf + out, value, value_len);
+		out = out + value_len;
+		i = i + skip;
+	}
+
+	if(out == 0)
+		buf[out++] = '.';
+	buf[out] = '\0';
+
+	return 0;
+}
+
+/*
+ * elfp_deps_try_path: Searches the directories of a search path -
+ * 	DT_RPATH / DT_RUNPATH - for a library.
+ *
+ * @return: 0 if found, -1 if not.
+ */
+static int
+elfp_deps_try_path(elfp_deps *deps, const char *search, const char *origin,
+		int class, unsigned int machine, const char *name,
+		elfp_deps_found *found)
+{
+	char dir[PATH_MAX], path[PATH_MAX];
+	const char *start = NULL, *end = NULL;
+	int ret;
+
+	start = search;
+	while(1)
+	{
+		end = strchr(start, ':');
+		if(end == NULL)
+			end = start + strlen(start);
+
+		ret = elfp_deps_expand(start, end - start, origin, class,
+							dir, sizeof(dir));
+		if(ret == 0 && (unsigned int)snprintf(path, sizeof(path), "%s/%s",
+						dir, name) < sizeof(path))
+		{
+			if(elfp_deps_try(deps, path, class, machine, found) == 0)
+				return 0;
+		}
+
+		if(*end == '\0')
+			break;
+		start = end + 1;
+	}
+
+	return -1;
+}
+
+/*
+ * elfp_deps_try_default: Searches the default directories for a library.
+ *
+ * 	* The result depends only on the name, class and machine. It is
+ * 	cached, so that a library needed by many is searched for once.
+ *
+ * @return: 0 if found, -1 if not.
+ */
+static int
+elfp_deps_try_default(elfp_deps *deps, int class, unsigned int machine,
+			const char *name, elfp_deps_found *found)
+{
+	static const char *dirs[] = {"/lib", "/usr/lib"};
+	static const char *dirs64[] = {"/lib64", "/usr/lib64"};
+	elfp_deps_cached *cached = NULL;
+	const char *multiarch = NULL;
+	const char *cached_path = NULL;
+	char path[PATH_MAX];
+	unsigned int bucket, i;
+	int ret = -1;
+
+	bucket = (elfp_shdr_hash(name) ^ machine) % ELFP_DEPS_CACHE_BUCKETS;
+
+	/* Searched for already? */
+	pthread_mutex_lock(&deps->lock);
+	for(cached = deps->cache[bucket]; cached != NULL; cached = cached->next)
+	{
+		if(cached->class == class && cached->machine == machine &&
+					strcmp(cached->name, name) == 0)
+		{
+			*found = cached->found;
+			pthread_mutex_unlock(&deps->lock);
+			return (found->err == 0) ? 0 : -1;
+		}
+	}
+	pthread_mutex_unlock(&deps->lock);
+
+	/* 1. ld.so.cache. A hit costs one open() instead of one for every
+	 * directory */
+	if(deps->ldcache != NULL)
+	{
+		cached_path = elfp_ldcache_lookup(deps->ldcache, name,
+				elfp_ldcache_flags(class, machine), 0);
+		if(cached_path != NULL)
+			ret = elfp_deps_try(deps, cached_path, class, machine, found);
+	}
+
+	/* 2. Multiarch directories */
+	multiarch = elfp_deps_multiarch(class, machine);
+	for(i = 0; ret == -1 && multiarch != NULL && i < 2; i++)
+	{
+		snprintf(path, sizeof(path), "%s/%s/%s", dirs[i], multiarch, name);
+		ret = elfp_deps_try(deps, path, class, machine, found);
+	}
+
+	/* 3. lib64 directories, for 64-bit files */
+	for(i = 0; ret == -1 && class == ELFCLASS64 && i < 2; i++)
+	{
+		snprintf(path, sizeof(path), "%s/%s", dirs64[i], name);
+		ret = elfp_deps_try(deps, path, class, machine, found);
+	}
+
+	/* 4. lib directories */
+	for(i = 0; ret == -1 && i < 2; i++)
+	{
+		snprintf(path, sizeof(path), "%s/%s", dirs[i], name);
+		ret = elfp_deps_try(deps, path, class, machine, found);
+	}
+
+	if(ret == -1)
+	{
+		found->path = NULL;
+		found->err = ENOENT;
+	}
+
+	/* Another worker may have searched for it meanwhile. Both got the
+	 * same answer, keeping one is enough */
+	cached = elfp_deps_alloc(deps, sizeof(elfp_deps_cached));
+	if(cached == NULL)
+		return ret;
+
+	cached->name = elfp_deps_strdup(deps, name);
+	if(cached->name == NULL)
+		return ret;
+
+	cached->class = class;
+	cached->machine = machine;
+	cached->found = *found;
+
+	pthread_mutex_lock(&deps->lock);
+	cached->next = deps->cache[bucket];
+	deps->cache[bucket] = cached;
+	pthread_mutex_unlock(&deps->lock);
+
+	return ret;
+}
+
+/*
+ * elfp_deps_search: Searches for a library needed by a file, in the
+ * 	order the dynamic loader does.
+ *
+ * @arg2: DT_RPATHs of the file and its loading chain.
+ */
+static void
+elfp_deps_search(elfp_deps *deps, const elfp_dynamic *info,
+		const elfp_deps_rpath *rpaths, const char *origin,
+		int class, unsigned int machine, const char *name,
+		elfp_deps_found *found)
+{
+	const elfp_deps_rpath *rpath = NULL;
+
+	/* A path. Nothing to search */
+	if(strchr(name, '/') != NULL)
+	{
+		if(elfp_deps_try(deps, name, class, machine, found) == -1)
+			found->err = ENOENT;
+		return;
+	}
+
+	/*
+	 * DT_RPATHs of the loading chain, the file's own first. All of them
+	 * are ignored if the file has a DT_RUNPATH.
+	 */
+	if(info == NULL || info->runpath == NULL)
+	{
+		for(rpath = rpaths; rpath != NULL; rpath = rpath->next)
+		{
+			if(elfp_deps_try_path(deps, rpath->rpath, rpath->origin,
+					class, machine, name, found) == 0)
+				return;
+		}
+	}
+
+	if(info != NULL && info->runpath != NULL &&
+		elfp_deps_try_path(deps, info->runpath, origin, class, machine,
+							name, found) == 0)
+		return;
+
+	elfp_deps_try_default(deps, class, machine, name, found);
+}
+
+/*
+ * elfp_deps_task: Parses a file of the level, and searches for every
+ * 	library it needs. Runs on a worker.
+ */
+static void
+elfp_deps_task(void *arg, unsigned long int index)
+{
+	elfp_deps_level *level = arg;
+	elfp_deps *deps = level->deps;
+	elfp_deps_node *node = level->nodes[index];
+	elfp_main *main = NULL;
+	elfp_main_dynamic *dynamic = NULL;
+	const elfp_dynamic *info = NULL;
+	elfp_deps_rpath *rpath = NULL;
+	char origin[PATH_MAX];
+	const char *slash = NULL;
+	unsigned long int i, n;
+	uint16_t machine;
+	int class;
+
+	/* Only the parts which are needed are read */
+	errno = 0;
+	main = elfp_main_create(node->dep.path, ELFP_OPEN_HEADERS_ONLY);
+	if(main == NULL)
+	{
+		node->dep.err = (errno != 0) ? errno : ENOEXEC;
+		return;
+	}
+
+	class = elfp_main_get_class(main);
+	dynamic = elfp_dyn_index_get(main);
+	if(dynamic == NULL ||
+		elfp_main_read(main, EI_NIDENT + 2, sizeof(machine), &machine) == -1)
+	{
+		node->dep.err = ENOEXEC;
+		elfp_main_release(main);
+		return;
+	}
+
+	/* Statically linked. Needs nothing */
+	if(dynamic->dyn == NULL)
+	{
+		elfp_main_release(main);
+		return;
+	}
+	info = &dynamic->info;
+
+	/* $ORIGIN is the directory the file is in */
+	slash = strrchr(node->dep.path, '/');
+	if(slash == NULL)
+		strcpy(origin, ".");
+	else if(slash == node->dep.path)
+		strcpy(origin, "/");
+	else
+		snprintf(origin, sizeof(origin), "%.*s",
+				(int)(slash - node->dep.path), node->dep.path);
+
+	/*
+	 * Files this one loads search its DT_RPATH, then the chain's. A
+	 * DT_RPATH next to a DT_RUNPATH is not used, but the chain above
+	 * still is.
+	 */
+	node->rpaths = node->loader;
+	if(info->rpath != NULL && info->runpath == NULL)
+	{
+		rpath = elfp_deps_alloc(deps, sizeof(elfp_deps_rpath));
+		if(rpath == NULL)
+		{
+			node->dep.err = ENOMEM;
+			elfp_main_release(main);
+			return;
+		}
+
+		/* The strings in the file go away with the object */
+		rpath->rpath = elfp_deps_strdup(deps, info->rpath);
+		rpath->origin = elfp_deps_strdup(deps, origin);
+		if(rpath->rpath == NULL || rpath->origin == NULL)
+		{
+			node->dep.err = ENOMEM;
+			elfp_main_release(main);
+			return;
+		}
+
+		rpath->next = node->loader;
+		node->rpaths = rpath;
+	}
+
+	n = info->n_needed;
+	node->dep.names = elfp_deps_alloc(deps, n * sizeof(const char *) + 1);
+	node->found = elfp_deps_alloc(deps, n * sizeof(elfp_deps_found) + 1);
+	if(node->dep.names == NULL || node->found == NULL)
+	{
+		node->dep.err = ENOMEM;
+		elfp_main_release(main);
+		return;
+	}
+
+	for(i = 0; i < n; i++)
+	{
+		node->dep.names[i] = elfp_deps_strdup(deps, info->needed[i]);
+		if(node->dep.names[i] == NULL)
+		{
+			node->dep.err = ENOMEM;
+			break;
+		}
+
+		elfp_deps_search(deps, info, node->rpaths, origin, class,
+				machine, info->needed[i], node->found + i);
+	}
+	node->dep.n_needed = i;
+
+	elfp_main_release(main);
+}
+
+/*
+ * elfp_deps_node_hash: Found files are hashed by identity, others by
+ * 	name.
+ */
+static unsigned long int
+elfp_deps_node_hash(const char *name, const elfp_deps_found *found)
+{
+	if(found->err != 0)
+		return elfp_shdr_hash(name);
+
+	return (found->dev * 0x9e3779b97f4a7c15UL) ^ found->ino;
+}
+
+/*
+ * elfp_deps_buckets_grow: Doubles the node buckets, once there are more
+ * 	nodes than buckets.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_deps_buckets_grow(elfp_deps *deps)
+{
+	elfp_deps_node **buckets = NULL;
+	elfp_deps_node *node = NULL;
+	elfp_deps_found found;
+	unsigned long int n_buckets, i, bucket;
+
+	n_buckets = deps->n_buckets * 2;
+	buckets = calloc(n_buckets, sizeof(elfp_deps_node *));
+	if(buckets == NULL)
+	{
+		elfp_err_warn("elfp_deps_buckets_grow", "calloc() failed");
+		return -1;
+	}
+
+	for(i = 0; i < deps->count; i++)
+	{
+		node = deps->nodes[i];
+		found.dev = node->dev;
+		found.ino = node->ino;
+		found.err = (node->dep.path == NULL) ? ENOENT : 0;
+
+		bucket = elfp_deps_node_hash(node->dep.name, &found) & (n_buckets - 1);
+		node->next = buckets[bucket];
+		buckets[bucket] = node;
+	}
+
+	free(deps->buckets);
+	deps->buckets = buckets;
+	deps->n_buckets = n_buckets;
+
+	return 0;
+}
+
+/*
+ * elfp_deps_node_get: Gets the node of a file, adding it to the graph
+ * 	if it is not there yet. Only the calling thread does this.
+ *
+ * @arg4: Set to 1 if the node is new.
+ *
+ * @return: Index of the node on success, -1 on failure.
+ */
+static long int
+elfp_deps_node_get(elfp_deps *deps, const char *name,
+		const elfp_deps_found *found, int *created)
+{
+	elfp_deps_node *node = NULL;
+	elfp_deps_node **nodes = NULL;
+	unsigned long int bucket, total;
+
+	*created = 0;
+
+	bucket = elfp_deps_node_hash(name, found) & (deps->n_buckets - 1);
+	for(node = deps->buckets[bucket]; node != NULL; node = node->next)
+	{
+		if(found->err == 0 && node->dep.path != NULL &&
+			node->dev == found->dev && node->ino == found->ino)
+			return node->index;
+
+		if(found->err != 0 && node->dep.path == NULL &&
+					strcmp(node->dep.name, name) == 0)
+			return node->index;
+	}
+
+	/* A new one */
+	if(deps->count == deps->total)
+	{
+		total = deps->total * 2;
+		nodes = realloc(deps->nodes, total * sizeof(elfp_deps_node *));
+		if(nodes == NULL)
+		{
+			elfp_err_warn("elfp_deps_node_get", "realloc() failed");
+			return -1;
+		}
+		deps->nodes = nodes;
+		deps->total = total;
+	}
+
+	node = elfp_deps_alloc(deps, sizeof(elfp_deps_node));
+	if(node == NULL)
+		return -1;
+
+	node->dep.name = name;
+	node->dep.path = found->path;
+	node->dep.err = found->err;
+	node->dev = found->dev;
+	node->ino = found->ino;
+	node->index = deps->count;
+
+	node->next = deps->buckets[bucket];
+	deps->buckets[bucket] = node;
+	deps->nodes[deps->count] = node;
+	deps->count++;
+
+	if(deps->count > deps->n_buckets && elfp_deps_buckets_grow(deps) == -1)
+		return -1;
+
+	*created = 1;
+	return node->index;
+}
+
+/*
+ * elfp_deps_level_add: Adds a node to a level.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_deps_level_add(elfp_deps_level *level, elfp_deps_node *node)
+{
+	elfp_deps_node **nodes = NULL;
+	unsigned long int total;
+
+	if(level->count == level->total)
+	{
+		total = (level->total == 0) ? 16 : level->total * 2;
+		nodes = realloc(level->nodes, total * sizeof(elfp_deps_node *));
+		if(nodes == NULL)
+		{
+			elfp_err_warn("elfp_deps_level_add", "realloc() failed");
+			return -1;
+		}
+		level->nodes = nodes;
+		level->total = total;
+	}
+
+	level->nodes[level->count] = node;
+	level->count++;
+
+	return 0;
+}
+
+/*
+ * elfp_deps_level_merge: Makes the edges of a parsed level, and collects
+ * 	the files seen for the first time into the next one.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_deps_level_merge(elfp_deps *deps, elfp_deps_level *level,
+					elfp_deps_level *next)
+{
+	elfp_deps_node *node = NULL;
+	unsigned long int i, j;
+	long int index;
+	int created;
+
+	for(i = 0; i < level->count; i++)
+	{
+		node = level->nodes[i];
+		if(node->dep.n_needed == 0)
+			continue;
+
+		node->dep.needed = elfp_deps_alloc(deps,
+				node->dep.n_needed * sizeof(unsigned long int));
+		if(node->dep.needed == NULL)
+			return -1;
+
+		for(j = 0; j < node->dep.n_needed; j++)
+		{
+			index = elfp_deps_node_get(deps, node->dep.names[j],
+						node->found + j, &created);
+			if(index == -1)
+				return -1;
+
+			node->dep.needed[j] = index;
+
+			/* Files which were not found have nothing to parse */
+			if(created == 0 || node->found[j].err != 0)
+				continue;
+
+			/* The first file which needs it loads it */
+			deps->nodes[index]->loader = node->rpaths;
+			if(elfp_deps_level_add(next, deps->nodes[index]) == -1)
+				return -1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * All functions defined below are exposed to programmers.
+ *
+ * Refer to elfp.h for more details.
+ */
+
+elfp_deps*
+elfp_deps_resolve(const char **roots, unsigned long int n_roots,
+					unsigned int n_threads)
+{
+	/* Basic check */
+	if(roots == NULL || n_roots == 0)
+	{
+		elfp_err_warn("elfp_deps_resolve", "Invalid argument(s) passed");
+		return NULL;
+	}
+
+	elfp_deps *deps = NULL;
+	elfp_deps_level level, next;
+	elfp_deps_found found;
+	const char *name = NULL;
+	struct stat st;
+	unsigned long int i;
+	long int index;
+	int created, ret;
+
+	memset(&level, 0, sizeof(level));
+	memset(&next, 0, sizeof(next));
+
+	/* Allocate memory */
+	deps = calloc(1, sizeof(elfp_deps));
+	if(deps == NULL)
+	{
+		elfp_err_warn("elfp_deps_resolve", "calloc() failed");
+		return NULL;
+	}
+
+	pthread_mutex_init(&deps->lock, NULL);
+	elfp_ds_arena_init(&deps->arena);
+
+	deps->total = 64;
+	deps->n_buckets = ELFP_DEPS_NODE_BUCKETS;
+	deps->n_roots = n_roots;
+	deps->nodes = malloc(deps->total * sizeof(elfp_deps_node *));
+	deps->buckets = calloc(deps->n_buckets, sizeof(elfp_deps_node *));
+	deps->roots = malloc(n_roots * sizeof(unsigned long int));
+	if(deps->nodes == NULL || deps->buckets == NULL || deps->roots == NULL)
+	{
+		elfp_err_warn("elfp_deps_resolve", "malloc() failed");
+		goto fail_err;
+	}
+
+	/* Not having one is fine. Directories are searched then */
+	deps->ldcache = elfp_ldcache_open(NULL);
+
+	/* 1. Roots are the first level. Same file given twice is one node */
+	level.deps = deps;
+	for(i = 0; i < n_roots; i++)
+	{
+		if(roots[i] == NULL)
+		{
+			elfp_err_warn("elfp_deps_resolve", "NULL root passed");
+			goto fail_err;
+		}
+
+		name = elfp_deps_strdup(deps, roots[i]);
+		if(name == NULL)
+			goto fail_err;
+
+		memset(&found, 0, sizeof(found));
+		if(stat(roots[i], &st) == -1)
+		{
+			found.err = errno;
+		}
+		else
+		{
+			found.path = name;
+			found.dev = st.st_dev;
+			found.ino = st.st_ino;
+		}
+
+		index = elfp_deps_node_get(deps, name, &found, &created);
+		if(index == -1)
+			goto fail_err;
+
+		deps->roots[i] = index;
+		if(created == 1 && found.err == 0 &&
+			elfp_deps_level_add(&level, deps->nodes[index]) == -1)
+			goto fail_err;
+	}
+
+	/* 2. A level at a time, till there is nothing new */
+	while(level.count != 0)
+	{
+		ret = elfp_pool_run(level.count, n_threads, elfp_deps_task, &level);
+		if(ret == -1)
+		{
+			elfp_err_warn("elfp_deps_resolve", "elfp_pool_run() failed");
+			goto fail_err;
+		}
+
+		next.deps = deps;
+		next.count = 0;
+		ret = elfp_deps_level_merge(deps, &level, &next);
+		if(ret == -1)
+		{
+			elfp_err_warn("elfp_deps_resolve", "elfp_deps_level_merge() failed");
+			goto fail_err;
+		}
+
+		/* The next level reuses this one's memory */
+		free(level.nodes);
+		level = next;
+		memset(&next, 0, sizeof(next));
+	}
+
+	free(level.nodes);
+	return deps;
+
+fail_err:
+	free(level.nodes);
+	free(next.nodes);
+	elfp_deps_free(deps);
+	return NULL;
+}
+
+unsigned long int
+elfp_deps_count(elfp_deps *deps)
+{
+	if(deps == NULL)
+	{
+		elfp_err_warn("elfp_deps_count", "NULL argument passed");
+		return 0;
+	}
+
+	return deps->count;
+}
+
+const elfp_dep*
+elfp_deps_get(elfp_deps *deps, unsigned long int index)
+{
+	if(deps == NULL || index >= deps->count)
+	{
+		elfp_err_warn("elfp_deps_get", "Invalid argument(s) passed");
+		return NULL;
+	}
+
+	return &deps->nodes[index]->dep;
+}
+
+unsigned long int
+elfp_deps_root(elfp_deps *deps, unsigned long int root)
+{
+	if(deps == NULL || root >= deps->n_roots)
+	{
+		elfp_err_warn("elfp_deps_root", "Invalid argument(s) passed");
+		return (unsigned long int)-1;
+	}
+
+	return deps->roots[root];
+}
+
+int
+elfp_deps_dump(elfp_deps *deps, unsigned long int root)
+{
+	/* Basic check */
+	if(deps == NULL || root >= deps->n_roots)
+	{
+		elfp_err_warn("elfp_deps_dump", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	unsigned long int *queue = NULL;
+	unsigned char *seen = NULL;
+	unsigned long int head, tail, i, index;
+	const elfp_dep *dep = NULL;
+
+	queue = malloc(deps->count * sizeof(unsigned long int));
+	seen = calloc(deps->count, sizeof(unsigned char));
+	if(queue == NULL || seen == NULL)
+	{
+		elfp_err_warn("elfp_deps_dump", "malloc() failed");
+		free(queue);
+		free(seen);
+		return -1;
+	}
+
+	/* Breadth first, the order the loader loads them in */
+	index = deps->roots[root];
+	dep = &deps->nodes[index]->dep;
+	if(dep->err != 0)
+		printf("%s: %s\n", dep->name, strerror(dep->err));
+	else
+		printf("%s:\n", dep->name);
+
+	head = 0;
+	tail = 0;
+	queue[tail++] = index;
+	seen[index] = 1;
+	while(head < tail)
+	{
+		dep = &deps->nodes[queue[head++]]->dep;
+		for(i = 0; i < dep->n_needed; i++)
+		{
+			index = dep->needed[i];
+			if(seen[index] == 1)
+				continue;
+			seen[index] = 1;
+			queue[tail++] = index;
+
+			if(deps->nodes[index]->dep.path == NULL)
+				printf("\t%s => not found\n", dep->names[i]);
+			else
+				printf("\t%s => %s\n", dep->names[i],
+						deps->nodes[index]->dep.path);
+		}
+	}
+
+	free(queue);
+	free(seen);
+
+	return 0;
+}
+
+void
+elfp_deps_free(elfp_deps *deps)
+{
+	if(deps == NULL)
+		return;
+
+	elfp_ldcache_close(deps->ldcache);
+	elfp_ds_arena_fini(&deps->arena);
+	pthread_mutex_destroy(&deps->lock);
+	free(deps->nodes);
+	free(deps->buckets);
+	free(deps->roots);
+	free(deps);
+}
@@ -0,0 +1,2050 @@
+/*
+ * File: elfp_die.c
+ *
+ * Description: Address -> function, inlined ones included, from the
+ * 	DIEs of .debug_info. DWARF 2 to 5.
+ *
+ * 	* Two indexes, both built the first time they are needed:
+ * 	* The unit table - the units of .debug_info, their abbreviation
+ * 	tables decoded, and what their unit DIEs say. Plus which unit an
+ * 	address is in, from .debug_aranges / the unit DIEs.
+ * 	* The function index - address ranges of every DW_TAG_subprogram
+ * 	and DW_TAG_inlined_subroutine DIE, sorted by address.
+ * 	* Both are built a unit per task, on many threads for big files.
+ * 	* Building the function index reads the attributes of function
+ * 	DIEs only. Every other DIE is skipped with its abbreviation's skip
+ * 	steps - attributes of fixed size in one go - and types with a
+ * 	DW_AT_sibling are jumped over whole.
+ * 	* Names are not copied. They point into .debug_info / .debug_str /
+ * 	.debug_line_str.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#include "./include/elfp_die.h"
+#include "./include/elfp_dwarf.h"
+#include "./include/elfp_line.h"
+#include "./include/elfp_shdr.h"
+#include "./include/elfp_sym.h"
+#include "./include/elfp_pool.h"
+#include "./include/elfp_int.h"
+#include "./include/elfp_err.h"
+#include "./include/elfp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <elf.h>
+
+/* .debug_info bigger than this is decoded on many threads */
+#define ELFP_DIE_PARALLEL_MIN (256 * 1024)
+
+/* Most abstract_origin / specification links followed for a name */
+#define ELFP_DIE_HOPS_MAX 8
+
+/* The attributes of a DIE the indexes care about. A value's form is 0
+ * if the DIE doesn't have the attribute */
+typedef struct elfp_die_attrs
+{
+	unsigned int tag;
+	int declaration;
+
+	elfp_dwarf_value name;
+	elfp_dwarf_value linkage_name;
+	elfp_dwarf_value low_pc;
+	elfp_dwarf_value high_pc;
+	elfp_dwarf_value ranges;
+	elfp_dwarf_value comp_dir;
+	elfp_dwarf_value stmt_list;
+	elfp_dwarf_value origin;
+	elfp_dwarf_value specification;
+	elfp_dwarf_value sibling;
+	elfp_dwarf_value call_file;
+	elfp_dwarf_value call_line;
+	elfp_dwarf_value str_offsets_base;
+	elfp_dwarf_value addr_base;
+	elfp_dwarf_value rnglists_base;
+
+} elfp_die_attrs;
+
+/* Address ranges, two longs (low, high) each */
+typedef struct elfp_die_ranges
+{
+	unsigned long int *list;
+	unsigned long int count;
+	unsigned long int max;
+
+} elfp_die_ranges;
+
+/* A function range as a unit's task finds it */
+typedef struct elfp_die_row
+{
+	unsigned long int low;
+	unsigned long int high;
+	unsigned long int die;
+	unsigned int call_file;
+	unsigned int call_line;
+	int inlined;
+
+} elfp_die_row;
+
+/* What a unit's task of the function index puts out */
+typedef struct elfp_die_out
+{
+	elfp_die_row *rows;
+	unsigned long int count;
+	unsigned long int max;
+	int broken;
+
+} elfp_die_out;
+
+/* What the tasks share */
+typedef struct elfp_die_build
+{
+	elfp_main *main;
+	elfp_main_units *units;
+	elfp_die_out *outs;
+
+} elfp_die_build;
+
+/*
+ * elfp_die_grow: Makes room for one more element in a malloc()ed array.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_die_grow(void **array, unsigned long int *max, unsigned long int count,
+						unsigned long int size)
+{
+	void *new_array = NULL;
+	unsigned long int new_max;
+
+	if(count < *max)
+		return 0;
+
+	new_max = (*max == 0) ? 16 : *max * 2;
+	new_array = realloc(*array, new_max * size);
+	if(new_array == NULL)
+		return -1;
+
+	*array = new_array;
+	*max = new_max;
+
+	return 0;
+}
+
+/*
+ * elfp_die_abbrev_cmp: Orders abbreviations by code.
+ */
+static int
+elfp_die_abbrev_cmp(const void *p1, const void *p2)
+{
+	const elfp_die_abbrev *a1 = p1, *a2 = p2;
+
+	return (a1->code > a2->code) - (a1->code < a2->code);
+}
+
+/*
+ * elfp_die_abbrev_action: What the function index does with DIEs of an
+ * 	abbreviation.
+ */
+static int
+elfp_die_abbrev_action(const elfp_die_abbrev *abbrev)
+{
+	unsigned int i;
+
+	switch(abbrev->tag)
+	{
+		case DW_TAG_subprogram:
+		case DW_TAG_inlined_subroutine:
+			return ELFP_DIE_FUNC;
+
+		/* Nothing in a type has code. Methods defined in a class
+		 * are declarations, their definitions are outside it */
+		case DW_TAG_array_type:
+		case DW_TAG_class_type:
+		case DW_TAG_enumeration_type:
+		case DW_TAG_structure_type:
+		case DW_TAG_subroutine_type:
+		case DW_TAG_union_type:
+			if(abbrev->has_children == 0)
+				return ELFP_DIE_SKIP;
+
+			for(i = 0; i < abbrev->n_attrs; i++)
+			{
+				if(abbrev->attrs[i].name == DW_AT_sibling)
+					return ELFP_DIE_SUBTREE;
+			}
+			return ELFP_DIE_SKIP;
+
+		default:
+			return ELFP_DIE_SKIP;
+	}
+}
+
+/*
+ * elfp_die_abbrevs_decode: Decodes an abbreviation table.
+ *
+ * 	* Goes over the table twice - first to count, then to fill up one
+ * 	arena block with everything.
+ *
+ * @return: NULL on failure, the table on success.
+ */
+static elfp_die_abbrevs*
+elfp_die_abbrevs_decode(elfp_main *main, const elfp_main_units *units,
+			const elfp_die_unit *unit)
+{
+	elfp_dwarf_cursor cursor;
+	elfp_die_abbrevs *abbrevs = NULL;
+	elfp_die_abbrev *abbrev = NULL;
+	elfp_die_attr *attrs = NULL;
+	elfp_die_skip *skips = NULL;
+	unsigned long int count, n_attrs, code, bytes, i;
+	unsigned int name, form;
+	unsigned char *block = NULL;
+	int pass, size;
+
+	cursor = units->abbrev;
+	if(unit->abbrev_offset >= (unsigned long int)(cursor.end - cursor.p))
+		return NULL;
+
+	count = 0;
+	n_attrs = 0;
+	for(pass = 0; pass < 2; pass++)
+	{
+		cursor = units->abbrev;
+		cursor.p = cursor.p + unit->abbrev_offset;
+		i = 0;
+
+		while(1)
+		{
+			code = elfp_dwarf_uleb(&cursor);
+			if(code == 0 || cursor.error != 0)
+				break;
+
+			if(pass == 1)
+			{
+				abbrev = abbrevs->list + i;
+				abbrev->code = code;
+				abbrev->tag = elfp_dwarf_uleb(&cursor);
+				abbrev->has_children = elfp_dwarf_u8(&cursor);
+				abbrev->attrs = attrs;
+				abbrev->skips = skips;
+			}
+			else
+			{
+				elfp_dwarf_uleb(&cursor);
+				elfp_dwarf_u8(&cursor);
+			}
+
+			bytes = 0;
+			while(1)
+			{
+				name = elfp_dwarf_uleb(&cursor);
+				form = elfp_dwarf_uleb(&cursor);
+				if((name == 0 && form == 0) || cursor.error != 0)
+					break;
+
+				if(pass == 0)
+				{
+					if(form == DW_FORM_implicit_const)
+						elfp_dwarf_sleb(&cursor);
+					n_attrs = n_attrs + 1;
+					continue;
+				}
+
+				attrs->name = name;
+				attrs->form = form;
+				if(form == DW_FORM_implicit_const)
+					attrs->implicit_const = elfp_dwarf_sleb(&cursor);
+				attrs++;
+				abbrev->n_attrs = abbrev->n_attrs + 1;
+
+				/* Fixed-size ones add up to one step */
+				size = elfp_dwarf_form_size(form, &unit->format);
+				if(size >= 0)
+				{
+					bytes = bytes + size;
+					continue;
+				}
+
+				skips->bytes = bytes;
+				skips->form = form;
+				skips++;
+				abbrev->n_skips = abbrev->n_skips + 1;
+				bytes = 0;
+			}
+
+			if(pass == 1)
+			{
+				if(bytes != 0 || abbrev->n_skips == 0)
+				{
+					skips->bytes = bytes;
+					skips->form = 0;
+					skips++;
+					abbrev->n_skips = abbrev->n_skips + 1;
+				}
+				abbrev->action = elfp_die_abbrev_action(abbrev);
+			}
+			i = i + 1;
+		}
+
+		if(cursor.error != 0)
+			return NULL;
+
+		if(pass == 1)
+			break;
+
+		count = i;
+
+		/* An attribute is at most a step, plus one per abbreviation */
+		block = elfp_main_alloc(main, sizeof(elfp_die_abbrevs) +
+				count * sizeof(elfp_die_abbrev) +
+				n_attrs * sizeof(elfp_die_attr) +
+				(n_attrs + count) * sizeof(elfp_die_skip));
+		if(block == NULL)
+		{
+			elfp_err_warn("elfp_die_abbrevs_decode", "elfp_main_alloc() failed");
+			return NULL;
+		}
+
+		abbrevs = (elfp_die_abbrevs *)block;
+		abbrevs->list = (elfp_die_abbrev *)(abbrevs + 1);
+		attrs = (elfp_die_attr *)(abbrevs->list + count);
+		skips = (elfp_die_skip *)(attrs + n_attrs);
+		abbrevs->count = count;
+	}
+
+	abbrevs->dense = 1;
+	for(i = 0; i < count; i++)
+	{
+		if(abbrevs->list[i].code != i + 1)
+		{
+			abbrevs->dense = 0;
+			break;
+		}
+	}
+
+	if(abbrevs->dense == 0)
+		qsort(abbrevs->list, count, sizeof(elfp_die_abbrev),
+						elfp_die_abbrev_cmp);
+
+	return abbrevs;
+}
+
+/*
+ * elfp_die_abbrev_find: Finds an abbreviation by its code.
+ *
+ * @return: The abbreviation, NULL if there is no such code.
+ */
+static const elfp_die_abbrev*
+elfp_die_abbrev_find(const elfp_die_abbrevs *abbrevs, unsigned long int code)
+{
+	unsigned long int low, high, middle;
+
+	if(abbrevs->dense != 0)
+		return (code - 1 < abbrevs->count) ? abbrevs->list + code - 1 : NULL;
+
+	low = 0;
+	high = abbrevs->count;
+	while(low < high)
+	{
+		middle = low + (high - low) / 2;
+		if(abbrevs->list[middle].code < code)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	if(low == abbrevs->count || abbrevs->list[low].code != code)
+		return NULL;
+
+	return abbrevs->list + low;
+}
+
+/*
+ * elfp_die_attrs_skip: Skips the attributes of a DIE.
+ */
+static void
+elfp_die_attrs_skip(elfp_dwarf_cursor *cursor, const elfp_die_abbrev *abbrev,
+				const elfp_dwarf_format *format)
+{
+	const elfp_die_skip *skip = NULL;
+	unsigned int i;
+
+	for(i = 0; i < abbrev->n_skips; i++)
+	{
+		skip = abbrev->skips + i;
+		elfp_dwarf_skip(cursor, skip->bytes);
+		if(skip->form != 0)
+			elfp_dwarf_form_skip(cursor, skip->form, format);
+	}
+}
+
+/*
+ * elfp_die_read: Reads the attributes of a DIE.
+ *
+ * @return: 0 on success, -1 if the DIE is broken.
+ */
+static int
+elfp_die_read(elfp_dwarf_cursor *cursor, const elfp_die_abbrev *abbrev,
+		const elfp_dwarf_format *format, elfp_die_attrs *attrs)
+{
+	const elfp_die_attr *attr = NULL;
+	elfp_dwarf_value value;
+	unsigned int i;
+
+	memset(attrs, 0, sizeof(elfp_die_attrs));
+	attrs->tag = abbrev->tag;
+
+	for(i = 0; i < abbrev->n_attrs; i++)
+	{
+		attr = abbrev->attrs + i;
+		if(elfp_dwarf_form_read(cursor, attr->form, format, &value) == -1)
+			return -1;
+		if(value.form == DW_FORM_implicit_const)
+			value.u = attr->implicit_const;
+
+		switch(attr->name)
+		{
+			case DW_AT_name:
+				attrs->name = value;
+				break;
+			case DW_AT_linkage_name:
+			case DW_AT_MIPS_linkage_name:
+				attrs->linkage_name = value;
+				break;
+			case DW_AT_low_pc:
+				attrs->low_pc = value;
+				break;
+			case DW_AT_high_pc:
+				attrs->high_pc = value;
+				break;
+			case DW_AT_ranges:
+				attrs->ranges = value;
+				break;
+			case DW_AT_comp_dir:
+				attrs->comp_dir = value;
+				break;
+			case DW_AT_stmt_list:
+				attrs->stmt_list = value;
+				break;
+			case DW_AT_abstract_origin:
+				attrs->origin = value;
+				break;
+			case DW_AT_specification:
+				attrs->specification = value;
+				break;
+			case DW_AT_sibling:
+				attrs->sibling = value;
+				break;
+			case DW_AT_call_file:
+				attrs->call_file = value;
+				break;
+			case DW_AT_call_line:
+				attrs->call_line = value;
+				break;
+			case DW_AT_declaration:
+				attrs->declaration = (value.u != 0);
+				break;
+			case DW_AT_str_offsets_base:
+				attrs->str_offsets_base = value;
+				break;
+			case DW_AT_addr_base:
+			case DW_AT_GNU_addr_base:
+				attrs->addr_base = value;
+				break;
+			case DW_AT_rnglists_base:
+				attrs->rnglists_base = value;
+				break;
+			default:
+				break;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * elfp_die_string: Gets the string an attribute's value is / points to.
+ *
+ * @return: The string, NULL if it can't be found.
+ */
+static const char*
+elfp_die_string(const elfp_main_units *units, const elfp_die_unit *unit,
+					const elfp_dwarf_value *value)
+{
+	elfp_dwarf_cursor cursor;
+	unsigned long int offset;
+
+	switch(value->form)
+	{
+		case DW_FORM_string:
+			return (const char *)value->data;
+
+		case DW_FORM_strp:
+			return elfp_dwarf_str(&units->str, value->u);
+
+		case DW_FORM_line_strp:
+			return elfp_dwarf_str(&units->line_str, value->u);
+
+		/* An index in the unit's part of .debug_str_offsets */
+		case DW_FORM_strx:
+		case DW_FORM_strx1:
+		case DW_FORM_strx2:
+		case DW_FORM_strx3:
+		case DW_FORM_strx4:
+		case DW_FORM_GNU_str_index:
+			cursor = units->str_offsets;
+			offset = unit->str_offsets_base +
+					value->u * unit->format.offset_size;
+			elfp_dwarf_skip(&cursor, offset);
+			offset = elfp_dwarf_uint(&cursor, unit->format.offset_size);
+			if(cursor.error != 0)
+				return NULL;
+			return elfp_dwarf_str(&units->str, offset);
+
+		default:
+			return NULL;
+	}
+}
+
+/*
+ * elfp_die_addrx: Gets an address of the unit's part of .debug_addr.
+ *
+ * @return: 0 on success, -1 if the index is junk.
+ */
+static int
+elfp_die_addrx(const elfp_main_units *units, const elfp_die_unit *unit,
+			unsigned long int index, unsigned long int *addr)
+{
+	elfp_dwarf_cursor cursor;
+
+	cursor = units->addr;
+	elfp_dwarf_skip(&cursor, unit->addr_base +
+				index * unit->format.addr_size);
+	*addr = elfp_dwarf_uint(&cursor, unit->format.addr_size);
+
+	return (cursor.error == 0) ? 0 : -1;
+}
+
+/*
+ * elfp_die_address: Gets the address an attribute's value is / points to.
+ *
+ * @return: 0 on success, -1 if the value is not an address.
+ */
+static int
+elfp_die_address(const elfp_main_units *units, const elfp_die_unit *unit,
+		const elfp_dwarf_value *value, unsigned long int *addr)
+{
+	switch(value->form)
+	{
+		case DW_FORM_addr:
+			*addr = value->u;
+			return 0;
+
+		case DW_FORM_addrx:
+		case DW_FORM_addrx1:
+		case DW_FORM_addrx2:
+		case DW_FORM_addrx3:
+		case DW_FORM_addrx4:
+		case DW_FORM_GNU_addr_index:
+			return elfp_die_addrx(units, unit, value->u, addr);
+
+		default:
+			return -1;
+	}
+}
+
+/*
+ * elfp_die_ref: Gets the .debug_info offset of the DIE a reference
+ * 	points to.
+ *
+ * @return: 0 on success, -1 if it points outside .debug_info.
+ */
+static int
+elfp_die_ref(const elfp_die_unit *unit, const elfp_dwarf_value *value,
+						unsigned long int *offset)
+{
+	switch(value->form)
+	{
+		case DW_FORM_ref1:
+		case DW_FORM_ref2:
+		case DW_FORM_ref4:
+		case DW_FORM_ref8:
+		case DW_FORM_ref_udata:
+			*offset = unit->offset + value->u;
+			return 0;
+
+		case DW_FORM_ref_addr:
+			*offset = value->u;
+			return 0;
+
+		/* Other files / type units */
+		default:
+			return -1;
+	}
+}
+
+/*
+ * elfp_die_range_add: Adds [low, high) to a list of ranges.
+ *
+ * 	* Empty ranges and ranges of code the linker threw away are left
+ * 	out. Linkers point those at 0 or at the highest address.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_die_range_add(const elfp_main_units *units, const elfp_die_unit *unit,
+	elfp_die_ranges *ranges, unsigned long int low, unsigned long int high)
+{
+	unsigned long int max_addr;
+
+	max_addr = (unit->format.addr_size == 4) ? 0xffffffffUL : ~0UL;
+	if(high <= low || low >= max_addr - 1 ||
+			(low == 0 && units->relocatable == 0))
+		return 0;
+
+	if(elfp_die_grow((void **)&ranges->list, &ranges->max,
+			ranges->count * 2 + 1, sizeof(unsigned long int)) == -1)
+		return -1;
+
+	ranges->list[ranges->count * 2] = low;
+	ranges->list[ranges->count * 2 + 1] = high;
+	ranges->count = ranges->count + 1;
+
+	return 0;
+}
+
+/*
+ * elfp_die_rnglist: Reads a range list of .debug_rnglists (DWARF 5).
+ *
+ * @return: 0 on success, -1 on failure / if the list is broken.
+ */
+static int
+elfp_die_rnglist(const elfp_main_units *units, const elfp_die_unit *unit,
+		unsigned long int offset, elfp_die_ranges *ranges)
+{
+	elfp_dwarf_cursor cursor;
+	unsigned long int base, low, high;
+	unsigned int kind, size;
+
+	cursor = units->rnglists;
+	elfp_dwarf_skip(&cursor, offset);
+	size = unit->format.addr_size;
+	base = unit->base;
+
+	while(cursor.error == 0)
+	{
+		kind = elfp_dwarf_u8(&cursor);
+		low = 0;
+		high = 0;
+
+		switch(kind)
+		{
+			case DW_RLE_end_of_list:
+				return (cursor.error == 0) ? 0 : -1;
+
+			case DW_RLE_base_addressx:
+				if(elfp_die_addrx(units, unit, elfp_dwarf_uleb(&cursor),
+								&base) == -1)
+					return -1;
+				continue;
+
+			case DW_RLE_startx_endx:
+				if(elfp_die_addrx(units, unit, elfp_dwarf_uleb(&cursor),
+								&low) == -1 ||
+					elfp_die_addrx(units, unit,
+					elfp_dwarf_uleb(&cursor), &high) == -1)
+					return -1;
+				break;
+
+			case DW_RLE_startx_length:
+				if(elfp_die_addrx(units, unit, elfp_dwarf_uleb(&cursor),
+								&low) == -1)
+					return -1;
+				high = low + elfp_dwarf_uleb(&cursor);
+				break;
+
+			case DW_RLE_offset_pair:
+				low = base + elfp_dwarf_uleb(&cursor);
+				high = base + elfp_dwarf_uleb(&cursor);
+				break;
+
+			case DW_RLE_base_address:
+				base = elfp_dwarf_uint(&cursor, size);
+				continue;
+
+			case DW_RLE_start_end:
+				low = elfp_dwarf_uint(&cursor, size);
+				high = elfp_dwarf_uint(&cursor, size);
+				break;
+
+			case DW_RLE_start_length:
+				low = elfp_dwarf_uint(&cursor, size);
+				high = low + elfp_dwarf_uleb(&cursor);
+				break;
+
+			default:
+				return -1;
+		}
+
+		if(cursor.error == 0 &&
+			elfp_die_range_add(units, unit, ranges, low, high) == -1)
+			return -1;
+	}
+
+	return -1;
+}
+
+/*
+ * elfp_die_range_list: Reads a range list of .debug_ranges (DWARF 2 - 4).
+ *
+ * @return: 0 on success, -1 on failure / if the list is broken.
+ */
+static int
+elfp_die_range_list(const elfp_main_units *units, const elfp_die_unit *unit,
+		unsigned long int offset, elfp_die_ranges *ranges)
+{
+	elfp_dwarf_cursor cursor;
+	unsigned long int base, low, high, max_addr;
+	unsigned int size;
+
+	cursor = units->ranges;
+	elfp_dwarf_skip(&cursor, offset);
+	size = unit->format.addr_size;
+	max_addr = (size == 4) ? 0xffffffffUL : ~0UL;
+	base = unit->base;
+
+	while(cursor.error == 0)
+	{
+		low = elfp_dwarf_uint(&cursor, size);
+		high = elfp_dwarf_uint(&cursor, size);
+		if(cursor.error != 0)
+			break;
+
+		if(low == 0 && high == 0)
+			return 0;
+
+		/* Base address selection */
+		if(low == max_addr)
+		{
+			base = high;
+			continue;
+		}
+
+		if(elfp_die_range_add(units, unit, ranges, base + low,
+							base + high) == -1)
+			return -1;
+	}
+
+	return -1;
+}
+
+/*
+ * elfp_die_pc_ranges: Gets the address ranges of a DIE - its low_pc /
+ * 	high_pc pair or its range list.
+ *
+ * @return: 0 on success, -1 on failure / if they are broken.
+ */
+static int
+elfp_die_pc_ranges(const elfp_main_units *units, const elfp_die_unit *unit,
+		const elfp_die_attrs *attrs, elfp_die_ranges *ranges)
+{
+	elfp_dwarf_cursor cursor;
+	unsigned long int low, high, offset;
+
+	if(attrs->low_pc.form != 0 && attrs->high_pc.form != 0)
+	{
+		if(elfp_die_address(units, unit, &attrs->low_pc, &low) == -1)
+			return -1;
+
+		/* high_pc of a constant class is a length (DWARF 4 on) */
+		if(elfp_die_address(units, unit, &attrs->high_pc, &high) == -1)
+			high = low + attrs->high_pc.u;
+
+		return elfp_die_range_add(units, unit, ranges, low, high);
+	}
+
+	if(attrs->ranges.form == 0)
+		return 0;
+
+	if(unit->format.version < 5)
+		return elfp_die_range_list(units, unit, attrs->ranges.u, ranges);
+
+	/* An index in the unit's offset table. Offsets there are from
+	 * where the table starts */
+	offset = attrs->ranges.u;
+	if(attrs->ranges.form == DW_FORM_rnglistx)
+	{
+		cursor = units->rnglists;
+		elfp_dwarf_skip(&cursor, unit->rnglists_base +
+					offset * unit->format.offset_size);
+		offset = elfp_dwarf_uint(&cursor, unit->format.offset_size);
+		if(cursor.error != 0)
+			return -1;
+		offset = offset + unit->rnglists_base;
+	}
+
+	return elfp_die_rnglist(units, unit, offset, ranges);
+}
+
+/*
+ * elfp_die_unit_task: Decodes a unit's abbreviation table and its unit DIE.
+ * 	A task of the unit table's pool.
+ */
+static void
+elfp_die_unit_task(void *arg, unsigned long int index)
+{
+	elfp_die_build *build = arg;
+	elfp_main_units *units = build->units;
+	elfp_die_unit *unit = units->units + index;
+	const elfp_die_abbrev *abbrev = NULL;
+	elfp_dwarf_cursor cursor;
+	elfp_die_attrs attrs;
+	elfp_die_ranges ranges;
+
+	unit->abbrevs = elfp_die_abbrevs_decode(build->main, units, unit);
+	if(unit->abbrevs == NULL)
+		return;
+
+	cursor = units->info;
+	cursor.end = cursor.p + unit->end;
+	cursor.p = cursor.p + unit->die;
+
+	abbrev = elfp_die_abbrev_find(unit->abbrevs, elfp_dwarf_uleb(&cursor));
+	if(abbrev == NULL ||
+		elfp_die_read(&cursor, abbrev, &unit->format, &attrs) == -1)
+		return;
+
+	/* The bases first - the other attributes may need them */
+	unit->tag = attrs.tag;
+	unit->str_offsets_base = attrs.str_offsets_base.u;
+	unit->addr_base = attrs.addr_base.u;
+	unit->rnglists_base = attrs.rnglists_base.u;
+	if(attrs.low_pc.form != 0)
+		elfp_die_address(units, unit, &attrs.low_pc, &unit->base);
+
+	unit->name = elfp_die_string(units, unit, &attrs.name);
+	unit->comp_dir = elfp_die_string(units, unit, &attrs.comp_dir);
+	unit->has_stmt_list = (attrs.stmt_list.form != 0);
+	unit->stmt_list = attrs.stmt_list.u;
+
+	memset(&ranges, 0, sizeof(ranges));
+	elfp_die_pc_ranges(units, unit, &attrs, &ranges);
+	if(ranges.count != 0)
+	{
+		unit->ranges = elfp_main_alloc(build->main,
+				ranges.count * 2 * sizeof(unsigned long int));
+		if(unit->ranges != NULL)
+		{
+			memcpy(unit->ranges, ranges.list,
+				ranges.count * 2 * sizeof(unsigned long int));
+			unit->n_ranges = ranges.count;
+		}
+	}
+	free(ranges.list);
+}
+
+/*
+ * elfp_die_unit_find: Finds the unit a .debug_info offset is in.
+ *
+ * @return: Index of the unit, -1 if there is none.
+ */
+static long int
+elfp_die_unit_find(const elfp_main_units *units, unsigned long int offset)
+{
+	unsigned long int low, high, middle;
+
+	low = 0;
+	high = units->count;
+	while(low < high)
+	{
+		middle = low + (high - low) / 2;
+		if(units->units[middle].offset <= offset)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	if(low == 0 || offset >= units->units[low - 1].end)
+		return -1;
+
+	return low - 1;
+}
+
+/*
+ * elfp_die_aranges: Reads .debug_aranges - which unit covers what.
+ *
+ * @arg3: covered[i] is set for every unit i which has a set there.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_die_aranges(elfp_main *main, const elfp_main_units *units,
+			elfp_die_ranges *ranges, unsigned int **owners,
+			unsigned long int *max_owners, unsigned char *covered)
+{
+	elfp_dwarf_cursor section, set;
+	const unsigned char *start = NULL;
+	unsigned long int length, offset, low, size, align;
+	unsigned int offset_size, addr_size;
+	unsigned long int count;
+	long int index;
+	elfp_die_unit *unit = NULL;
+	const unsigned char *data = NULL;
+	int ret = 0;
+
+	if(elfp_dwarf_section_get(main, ".debug_aranges", &section) == -1)
+		return 0;
+
+	/* The ranges are copied out. The section is not needed after this */
+	data = section.p;
+
+	while(section.p < section.end && ret == 0)
+	{
+		start = section.p;
+		length = elfp_dwarf_unit_length(&section, &offset_size);
+		if(section.error != 0)
+			break;
+
+		set = section;
+		set.end = section.p + length;
+		elfp_dwarf_skip(&section, length);
+
+		elfp_dwarf_u16(&set);
+		offset = elfp_dwarf_uint(&set, offset_size);
+		addr_size = elfp_dwarf_u8(&set);
+		elfp_dwarf_u8(&set);
+		if(set.error != 0 || (addr_size != 4 && addr_size != 8))
+			continue;
+
+		index = elfp_die_unit_find(units, offset);
+		if(index == -1 || units->units[index].offset != offset)
+			continue;
+		unit = units->units + index;
+		covered[index] = 1;
+
+		/* Tuples start at a multiple of their size */
+		align = (set.p - start) % (2 * addr_size);
+		if(align != 0)
+			elfp_dwarf_skip(&set, 2 * addr_size - align);
+
+		while(set.error == 0)
+		{
+			low = elfp_dwarf_uint(&set, addr_size);
+			size = elfp_dwarf_uint(&set, addr_size);
+			if(set.error != 0 || (low == 0 && size == 0))
+				break;
+
+			count = ranges->count;
+			if(elfp_die_range_add(units, unit, ranges, low,
+							low + size) == -1 ||
+				elfp_die_grow((void **)owners, max_owners,
+				ranges->count, sizeof(unsigned int)) == -1)
+			{
+				ret = -1;
+				break;
+			}
+			if(ranges->count != count)
+				(*owners)[count] = index;
+		}
+	}
+
+	elfp_main_put_range(main, data);
+	return ret;
+}
+
+/*
+ * elfp_die_address_map: Builds the unit table's address map.
+ *
+ * 	* Units with a set in .debug_aranges are mapped from there, others
+ * 	from the ranges of their unit DIE.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_die_address_map(elfp_main *main, elfp_main_units *units)
+{
+	elfp_die_ranges ranges;
+	elfp_die_unit *unit = NULL;
+	unsigned int *owners = NULL, *order = NULL;
+	unsigned char *covered = NULL;
+	unsigned long int *lows = NULL, max_owners, count, i, j;
+	int ret = -1;
+
+	memset(&ranges, 0, sizeof(ranges));
+	max_owners = 0;
+
+	covered = calloc(units->count, 1);
+	if(covered == NULL)
+	{
+		elfp_err_warn("elfp_die_address_map", "calloc() failed");
+		return -1;
+	}
+
+	if(elfp_die_aranges(main, units, &ranges, &owners, &max_owners,
+							covered) == -1)
+		goto out;
+
+	for(i = 0; i < units->count; i++)
+	{
+		unit = units->units + i;
+		if(covered[i] != 0)
+			continue;
+
+		for(j = 0; j < unit->n_ranges; j++)
+		{
+			count = ranges.count;
+			if(elfp_die_range_add(units, unit, &ranges,
+				unit->ranges[2 * j], unit->ranges[2 * j + 1]) == -1 ||
+				elfp_die_grow((void **)&owners, &max_owners,
+				ranges.count, sizeof(unsigned int)) == -1)
+				goto out;
+			if(ranges.count != count)
+				owners[count] = i;
+		}
+	}
+
+	if(ranges.count == 0)
+	{
+		ret = 0;
+		goto out;
+	}
+
+	lows = malloc(ranges.count * sizeof(unsigned long int));
+	order = malloc(ranges.count * sizeof(unsigned int));
+	units->range_lows = elfp_main_alloc(main,
+				ranges.count * sizeof(unsigned long int));
+	units->range_highs = elfp_main_alloc(main,
+				ranges.count * sizeof(unsigned long int));
+	units->range_units = elfp_main_alloc(main,
+				ranges.count * sizeof(unsigned int));
+	if(lows == NULL || order == NULL || units->range_lows == NULL ||
+		units->range_highs == NULL || units->range_units == NULL)
+		goto out;
+
+	for(i = 0; i < ranges.count; i++)
+	{
+		lows[i] = ranges.list[2 * i];
+		order[i] = i;
+	}
+
+	if(elfp_sym_radix_sort(lows, order, ranges.count) == -1)
+		goto out;
+
+	for(i = 0; i < ranges.count; i++)
+	{
+		units->range_lows[i] = lows[i];
+		units->range_highs[i] = ranges.list[2 * order[i] + 1];
+		units->range_units[i] = owners[order[i]];
+	}
+	units->n_ranges = ranges.count;
+	ret = 0;
+
+out:
+	if(ret == -1)
+		elfp_err_warn("elfp_die_address_map", "Out of memory");
+
+	free(ranges.list);
+	free(owners);
+	free(covered);
+	free(lows);
+	free(order);
+
+	return ret;
+}
+
+/*
+ * elfp_die_units_build: Builds the unit table of a file.
+ *
+ * 	* Called with index_lock held. The section index is built already.
+ *
+ * @return: NULL on failure, the table on success.
+ */
+static elfp_main_units*
+elfp_die_units_build(elfp_main *main)
+{
+	elfp_main_units *units = NULL;
+	elfp_die_unit *list = NULL, *unit = NULL;
+	elfp_die_build build;
+	elfp_dwarf_cursor section, header;
+	const unsigned char *start = NULL;
+	unsigned long int max_units, count, length, i;
+	unsigned int offset_size;
+	unsigned short int type;
+	int ret;
+
+	units = elfp_main_alloc(main, sizeof(elfp_main_units));
+	if(units == NULL)
+	{
+		elfp_err_warn("elfp_die_units_build", "elfp_main_alloc() failed");
+		return NULL;
+	}
+
+	/* Nothing to index */
+	if(elfp_dwarf_section_get(main, ".debug_info", &units->info) == -1 ||
+		elfp_dwarf_section_get(main, ".debug_abbrev", &units->abbrev) == -1)
+		return units;
+
+	elfp_dwarf_section_get(main, ".debug_str", &units->str);
+	elfp_dwarf_section_get(main, ".debug_line_str", &units->line_str);
+	elfp_dwarf_section_get(main, ".debug_str_offsets", &units->str_offsets);
+	elfp_dwarf_section_get(main, ".debug_addr", &units->addr);
+	elfp_dwarf_section_get(main, ".debug_ranges", &units->ranges);
+	elfp_dwarf_section_get(main, ".debug_rnglists", &units->rnglists);
+
+	type = ET_NONE;
+	elfp_main_read(main, EI_NIDENT, sizeof(type), &type);
+	units->relocatable = (type == ET_REL);
+
+	/* Where the units are. Their headers say how long they are */
+	section = units->info;
+	max_units = 0;
+	count = 0;
+	while(section.p < section.end)
+	{
+		start = section.p;
+		header = section;
+		length = elfp_dwarf_unit_length(&section, &offset_size);
+		if(section.error != 0)
+		{
+			units->n_broken = units->n_broken + 1;
+			break;
+		}
+		header.end = section.p + length;
+		header.p = section.p;
+		elfp_dwarf_skip(&section, length);
+
+		if(elfp_die_grow((void **)&list, &max_units, count,
+					sizeof(elfp_die_unit)) == -1)
+		{
+			elfp_err_warn("elfp_die_units_build", "realloc() failed");
+			free(list);
+			return NULL;
+		}
+
+		unit = list + count;
+		memset(unit, 0, sizeof(elfp_die_unit));
+		unit->format.offset_size = offset_size;
+		unit->format.version = elfp_dwarf_u16(&header);
+		if(unit->format.version >= 5)
+		{
+			unit->unit_type = elfp_dwarf_u8(&header);
+			unit->format.addr_size = elfp_dwarf_u8(&header);
+			unit->abbrev_offset = elfp_dwarf_uint(&header, offset_size);
+
+			/* Type units have types only, skeletons nothing at all */
+			if(unit->unit_type == DW_UT_type ||
+				unit->unit_type == DW_UT_split_type)
+				continue;
+			if(unit->unit_type == DW_UT_skeleton ||
+				unit->unit_type == DW_UT_split_compile)
+				elfp_dwarf_skip(&header, 8);
+		}
+		else
+		{
+			unit->unit_type = DW_UT_compile;
+			unit->abbrev_offset = elfp_dwarf_uint(&header, offset_size);
+			unit->format.addr_size = elfp_dwarf_u8(&header);
+		}
+
+		if(header.error != 0 || unit->format.version < 2 ||
+			unit->format.version > 5 ||
+			(unit->format.addr_size != 4 && unit->format.addr_size != 8))
+		{
+			units->n_broken = units->n_broken + 1;
+			continue;
+		}
+
+		unit->offset = start - units->info.p;
+		unit->die = header.p - units->info.p;
+		unit->end = header.end - units->info.p;
+		count = count + 1;
+	}
+
+	if(count != 0)
+	{
+		units->units = elfp_main_alloc(main, count * sizeof(elfp_die_unit));
+		if(units->units == NULL)
+		{
+			elfp_err_warn("elfp_die_units_build", "elfp_main_alloc() failed");
+			free(list);
+			return NULL;
+		}
+		memcpy(units->units, list, count * sizeof(elfp_die_unit));
+	}
+	free(list);
+	units->count = count;
+
+	/* Small ones are over before the threads would have started */
+	memset(&build, 0, sizeof(build));
+	build.main = main;
+	build.units = units;
+	ret = elfp_pool_run(count, (units->info.end - units->info.p >=
+			ELFP_DIE_PARALLEL_MIN) ? 0 : 1, elfp_die_unit_task, &build);
+	if(ret == -1)
+	{
+		elfp_err_warn("elfp_die_units_build", "elfp_pool_run() failed");
+		return NULL;
+	}
+
+	for(i = 0; i < count; i++)
+	{
+		if(units->units[i].abbrevs == NULL)
+			units->n_broken = units->n_broken + 1;
+	}
+
+	if(elfp_die_address_map(main, units) == -1)
+	{
+		elfp_err_warn("elfp_die_units_build", "elfp_die_address_map() failed");
+		return NULL;
+	}
+
+	return units;
+}
+
+elfp_main_units*
+elfp_die_units_get(elfp_main *main)
+{
+	/* Basic check */
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_die_units_get", "NULL argument passed");
+		return NULL;
+	}
+
+	elfp_main_units *units = NULL;
+
+	/* Built already? */
+	units = __atomic_load_n(&main->units, __ATOMIC_ACQUIRE);
+	if(units != NULL)
+		return units;
+
+	/* The builder needs the section index, which takes index_lock
+	 * itself. Get that out of the way first */
+	if(elfp_shdr_index_get(main) == NULL)
+	{
+		elfp_err_warn("elfp_die_units_get", "elfp_shdr_index_get() failed");
+		return NULL;
+	}
+
+	/* Only one thread builds it. Others wait and use it */
+	pthread_mutex_lock(&main->index_lock);
+	units = main->units;
+	if(units == NULL)
+	{
+		units = elfp_die_units_build(main);
+		if(units != NULL)
+			__atomic_store_n(&main->units, units, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&main->index_lock);
+
+	if(units == NULL)
+		elfp_err_warn("elfp_die_units_get", "elfp_die_units_build() failed");
+
+	return units;
+}
+
+/*
+ * elfp_die_row_add: Adds the ranges of a function DIE to a task's output.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_die_row_add(elfp_die_out *out, const elfp_die_attrs *attrs,
+		const elfp_die_ranges *ranges, unsigned long int die)
+{
+	elfp_die_row *row = NULL;
+	unsigned long int i;
+
+	for(i = 0; i < ranges->count; i++)
+	{
+		if(elfp_die_grow((void **)&out->rows, &out->max, out->count,
+						sizeof(elfp_die_row)) == -1)
+			return -1;
+
+		row = out->rows + out->count;
+		row->low = ranges->list[2 * i];
+		row->high = ranges->list[2 * i + 1];
+		row->die = die;
+		row->call_file = attrs->call_file.u;
+		row->call_line = attrs->call_line.u;
+		row->inlined = (attrs->tag == DW_TAG_inlined_subroutine);
+		out->count = out->count + 1;
+	}
+
+	return 0;
+}
+
+/*
+ * elfp_die_funcs_task: Finds the function ranges of a unit. A task of
+ * 	the function index's pool.
+ */
+static void
+elfp_die_funcs_task(void *arg, unsigned long int index)
+{
+	elfp_die_build *build = arg;
+	const elfp_main_units *units = build->units;
+	const elfp_die_unit *unit = units->units + index;
+	const elfp_die_abbrev *abbrev = NULL;
+	elfp_die_out *out = build->outs + index;
+	elfp_dwarf_cursor cursor;
+	elfp_die_attrs attrs;
+	elfp_die_ranges ranges;
+	const unsigned char *start = NULL;
+	unsigned long int die, code, sibling, depth, func_depth;
+	int action;
+
+	if(unit->abbrevs == NULL)
+		return;
+
+	memset(&ranges, 0, sizeof(ranges));
+	start = units->info.p;
+	cursor = units->info;
+	cursor.end = start + unit->end;
+	cursor.p = start + unit->die;
+
+	/* How deep the DIE is, and how deep the children of the function
+	 * it is in are - 0 if it is not in one */
+	depth = 0;
+	func_depth = 0;
+
+	while(cursor.p < cursor.end)
+	{
+		die = cursor.p - start;
+		code = elfp_dwarf_uleb(&cursor);
+
+		/* End of a DIE's children */
+		if(code == 0)
+		{
+			if(depth != 0)
+				depth = depth - 1;
+			if(depth < func_depth)
+				func_depth = 0;
+			continue;
+		}
+
+		abbrev = elfp_die_abbrev_find(unit->abbrevs, code);
+		if(abbrev == NULL)
+		{
+			out->broken = 1;
+			break;
+		}
+
+		/* Classes local to a function have their methods' code in
+		 * them. Lambdas, for example */
+		action = abbrev->action;
+		if(action == ELFP_DIE_SUBTREE && func_depth != 0)
+			action = ELFP_DIE_SKIP;
+
+		if(action == ELFP_DIE_SKIP)
+		{
+			/* All of fixed size - most of them */
+			if(abbrev->n_skips == 1 && abbrev->skips[0].form == 0)
+				elfp_dwarf_skip(&cursor, abbrev->skips[0].bytes);
+			else
+				elfp_die_attrs_skip(&cursor, abbrev, &unit->format);
+		}
+		else if(elfp_die_read(&cursor, abbrev, &unit->format, &attrs) == -1)
+		{
+			out->broken = 1;
+			break;
+		}
+		else if(action == ELFP_DIE_SUBTREE)
+		{
+			/* Over the children, if the sibling is ahead in the unit */
+			if(elfp_die_ref(unit, &attrs.sibling, &sibling) == 0 &&
+				sibling > (unsigned long int)(cursor.p - start) &&
+				sibling <= unit->end)
+			{
+				cursor.p = start + sibling;
+				continue;
+			}
+		}
+		else
+		{
+			if(func_depth == 0 && abbrev->has_children != 0)
+				func_depth = depth + 1;
+
+			ranges.count = 0;
+			if(attrs.declaration == 0 &&
+				elfp_die_pc_ranges(units, unit, &attrs, &ranges) == -1)
+				out->broken = 1;
+			if(elfp_die_row_add(out, &attrs, &ranges, die) == -1)
+			{
+				out->broken = 1;
+				break;
+			}
+		}
+
+		if(abbrev->has_children != 0)
+			depth = depth + 1;
+
+		if(cursor.error != 0)
+		{
+			out->broken = 1;
+			break;
+		}
+	}
+
+	free(ranges.list);
+}
+
+/*
+ * elfp_die_parents: Links every entry of a sorted list to the innermost
+ * 	entry before it whose range contains its start.
+ *
+ * 	* Ranges still open when an entry starts, innermost on top of a
+ * 	stack.
+ *
+ * @arg0: Entries, as indexes in the index. In the order of the index
+ * @arg1: Number of entries
+ * @arg2: The index. lows and highs are read, the links written to
+ * 	outer or parent
+ * @arg3: 1 to write parent, 0 to write outer
+ * @arg4: Room for count entries
+ */
+static void
+elfp_die_parents(const unsigned int *list, unsigned long int count,
+		elfp_main_funcs *funcs, int parent, unsigned int *stack)
+{
+	unsigned long int i, top;
+	unsigned int link;
+
+	top = 0;
+	for(i = 0; i < count; i++)
+	{
+		while(top != 0 && funcs->funcs[stack[top - 1]].high <=
+						funcs->lows[list[i]])
+			top = top - 1;
+
+		link = (top != 0) ? stack[top - 1] : ELFP_DIE_NO_PARENT;
+		if(parent != 0)
+			funcs->funcs[list[i]].parent = link;
+		else
+			funcs->funcs[list[i]].outer = link;
+
+		stack[top] = list[i];
+		top = top + 1;
+	}
+}
+
+/*
+ * elfp_die_funcs_merge: Puts the function ranges of all the units in one
+ * 	index sorted by address, and links them up.
+ *
+ * 	* The sort is stable, and the DIEs of a unit come parents first. A
+ * 	parent which starts where its child does stays before it.
+ * 	* outer links the entries of all the units, parent those of the
+ * 	same unit only. The two differ when units repeat each other's
+ * 	functions - templates / inline functions kept in one copy.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_die_funcs_merge(elfp_main *main, const elfp_main_units *units,
+			elfp_die_out *outs, elfp_main_funcs *funcs)
+{
+	elfp_die_row *rows = NULL, *row = NULL;
+	elfp_die_func *func = NULL;
+	unsigned long int *lows = NULL, *starts = NULL, count, i, j, k;
+	unsigned int *order = NULL, *units_of = NULL, *stack = NULL;
+	int ret = -1;
+
+	count = 0;
+	for(i = 0; i < units->count; i++)
+		count = count + outs[i].count;
+
+	if(count == 0)
+		return 0;
+
+	/* Entry numbers have to fit in an unsigned int */
+	if(count >= ELFP_DIE_NO_PARENT)
+	{
+		elfp_err_warn("elfp_die_funcs_merge", "Too many functions");
+		return -1;
+	}
+
+	rows = malloc(count * sizeof(elfp_die_row));
+	lows = malloc(count * sizeof(unsigned long int));
+	order = malloc(count * sizeof(unsigned int));
+	units_of = malloc(count * sizeof(unsigned int));
+	stack = malloc(count * sizeof(unsigned int));
+	starts = malloc((units->count + 1) * sizeof(unsigned long int));
+	funcs->lows = elfp_main_alloc(main, count * sizeof(unsigned long int));
+	funcs->funcs = elfp_main_alloc(main, count * sizeof(elfp_die_func));
+	if(rows == NULL || lows == NULL || order == NULL || units_of == NULL ||
+		stack == NULL || starts == NULL || funcs->lows == NULL ||
+		funcs->funcs == NULL)
+	{
+		elfp_err_warn("elfp_die_funcs_merge", "Out of memory");
+		goto out;
+	}
+
+	k = 0;
+	for(i = 0; i < units->count; i++)
+	{
+		starts[i] = k;
+		for(j = 0; j < outs[i].count; j++)
+		{
+			rows[k] = outs[i].rows[j];
+			lows[k] = rows[k].low;
+			order[k] = k;
+			units_of[k] = i;
+			k = k + 1;
+		}
+	}
+	starts[units->count] = k;
+
+	if(elfp_sym_radix_sort(lows, order, count) == -1)
+	{
+		elfp_err_warn("elfp_die_funcs_merge", "elfp_sym_radix_sort() failed");
+		goto out;
+	}
+
+	for(i = 0; i < count; i++)
+	{
+		row = rows + order[i];
+		func = funcs->funcs + i;
+		funcs->lows[i] = lows[i];
+		func->high = row->high;
+		func->die = row->die;
+		func->unit = units_of[order[i]];
+		func->call_file = row->call_file;
+		func->call_line = row->call_line;
+		func->inlined = row->inlined;
+	}
+	funcs->count = count;
+
+	/* All of them, in order */
+	for(i = 0; i < count; i++)
+		order[i] = i;
+	elfp_die_parents(order, count, funcs, 0, stack);
+
+	/* A unit's own, in order - grouped by unit, keeping the order */
+	for(i = 0; i < count; i++)
+	{
+		order[starts[funcs->funcs[i].unit]] = i;
+		starts[funcs->funcs[i].unit]++;
+	}
+
+	k = 0;
+	for(i = 0; i < units->count; i++)
+	{
+		elfp_die_parents(order + k, outs[i].count, funcs, 1, stack);
+		k = k + outs[i].count;
+	}
+	ret = 0;
+
+out:
+	free(rows);
+	free(lows);
+	free(order);
+	free(units_of);
+	free(stack);
+	free(starts);
+
+	return ret;
+}
+
+/*
+ * elfp_die_funcs_build: Builds the function index of a file.
+ *
+ * 	* Called with index_lock held. The unit table is built already.
+ *
+ * @return: NULL on failure, the index on success.
+ */
+static elfp_main_funcs*
+elfp_die_funcs_build(elfp_main *main, elfp_main_units *units)
+{
+	elfp_main_funcs *funcs = NULL;
+	elfp_die_build build;
+	unsigned long int i;
+	int ret;
+
+	funcs = elfp_main_alloc(main, sizeof(elfp_main_funcs));
+	if(funcs == NULL)
+	{
+		elfp_err_warn("elfp_die_funcs_build", "elfp_main_alloc() failed");
+		return NULL;
+	}
+
+	if(units->count == 0)
+		return funcs;
+
+	memset(&build, 0, sizeof(build));
+	build.main = main;
+	build.units = units;
+	build.outs = calloc(units->count, sizeof(elfp_die_out));
+	if(build.outs == NULL)
+	{
+		elfp_err_warn("elfp_die_funcs_build", "calloc() failed");
+		return NULL;
+	}
+
+	/* Small ones are over before the threads would have started */
+	ret = elfp_pool_run(units->count, (units->info.end - units->info.p >=
+			ELFP_DIE_PARALLEL_MIN) ? 0 : 1, elfp_die_funcs_task, &build);
+	if(ret == 0)
+		ret = elfp_die_funcs_merge(main, units, build.outs, funcs);
+
+	for(i = 0; i < units->count; i++)
+		free(build.outs[i].rows);
+	free(build.outs);
+
+	if(ret == -1)
+	{
+		elfp_err_warn("elfp_die_funcs_build", "Decoding the DIEs failed");
+		return NULL;
+	}
+
+	return funcs;
+}
+
+elfp_main_funcs*
+elfp_die_funcs_get(elfp_main *main)
+{
+	/* Basic check */
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_die_funcs_get", "NULL argument passed");
+		return NULL;
+	}
+
+	elfp_main_funcs *funcs = NULL;
+	elfp_main_units *units = NULL;
+
+	/* Built already? */
+	funcs = __atomic_load_n(&main->funcs, __ATOMIC_ACQUIRE);
+	if(funcs != NULL)
+		return funcs;
+
+	/* The unit table takes index_lock itself */
+	units = elfp_die_units_get(main);
+	if(units == NULL)
+	{
+		elfp_err_warn("elfp_die_funcs_get", "elfp_die_units_get() failed");
+		return NULL;
+	}
+
+	/* Only one thread builds it. Others wait and use it */
+	pthread_mutex_lock(&main->index_lock);
+	funcs = main->funcs;
+	if(funcs == NULL)
+	{
+		funcs = elfp_die_funcs_build(main, units);
+		if(funcs != NULL)
+			__atomic_store_n(&main->funcs, funcs, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&main->index_lock);
+
+	if(funcs == NULL)
+		elfp_err_warn("elfp_die_funcs_get", "elfp_die_funcs_build() failed");
+
+	return funcs;
+}
+
+/*
+ * elfp_die_names: Gets the name and linkage name of a function DIE.
+ *
+ * 	* Concrete / inlined instances have them in their abstract origin,
+ * 	out-of-line definitions in their declaration. Those links are
+ * 	followed - across units too.
+ */
+static void
+elfp_die_names(const elfp_main_units *units, unsigned long int die,
+			const char **name, const char **linkage_name)
+{
+	const elfp_die_unit *unit = NULL;
+	const elfp_die_abbrev *abbrev = NULL;
+	elfp_dwarf_cursor cursor;
+	elfp_die_attrs attrs;
+	long int index;
+	int hops;
+
+	*name = NULL;
+	*linkage_name = NULL;
+
+	for(hops = 0; hops < ELFP_DIE_HOPS_MAX; hops++)
+	{
+		index = elfp_die_unit_find(units, die);
+		if(index == -1 || units->units[index].abbrevs == NULL)
+			return;
+		unit = units->units + index;
+
+		cursor = units->info;
+		cursor.end = cursor.p + unit->end;
+		cursor.p = cursor.p + die;
+		abbrev = elfp_die_abbrev_find(unit->abbrevs,
+						elfp_dwarf_uleb(&cursor));
+		if(abbrev == NULL ||
+			elfp_die_read(&cursor, abbrev, &unit->format, &attrs) == -1)
+			return;
+
+		if(*name == NULL)
+			*name = elfp_die_string(units, unit, &attrs.name);
+		if(*linkage_name == NULL)
+			*linkage_name = elfp_die_string(units, unit,
+							&attrs.linkage_name);
+		if(*name != NULL && *linkage_name != NULL)
+			return;
+
+		if(elfp_die_ref(unit, &attrs.origin, &die) == -1 &&
+			elfp_die_ref(unit, &attrs.specification, &die) == -1)
+			return;
+	}
+}
+
+/*
+ * elfp_die_cu_fill: Fills up an elfp_cu from a unit.
+ */
+static void
+elfp_die_cu_fill(const elfp_main_units *units, unsigned long int index,
+							elfp_cu *cu)
+{
+	const elfp_die_unit *unit = units->units + index;
+
+	cu->index = index;
+	cu->offset = unit->offset;
+	cu->version = unit->format.version;
+	cu->name = unit->name;
+	cu->comp_dir = unit->comp_dir;
+}
+
+/*
+ * elfp_die_func_fill: Fills up an elfp_func from an entry of the index.
+ */
+static void
+elfp_die_func_fill(elfp_main *main, const elfp_main_units *units,
+	const elfp_main_funcs *funcs, unsigned long int index, elfp_func *func)
+{
+	const elfp_die_func *entry = funcs->funcs + index;
+	const elfp_die_unit *unit = units->units + entry->unit;
+	const elfp_main_lines *lines = NULL;
+	const elfp_line_file *file = NULL;
+
+	memset(func, 0, sizeof(elfp_func));
+	func->low = funcs->lows[index];
+	func->high = entry->high;
+	func->die = entry->die;
+	func->inlined = entry->inlined;
+	elfp_die_names(units, entry->die, &func->name, &func->linkage_name);
+
+	if(entry->inlined == 0)
+		return;
+
+	func->call_line = entry->call_line;
+	if(unit->has_stmt_list == 0)
+		return;
+
+	/* The line index has the file tables */
+	lines = elfp_line_index_get(main);
+	if(lines == NULL)
+		return;
+
+	file = elfp_line_file_get(lines, unit->stmt_list, entry->call_file);
+	if(file != NULL)
+	{
+		func->call_dir = file->dir;
+		func->call_file = file->name;
+	}
+}
+
+/*
+ * elfp_die_upper: Finds the first entry of a sorted array which is more
+ * 	than addr.
+ *
+ * @return: Index of the entry, count if there is none.
+ */
+static unsigned long int
+elfp_die_upper(const unsigned long int *array, unsigned long int count,
+						unsigned long int addr)
+{
+	unsigned long int low, high, middle;
+
+	low = 0;
+	high = count;
+	while(low < high)
+	{
+		middle = low + (high - low) / 2;
+		if(array[middle] <= addr)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low;
+}
+
+/*
+ * All functions defined below are exposed to programmers.
+ *
+ * Refer to elfp.h for more details.
+ */
+
+unsigned long int
+elfp_cu_count(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_cu_count", "Handle failed the sanity test");
+		return 0;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_units *units = NULL;
+	unsigned long int count = 0;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_cu_count", "elfp_main_vec_get_em() failed");
+		return 0;
+	}
+
+	units = elfp_die_units_get(main);
+	if(units != NULL)
+		count = units->count;
+	elfp_main_vec_put_em(handle);
+
+	return count;
+}
+
+int
+elfp_cu_get(int handle, unsigned long int index, elfp_cu *cu)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || cu == NULL)
+	{
+		elfp_err_warn("elfp_cu_get", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_units *units = NULL;
+	int ret = -1;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_cu_get", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	units = elfp_die_units_get(main);
+	if(units != NULL && index < units->count)
+	{
+		elfp_die_cu_fill(units, index, cu);
+		ret = 0;
+	}
+	elfp_main_vec_put_em(handle);
+
+	return ret;
+}
+
+int
+elfp_cu_lookup(int handle, unsigned long int addr, elfp_cu *cu)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || cu == NULL)
+	{
+		elfp_err_warn("elfp_cu_lookup", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_units *units = NULL;
+	unsigned long int upper;
+	int ret = -1;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_cu_lookup", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	units = elfp_die_units_get(main);
+	if(units != NULL)
+	{
+		upper = elfp_die_upper(units->range_lows, units->n_ranges, addr);
+		if(upper != 0 && addr < units->range_highs[upper - 1])
+		{
+			elfp_die_cu_fill(units, units->range_units[upper - 1], cu);
+			ret = 0;
+		}
+	}
+	elfp_main_vec_put_em(handle);
+
+	return ret;
+}
+
+unsigned long int
+elfp_func_count(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_func_count", "Handle failed the sanity test");
+		return 0;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_funcs *funcs = NULL;
+	unsigned long int count = 0;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_func_count", "elfp_main_vec_get_em() failed");
+		return 0;
+	}
+
+	funcs = elfp_die_funcs_get(main);
+	if(funcs != NULL)
+		count = funcs->count;
+	elfp_main_vec_put_em(handle);
+
+	return count;
+}
+
+long int
+elfp_func_lookup(int handle, unsigned long int addr, elfp_func *frames,
+						unsigned long int max)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || (max != 0 && frames == NULL))
+	{
+		elfp_err_warn("elfp_func_lookup", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_units *units = NULL;
+	elfp_main_funcs *funcs = NULL;
+	unsigned long int index, n;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_func_lookup", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	funcs = elfp_die_funcs_get(main);
+	units = elfp_die_units_get(main);
+	if(funcs == NULL || units == NULL)
+	{
+		elfp_err_warn("elfp_func_lookup", "Building the function index failed");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	/* The last range starting at / before addr. The ranges it is in
+	 * start there too - the innermost one still going at addr is the
+	 * innermost frame */
+	index = elfp_die_upper(funcs->lows, funcs->count, addr);
+	index = (index == 0) ? ELFP_DIE_NO_PARENT : index - 1;
+	while(index != ELFP_DIE_NO_PARENT && addr >= funcs->funcs[index].high)
+		index = funcs->funcs[index].outer;
+
+	/* The others are in its unit */
+	n = 0;
+	while(index != ELFP_DIE_NO_PARENT && n < max)
+	{
+		if(addr < funcs->funcs[index].high)
+		{
+			elfp_die_func_fill(main, units, funcs, index, frames + n);
+			n = n + 1;
+
+			/* Where the inlined ones ended up */
+			if(funcs->funcs[index].inlined == 0)
+				break;
+		}
+		index = funcs->funcs[index].parent;
+	}
+
+	elfp_main_vec_put_em(handle);
+
+	return n;
+}
+
+int
+elfp_func_dump(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_func_dump", "Handle failed the sanity test");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_units *units = NULL;
+	elfp_main_funcs *funcs = NULL;
+	elfp_func func;
+	unsigned long int i, depth, parent;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_func_dump", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	funcs = elfp_die_funcs_get(main);
+	units = elfp_die_units_get(main);
+	if(funcs == NULL || units == NULL)
+	{
+		elfp_err_warn("elfp_func_dump", "Building the function index failed");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	printf("Functions: %lu ranges, %lu units", funcs->count, units->count);
+	if(units->n_broken != 0)
+		printf(" (%lu broken)", units->n_broken);
+	printf("\n");
+
+	for(i = 0; i < funcs->count; i++)
+	{
+		elfp_die_func_fill(main, units, funcs, i, &func);
+
+		/* Inlined ones under where they were inlined into */
+		depth = 0;
+		for(parent = funcs->funcs[i].parent; parent != ELFP_DIE_NO_PARENT;
+					parent = funcs->funcs[parent].parent)
+			depth = depth + 1;
+
+		printf("\t0x%016lx - 0x%016lx\t%*s%s", func.low, func.high,
+			(int)(2 * depth), "", (func.name != NULL) ? func.name : "??");
+		if(func.inlined != 0)
+		{
+			printf(" (inlined at ");
+			if(func.call_dir != NULL)
+				printf("%s/", func.call_dir);
+			printf("%s:%lu)", (func.call_file != NULL) ?
+					func.call_file : "??", func.call_line);
+		}
+		printf("\n");
+	}
+
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
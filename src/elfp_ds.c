@@ -127,3 +127,121 @@ elfp_ds_vector_add(elfp_ds_vector *vec, void *addr)
 	/* Good to go! */
 	return 0;
 }
+
+/*
+ * All definitions related to elfp_ds_arena structure.
+ */
+
+static void*
+elfp_ds_default_malloc(unsigned long int size)
+{
+	return malloc(size);
+}
+
+static elfp_ds_malloc_fn elfp_ds_malloc = elfp_ds_default_malloc;
+static elfp_ds_free_fn elfp_ds_free = free;
+
+void
+elfp_ds_set_allocator(elfp_ds_malloc_fn malloc_fn, elfp_ds_free_fn free_fn)
+{
+	elfp_ds_malloc = (malloc_fn != NULL) ? malloc_fn : elfp_ds_default_malloc;
+	elfp_ds_free = (free_fn != NULL) ? free_fn : free;
+}
+
+void
+elfp_ds_arena_init(elfp_ds_arena *arena)
+{
+	/* Basic check */
+	if(arena == NULL)
+	{
+		elfp_err_warn("elfp_ds_arena_init", "NULL argument passed");
+		return;
+	}
+
+	/* Chunks are allocated on demand */
+	arena->head = NULL;
+}
+
+void*
+elfp_ds_arena_alloc(elfp_ds_arena *arena, unsigned long int size)
+{
+	/* Basic check */
+	if(arena == NULL)
+	{
+		elfp_err_warn("elfp_ds_arena_alloc", "NULL argument passed");
+		return NULL;
+	}
+
+	elfp_ds_arena_chunk *chunk = NULL;
+	unsigned long int hdr_size, chunk_size;
+	unsigned char *addr = NULL;
+
+	/* Keep every allocation aligned */
+	size = (size + ELFP_DS_ARENA_ALIGN - 1) & ~(ELFP_DS_ARENA_ALIGN - 1UL);
+	if(size == 0)
+		size = ELFP_DS_ARENA_ALIGN;
+
+	hdr_size = (sizeof(elfp_ds_arena_chunk) + ELFP_DS_ARENA_ALIGN - 1) &
+						~(ELFP_DS_ARENA_ALIGN - 1UL);
+
+	/* 1. Fast path: bump the pointer */
+	chunk = arena->head;
+	if(chunk != NULL && chunk->size - chunk->used >= size)
+	{
+		addr = (unsigned char *)chunk + hdr_size + chunk->used;
+		chunk->used = chunk->used + size;
+		return addr;
+	}
+
+	/* 2. Need a new chunk. Big allocations get a chunk of their own */
+	chunk_size = (size > ELFP_DS_ARENA_CHUNK_SIZE - hdr_size) ?
+				size : ELFP_DS_ARENA_CHUNK_SIZE - hdr_size;
+
+	chunk = elfp_ds_malloc(hdr_size + chunk_size);
+	if(chunk == NULL)
+	{
+		elfp_err_warn("elfp_ds_arena_alloc", "Allocator failed");
+		return NULL;
+	}
+
+	chunk->size = chunk_size;
+	chunk->used = size;
+	addr = (unsigned char *)chunk + hdr_size;
+	memset(addr, '\0', chunk_size);
+
+	/* A dedicated chunk is full already. Keep bumping from the
+	 * current one */
+	if(arena->head != NULL && chunk_size == size)
+	{
+		chunk->next = arena->head->next;
+		arena->head->next = chunk;
+	}
+	else
+	{
+		chunk->next = arena->head;
+		arena->head = chunk;
+	}
+
+	return addr;
+}
+
+void
+elfp_ds_arena_fini(elfp_ds_arena *arena)
+{
+	/* Basic check */
+	if(arena == NULL)
+	{
+		elfp_err_warn("elfp_ds_arena_fini", "NULL argument passed");
+		return;
+	}
+
+	elfp_ds_arena_chunk *chunk = NULL;
+
+	/* Free all the chunks */
+	while(arena->head != NULL)
+	{
+		chunk = arena->head;
+		arena->head = chunk->next;
+		elfp_ds_free(chunk);
+	}
+}
@@ -0,0 +1,502 @@
+/*
+ * File: elfp_dwarf.c
+ *
+ * Description: Building blocks for reading DWARF - a bounds-checked
+ * 	cursor, LEB128 and attribute form readers.
+ *
+ * 	* Sections are read in place. Nothing is copied.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#include "./include/elfp_dwarf.h"
+#include "./include/elfp_shdr.h"
+#include "./include/elfp_int.h"
+#include "./include/elfp_err.h"
+
+#include <string.h>
+#include <stdint.h>
+#include <elf.h>
+
+/*
+ * elfp_dwarf_fail: Marks a cursor broken.
+ */
+static void
+elfp_dwarf_fail(elfp_dwarf_cursor *cursor)
+{
+	cursor->p = cursor->end;
+	cursor->error = 1;
+}
+
+int
+elfp_dwarf_section_get(elfp_main *main, const char *name,
+					elfp_dwarf_cursor *cursor)
+{
+	const elfp_section *sec = NULL;
+	const void *data = NULL;
+
+	memset(cursor, 0, sizeof(elfp_dwarf_cursor));
+
+	sec = elfp_shdr_find(main, name);
+	if(sec == NULL || sec->type == SHT_NOBITS || sec->size == 0)
+		return -1;
+
+	/* Would have to be inflated into a copy */
+	if((sec->flags & SHF_COMPRESSED) != 0)
+	{
+		elfp_err_warn("elfp_dwarf_section_get", "Compressed sections are not supported");
+		return -1;
+	}
+
+	data = elfp_shdr_data_get(main, sec);
+	if(data == NULL)
+		return -1;
+
+	cursor->p = data;
+	cursor->end = cursor->p + sec->size;
+
+	return 0;
+}
+
+unsigned int
+elfp_dwarf_u8(elfp_dwarf_cursor *cursor)
+{
+	if(cursor->p >= cursor->end)
+	{
+		elfp_dwarf_fail(cursor);
+		return 0;
+	}
+
+	return *cursor->p++;
+}
+
+unsigned int
+elfp_dwarf_u16(elfp_dwarf_cursor *cursor)
+{
+	uint16_t value;
+
+	if(cursor->end - cursor->p < 2)
+	{
+		elfp_dwarf_fail(cursor);
+		return 0;
+	}
+
+	memcpy(&value, cursor->p, 2);
+	cursor->p = cursor->p + 2;
+
+	return value;
+}
+
+unsigned int
+elfp_dwarf_u32(elfp_dwarf_cursor *cursor)
+{
+	uint32_t value;
+
+	if(cursor->end - cursor->p < 4)
+	{
+		elfp_dwarf_fail(cursor);
+		return 0;
+	}
+
+	memcpy(&value, cursor->p, 4);
+	cursor->p = cursor->p + 4;
+
+	return value;
+}
+
+unsigned long int
+elfp_dwarf_u64(elfp_dwarf_cursor *cursor)
+{
+	uint64_t value;
+
+	if(cursor->end - cursor->p < 8)
+	{
+		elfp_dwarf_fail(cursor);
+		return 0;
+	}
+
+	memcpy(&value, cursor->p, 8);
+	cursor->p = cursor->p + 8;
+
+	return value;
+}
+
+unsigned long int
+elfp_dwarf_uint(elfp_dwarf_cursor *cursor, unsigned int size)
+{
+	switch(size)
+	{
+		case 1:
+			return elfp_dwarf_u8(cursor);
+		case 2:
+			return elfp_dwarf_u16(cursor);
+		case 4:
+			return elfp_dwarf_u32(cursor);
+		case 8:
+			return elfp_dwarf_u64(cursor);
+		default:
+			elfp_dwarf_fail(cursor);
+			return 0;
+	}
+}
+
+unsigned long int
+elfp_dwarf_uleb(elfp_dwarf_cursor *cursor)
+{
+	const unsigned char *p = cursor->p;
+	unsigned long int value = 0;
+	unsigned int shift = 0;
+	unsigned char byte;
+
+	/* Most of them are a byte */
+	if(p < cursor->end && *p < 0x80)
+	{
+		cursor->p = p + 1;
+		return *p;
+	}
+
+	while(p < cursor->end)
+	{
+		byte = *p++;
+		if(shift < 64)
+			value = value | ((unsigned long int)(byte & 0x7f) << shift);
+		shift = shift + 7;
+
+		if((byte & 0x80) == 0)
+		{
+			cursor->p = p;
+			return value;
+		}
+	}
+
+	elfp_dwarf_fail(cursor);
+	return 0;
+}
+
+long int
+elfp_dwarf_sleb(elfp_dwarf_cursor *cursor)
+{
+	const unsigned char *p = cursor->p;
+	unsigned long int value = 0;
+	unsigned int shift = 0;
+	unsigned char byte;
+
+	while(p < cursor->end)
+	{
+		byte = *p++;
+		if(shift < 64)
+			value = value | ((unsigned long int)(byte & 0x7f) << shift);
+		shift = shift + 7;
+
+		if((byte & 0x80) == 0)
+		{
+			/* Sign extend */
+			if(shift < 64 && (byte & 0x40) != 0)
+				value = value | (~0UL << shift);
+
+			cursor->p = p;
+			return (long int)value;
+		}
+	}
+
+	elfp_dwarf_fail(cursor);
+	return 0;
+}
+
+const char*
+elfp_dwarf_cstr(elfp_dwarf_cursor *cursor)
+{
+	const unsigned char *nul = NULL;
+	const char *str = NULL;
+
+	nul = memchr(cursor->p, '\0', cursor->end - cursor->p);
+	if(nul == NULL)
+	{
+		elfp_dwarf_fail(cursor);
+		return NULL;
+	}
+
+	str = (const char *)cursor->p;
+	cursor->p = nul + 1;
+
+	return str;
+}
+
+void
+elfp_dwarf_skip(elfp_dwarf_cursor *cursor, unsigned long int size)
+{
+	if((unsigned long int)(cursor->end - cursor->p) < size)
+	{
+		elfp_dwarf_fail(cursor);
+		return;
+	}
+
+	cursor->p = cursor->p + size;
+}
+
+unsigned long int
+elfp_dwarf_unit_length(elfp_dwarf_cursor *cursor, unsigned int *offset_size)
+{
+	unsigned long int length;
+
+	length = elfp_dwarf_u32(cursor);
+	*offset_size = 4;
+
+	/* 64-bit DWARF. 0xfffffff0 - 0xfffffffe are reserved */
+	if(length == 0xffffffff)
+	{
+		length = elfp_dwarf_u64(cursor);
+		*offset_size = 8;
+	}
+	else if(length >= 0xfffffff0)
+	{
+		elfp_dwarf_fail(cursor);
+		return 0;
+	}
+
+	if(length > (unsigned long int)(cursor->end - cursor->p))
+	{
+		elfp_dwarf_fail(cursor);
+		return 0;
+	}
+
+	return length;
+}
+
+int
+elfp_dwarf_form_size(unsigned int form, const elfp_dwarf_format *format)
+{
+	switch(form)
+	{
+		case DW_FORM_flag_present:
+		case DW_FORM_implicit_const:
+			return 0;
+
+		case DW_FORM_data1:
+		case DW_FORM_ref1:
+		case DW_FORM_flag:
+		case DW_FORM_strx1:
+		case DW_FORM_addrx1:
+			return 1;
+
+		case DW_FORM_data2:
+		case DW_FORM_ref2:
+		case DW_FORM_strx2:
+		case DW_FORM_addrx2:
+			return 2;
+
+		case DW_FORM_strx3:
+		case DW_FORM_addrx3:
+			return 3;
+
+		case DW_FORM_data4:
+		case DW_FORM_ref4:
+		case DW_FORM_ref_sup4:
+		case DW_FORM_strx4:
+		case DW_FORM_addrx4:
+			return 4;
+
+		case DW_FORM_data8:
+		case DW_FORM_ref8:
+		case DW_FORM_ref_sig8:
+		case DW_FORM_ref_sup8:
+			return 8;
+
+		case DW_FORM_data16:
+			return 16;
+
+		case DW_FORM_addr:
+			return format->addr_size;
+
+		case DW_FORM_strp:
+		case DW_FORM_line_strp:
+		case DW_FORM_sec_offset:
+		case DW_FORM_strp_sup:
+		case DW_FORM_GNU_ref_alt:
+		case DW_FORM_GNU_strp_alt:
+			return format->offset_size;
+
+		/* DWARF 2 had it the size of an address */
+		case DW_FORM_ref_addr:
+			return (format->version <= 2) ? format->addr_size :
+							format->offset_size;
+
+		default:
+			return -1;
+	}
+}
+
+int
+elfp_dwarf_form_read(elfp_dwarf_cursor *cursor, unsigned int form,
+		const elfp_dwarf_format *format, elfp_dwarf_value *value)
+{
+	int size;
+
+	/* The form is in the data */
+	while(form == DW_FORM_indirect)
+		form = elfp_dwarf_uleb(cursor);
+
+	value->form = form;
+	value->u = 0;
+	value->data = NULL;
+	value->size = 0;
+
+	switch(form)
+	{
+		case DW_FORM_string:
+			value->data = (const unsigned char *)elfp_dwarf_cstr(cursor);
+			if(value->data != NULL)
+				value->size = cursor->p - value->data - 1;
+			break;
+
+		case DW_FORM_block1:
+		case DW_FORM_block2:
+		case DW_FORM_block4:
+		case DW_FORM_block:
+		case DW_FORM_exprloc:
+			if(form == DW_FORM_block1)
+				value->size = elfp_dwarf_u8(cursor);
+			else if(form == DW_FORM_block2)
+				value->size = elfp_dwarf_u16(cursor);
+			else if(form == DW_FORM_block4)
+				value->size = elfp_dwarf_u32(cursor);
+			else
+				value->size = elfp_dwarf_uleb(cursor);
+			value->data = cursor->p;
+			elfp_dwarf_skip(cursor, value->size);
+			break;
+
+		case DW_FORM_data16:
+			value->data = cursor->p;
+			value->size = 16;
+			elfp_dwarf_skip(cursor, 16);
+			break;
+
+		case DW_FORM_sdata:
+			value->u = (unsigned long int)elfp_dwarf_sleb(cursor);
+			break;
+
+		case DW_FORM_udata:
+		case DW_FORM_ref_udata:
+		case DW_FORM_strx:
+		case DW_FORM_addrx:
+		case DW_FORM_loclistx:
+		case DW_FORM_rnglistx:
+		case DW_FORM_GNU_addr_index:
+		case DW_FORM_GNU_str_index:
+			value->u = elfp_dwarf_uleb(cursor);
+			break;
+
+		/* The value is in the abbreviation - the caller has it */
+		case DW_FORM_implicit_const:
+		case DW_FORM_flag_present:
+			value->u = (form == DW_FORM_flag_present);
+			break;
+
+		case DW_FORM_strx3:
+		case DW_FORM_addrx3:
+			value->u = elfp_dwarf_u16(cursor);
+			value->u = value->u | (elfp_dwarf_u8(cursor) << 16);
+			break;
+
+		default:
+			size = elfp_dwarf_form_size(form, format);
+			if(size != 1 && size != 2 && size != 4 && size != 8)
+			{
+				elfp_dwarf_fail(cursor);
+				return -1;
+			}
+			value->u = elfp_dwarf_uint(cursor, size);
+			break;
+	}
+
+	return (cursor->error == 0) ? 0 : -1;
+}
+
+int
+elfp_dwarf_form_skip(elfp_dwarf_cursor *cursor, unsigned int form,
+				const elfp_dwarf_format *format)
+{
+	const unsigned char *nul = NULL;
+	elfp_dwarf_value value;
+	int size;
+
+	switch(form)
+	{
+		case DW_FORM_string:
+			nul = memchr(cursor->p, '\0', cursor->end - cursor->p);
+			if(nul == NULL)
+			{
+				elfp_dwarf_fail(cursor);
+				return -1;
+			}
+			cursor->p = nul + 1;
+			return 0;
+
+		/* No need to put the value together */
+		case DW_FORM_udata:
+		case DW_FORM_sdata:
+		case DW_FORM_ref_udata:
+		case DW_FORM_strx:
+		case DW_FORM_addrx:
+		case DW_FORM_loclistx:
+		case DW_FORM_rnglistx:
+		case DW_FORM_GNU_addr_index:
+		case DW_FORM_GNU_str_index:
+			while(cursor->p < cursor->end && (*cursor->p & 0x80) != 0)
+				cursor->p++;
+			if(cursor->p == cursor->end)
+			{
+				elfp_dwarf_fail(cursor);
+				return -1;
+			}
+			cursor->p++;
+			return 0;
+
+		case DW_FORM_block1:
+		case DW_FORM_block2:
+		case DW_FORM_block4:
+		case DW_FORM_block:
+		case DW_FORM_exprloc:
+		case DW_FORM_indirect:
+			return elfp_dwarf_form_read(cursor, form, format, &value);
+
+		default:
+			size = elfp_dwarf_form_size(form, format);
+			if(size == -1)
+			{
+				elfp_dwarf_fail(cursor);
+				return -1;
+			}
+			elfp_dwarf_skip(cursor, size);
+			return (cursor->error == 0) ? 0 : -1;
+	}
+}
+
+const char*
+elfp_dwarf_str(const elfp_dwarf_cursor *section, unsigned long int offset)
+{
+	unsigned long int size;
+
+	size = section->end - section->p;
+	if(offset >= size)
+		return NULL;
+
+	if(memchr(section->p + offset, '\0', size - offset) == NULL)
+		return NULL;
+
+	return (const char *)section->p + offset;
+}
@@ -0,0 +1,1115 @@
+/*
+ * File: elfp_dyn.c
+ *
+ * Description: Parsing the DYNAMIC segment, and looking up dynamic
+ * 	symbols through the hash tables it points to.
+ *
+ * 	* The PT_LOAD map and the DYNAMIC segment are indexed once per
+ * 	file, the first time they are used. Refer elfp_dyn.h.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#include "./include/elfp_int.h"
+#include "./include/elfp_dyn.h"
+#include "./include/elfp_shdr.h"
+#include "./include/elfp_sym.h"
+#include "./include/elfp_err.h"
+#include "./include/elfp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <elf.h>
+
+/*
+ * The below functions are internal to the library.
+ *
+ * Refer elfp_dyn.h for their description.
+ */
+
+int
+elfp_dyn_vaddr_to_offset(elfp_main_dynamic *dynamic, unsigned long int vaddr,
+		unsigned long int *offset, unsigned long int *avail)
+{
+	elfp_load *load = NULL;
+	unsigned long int i;
+
+	for(i = 0; i < dynamic->n_loads; i++)
+	{
+		load = dynamic->loads + i;
+
+		/* Only the part of the segment which is in the file counts.
+		 * The rest (.bss) is zeroes made up by the loader */
+		if(vaddr < load->vaddr || vaddr - load->vaddr >= load->filesz)
+			continue;
+
+		*offset = load->offset + (vaddr - load->vaddr);
+		if(avail != NULL)
+			*avail = load->filesz - (vaddr - load->vaddr);
+		return 0;
+	}
+
+	return -1;
+}
+
+void
+elfp_dyn_entry_get(elfp_main *main, elfp_main_dynamic *dynamic,
+		unsigned long int index, unsigned long int *tag,
+		unsigned long int *val)
+{
+	const Elf64_Dyn *d64 = NULL;
+	const Elf32_Dyn *d32 = NULL;
+
+	if(elfp_main_get_class(main) == ELFCLASS32)
+	{
+		d32 = (const Elf32_Dyn *)dynamic->dyn + index;
+		*tag = d32->d_tag;
+		*val = d32->d_un.d_val;
+	}
+	else
+	{
+		d64 = (const Elf64_Dyn *)dynamic->dyn + index;
+		*tag = d64->d_tag;
+		*val = d64->d_un.d_val;
+	}
+}
+
+/*
+ * elfp_dyn_table_fix: Turns the address of a table into a file offset.
+ *
+ * 	* The size is cut down to what the file has till the end of the
+ * 	segment. If it is not known, it becomes that.
+ * 	* A table which is not in the file is dropped.
+ */
+static void
+elfp_dyn_table_fix(elfp_main_dynamic *dynamic, elfp_dyn_table *table,
+						int size_known)
+{
+	unsigned long int vaddr, avail;
+	int ret;
+
+	vaddr = table->offset;
+	if(vaddr == 0)
+	{
+		table->size = 0;
+		return;
+	}
+
+	ret = elfp_dyn_vaddr_to_offset(dynamic, vaddr, &table->offset, &avail);
+	if(ret == -1)
+	{
+		elfp_err_warn("elfp_dyn_table_fix", "Table is not in the file");
+		table->offset = 0;
+		table->size = 0;
+		return;
+	}
+
+	if(size_known == 0 || table->size > avail)
+		table->size = avail;
+}
+
+/*
+ * elfp_dyn_table_map: Gets the address at which a table is.
+ *
+ * @return: NULL if the file doesn't have it, its address otherwise.
+ */
+static const void*
+elfp_dyn_table_map(elfp_main *main, elfp_dyn_table *table)
+{
+	if(table->offset == 0)
+		return NULL;
+
+	return elfp_main_get_range(main, table->offset, table->size);
+}
+
+/*
+ * elfp_dyn_string_get: Gets a string from the dynamic string table.
+ *
+ * @return: NULL if the offset is junk, the string otherwise.
+ */
+static const char*
+elfp_dyn_string_get(elfp_main_dynamic *dynamic, unsigned long int offset)
+{
+	if(dynamic->strtab == NULL || offset >= dynamic->strsize)
+		return NULL;
+
+	if(memchr(dynamic->strtab + offset, '\0', dynamic->strsize - offset) == NULL)
+		return NULL;
+
+	return dynamic->strtab + offset;
+}
+
+/*
+ * elfp_dyn_index_build: Builds the PT_LOAD map and indexes the DYNAMIC
+ * 	segment.
+ *
+ * @return: NULL on failure, the index on success.
+ */
+static elfp_main_dynamic*
+elfp_dyn_index_build(elfp_main *main)
+{
+	elfp_main_dynamic *dynamic = NULL;
+	Elf64_Ehdr e64hdr;
+	Elf32_Ehdr e32hdr;
+	const Elf64_Phdr *p64hdr = NULL;
+	const Elf32_Phdr *p32hdr = NULL;
+	void *pht = NULL;
+	unsigned long int phoff, phnum, entsize, i;
+	unsigned long int type, offset, vaddr, filesz, memsz;
+	unsigned long int dyn_offset = 0, dyn_size = 0, max;
+	unsigned long int tag, val, n_needed = 0;
+	unsigned long int soname = ULONG_MAX, rpath = ULONG_MAX, runpath = ULONG_MAX;
+	unsigned long int init = 0, fini = 0;
+	unsigned long int versym = 0, versym_size, versym_offset;
+	const char *str = NULL;
+	elfp_dynamic *info = NULL;
+	elfp_load *load = NULL;
+	int class, ret;
+
+	dynamic = elfp_main_alloc(main, sizeof(elfp_main_dynamic));
+	if(dynamic == NULL)
+	{
+		elfp_err_warn("elfp_dyn_index_build", "elfp_main_alloc() failed");
+		return NULL;
+	}
+
+	/* 1. Get a copy of the PHT. No PHT is not an error, the index is
+	 * just empty */
+	class = elfp_main_get_class(main);
+	if(class == ELFCLASS32)
+	{
+		ret = elfp_main_read(main, 0, sizeof(Elf32_Ehdr), &e32hdr);
+		phoff = e32hdr.e_phoff;
+		phnum = e32hdr.e_phnum;
+		entsize = sizeof(Elf32_Phdr);
+		if(ret == -1 || e32hdr.e_phentsize != entsize)
+			return dynamic;
+	}
+	else
+	{
+		ret = elfp_main_read(main, 0, sizeof(Elf64_Ehdr), &e64hdr);
+		phoff = e64hdr.e_phoff;
+		phnum = e64hdr.e_phnum;
+		entsize = sizeof(Elf64_Phdr);
+		if(ret == -1 || e64hdr.e_phentsize != entsize)
+			return dynamic;
+	}
+
+	if(phnum == 0)
+		return dynamic;
+
+	pht = malloc(phnum * entsize);
+	if(pht == NULL)
+	{
+		elfp_err_warn("elfp_dyn_index_build", "malloc() failed");
+		return NULL;
+	}
+
+	ret = elfp_main_read(main, phoff, phnum * entsize, pht);
+	if(ret == -1)
+	{
+		free(pht);
+		return dynamic;
+	}
+
+	dynamic->loads = elfp_main_alloc(main, phnum * sizeof(elfp_load));
+	if(dynamic->loads == NULL)
+	{
+		elfp_err_warn("elfp_dyn_index_build", "elfp_main_alloc() failed");
+		free(pht);
+		return NULL;
+	}
+
+	/* 2. The PT_LOAD map, and where DYNAMIC is */
+	p64hdr = pht;
+	p32hdr = pht;
+	for(i = 0; i < phnum; i++)
+	{
+		if(class == ELFCLASS32)
+		{
+			type = p32hdr[i].p_type;
+			offset = p32hdr[i].p_offset;
+			vaddr = p32hdr[i].p_vaddr;
+			filesz = p32hdr[i].p_filesz;
+			memsz = p32hdr[i].p_memsz;
+		}
+		else
+		{
+			type = p64hdr[i].p_type;
+			offset = p64hdr[i].p_offset;
+			vaddr = p64hdr[i].p_vaddr;
+			filesz = p64hdr[i].p_filesz;
+			memsz = p64hdr[i].p_memsz;
+		}
+
+		/* A segment which says it is bigger than the file is cut
+		 * down to what is there */
+		if(offset > main->file_size)
+			continue;
+		if(filesz > main->file_size - offset)
+			filesz = main->file_size - offset;
+
+		if(type == PT_LOAD)
+		{
+			load = dynamic->loads + dynamic->n_loads;
+			load->vaddr = vaddr;
+			load->memsz = memsz;
+			load->offset = offset;
+			load->filesz = filesz;
+			dynamic->n_loads++;
+		}
+		else if(type == PT_DYNAMIC && dyn_size == 0)
+		{
+			dyn_offset = offset;
+			dyn_size = filesz;
+		}
+	}
+
+	free(pht);
+
+	if(dyn_size == 0)
+		return dynamic;
+
+	/* 3. The DYNAMIC segment. It ends at DT_NULL */
+	dynamic->dyn = elfp_main_get_range(main, dyn_offset, dyn_size);
+	if(dynamic->dyn == NULL)
+		return dynamic;
+
+	if(class == ELFCLASS32)
+		max = dyn_size / sizeof(Elf32_Dyn);
+	else
+		max = dyn_size / sizeof(Elf64_Dyn);
+
+	info = &dynamic->info;
+	for(i = 0; i < max; i++)
+	{
+		elfp_dyn_entry_get(main, dynamic, i, &tag, &val);
+		if(tag == DT_NULL)
+			break;
+
+		/* Addresses go into offset for now. They are translated once
+		 * the walk is done */
+		switch(tag)
+		{
+			case DT_NEEDED:
+				n_needed++;
+				break;
+
+			case DT_SONAME:
+				soname = val;
+				break;
+
+			case DT_RPATH:
+				rpath = val;
+				break;
+
+			case DT_RUNPATH:
+				runpath = val;
+				break;
+
+			case DT_FLAGS:
+				info->flags = val;
+				break;
+
+			case DT_FLAGS_1:
+				info->flags_1 = val;
+				break;
+
+			case DT_SYMTAB:
+				info->symtab.offset = val;
+				break;
+
+			case DT_STRTAB:
+				info->strtab.offset = val;
+				break;
+
+			case DT_STRSZ:
+				info->strtab.size = val;
+				break;
+
+			case DT_SYMENT:
+				info->syment = val;
+				break;
+
+			case DT_HASH:
+				info->hash.offset = val;
+				break;
+
+			case DT_GNU_HASH:
+				info->gnu_hash.offset = val;
+				break;
+
+			case DT_VERSYM:
+				versym = val;
+				break;
+
+			case DT_RELA:
+				info->rela.offset = val;
+				break;
+
+			case DT_RELASZ:
+				info->rela.size = val;
+				break;
+
+			case DT_RELAENT:
+				info->relaent = val;
+				break;
+
+			case DT_RELACOUNT:
+				info->relacount = val;
+				break;
+
+			case DT_REL:
+				info->rel.offset = val;
+				break;
+
+			case DT_RELSZ:
+				info->rel.size = val;
+				break;
+
+			case DT_RELENT:
+				info->relent = val;
+				break;
+
+			case DT_RELCOUNT:
+				info->relcount = val;
+				break;
+
+			case DT_RELR:
+				info->relr.offset = val;
+				break;
+
+			case DT_RELRSZ:
+				info->relr.size = val;
+				break;
+
+			case DT_JMPREL:
+				info->jmprel.offset = val;
+				break;
+
+			case DT_PLTRELSZ:
+				info->jmprel.size = val;
+				break;
+
+			case DT_PLTREL:
+				info->pltrel = val;
+				break;
+
+			case DT_INIT:
+				init = val;
+				break;
+
+			case DT_FINI:
+				fini = val;
+				break;
+
+			case DT_INIT_ARRAY:
+				info->init_array.offset = val;
+				break;
+
+			case DT_INIT_ARRAYSZ:
+				info->init_array.size = val;
+				break;
+
+			case DT_FINI_ARRAY:
+				info->fini_array.offset = val;
+				break;
+
+			case DT_FINI_ARRAYSZ:
+				info->fini_array.size = val;
+				break;
+
+			case DT_PREINIT_ARRAY:
+				info->preinit_array.offset = val;
+				break;
+
+			case DT_PREINIT_ARRAYSZ:
+				info->preinit_array.size = val;
+				break;
+		}
+	}
+	dynamic->count = i;
+
+	/* 4. Addresses to file offsets */
+	elfp_dyn_table_fix(dynamic, &info->symtab, 0);
+	elfp_dyn_table_fix(dynamic, &info->strtab, 1);
+	elfp_dyn_table_fix(dynamic, &info->hash, 0);
+	elfp_dyn_table_fix(dynamic, &info->gnu_hash, 0);
+	elfp_dyn_table_fix(dynamic, &info->rela, 1);
+	elfp_dyn_table_fix(dynamic, &info->rel, 1);
+	elfp_dyn_table_fix(dynamic, &info->relr, 1);
+	elfp_dyn_table_fix(dynamic, &info->jmprel, 1);
+	elfp_dyn_table_fix(dynamic, &info->init_array, 1);
+	elfp_dyn_table_fix(dynamic, &info->fini_array, 1);
+	elfp_dyn_table_fix(dynamic, &info->preinit_array, 1);
+
+	if(init != 0 && elfp_dyn_vaddr_to_offset(dynamic, init, &info->init, NULL) == -1)
+		info->init = 0;
+	if(fini != 0 && elfp_dyn_vaddr_to_offset(dynamic, fini, &info->fini, NULL) == -1)
+		info->fini = 0;
+
+	/* 5. Tables needed for symbol lookup. Any of them can be missing */
+	if(class == ELFCLASS32)
+		dynamic->syms_max = info->symtab.size / sizeof(Elf32_Sym);
+	else
+		dynamic->syms_max = info->symtab.size / sizeof(Elf64_Sym);
+
+	dynamic->syms = elfp_dyn_table_map(main, &info->symtab);
+	dynamic->strtab = elfp_dyn_table_map(main, &info->strtab);
+	dynamic->strsize = info->strtab.size;
+	dynamic->hash = elfp_dyn_table_map(main, &info->hash);
+	dynamic->hash_words = info->hash.size / sizeof(unsigned int);
+	dynamic->gnu_hash = elfp_dyn_table_map(main, &info->gnu_hash);
+	dynamic->gnu_hash_words = info->gnu_hash.size / sizeof(unsigned int);
+
+	if(versym != 0 && elfp_dyn_vaddr_to_offset(dynamic, versym,
+				&versym_offset, &versym_size) == 0)
+	{
+		dynamic->versym = elfp_main_get_range(main, versym_offset,
+								versym_size);
+		dynamic->versym_count = versym_size / sizeof(uint16_t);
+		if(dynamic->versym_count > dynamic->syms_max)
+			dynamic->versym_count = dynamic->syms_max;
+		if(dynamic->versym == NULL)
+			dynamic->versym_count = 0;
+	}
+
+	/* 6. Strings. An entry with a broken string is left out */
+	if(soname != ULONG_MAX)
+		info->soname = elfp_dyn_string_get(dynamic, soname);
+	if(rpath != ULONG_MAX)
+		info->rpath = elfp_dyn_string_get(dynamic, rpath);
+	if(runpath != ULONG_MAX)
+		info->runpath = elfp_dyn_string_get(dynamic, runpath);
+
+	info->needed = elfp_main_alloc(main, n_needed * sizeof(const char *) + 1);
+	if(info->needed == NULL)
+	{
+		elfp_err_warn("elfp_dyn_index_build", "elfp_main_alloc() failed");
+		return NULL;
+	}
+
+	for(i = 0; i < dynamic->count && info->n_needed < n_needed; i++)
+	{
+		elfp_dyn_entry_get(main, dynamic, i, &tag, &val);
+		if(tag != DT_NEEDED)
+			continue;
+
+		str = elfp_dyn_string_get(dynamic, val);
+		if(str == NULL)
+		{
+			elfp_err_warn("elfp_dyn_index_build", "Broken DT_NEEDED entry");
+			continue;
+		}
+
+		info->needed[info->n_needed] = str;
+		info->n_needed++;
+	}
+
+	return dynamic;
+}
+
+elfp_main_dynamic*
+elfp_dyn_index_get(elfp_main *main)
+{
+	/* Basic check */
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_dyn_index_get", "NULL argument passed");
+		return NULL;
+	}
+
+	elfp_main_dynamic *dynamic = NULL;
+
+	/* Built already? */
+	dynamic = __atomic_load_n(&main->dynamic, __ATOMIC_ACQUIRE);
+	if(dynamic != NULL)
+		return dynamic;
+
+	/* Only one thread builds it. Others wait and use it */
+	pthread_mutex_lock(&main->index_lock);
+	dynamic = main->dynamic;
+	if(dynamic == NULL)
+	{
+		dynamic = elfp_dyn_index_build(main);
+		if(dynamic != NULL)
+			__atomic_store_n(&main->dynamic, dynamic, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&main->index_lock);
+
+	if(dynamic == NULL)
+		elfp_err_warn("elfp_dyn_index_get", "elfp_dyn_index_build() failed");
+
+	return dynamic;
+}
+
+/*
+ * elfp_dyn_sysv_hash: Hash of a name, as DT_HASH uses.
+ */
+static unsigned int
+elfp_dyn_sysv_hash(const char *name)
+{
+	const unsigned char *c = (const unsigned char *)name;
+	unsigned int hash = 0, high;
+
+	while(*c != '\0')
+	{
+		hash = (hash << 4) + *c;
+		high = hash & 0xf0000000;
+		if(high != 0)
+			hash = hash ^ (high >> 24);
+		hash = hash & ~high;
+		c++;
+	}
+
+	return hash;
+}
+
+/*
+ * elfp_dyn_sym_match: Decodes a dynamic symbol and checks if it is a
+ * 	definition of name - the way ld.so decides. A name without a
+ * 	version never binds to a hidden one ("memcpy@GLIBC_2.2.5"), only
+ * 	to the default ("memcpy@@GLIBC_2.14").
+ *
+ * @return: 1 if it is, 0 if not.
+ */
+static int
+elfp_dyn_sym_match(elfp_main *main, elfp_main_dynamic *dynamic,
+		unsigned long int index, const char *name, elfp_sym *sym)
+{
+	elfp_main_symbols table;
+	unsigned long int name_off, len;
+	uint16_t versym;
+
+	/* elfp_sym_decode() only needs the table and its strings */
+	memset(&table, 0, sizeof(table));
+	table.syms = dynamic->syms;
+	table.count = dynamic->syms_max;
+	table.strtab = dynamic->strtab;
+	table.strsize = dynamic->strsize;
+
+	elfp_sym_decode(main, &table, index, sym);
+
+	/* Undefined references and symbols which don't stand for code or
+	 * data don't satisfy a lookup */
+	if(sym->shndx == SHN_UNDEF)
+		return 0;
+
+	switch(sym->type)
+	{
+		case STT_NOTYPE:
+		case STT_OBJECT:
+		case STT_FUNC:
+		case STT_COMMON:
+		case STT_TLS:
+		case STT_GNU_IFUNC:
+			break;
+
+		default:
+			return 0;
+	}
+
+	if(index < dynamic->versym_count)
+	{
+		memcpy(&versym, dynamic->versym + index * sizeof(uint16_t),
+							sizeof(uint16_t));
+		if((versym & ELFP_VERSYM_HIDDEN) != 0)
+			return 0;
+	}
+
+	/* The string table need not end with a NUL. Don't go past it */
+	if(sym->name < dynamic->strtab ||
+			sym->name >= dynamic->strtab + dynamic->strsize)
+		return 0;
+
+	name_off = sym->name - dynamic->strtab;
+	len = strlen(name);
+	if(len >= dynamic->strsize - name_off)
+		return 0;
+
+	return (memcmp(sym->name, name, len) == 0 && sym->name[len] == '\0');
+}
+
+/*
+ * elfp_dyn_gnu_lookup: Looks up a name in DT_GNU_HASH.
+ *
+ * 	* Bloom filter first. It rejects most names which are not there
+ * 	without touching the buckets.
+ * 	* Then the bucket, and its chain. Chain entries are the hashes
+ * 	of consecutive symbols, with the lowest bit marking the last one.
+ *
+ * @return: 0 if found, -1 if not.
+ */
+static int
+elfp_dyn_gnu_lookup(elfp_main *main, elfp_main_dynamic *dynamic,
+		const char *name, elfp_sym *sym)
+{
+	const unsigned int *words = dynamic->gnu_hash;
+	const unsigned int *buckets = NULL, *chain = NULL;
+	const uint64_t *bloom64 = NULL;
+	const uint32_t *bloom32 = NULL;
+	unsigned long int n_buckets, sym_offset, bloom_size, bloom_shift;
+	unsigned long int bloom_words, chain_words, index;
+	unsigned int hash, chain_hash;
+	uint64_t word64, mask64;
+	uint32_t word32, mask32;
+
+	if(dynamic->gnu_hash_words < 4)
+		goto corrupt;
+
+	n_buckets = words[0];
+	sym_offset = words[1];
+	bloom_size = words[2];
+	bloom_shift = words[3];
+
+	/* Bloom words are of the class's word size */
+	if(elfp_main_get_class(main) == ELFCLASS32)
+		bloom_words = bloom_size;
+	else
+		bloom_words = bloom_size * 2;
+
+	if(n_buckets == 0 || bloom_size == 0 ||
+		(bloom_size & (bloom_size - 1)) != 0 ||
+		4 + bloom_words + n_buckets > dynamic->gnu_hash_words)
+		goto corrupt;
+
+	buckets = words + 4 + bloom_words;
+	chain = buckets + n_buckets;
+	chain_words = dynamic->gnu_hash_words - (4 + bloom_words + n_buckets);
+
+	hash = elfp_shdr_hash(name);
+
+	/* 1. Bloom filter. 2 bits per name */
+	if(elfp_main_get_class(main) == ELFCLASS32)
+	{
+		bloom32 = (const uint32_t *)(words + 4);
+		word32 = bloom32[(hash / 32) & (bloom_size - 1)];
+		mask32 = ((uint32_t)1 << (hash % 32)) |
+				((uint32_t)1 << ((hash >> bloom_shift) % 32));
+		if((word32 & mask32) != mask32)
+			return -1;
+	}
+	else
+	{
+		bloom64 = (const uint64_t *)(words + 4);
+		word64 = bloom64[(hash / 64) & (bloom_size - 1)];
+		mask64 = ((uint64_t)1 << (hash % 64)) |
+				((uint64_t)1 << ((hash >> bloom_shift) % 64));
+		if((word64 & mask64) != mask64)
+			return -1;
+	}
+
+	/* 2. Bucket. Symbols below sym_offset are not in the table */
+	index = buckets[hash % n_buckets];
+	if(index < sym_offset)
+		return -1;
+
+	/* 3. Chain */
+	while(1)
+	{
+		if(index - sym_offset >= chain_words || index >= dynamic->syms_max)
+			goto corrupt;
+
+		chain_hash = chain[index - sym_offset];
+		if((hash | 1) == (chain_hash | 1) &&
+			elfp_dyn_sym_match(main, dynamic, index, name, sym) == 1)
+			return 0;
+
+		if((chain_hash & 1) != 0)
+			return -1;
+
+		index++;
+	}
+
+corrupt:
+	elfp_err_warn("elfp_dyn_gnu_lookup", "DT_GNU_HASH is corrupt");
+	return -1;
+}
+
+/*
+ * elfp_dyn_sysv_lookup: Looks up a name in DT_HASH.
+ *
+ * @return: 0 if found, -1 if not.
+ */
+static int
+elfp_dyn_sysv_lookup(elfp_main *main, elfp_main_dynamic *dynamic,
+		const char *name, elfp_sym *sym)
+{
+	const unsigned int *words = dynamic->hash;
+	const unsigned int *buckets = NULL, *chain = NULL;
+	unsigned long int n_buckets, n_chain, index, steps;
+
+	if(dynamic->hash_words < 2)
+		goto corrupt;
+
+	n_buckets = words[0];
+	n_chain = words[1];
+	if(n_buckets == 0 || 2 + n_buckets + n_chain > dynamic->hash_words)
+		goto corrupt;
+
+	buckets = words + 2;
+	chain = buckets + n_buckets;
+
+	/* A chain can't be longer than the table. If it is, it loops */
+	steps = 0;
+	for(index = buckets[elfp_dyn_sysv_hash(name) % n_buckets];
+			index != STN_UNDEF; index = chain[index])
+	{
+		if(index >= n_chain || index >= dynamic->syms_max ||
+							steps++ > n_chain)
+			goto corrupt;
+
+		if(elfp_dyn_sym_match(main, dynamic, index, name, sym) == 1)
+			return 0;
+	}
+
+	return -1;
+
+corrupt:
+	elfp_err_warn("elfp_dyn_sysv_lookup", "DT_HASH is corrupt");
+	return -1;
+}
+
+/*
+ * All functions defined below are exposed to programmers.
+ *
+ * Refer to elfp.h for more details.
+ */
+
+const elfp_dynamic*
+elfp_dyn_get(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_dyn_get", "Handle failed the sanity test");
+		return NULL;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_dynamic *dynamic = NULL;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_dyn_get", "elfp_main_vec_get_em() failed");
+		return NULL;
+	}
+
+	dynamic = elfp_dyn_index_get(main);
+	elfp_main_vec_put_em(handle);
+
+	if(dynamic == NULL)
+	{
+		elfp_err_warn("elfp_dyn_get", "elfp_dyn_index_get() failed");
+		return NULL;
+	}
+
+	/* It lives in the arena. It is there till the handle is closed */
+	if(dynamic->dyn == NULL)
+		return NULL;
+
+	return &dynamic->info;
+}
+
+int
+elfp_dynsym_lookup(int handle, const char *name, elfp_sym *sym)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || name == NULL || sym == NULL)
+	{
+		elfp_err_warn("elfp_dynsym_lookup", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_dynamic *dynamic = NULL;
+	int ret = -1;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_dynsym_lookup", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	dynamic = elfp_dyn_index_get(main);
+	if(dynamic == NULL)
+	{
+		elfp_err_warn("elfp_dynsym_lookup", "elfp_dyn_index_get() failed");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	/* DT_GNU_HASH if it is there. Files built for old loaders have
+	 * only DT_HASH */
+	if(dynamic->syms == NULL || dynamic->strtab == NULL)
+		elfp_err_warn("elfp_dynsym_lookup", "No dynamic symbol table");
+	else if(dynamic->gnu_hash != NULL)
+		ret = elfp_dyn_gnu_lookup(main, dynamic, name, sym);
+	else if(dynamic->hash != NULL)
+		ret = elfp_dyn_sysv_lookup(main, dynamic, name, sym);
+	else
+		elfp_err_warn("elfp_dynsym_lookup", "No symbol hash table");
+
+	elfp_main_vec_put_em(handle);
+
+	return ret;
+}
+
+int
+elfp_dyn_dump(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_dyn_dump", "Handle failed the sanity test");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_dynamic *dynamic = NULL;
+	unsigned long int i, tag, val;
+	const char *str = NULL;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_dyn_dump", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	dynamic = elfp_dyn_index_get(main);
+	if(dynamic == NULL)
+	{
+		elfp_err_warn("elfp_dyn_dump", "elfp_dyn_index_get() failed");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	if(dynamic->dyn == NULL)
+	{
+		printf("There is no DYNAMIC segment in this file\n");
+		elfp_main_vec_put_em(handle);
+		return 0;
+	}
+
+	printf("\n==================================================\n");
+	printf("Dynamic segment: %lu entries\n\n", dynamic->count);
+	printf("%-18s  %-18s  %s\n", "Tag", "Type", "Name/Value");
+
+	for(i = 0; i < dynamic->count; i++)
+	{
+		elfp_dyn_entry_get(main, dynamic, i, &tag, &val);
+		printf("0x%016lx  %-18s  ", tag, elfp_dyn_decode_tag(tag));
+
+		switch(tag)
+		{
+			case DT_NEEDED:
+			case DT_SONAME:
+			case DT_RPATH:
+			case DT_RUNPATH:
+				str = elfp_dyn_string_get(dynamic, val);
+				if(str == NULL)
+					printf("<corrupt: 0x%lx>\n", val);
+				else if(tag == DT_NEEDED)
+					printf("Shared library: [%s]\n", str);
+				else if(tag == DT_SONAME)
+					printf("Library soname: [%s]\n", str);
+				else
+					printf("Library search path: [%s]\n", str);
+				break;
+
+			case DT_PLTRELSZ:
+			case DT_RELASZ:
+			case DT_RELAENT:
+			case DT_STRSZ:
+			case DT_SYMENT:
+			case DT_RELSZ:
+			case DT_RELENT:
+			case DT_INIT_ARRAYSZ:
+			case DT_FINI_ARRAYSZ:
+			case DT_PREINIT_ARRAYSZ:
+			case DT_RELRSZ:
+			case DT_RELRENT:
+				printf("%lu (bytes)\n", val);
+				break;
+
+			default:
+				printf("0x%lx\n", val);
+				break;
+		}
+	}
+
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
+
+/*
+ * Decode functions.
+ */
+const char*
+elfp_dyn_decode_tag(unsigned long int tag)
+{
+	switch(tag)
+	{
+		case DT_NULL:
+			return "NULL";
+
+		case DT_NEEDED:
+			return "NEEDED";
+
+		case DT_PLTRELSZ:
+			return "PLTRELSZ";
+
+		case DT_PLTGOT:
+			return "PLTGOT";
+
+		case DT_HASH:
+			return "HASH";
+
+		case DT_STRTAB:
+			return "STRTAB";
+
+		case DT_SYMTAB:
+			return "SYMTAB";
+
+		case DT_RELA:
+			return "RELA";
+
+		case DT_RELASZ:
+			return "RELASZ";
+
+		case DT_RELAENT:
+			return "RELAENT";
+
+		case DT_STRSZ:
+			return "STRSZ";
+
+		case DT_SYMENT:
+			return "SYMENT";
+
+		case DT_INIT:
+			return "INIT";
+
+		case DT_FINI:
+			return "FINI";
+
+		case DT_SONAME:
+			return "SONAME";
+
+		case DT_RPATH:
+			return "RPATH";
+
+		case DT_SYMBOLIC:
+			return "SYMBOLIC";
+
+		case DT_REL:
+			return "REL";
+
+		case DT_RELSZ:
+			return "RELSZ";
+
+		case DT_RELENT:
+			return "RELENT";
+
+		case DT_PLTREL:
+			return "PLTREL";
+
+		case DT_DEBUG:
+			return "DEBUG";
+
+		case DT_TEXTREL:
+			return "TEXTREL";
+
+		case DT_JMPREL:
+			return "JMPREL";
+
+		case DT_BIND_NOW:
+			return "BIND_NOW";
+
+		case DT_INIT_ARRAY:
+			return "INIT_ARRAY";
+
+		case DT_FINI_ARRAY:
+			return "FINI_ARRAY";
+
+		case DT_INIT_ARRAYSZ:
+			return "INIT_ARRAYSZ";
+
+		case DT_FINI_ARRAYSZ:
+			return "FINI_ARRAYSZ";
+
+		case DT_RUNPATH:
+			return "RUNPATH";
+
+		case DT_FLAGS:
+			return "FLAGS";
+
+		case DT_PREINIT_ARRAY:
+			return "PREINIT_ARRAY";
+
+		case DT_PREINIT_ARRAYSZ:
+			return "PREINIT_ARRAYSZ";
+
+		case DT_SYMTAB_SHNDX:
+			return "SYMTAB_SHNDX";
+
+		case DT_RELRSZ:
+			return "RELRSZ";
+
+		case DT_RELR:
+			return "RELR";
+
+		case DT_RELRENT:
+			return "RELRENT";
+
+		case DT_GNU_HASH:
+			return "GNU_HASH";
+
+		case DT_VERSYM:
+			return "VERSYM";
+
+		case DT_RELACOUNT:
+			return "RELACOUNT";
+
+		case DT_RELCOUNT:
+			return "RELCOUNT";
+
+		case DT_FLAGS_1:
+			return "FLAGS_1";
+
+		case DT_VERDEF:
+			return "VERDEF";
+
+		case DT_VERDEFNUM:
+			return "VERDEFNUM";
+
+		case DT_VERNEED:
+			return "VERNEED";
+
+		case DT_VERNEEDNUM:
+			return "VERNEEDNUM";
+
+		/* Anything else is not known to us */
+		default:
+			return "Unknown tag";
+	}
+}
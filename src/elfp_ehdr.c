@@ -203,10 +203,17 @@ elfp_ehdr_get(int handle)
 		return NULL;
 	}
 
-	addr = elfp_main_get_staddr(main);
+	if(elfp_main_get_class(main) == ELFCLASS32)
+		addr = elfp_main_get_range(main, 0, sizeof(Elf32_Ehdr));
+	else
+		addr = elfp_main_get_range(main, 0, sizeof(Elf64_Ehdr));
+
+	/* The pointer outlives our reference. The caller must not let the
+	 * handle be closed while using it - refer elfp.h */
+	elfp_main_vec_put_em(handle);
 	if(addr == NULL)
 	{
-		elfp_err_warn("elfp_ehdr_get", "elfp_main_get_staddr() failed");
+		elfp_err_warn("elfp_ehdr_get", "elfp_main_get_range() failed");
 		return NULL;
 	}
 	return addr;
@@ -310,6 +317,7 @@ elfp_ehdr_class_get(int handle)
 	}
 
 	class = elfp_main_get_class(main);
+	elfp_main_vec_put_em(handle);
 	return class;
 }
 
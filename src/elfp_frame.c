@@ -0,0 +1,901 @@
+/*
+ * File: elfp_frame.c
+ *
+ * Description: Call frame information. CIEs and FDEs of .eh_frame and
+ * 	.debug_frame, and the binary search table of .eh_frame_hdr which
+ * 	finds the FDE of an address.
+ *
+ * 	* .eh_frame_hdr's header is read once per file, the first time it
+ * 	is used. A lookup is a binary search in the table and a read of
+ * 	one FDE and its CIE, all in the mapped file. Nothing is allocated.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#include "./include/elfp_frame.h"
+#include "./include/elfp_dwarf.h"
+#include "./include/elfp_shdr.h"
+#include "./include/elfp_dyn.h"
+#include "./include/elfp_int.h"
+#include "./include/elfp_err.h"
+#include "./include/elfp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <elf.h>
+
+/*
+ * The below functions are internal to the library.
+ *
+ * Refer elfp_frame.h for their description.
+ */
+
+int
+elfp_frame_pointer_read(elfp_dwarf_cursor *cursor, unsigned int encoding,
+		const elfp_frame_section *section, unsigned long int *value)
+{
+	const unsigned char *field = cursor->p;
+	unsigned long int v, base, position, pad;
+
+	if(encoding == DW_EH_PE_omit)
+	{
+		*value = 0;
+		return 0;
+	}
+
+	/* An absolute pointer, at the next multiple of its size */
+	if((encoding & 0x70) == DW_EH_PE_aligned)
+	{
+		position = section->vaddr + (cursor->p - section->data);
+		pad = (section->addr_size - position % section->addr_size) %
+							section->addr_size;
+		elfp_dwarf_skip(cursor, pad);
+		*value = elfp_dwarf_uint(cursor, section->addr_size);
+		return (cursor->error == 0) ? 0 : -1;
+	}
+
+	switch(encoding & 0x0f)
+	{
+		case DW_EH_PE_absptr:
+			v = elfp_dwarf_uint(cursor, section->addr_size);
+			break;
+
+		case DW_EH_PE_uleb128:
+			v = elfp_dwarf_uleb(cursor);
+			break;
+
+		case DW_EH_PE_udata2:
+			v = elfp_dwarf_u16(cursor);
+			break;
+
+		case DW_EH_PE_udata4:
+			v = elfp_dwarf_u32(cursor);
+			break;
+
+		case DW_EH_PE_udata8:
+			v = elfp_dwarf_u64(cursor);
+			break;
+
+		case DW_EH_PE_sleb128:
+			v = elfp_dwarf_sleb(cursor);
+			break;
+
+		case DW_EH_PE_sdata2:
+			v = (long int)(int16_t)elfp_dwarf_u16(cursor);
+			break;
+
+		case DW_EH_PE_sdata4:
+			v = (long int)(int32_t)elfp_dwarf_u32(cursor);
+			break;
+
+		case DW_EH_PE_sdata8:
+			v = elfp_dwarf_u64(cursor);
+			break;
+
+		default:
+			return -1;
+	}
+
+	if(cursor->error != 0)
+		return -1;
+
+	/* What it is relative to. Text and function bases are not known
+	 * here - only LSDAs use them */
+	switch(encoding & 0x70)
+	{
+		case DW_EH_PE_absptr:
+			base = 0;
+			break;
+
+		case DW_EH_PE_pcrel:
+			base = section->vaddr + (field - section->data);
+			break;
+
+		case DW_EH_PE_datarel:
+			base = section->data_base;
+			break;
+
+		default:
+			return -1;
+	}
+
+	v = v + base;
+	if(section->addr_size == 4)
+		v = v & 0xffffffffUL;
+
+	*value = v;
+	return 0;
+}
+
+/*
+ * elfp_frame_entry_start: Starts reading a CIE / FDE.
+ *
+ * @arg2: Reference to a cursor. Set up to cover the entry, past its
+ * 	length and CIE id / pointer.
+ * @arg3: Reference to the CIE id / pointer, and where it is in the
+ * 	section. Filled up by the function.
+ *
+ * @return: Size of the entry on success, 0 if it is the terminator /
+ * 	broken.
+ */
+static unsigned long int
+elfp_frame_entry_start(const elfp_frame_section *section, unsigned long int offset,
+		elfp_dwarf_cursor *cursor, unsigned long int *id,
+		unsigned long int *id_offset, unsigned int *offset_size)
+{
+	unsigned long int length;
+
+	if(offset >= section->size)
+		return 0;
+
+	cursor->p = section->data + offset;
+	cursor->end = section->data + section->size;
+	cursor->error = 0;
+
+	length = elfp_dwarf_unit_length(cursor, offset_size);
+	if(cursor->error != 0 || length == 0)
+		return 0;
+
+	cursor->end = cursor->p + length;
+	*id_offset = cursor->p - section->data;
+	*id = elfp_dwarf_uint(cursor, *offset_size);
+	if(cursor->error != 0)
+		return 0;
+
+	return cursor->end - (section->data + offset);
+}
+
+/*
+ * elfp_frame_is_cie: Checks if a CIE id / pointer says "this is a CIE".
+ */
+static int
+elfp_frame_is_cie(const elfp_frame_section *section, unsigned long int id,
+						unsigned int offset_size)
+{
+	if(section->is_eh != 0)
+		return id == 0;
+
+	return (offset_size == 4) ? (id == 0xffffffffUL) : (id == ~0UL);
+}
+
+unsigned long int
+elfp_frame_entry_size(const elfp_frame_section *section, unsigned long int offset,
+							int *is_cie)
+{
+	elfp_dwarf_cursor cursor;
+	unsigned long int size, id, id_offset;
+	unsigned int offset_size;
+
+	size = elfp_frame_entry_start(section, offset, &cursor, &id, &id_offset,
+								&offset_size);
+	if(size != 0)
+		*is_cie = elfp_frame_is_cie(section, id, offset_size);
+
+	return size;
+}
+
+int
+elfp_frame_cie_read(const elfp_frame_section *section, unsigned long int offset,
+					elfp_frame_cie *cie)
+{
+	elfp_dwarf_cursor cursor;
+	unsigned long int size, id, id_offset, aug_size, personality;
+	unsigned int offset_size, encoding;
+	const unsigned char *aug_end = NULL;
+	const char *aug = NULL;
+
+	size = elfp_frame_entry_start(section, offset, &cursor, &id, &id_offset,
+								&offset_size);
+	if(size == 0 || elfp_frame_is_cie(section, id, offset_size) == 0)
+		return -1;
+
+	memset(cie, 0, sizeof(elfp_frame_cie));
+	cie->offset = offset;
+	cie->size = size;
+	cie->fde_encoding = DW_EH_PE_absptr;
+	cie->lsda_encoding = DW_EH_PE_omit;
+	cie->addr_size = section->addr_size;
+
+	cie->version = elfp_dwarf_u8(&cursor);
+	if(cie->version != 1 && cie->version != 3 && cie->version != 4)
+		return -1;
+
+	cie->augmentation = elfp_dwarf_cstr(&cursor);
+	if(cie->augmentation == NULL)
+		return -1;
+
+	/* Version 4 says how big addresses are. Segments are not supported */
+	if(cie->version == 4)
+	{
+		cie->addr_size = elfp_dwarf_u8(&cursor);
+		if(elfp_dwarf_u8(&cursor) != 0 ||
+			(cie->addr_size != 4 && cie->addr_size != 8))
+			return -1;
+	}
+
+	/* Old GCC's "eh" - the address of the EH data */
+	aug = cie->augmentation;
+	if(aug[0] == 'e' && aug[1] == 'h')
+	{
+		elfp_dwarf_skip(&cursor, cie->addr_size);
+		aug = aug + 2;
+	}
+
+	cie->code_align = elfp_dwarf_uleb(&cursor);
+	cie->data_align = elfp_dwarf_sleb(&cursor);
+	if(cie->version == 1)
+		cie->ra_register = elfp_dwarf_u8(&cursor);
+	else
+		cie->ra_register = elfp_dwarf_uleb(&cursor);
+
+	/* "z" - augmentation data, whose size is known. What comes after
+	 * the "z" says what is in it. Without "z", an augmentation can't be
+	 * skipped */
+	if(aug[0] == 'z')
+	{
+		cie->has_augmentation_data = 1;
+		aug_size = elfp_dwarf_uleb(&cursor);
+		if(cursor.error != 0 ||
+			aug_size > (unsigned long int)(cursor.end - cursor.p))
+			return -1;
+		aug_end = cursor.p + aug_size;
+
+		for(aug = aug + 1; *aug != '\0' && cursor.error == 0; aug++)
+		{
+			if(*aug == 'R')
+				cie->fde_encoding = elfp_dwarf_u8(&cursor);
+			else if(*aug == 'L')
+				cie->lsda_encoding = elfp_dwarf_u8(&cursor);
+			else if(*aug == 'P')
+			{
+				encoding = elfp_dwarf_u8(&cursor);
+				if(elfp_frame_pointer_read(&cursor, encoding &
+					~DW_EH_PE_indirect, section, &personality) == -1)
+					break;
+			}
+			else if(*aug == 'S')
+				cie->signal_frame = 1;
+			else if(*aug != 'B' && *aug != 'G')
+				break;
+		}
+
+		cursor.p = aug_end;
+		cursor.error = 0;
+	}
+	else if(aug[0] != '\0')
+		return -1;
+
+	if(cursor.error != 0 || cursor.p > cursor.end)
+		return -1;
+
+	cie->insns = cursor.p;
+	cie->insns_size = cursor.end - cursor.p;
+
+	return 0;
+}
+
+int
+elfp_frame_fde_read(const elfp_frame_section *section, unsigned long int offset,
+			elfp_frame_fde *fde, elfp_frame_cie *cie)
+{
+	elfp_dwarf_cursor cursor;
+	elfp_frame_section range_section;
+	unsigned long int size, id, id_offset, aug_size;
+	unsigned int offset_size;
+
+	size = elfp_frame_entry_start(section, offset, &cursor, &id, &id_offset,
+								&offset_size);
+	if(size == 0 || elfp_frame_is_cie(section, id, offset_size) != 0)
+		return -1;
+
+	memset(fde, 0, sizeof(elfp_frame_fde));
+	fde->offset = offset;
+	fde->size = size;
+
+	/* .eh_frame points back to the CIE from the pointer. .debug_frame
+	 * has its offset */
+	if(section->is_eh != 0)
+	{
+		if(id > id_offset)
+			return -1;
+		fde->cie_offset = id_offset - id;
+	}
+	else
+		fde->cie_offset = id;
+
+	if(elfp_frame_cie_read(section, fde->cie_offset, cie) == -1)
+		return -1;
+
+	/* The range is a size. It is encoded the same way as the start,
+	 * but isn't relative to anything */
+	if(section->is_eh != 0)
+	{
+		if(elfp_frame_pointer_read(&cursor, cie->fde_encoding, section,
+							&fde->pc_begin) == -1)
+			return -1;
+
+		range_section = *section;
+		range_section.addr_size = cie->addr_size;
+		if(elfp_frame_pointer_read(&cursor, cie->fde_encoding & 0x0f,
+				&range_section, &fde->pc_range) == -1)
+			return -1;
+	}
+	else
+	{
+		fde->pc_begin = elfp_dwarf_uint(&cursor, cie->addr_size);
+		fde->pc_range = elfp_dwarf_uint(&cursor, cie->addr_size);
+	}
+
+	if(cie->has_augmentation_data != 0)
+	{
+		aug_size = elfp_dwarf_uleb(&cursor);
+		elfp_dwarf_skip(&cursor, aug_size);
+	}
+
+	if(cursor.error != 0)
+		return -1;
+
+	fde->insns = cursor.p;
+	fde->insns_size = cursor.end - cursor.p;
+
+	return 0;
+}
+
+/*
+ * elfp_frame_encoding_size: Size of a pointer encoded a way.
+ *
+ * @return: The size, 0 if it is not fixed.
+ */
+static unsigned int
+elfp_frame_encoding_size(unsigned int encoding, unsigned int addr_size)
+{
+	if(encoding == DW_EH_PE_omit)
+		return 0;
+
+	switch(encoding & 0x0f)
+	{
+		case DW_EH_PE_absptr:
+			return addr_size;
+
+		case DW_EH_PE_udata2:
+		case DW_EH_PE_sdata2:
+			return 2;
+
+		case DW_EH_PE_udata4:
+		case DW_EH_PE_sdata4:
+			return 4;
+
+		case DW_EH_PE_udata8:
+		case DW_EH_PE_sdata8:
+			return 8;
+
+		default:
+			return 0;
+	}
+}
+
+/*
+ * elfp_frame_table_get: Reads an entry of .eh_frame_hdr's table.
+ *
+ * @arg2: 0 for the initial location, 1 for the FDE's address
+ *
+ * @return: The value. 0 if it can't be read - the table is checked when
+ * 	it is set up, so that doesn't happen.
+ */
+static unsigned long int
+elfp_frame_table_get(const elfp_main_eh_hdr *eh_hdr, unsigned long int index,
+							int field)
+{
+	elfp_dwarf_cursor cursor;
+	unsigned long int value = 0;
+	int32_t relative;
+
+	cursor.p = eh_hdr->table + index * eh_hdr->entry_size +
+				field * (eh_hdr->entry_size / 2);
+
+	/* What linkers write - offsets from .eh_frame_hdr, 4 bytes each.
+	 * Lookups read a few of these, so they get a way of their own */
+	if(eh_hdr->table_encoding == (DW_EH_PE_datarel | DW_EH_PE_sdata4))
+	{
+		memcpy(&relative, cursor.p, 4);
+		value = eh_hdr->hdr.vaddr + (long int)relative;
+		return (eh_hdr->hdr.addr_size == 4) ? (value & 0xffffffffUL) : value;
+	}
+
+	cursor.end = eh_hdr->hdr.data + eh_hdr->hdr.size;
+	cursor.error = 0;
+
+	elfp_frame_pointer_read(&cursor, eh_hdr->table_encoding, &eh_hdr->hdr,
+								&value);
+
+	return value;
+}
+
+/*
+ * elfp_frame_hdr_find: Finds .eh_frame_hdr - the PT_GNU_EH_FRAME segment,
+ * 	the section of that name in files without one.
+ *
+ * @return: 0 if found, -1 otherwise.
+ */
+static int
+elfp_frame_hdr_find(elfp_main *main, unsigned long int *offset,
+		unsigned long int *vaddr, unsigned long int *size)
+{
+	Elf64_Ehdr e64hdr;
+	Elf32_Ehdr e32hdr;
+	Elf64_Phdr p64hdr;
+	Elf32_Phdr p32hdr;
+	const elfp_section *sec = NULL;
+	unsigned long int phoff, phnum, entsize, i;
+	int class, ret;
+
+	class = elfp_main_get_class(main);
+	if(class == ELFCLASS32)
+	{
+		ret = elfp_main_read(main, 0, sizeof(Elf32_Ehdr), &e32hdr);
+		phoff = e32hdr.e_phoff;
+		phnum = e32hdr.e_phnum;
+		entsize = sizeof(Elf32_Phdr);
+		if(ret == -1 || e32hdr.e_phentsize != entsize)
+			phnum = 0;
+	}
+	else
+	{
+		ret = elfp_main_read(main, 0, sizeof(Elf64_Ehdr), &e64hdr);
+		phoff = e64hdr.e_phoff;
+		phnum = e64hdr.e_phnum;
+		entsize = sizeof(Elf64_Phdr);
+		if(ret == -1 || e64hdr.e_phentsize != entsize)
+			phnum = 0;
+	}
+
+	for(i = 0; i < phnum; i++)
+	{
+		if(class == ELFCLASS32)
+		{
+			if(elfp_main_read(main, phoff + i * entsize, entsize,
+								&p32hdr) == -1)
+				break;
+			if(p32hdr.p_type != PT_GNU_EH_FRAME)
+				continue;
+			*offset = p32hdr.p_offset;
+			*vaddr = p32hdr.p_vaddr;
+			*size = p32hdr.p_filesz;
+		}
+		else
+		{
+			if(elfp_main_read(main, phoff + i * entsize, entsize,
+								&p64hdr) == -1)
+				break;
+			if(p64hdr.p_type != PT_GNU_EH_FRAME)
+				continue;
+			*offset = p64hdr.p_offset;
+			*vaddr = p64hdr.p_vaddr;
+			*size = p64hdr.p_filesz;
+		}
+		return 0;
+	}
+
+	sec = elfp_shdr_find(main, ".eh_frame_hdr");
+	if(sec == NULL || sec->type == SHT_NOBITS)
+		return -1;
+
+	*offset = sec->offset;
+	*vaddr = sec->addr;
+	*size = sec->size;
+
+	return 0;
+}
+
+/*
+ * elfp_frame_eh_frame_find: Finds the .eh_frame .eh_frame_hdr points to.
+ * 	The section if it is where the pointer points, the rest of the
+ * 	PT_LOAD segment from there otherwise.
+ *
+ * @return: 0 if found, -1 otherwise.
+ */
+static int
+elfp_frame_eh_frame_find(elfp_main *main, unsigned long int vaddr,
+		unsigned long int *offset, unsigned long int *size)
+{
+	const elfp_section *sec = NULL;
+	elfp_main_dynamic *dynamic = NULL;
+
+	sec = elfp_shdr_find(main, ".eh_frame");
+	if(sec != NULL && sec->addr == vaddr && sec->type != SHT_NOBITS)
+	{
+		*offset = sec->offset;
+		*size = sec->size;
+		return 0;
+	}
+
+	dynamic = elfp_dyn_index_get(main);
+	if(dynamic == NULL)
+		return -1;
+
+	return elfp_dyn_vaddr_to_offset(dynamic, vaddr, offset, size);
+}
+
+/*
+ * elfp_frame_eh_hdr_read: Reads .eh_frame_hdr's header, and checks the
+ * 	table is sorted.
+ *
+ * 	* Called with index_lock held. The section index and the PT_LOAD
+ * 	map are built already.
+ *
+ * @return: NULL on failure, the table on success.
+ */
+static elfp_main_eh_hdr*
+elfp_frame_eh_hdr_read(elfp_main *main)
+{
+	elfp_main_eh_hdr *eh_hdr = NULL;
+	elfp_frame_section *hdr = NULL;
+	elfp_dwarf_cursor cursor;
+	unsigned long int offset, vaddr, size, eh_vaddr, n_fdes, i, prev, loc;
+	unsigned int eh_encoding, count_encoding;
+
+	eh_hdr = elfp_main_alloc(main, sizeof(elfp_main_eh_hdr));
+	if(eh_hdr == NULL)
+	{
+		elfp_err_warn("elfp_frame_eh_hdr_read", "elfp_main_alloc() failed");
+		return NULL;
+	}
+
+	if(elfp_frame_hdr_find(main, &offset, &vaddr, &size) == -1 ||
+		offset > main->file_size || size > main->file_size - offset ||
+		size < 4)
+		return eh_hdr;
+
+	hdr = &eh_hdr->hdr;
+	hdr->data = elfp_main_get_range(main, offset, size);
+	if(hdr->data == NULL)
+		return eh_hdr;
+	hdr->size = size;
+	hdr->offset = offset;
+	hdr->vaddr = vaddr;
+	hdr->is_eh = 1;
+	hdr->addr_size = (elfp_main_get_class(main) == ELFCLASS32) ? 4 : 8;
+	hdr->data_base = vaddr;
+
+	/* version, then how the three fields after are encoded */
+	cursor.p = hdr->data;
+	cursor.end = hdr->data + size;
+	cursor.error = 0;
+	if(elfp_dwarf_u8(&cursor) != 1)
+	{
+		elfp_err_warn("elfp_frame_eh_hdr_read", "Unsupported .eh_frame_hdr version");
+		return eh_hdr;
+	}
+	eh_encoding = elfp_dwarf_u8(&cursor);
+	count_encoding = elfp_dwarf_u8(&cursor);
+	eh_hdr->table_encoding = elfp_dwarf_u8(&cursor);
+
+	if(elfp_frame_pointer_read(&cursor, eh_encoding, hdr, &eh_vaddr) == -1 ||
+		elfp_frame_eh_frame_find(main, eh_vaddr, &offset, &size) == -1 ||
+		offset > main->file_size || size > main->file_size - offset)
+	{
+		elfp_err_warn("elfp_frame_eh_hdr_read", ".eh_frame is not in the file");
+		return eh_hdr;
+	}
+
+	eh_hdr->eh_frame = *hdr;
+	eh_hdr->eh_frame.data = elfp_main_get_range(main, offset, size);
+	if(eh_hdr->eh_frame.data == NULL)
+		return eh_hdr;
+	eh_hdr->eh_frame.size = size;
+	eh_hdr->eh_frame.offset = offset;
+	eh_hdr->eh_frame.vaddr = eh_vaddr;
+	eh_hdr->available = 1;
+
+	/* The table. Only one of fixed size entries can be searched */
+	eh_hdr->entry_size = 2 * elfp_frame_encoding_size(
+				eh_hdr->table_encoding, hdr->addr_size);
+	if(count_encoding == DW_EH_PE_omit || eh_hdr->entry_size == 0 ||
+		(eh_hdr->table_encoding & DW_EH_PE_indirect) != 0 ||
+		elfp_frame_pointer_read(&cursor, count_encoding, hdr, &n_fdes) == -1)
+		return eh_hdr;
+
+	if(n_fdes > (unsigned long int)(cursor.end - cursor.p) /
+							eh_hdr->entry_size)
+	{
+		elfp_err_warn("elfp_frame_eh_hdr_read", "Broken .eh_frame_hdr table");
+		return eh_hdr;
+	}
+
+	eh_hdr->table = cursor.p;
+	eh_hdr->n_fdes = n_fdes;
+
+	/* Linkers sort it. A binary search in one they didn't would find
+	 * the wrong FDEs */
+	prev = 0;
+	for(i = 0; i < n_fdes; i++)
+	{
+		loc = elfp_frame_table_get(eh_hdr, i, 0);
+		if(i != 0 && loc < prev)
+		{
+			elfp_err_warn("elfp_frame_eh_hdr_read", ".eh_frame_hdr table is not sorted");
+			eh_hdr->table = NULL;
+			eh_hdr->n_fdes = 0;
+			break;
+		}
+		prev = loc;
+	}
+
+	return eh_hdr;
+}
+
+elfp_main_eh_hdr*
+elfp_frame_eh_hdr_get(elfp_main *main)
+{
+	/* Basic check */
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_frame_eh_hdr_get", "NULL argument passed");
+		return NULL;
+	}
+
+	elfp_main_eh_hdr *eh_hdr = NULL;
+
+	/* Read already? */
+	eh_hdr = __atomic_load_n(&main->eh_hdr, __ATOMIC_ACQUIRE);
+	if(eh_hdr != NULL)
+		return eh_hdr;
+
+	/* The section index and the PT_LOAD map take index_lock themselves.
+	 * Get them out of the way first */
+	if(elfp_shdr_index_get(main) == NULL || elfp_dyn_index_get(main) == NULL)
+	{
+		elfp_err_warn("elfp_frame_eh_hdr_get", "Failed to get the section index / PT_LOAD map");
+		return NULL;
+	}
+
+	/* Only one thread reads it. Others wait and use it */
+	pthread_mutex_lock(&main->index_lock);
+	eh_hdr = main->eh_hdr;
+	if(eh_hdr == NULL)
+	{
+		eh_hdr = elfp_frame_eh_hdr_read(main);
+		if(eh_hdr != NULL)
+			__atomic_store_n(&main->eh_hdr, eh_hdr, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&main->index_lock);
+
+	if(eh_hdr == NULL)
+		elfp_err_warn("elfp_frame_eh_hdr_get", "elfp_frame_eh_hdr_read() failed");
+
+	return eh_hdr;
+}
+
+/*
+ * elfp_frame_fde_find: Finds the FDE of an address through the table.
+ *
+ * @return: 0 on success, -1 if no FDE covers the address.
+ */
+static int
+elfp_frame_fde_find(const elfp_main_eh_hdr *eh_hdr, unsigned long int pc,
+			elfp_frame_fde *fde, elfp_frame_cie *cie)
+{
+	unsigned long int low, high, middle, fde_vaddr;
+
+	/* The last entry which starts at / before pc */
+	low = 0;
+	high = eh_hdr->n_fdes;
+	while(low < high)
+	{
+		middle = low + (high - low) / 2;
+		if(elfp_frame_table_get(eh_hdr, middle, 0) <= pc)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	if(low == 0)
+		return -1;
+
+	fde_vaddr = elfp_frame_table_get(eh_hdr, low - 1, 1);
+	if(fde_vaddr < eh_hdr->eh_frame.vaddr)
+		return -1;
+
+	if(elfp_frame_fde_read(&eh_hdr->eh_frame, fde_vaddr -
+			eh_hdr->eh_frame.vaddr, fde, cie) == -1)
+		return -1;
+
+	if(pc < fde->pc_begin || pc - fde->pc_begin >= fde->pc_range)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * elfp_frame_fde_fill: Fills up the user's elfp_fde.
+ */
+static void
+elfp_frame_fde_fill(const elfp_frame_section *section, const elfp_frame_fde *fde,
+				const elfp_frame_cie *cie, elfp_fde *out)
+{
+	out->pc_begin = fde->pc_begin;
+	out->pc_end = fde->pc_begin + fde->pc_range;
+	out->fde = section->data + fde->offset;
+	out->fde_offset = section->offset + fde->offset;
+	out->fde_size = fde->size;
+	out->cie = section->data + cie->offset;
+	out->cie_offset = section->offset + cie->offset;
+	out->cie_size = cie->size;
+	out->augmentation = cie->augmentation;
+	out->code_align = cie->code_align;
+	out->data_align = cie->data_align;
+	out->ra_register = cie->ra_register;
+	out->signal_frame = cie->signal_frame;
+	out->cie_insns = cie->insns;
+	out->cie_insns_size = cie->insns_size;
+	out->insns = fde->insns;
+	out->insns_size = fde->insns_size;
+}
+
+/*
+ * All functions defined below are exposed to programmers.
+ *
+ * Refer to elfp.h for more details.
+ */
+
+unsigned long int
+elfp_fde_count(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_fde_count", "Handle failed the sanity test");
+		return 0;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_eh_hdr *eh_hdr = NULL;
+	unsigned long int count = 0;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_fde_count", "elfp_main_vec_get_em() failed");
+		return 0;
+	}
+
+	eh_hdr = elfp_frame_eh_hdr_get(main);
+	if(eh_hdr != NULL)
+		count = eh_hdr->n_fdes;
+	elfp_main_vec_put_em(handle);
+
+	return count;
+}
+
+int
+elfp_fde_lookup(int handle, unsigned long int pc, elfp_fde *fde)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || fde == NULL)
+	{
+		elfp_err_warn("elfp_fde_lookup", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_eh_hdr *eh_hdr = NULL;
+	elfp_frame_fde this_fde;
+	elfp_frame_cie cie;
+	int ret = -1;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_fde_lookup", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	eh_hdr = elfp_frame_eh_hdr_get(main);
+	if(eh_hdr != NULL && eh_hdr->table != NULL)
+	{
+		ret = elfp_frame_fde_find(eh_hdr, pc, &this_fde, &cie);
+		if(ret == 0)
+			elfp_frame_fde_fill(&eh_hdr->eh_frame, &this_fde, &cie, fde);
+	}
+	elfp_main_vec_put_em(handle);
+
+	return ret;
+}
+
+int
+elfp_fde_dump(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_fde_dump", "Handle failed the sanity test");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_eh_hdr *eh_hdr = NULL;
+	elfp_frame_fde fde;
+	elfp_frame_cie cie;
+	unsigned long int i, loc, fde_vaddr;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_fde_dump", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	eh_hdr = elfp_frame_eh_hdr_get(main);
+	if(eh_hdr == NULL)
+	{
+		elfp_err_warn("elfp_fde_dump", "elfp_frame_eh_hdr_get() failed");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	if(eh_hdr->available == 0)
+	{
+		printf("No .eh_frame_hdr\n");
+		elfp_main_vec_put_em(handle);
+		return 0;
+	}
+
+	printf(".eh_frame_hdr at 0x%lx, .eh_frame at 0x%lx (%lu bytes), %lu FDEs in the table (encoding 0x%x)\n",
+		eh_hdr->hdr.vaddr, eh_hdr->eh_frame.vaddr, eh_hdr->eh_frame.size,
+		eh_hdr->n_fdes, eh_hdr->table_encoding);
+
+	for(i = 0; i < eh_hdr->n_fdes; i++)
+	{
+		loc = elfp_frame_table_get(eh_hdr, i, 0);
+		fde_vaddr = elfp_frame_table_get(eh_hdr, i, 1);
+		printf("\t0x%lx: FDE at 0x%lx", loc, fde_vaddr);
+
+		if(fde_vaddr >= eh_hdr->eh_frame.vaddr &&
+			elfp_frame_fde_read(&eh_hdr->eh_frame, fde_vaddr -
+				eh_hdr->eh_frame.vaddr, &fde, &cie) == 0)
+			printf(", [0x%lx, 0x%lx), CIE \"%s\"%s\n", fde.pc_begin,
+				fde.pc_begin + fde.pc_range, cie.augmentation,
+				(fde.pc_begin != loc) ? " (does not match)" : "");
+		else
+			printf(", broken\n");
+	}
+
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
@@ -24,9 +24,11 @@
 #include "./include/elfp_err.h"
 #include "./include/elfp_int.h"
 #include "./include/elfp_ds.h"
+#include "./include/elfp.h"
 
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -40,21 +42,260 @@
  * Refer elfp_int.h for structure definition and functions' description.
  */
 
-elfp_main*
-elfp_main_create(const char *file_path)
+/*
+ * elfp_main_read_headers: Reads the ELF header and (if it is close enough)
+ * 	the Program Header Table into an owned buffer.
+ *
+ * 	* Used in place of mmap() by ELFP_OPEN_HEADERS_ONLY and
+ * 	ELFP_OPEN_WINDOWED.
+ * 	* The buffer has the same layout as the file. So, it can be used
+ * 	as start address for everything it covers.
+ */
+static int
+elfp_main_read_headers(elfp_main *main)
 {
-	/* Basic check */
-	if(file_path == NULL)
+	Elf64_Ehdr e64hdr;
+	Elf32_Ehdr *e32hdr = NULL;
+	unsigned long int ehsize, phoff, phsize, bufsize;
+	unsigned char class;
+	ssize_t ret;
+
+	/* Class decides the size of the header */
+	ret = pread(main->fd, &class, 1, EI_CLASS);
+	if(ret != 1)
 	{
-		elfp_err_warn("elfp_main_create", "NULL argument passed");
-		return NULL;
+		if(ret >= 0)
+			errno = ENOEXEC;
+		elfp_err_warn("elfp_main_read_headers", "pread() failed");
+		return -1;
+	}
+
+	ehsize = (class == ELFCLASS32) ? sizeof(Elf32_Ehdr) : sizeof(Elf64_Ehdr);
+	ret = pread(main->fd, &e64hdr, ehsize, 0);
+	if(ret < 0 || (unsigned long int)ret != ehsize)
+	{
+		if(ret >= 0)
+			errno = ENOEXEC;
+		elfp_err_warn("elfp_main_read_headers", "pread() failed");
+		return -1;
+	}
+
+	if(class == ELFCLASS32)
+	{
+		e32hdr = (Elf32_Ehdr *)&e64hdr;
+		phoff = e32hdr->e_phoff;
+		phsize = (unsigned long int)e32hdr->e_phnum * e32hdr->e_phentsize;
+	}
+	else
+	{
+		phoff = e64hdr.e_phoff;
+		phsize = (unsigned long int)e64hdr.e_phnum * e64hdr.e_phentsize;
+	}
+
+	/* The PHT is almost always right after the ELF header. If it is
+	 * somewhere far, only the header is kept and the PHT is mapped
+	 * on demand */
+	bufsize = ehsize;
+	if(phoff >= ehsize && phoff <= ELFP_HEADERS_BUF_MAX &&
+		phsize <= ELFP_HEADERS_BUF_MAX - phoff &&
+		phoff + phsize <= main->file_size)
+	{
+		bufsize = phoff + phsize;
+	}
+
+	main->hdr_buf = malloc(bufsize);
+	if(main->hdr_buf == NULL)
+	{
+		elfp_err_warn("elfp_main_read_headers", "malloc() failed");
+		return -1;
+	}
+	memcpy(main->hdr_buf, &e64hdr, ehsize);
+
+	if(bufsize > ehsize)
+	{
+		ret = pread(main->fd, main->hdr_buf + ehsize, bufsize - ehsize, ehsize);
+		if(ret < 0 || (unsigned long int)ret != bufsize - ehsize)
+		{
+			if(ret >= 0)
+				errno = EIO;
+			elfp_err_warn("elfp_main_read_headers", "pread() failed");
+			free(main->hdr_buf);
+			main->hdr_buf = NULL;
+			return -1;
+		}
+	}
+
+	main->hdr_size = bufsize;
+	main->start_addr = main->hdr_buf;
+
+	return 0;
+}
+
+/*
+ * The cache of shared objects. Refer ELFP_OPEN_SHARED.
+ *
+ * 	* A hash table of elfp_main objects, chained through cache_next.
+ * 	* refs of a cached object is changed only with the lock held. That
+ * 	way, a lookup can't pick up an object whose last reference is just
+ * 	being dropped.
+ */
+static elfp_main *elfp_main_cache[ELFP_MAIN_CACHE_BUCKETS];
+static pthread_mutex_t elfp_main_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+elfp_main_cache_key_init(elfp_main_cache_key *key, struct stat *st,
+					unsigned int flags)
+{
+	memset(key, '\0', sizeof(elfp_main_cache_key));
+	key->dev = st->st_dev;
+	key->ino = st->st_ino;
+	key->size = st->st_size;
+	key->mtime_sec = st->st_mtim.tv_sec;
+	key->mtime_nsec = st->st_mtim.tv_nsec;
+
+	/* A header-only / windowed object is not handed out to someone
+	 * who wanted the whole file mapped, and vice versa */
+	key->flags = flags & (ELFP_OPEN_HEADERS_ONLY | ELFP_OPEN_WINDOWED);
+}
+
+static unsigned long int
+elfp_main_cache_bucket(elfp_main_cache_key *key)
+{
+	unsigned long int hash;
+
+	hash = key->ino * 0x9e3779b97f4a7c15UL;
+	hash = hash ^ (key->dev + (hash << 6) + (hash >> 2));
+
+	return hash % ELFP_MAIN_CACHE_BUCKETS;
+}
+
+/* Called with the lock held */
+static elfp_main*
+elfp_main_cache_find(elfp_main_cache_key *key)
+{
+	elfp_main *main = NULL;
+
+	for(main = elfp_main_cache[elfp_main_cache_bucket(key)]; main != NULL;
+						main = main->cache_next)
+	{
+		if(memcmp(&main->cache_key, key, sizeof(elfp_main_cache_key)) == 0)
+			return main;
+	}
+
+	return NULL;
+}
+
+/*
+ * elfp_main_cache_get: Looks up the cache and takes a reference
+ * 	on what it finds.
+ */
+static elfp_main*
+elfp_main_cache_get(elfp_main_cache_key *key)
+{
+	elfp_main *main = NULL;
+
+	pthread_mutex_lock(&elfp_main_cache_lock);
+	main = elfp_main_cache_find(key);
+	if(main != NULL)
+		main->refs = main->refs + 1;
+	pthread_mutex_unlock(&elfp_main_cache_lock);
+
+	return main;
+}
+
+/*
+ * elfp_main_cache_add: Adds a newly created object to the cache.
+ *
+ * @return: The object which should be used. If the same file got cached
+ * 	in the meantime, that one. The new object is cleaned up then.
+ */
+static elfp_main*
+elfp_main_cache_add(elfp_main *main)
+{
+	elfp_main *cached = NULL;
+	unsigned long int bucket;
+
+	pthread_mutex_lock(&elfp_main_cache_lock);
+
+	cached = elfp_main_cache_find(&main->cache_key);
+	if(cached != NULL)
+	{
+		cached->refs = cached->refs + 1;
+		pthread_mutex_unlock(&elfp_main_cache_lock);
+
+		/* Lost the race */
+		elfp_main_fini(main);
+		return cached;
+	}
+
+	bucket = elfp_main_cache_bucket(&main->cache_key);
+	main->cache_next = elfp_main_cache[bucket];
+	elfp_main_cache[bucket] = main;
+	main->cached = 1;
+
+	pthread_mutex_unlock(&elfp_main_cache_lock);
+
+	return main;
+}
+
+/*
+ * elfp_main_advise: Tells the kernel how a freshly opened file is going
+ * 	to be used.
+ * 	* Parsers jump from header to header. Reading around every fault
+ * 	mostly brings in pages nobody asks for.
+ * 	* The PHT and the Section Header Table are asked for by almost
+ * 	everything. Start reading them before anyone does.
+ */
+static void
+elfp_main_advise(elfp_main *main)
+{
+	Elf64_Ehdr ehdr64;
+	Elf32_Ehdr ehdr32;
+	unsigned long int phoff, phsize, shoff, shsize;
+
+	if(main->class == ELFCLASS32)
+	{
+		if(elfp_main_read(main, 0, sizeof(Elf32_Ehdr), &ehdr32) == -1)
+			return;
+		phoff = ehdr32.e_phoff;
+		phsize = (unsigned long int)ehdr32.e_phnum * ehdr32.e_phentsize;
+		shoff = ehdr32.e_shoff;
+		shsize = (unsigned long int)ehdr32.e_shnum * ehdr32.e_shentsize;
 	}
+	else
+	{
+		if(elfp_main_read(main, 0, sizeof(Elf64_Ehdr), &ehdr64) == -1)
+			return;
+		phoff = ehdr64.e_phoff;
+		phsize = (unsigned long int)ehdr64.e_phnum * ehdr64.e_phentsize;
+		shoff = ehdr64.e_shoff;
+		shsize = (unsigned long int)ehdr64.e_shnum * ehdr64.e_shentsize;
+	}
+
+	if(main->hdr_buf == NULL)
+		madvise(main->start_addr, main->file_size, MADV_RANDOM);
+
+	elfp_main_prefetch(main, phoff, phsize);
+	elfp_main_prefetch(main, shoff, shsize);
+}
 
+/*
+ * elfp_main_create_common: Everything needed to create an elfp_main
+ * 	object, once the file is open.
+ *
+ * 	* On failure, fd is left open. It is the caller's.
+ */
+static elfp_main*
+elfp_main_create_common(int fd, const char *file_path, unsigned int flags)
+{
 	int ret;
 	elfp_main *main = NULL;
+	elfp_main *cached = NULL;
 	struct stat st;
 	unsigned char magic[4] = {'\0', '\0', '\0', '\0'};
 	void *start_addr = NULL;
+	char fd_path[32];
+	int map_flags = 0;
 
 	/* Allocate memory */
 	main = calloc(1, sizeof(elfp_main));
@@ -70,41 +311,30 @@ elfp_main_create(const char *file_path)
 	/*
 	 * 1. File descriptor 
 	 */
-	
-	/* Check if we can read the file or not */
-	ret = access(file_path, R_OK);
-	if(ret == -1)
-	{
-		elfp_err_warn("elfp_main_create", "access() failed");
-		elfp_err_warn("elfp_main_create", "File doesn't exist / No read permissions");
-		goto return_free;
-	}
-
-	/* Open the file */
-	ret = open(file_path, O_RDONLY);
-	if(ret == -1)
-	{
-		elfp_err_warn("elfp_main_create", "open() failed");
-		goto return_free;
-	}
-	/* Update the file descriptor */
-	main->fd = ret;
+	main->fd = fd;
 
 	/*
 	 * 2. Check if the file is ELF or not.
+	 *
+	 * pread() doesn't move the file offset. It matters when the
+	 * descriptor came from the caller.
 	 */
-	ret = read(main->fd, magic, 4);
+	ret = pread(main->fd, magic, 4, 0);
 	if(ret != 4)
 	{
-		elfp_err_warn("elfp_main_create", "read() failed");
-		goto return_close;
+		/* A short read means the file is too small to be an ELF */
+		if(ret >= 0)
+			errno = ENOEXEC;
+		elfp_err_warn("elfp_main_create", "pread() failed");
+		goto return_free;
 	}
 
-	if(strcmp(magic, ELFMAG) != 0)
+	if(memcmp(magic, ELFMAG, SELFMAG) != 0)
 	{
+		errno = ENOEXEC;
 		elfp_err_warn("elfp_main_create", 
 		"Not an ELF file according to the magic characters");
-		goto return_close;
+		goto return_free;
 	}
 	
 	/* Now that we know that it IS an ELF file, let us continue
@@ -117,45 +347,107 @@ elfp_main_create(const char *file_path)
 	if(ret == -1)
 	{
 		elfp_err_warn("elfp_main_create", "fstat() failed");
-		goto return_close;
+		goto return_free;
 	}
 	/* Update size */
 	main->file_size = st.st_size;
 
 	/*
-	 * 4. Update path
+	 * 3a. Shared opens: If this very file is open already, use that
+	 * object. Our descriptor is not needed then.
 	 */
-	strncpy(main->path, file_path, ELFP_FILEPATH_SIZE);
+	if(flags & ELFP_OPEN_SHARED)
+	{
+		elfp_main_cache_key_init(&main->cache_key, &st, flags);
+		cached = elfp_main_cache_get(&main->cache_key);
+		if(cached != NULL)
+		{
+			close(fd);
+			free(main);
+			return cached;
+		}
+	}
 
 	/*
-	 * 5. Update start address
+	 * 4. Update path
+	 *
+	 * Files opened from a descriptor don't have one.
 	 */
-	start_addr = mmap(NULL, main->file_size, PROT_READ, MAP_PRIVATE,
-					main->fd, 0);
-	if(start_addr == MAP_FAILED)
+	if(file_path == NULL)
 	{
-		elfp_err_warn("elfp_main_create", "mmap() failed");
-		goto return_close;
+		snprintf(fd_path, sizeof(fd_path), "[fd %d]", fd);
+		file_path = fd_path;
 	}
-	main->start_addr = (unsigned char *)start_addr;
 
-	/* 
-	 * 6. Initialize the free list *
+	main->path = strdup(file_path);
+	if(main->path == NULL)
+	{
+		elfp_err_warn("elfp_main_create", "strdup() failed");
+		goto return_free;
+	}
+
+	/*
+	 * 5. Update start address
 	 */
-	ret = elfp_ds_vector_init(&main->free_vec);
-	if(ret != 0)
+	main->flags = flags;
+	if(flags & (ELFP_OPEN_HEADERS_ONLY | ELFP_OPEN_WINDOWED))
+	{
+		/* Only the headers are read now. Everything else
+		 * is mapped when someone asks for it */
+		ret = elfp_main_read_headers(main);
+		if(ret == -1)
+		{
+			elfp_err_warn("elfp_main_create",
+					"elfp_main_read_headers() failed");
+			goto return_free;
+		}
+	}
+	else
 	{
-		elfp_err_warn("elfp_main_create",
-				"elfp_ds_vector_init() failed");
+		/* Read in one go instead of a fault at a time */
+		map_flags = MAP_PRIVATE;
+		if(flags & ELFP_OPEN_POPULATE)
+			map_flags = map_flags | MAP_POPULATE;
 
-		goto return_munmap;
+		start_addr = mmap(NULL, main->file_size, PROT_READ, map_flags,
+						main->fd, 0);
+		if(start_addr == MAP_FAILED)
+		{
+			elfp_err_warn("elfp_main_create", "mmap() failed");
+			goto return_free;
+		}
+		main->start_addr = (unsigned char *)start_addr;
 	}
 
+	/* 
+	 * 6. Initialize the arena. Nothing is allocated till
+	 * a parser needs memory.
+	 */
+	elfp_ds_arena_init(&main->arena);
+
 	/*
 	 * class: Is it a 32-bit / 64-bit object.
 	 */
 	main->class = main->start_addr[EI_CLASS];
 
+	/* Not part of main_vec yet */
+	main->handle = -1;
+
+	pthread_mutex_init(&main->lock, NULL);
+	pthread_mutex_init(&main->index_lock, NULL);
+
+	/* Nothing to advise if it is all in memory already */
+	if(!(flags & ELFP_OPEN_NO_HINTS) && !(map_flags & MAP_POPULATE))
+		elfp_main_advise(main);
+
+	/* Only the creator holds it for now */
+	main->refs = 1;
+
+	/* Publish it for later shared opens. If someone else mapped the
+	 * same file in the meantime, theirs is used and ours goes */
+	if(flags & ELFP_OPEN_SHARED)
+		main = elfp_main_cache_add(main);
+
 	/* At this point, all members except 'handle' are populated.
 	 *
 	 * 'handle' is a member which a create() function cannot decide.
@@ -166,17 +458,195 @@ elfp_main_create(const char *file_path)
 	return main;
 		
 
-return_munmap:
-	munmap(main->start_addr, main->file_size);
-
-return_close:
-	close(main->fd);
-
 return_free:
+	/* free() never touches errno, the reason of failure is intact */
+	free(main->path);
 	free(main);
 	return NULL;
 }
 
+elfp_main*
+elfp_main_create(const char *file_path, unsigned int flags)
+{
+	return elfp_main_create_at(AT_FDCWD, file_path, flags);
+}
+
+elfp_main*
+elfp_main_create_at(int dirfd, const char *file_path, unsigned int flags)
+{
+	/* Basic check */
+	if(file_path == NULL)
+	{
+		elfp_err_warn("elfp_main_create_at", "NULL argument passed");
+		return NULL;
+	}
+
+	int fd;
+	int saved_errno;
+	elfp_main *main = NULL;
+
+	/* Open the file. Permissions are checked by openat() itself,
+	 * there is no need to look the path up once more with access() */
+	fd = openat(dirfd, file_path, O_RDONLY | O_CLOEXEC);
+	if(fd == -1)
+	{
+		elfp_err_warn("elfp_main_create_at", "openat() failed");
+		elfp_err_warn("elfp_main_create_at", "File doesn't exist / No read permissions");
+		return NULL;
+	}
+
+	main = elfp_main_create_common(fd, file_path, flags);
+	if(main == NULL)
+	{
+		/* Don't let close() overwrite the reason of failure */
+		saved_errno = errno;
+		close(fd);
+		errno = saved_errno;
+		return NULL;
+	}
+
+	return main;
+}
+
+elfp_main*
+elfp_main_create_fd(int fd, unsigned int flags)
+{
+	/* Basic check */
+	if(fd < 0)
+	{
+		elfp_err_warn("elfp_main_create_fd", "Invalid file descriptor passed");
+		errno = EBADF;
+		return NULL;
+	}
+
+	return elfp_main_create_common(fd, NULL, flags);
+}
+
+elfp_main*
+elfp_main_create_mem(const void *buf, unsigned long int size, unsigned int flags)
+{
+	/* Basic check */
+	if(buf == NULL)
+	{
+		elfp_err_warn("elfp_main_create_mem", "NULL argument passed");
+		return NULL;
+	}
+
+	elfp_main *main = NULL;
+	const unsigned char *ident = buf;
+	unsigned long int ehsize;
+
+	/*
+	 * 1. Check if the buffer is ELF or not.
+	 */
+	if(size < EI_NIDENT || memcmp(buf, ELFMAG, SELFMAG) != 0)
+	{
+		errno = ENOEXEC;
+		elfp_err_warn("elfp_main_create_mem",
+		"Not an ELF image according to the magic characters");
+		return NULL;
+	}
+
+	/* There is no file behind to read beyond it. The ELF header
+	 * at least has to be there */
+	ehsize = (ident[EI_CLASS] == ELFCLASS32) ? sizeof(Elf32_Ehdr) :
+							sizeof(Elf64_Ehdr);
+	if(size < ehsize)
+	{
+		errno = ENOEXEC;
+		elfp_err_warn("elfp_main_create_mem", "Image is smaller than the ELF header");
+		return NULL;
+	}
+
+	/* Allocate memory */
+	main = calloc(1, sizeof(elfp_main));
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_main_create_mem", "calloc() failed");
+		return NULL;
+	}
+
+	/*
+	 * 2. There is no file behind it. The buffer is used as-is,
+	 * as if it was the mapping of the whole file.
+	 *
+	 * ELFP_OPEN_HEADERS_ONLY and ELFP_OPEN_WINDOWED are meaningless
+	 * here. Nothing is mapped.
+	 */
+	main->fd = -1;
+	main->file_size = size;
+	main->start_addr = (unsigned char *)buf;
+	main->flags = (flags & ~(ELFP_OPEN_HEADERS_ONLY | ELFP_OPEN_WINDOWED)) |
+							ELFP_MAIN_CALLER_BUF;
+	main->path = strdup("[memory]");
+	if(main->path == NULL)
+	{
+		elfp_err_warn("elfp_main_create_mem", "strdup() failed");
+		free(main);
+		return NULL;
+	}
+
+	/*
+	 * 3. Initialize the arena
+	 */
+	elfp_ds_arena_init(&main->arena);
+
+	/*
+	 * 4. class and handle
+	 */
+	main->class = main->start_addr[EI_CLASS];
+	main->handle = -1;
+
+	pthread_mutex_init(&main->lock, NULL);
+	pthread_mutex_init(&main->index_lock, NULL);
+
+	main->refs = 1;
+
+	return main;
+}
+
+void
+elfp_main_release(elfp_main *main)
+{
+	/* Basic check */
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_main_release", "NULL argument passed");
+		return;
+	}
+
+	elfp_main **prev = NULL;
+	unsigned long int refs;
+
+	/* Not shared, nobody else can have it */
+	if(main->cached == 0)
+	{
+		refs = __atomic_sub_fetch(&main->refs, 1, __ATOMIC_ACQ_REL);
+		if(refs == 0)
+			elfp_main_fini(main);
+		return;
+	}
+
+	pthread_mutex_lock(&elfp_main_cache_lock);
+
+	main->refs = main->refs - 1;
+	refs = main->refs;
+
+	/* The last one out takes it out of the cache */
+	if(refs == 0)
+	{
+		prev = &elfp_main_cache[elfp_main_cache_bucket(&main->cache_key)];
+		while(*prev != main)
+			prev = &(*prev)->cache_next;
+		*prev = main->cache_next;
+	}
+
+	pthread_mutex_unlock(&elfp_main_cache_lock);
+
+	if(refs == 0)
+		elfp_main_fini(main);
+}
+
 int
 elfp_main_update_handle(elfp_main *main, int handle)
 {
@@ -201,23 +671,47 @@ elfp_main_fini(elfp_main *main)
 		return -1;
 	}
 	
-	int handle = main->handle;
+	elfp_main_map *map = NULL;
+
+	/* unmap the file. Caller owned buffers are left alone */
+	if(main->hdr_buf != NULL)
+		free(main->hdr_buf);
+	else if((main->flags & ELFP_MAIN_CALLER_BUF) == 0)
+		munmap(main->start_addr, main->file_size);
+
+	/* And all the ranges mapped on demand */
+	while(main->maps != NULL)
+	{
+		map = main->maps;
+		main->maps = map->next;
+		munmap(map->addr, map->size);
+		free(map);
+	}
 
-	/* unmap the file */
-	munmap(main->start_addr, main->file_size);
+	while(main->windows != NULL)
+	{
+		map = main->windows;
+		main->windows = map->next;
+		munmap(map->addr, map->size);
+		free(map);
+	}
 
 	/* Close the file */
-	close(main->fd);
+	if(main->fd != -1)
+		close(main->fd);
+
+	/* Everything the parsers allocated goes in one shot */
+	elfp_ds_arena_fini(&main->arena);
+
+	free(main->path);
 
-	/* De-init the free vector */
-	elfp_ds_vector_fini(&main->free_vec); 
+	pthread_mutex_destroy(&main->lock);
+	pthread_mutex_destroy(&main->index_lock);
 
 	/* Now that we have cleaned up everything inside the object,
 	 * it is time to clean the object itself */
 	free(main);
 	
-	/* Inform main_vec about it */
-	elfp_main_vec_inform(handle);
 
 	/* All the above functions can present a runtime error.
 	 * But they are ignored because nothing can be done to
@@ -279,17 +773,367 @@ elfp_main_get_handle(elfp_main *main)
 	return main->handle;
 }
 
-elfp_ds_vector*
-elfp_main_get_freevec(elfp_main *main)
+/*
+ * elfp_main_maps_trim: Unmaps ranges nobody holds, least recently used
+ * 	first, till size more bytes fit in ELFP_MAIN_MAPS_MAX.
+ *
+ * 	* Called with main->lock held.
+ *
+ * @return: 0 if they fit, -1 otherwise.
+ */
+static int
+elfp_main_maps_trim(elfp_main *main, unsigned long int size)
+{
+	elfp_main_map **prev = NULL;
+	elfp_main_map **victim = NULL;
+	elfp_main_map *map = NULL;
+
+	if(size > ELFP_MAIN_MAPS_MAX)
+		return -1;
+
+	while(main->maps_size > ELFP_MAIN_MAPS_MAX - size)
+	{
+		/* The last one nobody holds */
+		victim = NULL;
+		for(prev = &main->maps; *prev != NULL; prev = &(*prev)->next)
+		{
+			if((*prev)->refs == 0)
+				victim = prev;
+		}
+
+		if(victim == NULL)
+			return -1;
+
+		map = *victim;
+		*victim = map->next;
+		main->maps_size = main->maps_size - map->size;
+		munmap(map->addr, map->size);
+		free(map);
+	}
+
+	return 0;
+}
+
+void*
+elfp_main_get_range(elfp_main *main, unsigned long int offset,
+				unsigned long int size)
+{
+	/* Basic check */
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_main_get_range", "NULL argument passed");
+		return NULL;
+	}
+
+	elfp_main_map *map = NULL;
+	elfp_main_map **prev = NULL;
+	unsigned long int page_size, map_offset, map_size;
+	void *addr = NULL;
+
+	/* The range should be inside the file */
+	if(offset > main->file_size || size > main->file_size - offset)
+	{
+		elfp_err_warn("elfp_main_get_range", "Range is outside the file");
+		return NULL;
+	}
+
+	/* Whole file is mapped */
+	if(main->hdr_buf == NULL)
+		return main->start_addr + offset;
+
+	/* Covered by the headers we read */
+	if(offset + size <= main->hdr_size)
+		return main->hdr_buf + offset;
+
+	/* Already mapped on demand? Hold it and move it to the front */
+	pthread_mutex_lock(&main->lock);
+	for(prev = &main->maps; *prev != NULL; prev = &(*prev)->next)
+	{
+		map = *prev;
+		if(offset >= map->offset &&
+			offset + size <= map->offset + map->size)
+		{
+			*prev = map->next;
+			map->next = main->maps;
+			main->maps = map;
+			map->refs = map->refs + 1;
+			pthread_mutex_unlock(&main->lock);
+			return map->addr + (offset - map->offset);
+		}
+	}
+
+	/* Map it now. mmap() wants a page aligned offset */
+	page_size = sysconf(_SC_PAGESIZE);
+	map_offset = offset & ~(page_size - 1);
+	map_size = offset + size - map_offset;
+	if(map_size == 0)
+		map_size = 1;
+
+	/* Windowed files are too big to map all that is asked for */
+	if((main->flags & ELFP_OPEN_WINDOWED) &&
+		elfp_main_maps_trim(main, map_size) == -1)
+	{
+		errno = ENOMEM;
+		elfp_err_warn("elfp_main_get_range", "Too much of the file is mapped");
+		pthread_mutex_unlock(&main->lock);
+		return NULL;
+	}
+
+	map = calloc(1, sizeof(elfp_main_map));
+	if(map == NULL)
+	{
+		elfp_err_warn("elfp_main_get_range", "calloc() failed");
+		pthread_mutex_unlock(&main->lock);
+		return NULL;
+	}
+
+	addr = mmap(NULL, map_size, PROT_READ, MAP_PRIVATE, main->fd, map_offset);
+	if(addr == MAP_FAILED)
+	{
+		elfp_err_warn("elfp_main_get_range", "mmap() failed");
+		free(map);
+		pthread_mutex_unlock(&main->lock);
+		return NULL;
+	}
+
+	map->offset = map_offset;
+	map->size = map_size;
+	map->addr = addr;
+	map->refs = 1;
+	map->next = main->maps;
+	main->maps = map;
+	main->maps_size = main->maps_size + map_size;
+
+	pthread_mutex_unlock(&main->lock);
+
+	return map->addr + (offset - map->offset);
+}
+
+void
+elfp_main_put_range(elfp_main *main, const void *addr)
+{
+	/* Basic check */
+	if(main == NULL || addr == NULL)
+	{
+		elfp_err_warn("elfp_main_put_range", "Invalid argument(s) passed");
+		return;
+	}
+
+	const unsigned char *c = addr;
+	elfp_main_map *map = NULL;
+
+	/* Nothing was mapped for it */
+	if(main->hdr_buf == NULL ||
+		(c >= main->hdr_buf && c < main->hdr_buf + main->hdr_size))
+		return;
+
+	/* It stays mapped till room is needed */
+	pthread_mutex_lock(&main->lock);
+	for(map = main->maps; map != NULL; map = map->next)
+	{
+		if(c >= map->addr && c < map->addr + map->size)
+		{
+			if(map->refs > 0)
+				map->refs = map->refs - 1;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&main->lock);
+}
+
+/*
+ * elfp_main_window_get: Gets the window a file offset falls in, mapping
+ * 	it if needed. The least recently used window makes way for it if
+ * 	there are too many.
+ *
+ * 	* Called with main->lock held.
+ *
+ * @return: NULL on failure, the window on success.
+ */
+static elfp_main_map*
+elfp_main_window_get(elfp_main *main, unsigned long int offset)
+{
+	elfp_main_map *window = NULL;
+	elfp_main_map **prev = NULL;
+	unsigned long int window_offset;
+	void *addr = NULL;
+
+	window_offset = offset & ~((unsigned long int)ELFP_MAIN_WINDOW_SIZE - 1);
+
+	/* Mapped already? Move it to the front */
+	for(prev = &main->windows; *prev != NULL; prev = &(*prev)->next)
+	{
+		window = *prev;
+		if(window->offset == window_offset)
+		{
+			*prev = window->next;
+			window->next = main->windows;
+			main->windows = window;
+			return window;
+		}
+	}
+
+	/* Reuse the least recently used one - the last */
+	window = NULL;
+	if(main->n_windows == ELFP_MAIN_WINDOWS_MAX)
+	{
+		prev = &main->windows;
+		while((*prev)->next != NULL)
+			prev = &(*prev)->next;
+		window = *prev;
+		*prev = NULL;
+		munmap(window->addr, window->size);
+		main->n_windows = main->n_windows - 1;
+	}
+	else
+	{
+		window = calloc(1, sizeof(elfp_main_map));
+		if(window == NULL)
+		{
+			elfp_err_warn("elfp_main_window_get", "calloc() failed");
+			return NULL;
+		}
+	}
+
+	window->offset = window_offset;
+	window->size = main->file_size - window_offset;
+	if(window->size > ELFP_MAIN_WINDOW_SIZE)
+		window->size = ELFP_MAIN_WINDOW_SIZE;
+
+	addr = mmap(NULL, window->size, PROT_READ, MAP_PRIVATE, main->fd,
+							window_offset);
+	if(addr == MAP_FAILED)
+	{
+		elfp_err_warn("elfp_main_window_get", "mmap() failed");
+		free(window);
+		return NULL;
+	}
+
+	window->addr = addr;
+	window->next = main->windows;
+	main->windows = window;
+	main->n_windows = main->n_windows + 1;
+
+	return window;
+}
+
+int
+elfp_main_read(elfp_main *main, unsigned long int offset,
+			unsigned long int size, void *buf)
+{
+	/* Basic check */
+	if(main == NULL || (buf == NULL && size != 0))
+	{
+		elfp_err_warn("elfp_main_read", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main_map *window = NULL;
+	unsigned char *out = buf;
+	unsigned long int n;
+
+	/* The range should be inside the file */
+	if(offset > main->file_size || size > main->file_size - offset)
+	{
+		elfp_err_warn("elfp_main_read", "Range is outside the file");
+		return -1;
+	}
+
+	/* Whole file is mapped */
+	if(main->hdr_buf == NULL)
+	{
+		memcpy(out, main->start_addr + offset, size);
+		return 0;
+	}
+
+	/* Covered by the headers we read */
+	if(offset + size <= main->hdr_size)
+	{
+		memcpy(out, main->hdr_buf + offset, size);
+		return 0;
+	}
+
+	/* Window by window */
+	pthread_mutex_lock(&main->lock);
+	while(size > 0)
+	{
+		window = elfp_main_window_get(main, offset);
+		if(window == NULL)
+		{
+			elfp_err_warn("elfp_main_read",
+					"elfp_main_window_get() failed");
+			pthread_mutex_unlock(&main->lock);
+			return -1;
+		}
+
+		n = window->offset + window->size - offset;
+		if(n > size)
+			n = size;
+
+		memcpy(out, window->addr + (offset - window->offset), n);
+		out = out + n;
+		offset = offset + n;
+		size = size - n;
+	}
+	pthread_mutex_unlock(&main->lock);
+
+	return 0;
+}
+
+void
+elfp_main_prefetch(elfp_main *main, unsigned long int offset,
+				unsigned long int size)
+{
+	/* Basic check */
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_main_prefetch", "NULL argument passed");
+		return;
+	}
+
+	unsigned long int page_size, map_offset;
+
+	/* Caller's buffer is already in memory */
+	if(main->flags & (ELFP_OPEN_NO_HINTS | ELFP_MAIN_CALLER_BUF))
+		return;
+
+	if(offset >= main->file_size || size == 0)
+		return;
+	if(size > main->file_size - offset)
+		size = main->file_size - offset;
+
+	/* Whole file is mapped: madvise() wants a page aligned address */
+	if(main->hdr_buf == NULL)
+	{
+		page_size = sysconf(_SC_PAGESIZE);
+		map_offset = offset & ~(page_size - 1);
+		madvise(main->start_addr + map_offset, offset + size - map_offset,
+							MADV_WILLNEED);
+		return;
+	}
+
+	/* Ranges are mapped on demand. Get them into the page cache
+	 * so that the mapping doesn't have to wait */
+	posix_fadvise(main->fd, offset, size, POSIX_FADV_WILLNEED);
+}
+
+void*
+elfp_main_alloc(elfp_main *main, unsigned long int size)
 {
 	/* Basic check */
 	if(main == NULL)
 	{
-		elfp_err_warn("elfp_main_get_freevec", "NULL argument passed");
+		elfp_err_warn("elfp_main_alloc", "NULL argument passed");
 		return NULL;
 	}
 
-	return &main->free_vec;
+	void *addr = NULL;
+
+	pthread_mutex_lock(&main->lock);
+	addr = elfp_ds_arena_alloc(&main->arena, size);
+	pthread_mutex_unlock(&main->lock);
+
+	return addr;
 }
 
 unsigned long int
@@ -311,30 +1155,162 @@ elfp_main_get_class(elfp_main *main)
  * Refer elfp_int.h for declarations and description.
  */
 
-elfp_main_vector main_vec;
+elfp_main_vector main_vec = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+/*
+ * elfp_main_vec_slot_at: Gets the slot at an index.
+ *
+ * @return: NULL if the chunk holding it is not allocated yet.
+ */
+static elfp_main_slot*
+elfp_main_vec_slot_at(unsigned long int index)
+{
+	elfp_main_slot *chunk = NULL;
+
+	if(index >= ELFP_MAIN_VECTOR_MAX_SIZE)
+		return NULL;
+
+	/* Pairs with the release in elfp_main_vec_add() */
+	chunk = __atomic_load_n(&main_vec.chunks[index / ELFP_MAIN_VECTOR_CHUNK_SIZE],
+					__ATOMIC_ACQUIRE);
+	if(chunk == NULL)
+		return NULL;
+
+	return &chunk[index % ELFP_MAIN_VECTOR_CHUNK_SIZE];
+}
+
+/*
+ * elfp_main_vec_reclaim: Called when the last reference of a closed
+ * 	handle is dropped. Frees the object and the slot.
+ */
+static void
+elfp_main_vec_reclaim(unsigned long int index)
+{
+	elfp_main_slot *slot = NULL;
+	elfp_main *main = NULL;
+	unsigned long int gen;
+
+	slot = elfp_main_vec_slot_at(index);
+	main = slot->main;
+	gen = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) >> ELFP_SLOT_GEN_SHIFT;
+
+	pthread_mutex_lock(&main_vec.lock);
+
+	/* Remove it from the list of open handles */
+	if(slot->prev != -1)
+		elfp_main_vec_slot_at(slot->prev)->next = slot->next;
+	else
+		main_vec.live_head = slot->next;
+
+	if(slot->next != -1)
+		elfp_main_vec_slot_at(slot->next)->prev = slot->prev;
+	main_vec.live = main_vec.live - 1;
+
+	/* The slot can be reused now - unless no handle can carry its
+	 * generation anymore. Then it is retired */
+	slot->main = NULL;
+	slot->prev = -1;
+	slot->next = -1;
+	if(gen <= ELFP_HANDLE_GEN_MASK)
+	{
+		slot->next = main_vec.free_head;
+		main_vec.free_head = index;
+	}
+
+	pthread_mutex_unlock(&main_vec.lock);
+
+	/* Nobody can reach the object through this handle anymore.
+	 * Other handles may still share it */
+	elfp_main_release(main);
+}
 
 int
 elfp_main_vec_init()
 {
-	
-	/* Update initial size */
-	main_vec.total = ELFP_MAIN_VECTOR_INIT_SIZE;
+	/* Everything is allocated on demand. Just make sure
+	 * we start with an empty table */
+	pthread_mutex_lock(&main_vec.lock);
 
-	/* Allocate memory */
-	main_vec.vec = calloc(main_vec.total, sizeof(elfp_main *));
-	if(main_vec.vec == NULL)
+	if(main_vec.used == 0)
 	{
-		elfp_err_warn("elfp_main_vec_init", "calloc() failed");
-		elfp_err_warn("elfp_main_vec_init", "Fatal Error. Library cannot be used");
-		return -1;
+		main_vec.free_head = -1;
+		main_vec.live_head = -1;
+		main_vec.live = 0;
 	}
-	
-	/* Initially, there is nothing */
-	main_vec.latest = 0;
+
+	pthread_mutex_unlock(&main_vec.lock);
 
 	return 0;
 }
 
+/*
+ * elfp_main_vec_add_locked: Adds an elfp_main reference to main_vec.
+ * 	Called with main_vec's lock held.
+ *
+ * @return: handle on success, -1 on failure.
+ */
+static int
+elfp_main_vec_add_locked(elfp_main *main)
+{
+	elfp_main_slot *chunk = NULL;
+	elfp_main_slot *slot = NULL;
+	unsigned long int gen;
+	long int index;
+
+	/* 1. Reuse a free slot if there is one */
+	if(main_vec.free_head != -1)
+	{
+		index = main_vec.free_head;
+		main_vec.free_head = elfp_main_vec_slot_at(index)->next;
+	}
+	else
+	{
+		/* 2. Else, take a fresh one. Allocate a chunk if needed */
+		if(main_vec.used == ELFP_MAIN_VECTOR_MAX_SIZE)
+		{
+			elfp_err_warn("elfp_main_vec_add", "Too many open handles");
+			return -1;
+		}
+
+		index = main_vec.used;
+		if(index % ELFP_MAIN_VECTOR_CHUNK_SIZE == 0)
+		{
+			chunk = calloc(ELFP_MAIN_VECTOR_CHUNK_SIZE,
+						sizeof(elfp_main_slot));
+			if(chunk == NULL)
+			{
+				elfp_err_warn("elfp_main_vec_add", "calloc() failed");
+				return -1;
+			}
+
+			/* Lookups read it without the lock */
+			__atomic_store_n(&main_vec.chunks[index / ELFP_MAIN_VECTOR_CHUNK_SIZE],
+						chunk, __ATOMIC_RELEASE);
+		}
+
+		main_vec.used = main_vec.used + 1;
+	}
+
+	/* Add it and put it at the head of open handles */
+	slot = elfp_main_vec_slot_at(index);
+	slot->main = main;
+	slot->prev = -1;
+	slot->next = main_vec.live_head;
+	if(main_vec.live_head != -1)
+		elfp_main_vec_slot_at(main_vec.live_head)->prev = index;
+	main_vec.live_head = index;
+	main_vec.live = main_vec.live + 1;
+
+	/* Publish it: the handle's own reference. The object is visible
+	 * to lookups only after this */
+	gen = __atomic_load_n(&slot->state, __ATOMIC_RELAXED) >> ELFP_SLOT_GEN_SHIFT;
+	__atomic_store_n(&slot->state, (gen << ELFP_SLOT_GEN_SHIFT) | 1,
+						__ATOMIC_RELEASE);
+
+	/* All good, we got the handle */
+	return (int)((gen << ELFP_HANDLE_INDEX_BITS) | index);
+}
+
 int
 elfp_main_vec_add(elfp_main *main)
 {
@@ -345,83 +1321,175 @@ elfp_main_vec_add(elfp_main *main)
 		return -1;
 	}
 
-	void *new_addr = NULL;
 	int handle;
 
-	/* Check if the vector is full */
-	if(main_vec.latest == main_vec.total)
-	{
-		/* Allocate more memory */
-		new_addr = realloc(main_vec.vec, 
-			(main_vec.total + ELFP_MAIN_VECTOR_INIT_SIZE) * sizeof(elfp_main *));
+	pthread_mutex_lock(&main_vec.lock);
+	handle = elfp_main_vec_add_locked(main);
+	pthread_mutex_unlock(&main_vec.lock);
 
-		if(new_addr == NULL)
-		{
-			elfp_err_warn("elfp_main_vec_add", "realloc() failed");
-			return -1;
-		}
+	return handle;
+}
 
-		/* Zeroize the new memory */
-		memset(((char *)new_addr) + main_vec.total * sizeof(elfp_main *), '\0',
-				ELFP_MAIN_VECTOR_INIT_SIZE * sizeof(elfp_main *));
-		
-		/* All set, change the members */
-		main_vec.total = main_vec.total + ELFP_MAIN_VECTOR_INIT_SIZE;
-		main_vec.vec = new_addr;
+unsigned long int
+elfp_main_vec_add_many(elfp_main **mains, unsigned long int n, int *handles)
+{
+	/* Basic check */
+	if(mains == NULL || handles == NULL)
+	{
+		elfp_err_warn("elfp_main_vec_add_many", "NULL argument passed");
+		return 0;
 	}
 
-	/* Add it */
-	main_vec.vec[main_vec.latest] = main;
-	handle = main_vec.latest;
+	unsigned long int i, added = 0;
 
-	/* Then update it */
-	main_vec.latest = main_vec.latest + 1;
-	
-	/* All good, we got the handle */
-	return handle;
+	pthread_mutex_lock(&main_vec.lock);
+	for(i = 0; i < n; i++)
+	{
+		handles[i] = -1;
+		if(mains[i] == NULL)
+			continue;
+
+		handles[i] = elfp_main_vec_add_locked(mains[i]);
+		if(handles[i] != -1)
+			added++;
+	}
+	pthread_mutex_unlock(&main_vec.lock);
+
+	return added;
 }
 
 void
 elfp_main_vec_fini()
 {
+	elfp_main_slot *slot = NULL;
+	unsigned long int gen;
+	long int index;
 	unsigned long int i;
-	
-	/* Iterate through the vector and free all the active objects */
-	for(i = 0; i < main_vec.latest; i++)
-	{	
-		if(main_vec.vec[i] != NULL)
-			elfp_main_fini(main_vec.vec[i]);
+
+	/* Close all the open handles. Each close removes the handle
+	 * from the list of open handles */
+	while(1)
+	{
+		pthread_mutex_lock(&main_vec.lock);
+		index = main_vec.live_head;
+		pthread_mutex_unlock(&main_vec.lock);
+
+		if(index == -1)
+			break;
+
+		slot = elfp_main_vec_slot_at(index);
+		gen = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) >> ELFP_SLOT_GEN_SHIFT;
+		elfp_main_vec_remove((int)((gen << ELFP_HANDLE_INDEX_BITS) | index));
 	}
 
-	/* Free up the vector itself */
-	free(main_vec.vec);
+	/* Free up the chunks */
+	for(i = 0; i < ELFP_MAIN_VECTOR_MAX_CHUNKS; i++)
+	{
+		free(main_vec.chunks[i]);
+		main_vec.chunks[i] = NULL;
+	}
+
+	main_vec.used = 0;
+	main_vec.free_head = -1;
+	main_vec.live_head = -1;
+	main_vec.live = 0;
 	
 	return;
 }
 
-void
-elfp_main_vec_inform(int handle)
+int
+elfp_main_vec_remove(int handle)
 {	
-	/* Sanity check */
-	if(elfp_sanitize_handle(handle) == -1)
+	elfp_main_slot *slot = NULL;
+	unsigned long int index, gen, state, new_state, refs;
+
+	if(handle < 0)
+		return -1;
+
+	index = (unsigned long int)handle & ELFP_HANDLE_INDEX_MASK;
+	gen = (unsigned long int)handle >> ELFP_HANDLE_INDEX_BITS;
+
+	slot = elfp_main_vec_slot_at(index);
+	if(slot == NULL)
+		return -1;
+
+	/* Bump the generation and drop the handle's reference in one go.
+	 * Only one closer can win. Lookups of this handle fail from now on */
+	state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+	do
 	{
-		elfp_err_warn("elfp_main_vec_inform", "Handle failed sanity test");
-		return;
-	}
-	main_vec.vec[handle] = NULL;
+		refs = state & ELFP_SLOT_REFS_MASK;
+		if((state >> ELFP_SLOT_GEN_SHIFT) != gen || refs == 0)
+			return -1;
+
+		/* Not masked. Past ELFP_HANDLE_GEN_MASK, no handle matches
+		 * it and the slot is retired */
+		new_state = ((gen + 1) << ELFP_SLOT_GEN_SHIFT) | (refs - 1);
+	} while(!__atomic_compare_exchange_n(&slot->state, &state, new_state, 0,
+					__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+	/* Nobody else was looking at it */
+	if(refs == 1)
+		elfp_main_vec_reclaim(index);
+
+	return 0;
 }
 
 elfp_main*
 elfp_main_vec_get_em(int handle)
 {
-	return main_vec.vec[handle];
+	elfp_main_slot *slot = NULL;
+	unsigned long int index, gen, state;
+
+	if(handle < 0)
+		return NULL;
+
+	index = (unsigned long int)handle & ELFP_HANDLE_INDEX_MASK;
+	gen = (unsigned long int)handle >> ELFP_HANDLE_INDEX_BITS;
+
+	slot = elfp_main_vec_slot_at(index);
+	if(slot == NULL)
+		return NULL;
+
+	/* Take a reference, only if the handle is still open.
+	 * A closed handle has an older generation than its slot */
+	state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+	do
+	{
+		if((state >> ELFP_SLOT_GEN_SHIFT) != gen ||
+			(state & ELFP_SLOT_REFS_MASK) == 0)
+			return NULL;
+
+	} while(!__atomic_compare_exchange_n(&slot->state, &state, state + 1, 0,
+					__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+	return slot->main;
+}
+
+void
+elfp_main_vec_put_em(int handle)
+{
+	elfp_main_slot *slot = NULL;
+	unsigned long int index, state;
+
+	index = (unsigned long int)handle & ELFP_HANDLE_INDEX_MASK;
+	slot = elfp_main_vec_slot_at(index);
+	if(slot == NULL)
+		return;
+
+	/* The handle may have been closed in the meantime.
+	 * Then the last one out cleans up */
+	state = __atomic_sub_fetch(&slot->state, 1, __ATOMIC_ACQ_REL);
+	if((state & ELFP_SLOT_REFS_MASK) == 0)
+		elfp_main_vec_reclaim(index);
 }
 
 int
 elfp_sanitize_handle(int handle)
 {
 	/* Basic boundary checks */
-	if(handle < 0 || handle >= main_vec.latest)
+	if(handle < 0 ||
+		elfp_main_vec_slot_at((unsigned long int)handle & ELFP_HANDLE_INDEX_MASK) == NULL)
 	{
 		elfp_err_warn("elfp_sanitize_handle", "Invalid Handle passed");
 		return -1;
@@ -436,6 +1504,7 @@ elfp_sanitize_handle(int handle)
 		elfp_err_warn("elfp_sanitize_handle", "Handle already closed");
 		return -1;
 	}
+	elfp_main_vec_put_em(handle);
 	
 	/* At this point, these checks are sufficient.
 	 * We may add other checks later */
@@ -0,0 +1,374 @@
+/*
+ * File: elfp_ldcache.c
+ *
+ * Description: Reading ld.so.cache - the soname -> path table ldconfig
+ * 	writes for the dynamic loader.
+ *
+ * 	* The file is mapped once and looked up in place. Lookups are a
+ * 	binary search, the same one the dynamic loader does.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#include "./include/elfp_ldcache.h"
+#include "./include/elfp_err.h"
+#include "./include/elfp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <elf.h>
+
+/*
+ * elfp_ldcache_string: Gets a string of the cache.
+ *
+ * @return: NULL if the offset is junk, the string otherwise.
+ */
+static const char*
+elfp_ldcache_string(elfp_ldcache *cache, uint32_t offset)
+{
+	const char *base = (const char *)cache->header;
+
+	if(offset >= cache->strings_end)
+		return NULL;
+
+	if(memchr(base + offset, '\0', cache->strings_end - offset) == NULL)
+		return NULL;
+
+	return base + offset;
+}
+
+/*
+ * elfp_ldcache_cmp: Compares two sonames the way ldconfig sorts them.
+ * 	Runs of digits are compared as numbers, so libfoo.so.10 comes
+ * 	after libfoo.so.9.
+ *
+ * @return: <0, 0, >0 - like strcmp().
+ */
+static int
+elfp_ldcache_cmp(const char *p1, const char *p2)
+{
+	unsigned long int val1, val2;
+
+	while(*p1 != '\0')
+	{
+		if(*p1 >= '0' && *p1 <= '9')
+		{
+			if(*p2 < '0' || *p2 > '9')
+				return 1;
+
+			val1 = 0;
+			while(*p1 >= '0' && *p1 <= '9')
+				val1 = val1 * 10 + (*p1++ - '0');
+			val2 = 0;
+			while(*p2 >= '0' && *p2 <= '9')
+				val2 = val2 * 10 + (*p2++ - '0');
+
+			if(val1 != val2)
+				return (val1 < val2) ? -1 : 1;
+		}
+		else if(*p2 >= '0' && *p2 <= '9')
+		{
+			return -1;
+		}
+		else if(*p1 != *p2)
+		{
+			return (unsigned char)*p1 - (unsigned char)*p2;
+		}
+		else
+		{
+			p1++;
+			p2++;
+		}
+	}
+
+	return (unsigned char)*p1 - (unsigned char)*p2;
+}
+
+/*
+ * elfp_ldcache_parse: Finds the table in the mapped file and checks it.
+ *
+ * @return: 0 on success, -1 if the file is not a usable cache.
+ */
+static int
+elfp_ldcache_parse(elfp_ldcache *cache)
+{
+	const elfp_ldcache_header *header = NULL;
+	unsigned long int offset, old_nlibs;
+	uint32_t nlibs;
+	uint8_t endian;
+
+	/* Old format table first? Skip it. Its header is 16 bytes, entries
+	 * are 12 bytes each */
+	offset = 0;
+	if(cache->size >= 16 && memcmp(cache->addr, ELFP_LDCACHE_OLD_MAGIC,
+				sizeof(ELFP_LDCACHE_OLD_MAGIC) - 1) == 0)
+	{
+		memcpy(&nlibs, cache->addr + 12, sizeof(nlibs));
+		old_nlibs = nlibs;
+		offset = 16 + old_nlibs * 12;
+		offset = (offset + 3) & ~3UL;
+	}
+
+	if(offset > cache->size ||
+		cache->size - offset < sizeof(elfp_ldcache_header))
+		return -1;
+
+	header = (const elfp_ldcache_header *)(cache->addr + offset);
+	if(memcmp(header->magic, ELFP_LDCACHE_MAGIC,
+			sizeof(ELFP_LDCACHE_MAGIC) - 1) != 0 ||
+		memcmp(header->version, ELFP_LDCACHE_VERSION,
+			sizeof(ELFP_LDCACHE_VERSION) - 1) != 0)
+		return -1;
+
+	/* Written on a machine with the other byte order */
+	endian = header->flags & ELFP_LDCACHE_ENDIAN_MASK;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	if(endian == ELFP_LDCACHE_ENDIAN_BIG)
+		return -1;
+#else
+	if(endian == ELFP_LDCACHE_ENDIAN_LITTLE)
+		return -1;
+#endif
+
+	if(header->nlibs > (cache->size - offset - sizeof(elfp_ldcache_header)) /
+						sizeof(elfp_ldcache_entry))
+		return -1;
+
+	cache->header = header;
+	cache->entries = (const elfp_ldcache_entry *)(header + 1);
+	cache->count = header->nlibs;
+	cache->strings_end = cache->size - offset;
+
+	return 0;
+}
+
+/*
+ * All functions defined below are exposed to programmers.
+ *
+ * Refer to elfp.h for more details.
+ */
+
+elfp_ldcache*
+elfp_ldcache_open(const char *path)
+{
+	elfp_ldcache *cache = NULL;
+	struct stat st;
+	void *addr = NULL;
+	int fd, ret;
+
+	if(path == NULL)
+		path = ELFP_LDCACHE_PATH;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if(fd == -1)
+	{
+		elfp_err_warn("elfp_ldcache_open", "open() failed");
+		return NULL;
+	}
+
+	if(fstat(fd, &st) == -1 || st.st_size == 0)
+	{
+		elfp_err_warn("elfp_ldcache_open", "fstat() failed / empty file");
+		close(fd);
+		return NULL;
+	}
+
+	/* The mapping stays even after the descriptor is gone */
+	addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(addr == MAP_FAILED)
+	{
+		elfp_err_warn("elfp_ldcache_open", "mmap() failed");
+		return NULL;
+	}
+
+	cache = calloc(1, sizeof(elfp_ldcache));
+	if(cache == NULL)
+	{
+		elfp_err_warn("elfp_ldcache_open", "calloc() failed");
+		munmap(addr, st.st_size);
+		return NULL;
+	}
+
+	cache->addr = addr;
+	cache->size = st.st_size;
+
+	ret = elfp_ldcache_parse(cache);
+	if(ret == -1)
+	{
+		elfp_err_warn("elfp_ldcache_open", "Not a (supported) ld.so.cache");
+		elfp_ldcache_close(cache);
+		return NULL;
+	}
+
+	return cache;
+}
+
+unsigned int
+elfp_ldcache_flags(int class, unsigned int machine)
+{
+	/* The libc6 type, and the architecture in the next byte */
+	switch(machine)
+	{
+		case EM_X86_64:
+			return (class == ELFCLASS64) ? 0x0303 : 0x0803;
+
+		case EM_386:
+			return 0x0003;
+
+		case EM_AARCH64:
+			return 0x0a03;
+
+		case EM_ARM:
+			return 0x0903;
+
+		case EM_RISCV:
+			return (class == ELFCLASS64) ? 0x1003 : 0;
+
+		case EM_PPC64:
+			return 0x0503;
+
+		case EM_S390:
+			return (class == ELFCLASS64) ? 0x0403 : 0x0003;
+
+		default:
+			return 0;
+	}
+}
+
+const char*
+elfp_ldcache_lookup(elfp_ldcache *cache, const char *soname,
+		unsigned int flags, unsigned long int hwcap)
+{
+	/* Basic check */
+	if(cache == NULL || soname == NULL)
+	{
+		elfp_err_warn("elfp_ldcache_lookup", "Invalid argument(s) passed");
+		return NULL;
+	}
+
+	const elfp_ldcache_entry *entry = NULL;
+	const char *key = NULL;
+	long int left, right, middle;
+	unsigned long int i;
+	int cmp;
+
+	/* Entries are in descending order */
+	left = 0;
+	right = (long int)cache->count - 1;
+	middle = -1;
+	while(left <= right)
+	{
+		middle = left + (right - left) / 2;
+		key = elfp_ldcache_string(cache, cache->entries[middle].key);
+		if(key == NULL)
+		{
+			elfp_err_warn("elfp_ldcache_lookup", "Cache is corrupt");
+			return NULL;
+		}
+
+		cmp = elfp_ldcache_cmp(soname, key);
+		if(cmp == 0)
+			break;
+
+		if(cmp < 0)
+			left = middle + 1;
+		else
+			right = middle - 1;
+	}
+
+	if(left > right)
+		return NULL;
+
+	/* There can be many entries of that name - one per architecture,
+	 * per hwcap. Go to the first one */
+	while(middle > 0)
+	{
+		key = elfp_ldcache_string(cache, cache->entries[middle - 1].key);
+		if(key == NULL || strcmp(key, soname) != 0)
+			break;
+		middle--;
+	}
+
+	for(i = middle; i < cache->count; i++)
+	{
+		entry = cache->entries + i;
+		key = elfp_ldcache_string(cache, entry->key);
+		if(key == NULL || strcmp(key, soname) != 0)
+			break;
+
+		if(flags != 0 && (unsigned int)entry->flags != flags)
+			continue;
+
+		/* Needs something the caller doesn't have */
+		if((entry->hwcap & ~(uint64_t)hwcap) != 0)
+			continue;
+
+		return elfp_ldcache_string(cache, entry->value);
+	}
+
+	return NULL;
+}
+
+int
+elfp_ldcache_dump(elfp_ldcache *cache)
+{
+	/* Basic check */
+	if(cache == NULL)
+	{
+		elfp_err_warn("elfp_ldcache_dump", "NULL argument passed");
+		return -1;
+	}
+
+	const elfp_ldcache_entry *entry = NULL;
+	const char *key = NULL, *value = NULL;
+	unsigned long int i;
+
+	printf("%lu libs found in cache\n", cache->count);
+	for(i = 0; i < cache->count; i++)
+	{
+		entry = cache->entries + i;
+		key = elfp_ldcache_string(cache, entry->key);
+		value = elfp_ldcache_string(cache, entry->value);
+		if(key == NULL || value == NULL)
+			continue;
+
+		if(entry->hwcap != 0)
+			printf("\t%s (0x%04x, hwcap: 0x%016lx) => %s\n", key,
+				(unsigned int)entry->flags,
+				(unsigned long int)entry->hwcap, value);
+		else
+			printf("\t%s (0x%04x) => %s\n", key,
+				(unsigned int)entry->flags, value);
+	}
+
+	return 0;
+}
+
+void
+elfp_ldcache_close(elfp_ldcache *cache)
+{
+	if(cache == NULL)
+		return;
+
+	munmap((void *)cache->addr, cache->size);
+	free(cache);
+}
@@ -0,0 +1,1360 @@
+/*
+ * File: elfp_line.c
+ *
+ * Description: Address -> file:line, from the line number programs of
+ * 	.debug_line. DWARF 2 to 5.
+ *
+ * 	* The programs are run once, the first time a line is asked for -
+ * 	a unit per task, on many threads for big files. Their rows end up
+ * 	in one table sorted by address, and every lookup after that is a
+ * 	binary search.
+ * 	* File and directory names are not copied. They point into
+ * 	.debug_line / .debug_line_str / .debug_str.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#include "./include/elfp_line.h"
+#include "./include/elfp_dwarf.h"
+#include "./include/elfp_shdr.h"
+#include "./include/elfp_sym.h"
+#include "./include/elfp_pool.h"
+#include "./include/elfp_int.h"
+#include "./include/elfp_err.h"
+#include "./include/elfp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <elf.h>
+
+/* .debug_line bigger than this is decoded on many threads */
+#define ELFP_LINE_PARALLEL_MIN (256 * 1024)
+
+/* Most entry formats a DWARF 5 directory / file table can have */
+#define ELFP_LINE_FORMATS_MAX 16
+
+/* A row as a line number program puts it out */
+typedef struct elfp_line_row
+{
+	unsigned long int addr;
+	unsigned int file;
+	unsigned int line;
+
+} elfp_line_row;
+
+/* A line table and what came out of running its program */
+typedef struct elfp_line_unit
+{
+	const unsigned char *start;
+	const unsigned char *end;
+
+	elfp_line_file *files;
+	unsigned long int n_files;
+
+	elfp_line_row *rows;
+	unsigned long int n_rows;
+	unsigned long int max_rows;
+
+	int broken;
+
+	/* Number of its first file, and where its file table starts in
+	 * the index's */
+	unsigned int first_file;
+	unsigned long int file_base;
+
+} elfp_line_unit;
+
+/* Rows of a unit in ascending address order */
+typedef struct elfp_line_run
+{
+	unsigned long int first;
+	unsigned long int index;
+	const elfp_line_row *rows;
+	unsigned long int n_rows;
+	unsigned long int file_base;
+
+} elfp_line_run;
+
+/* What the tasks share */
+typedef struct elfp_line_build
+{
+	elfp_line_unit *units;
+	unsigned long int n_units;
+
+	elfp_dwarf_cursor line_str;
+	elfp_dwarf_cursor str;
+
+	/* Size of an address, for the units whose header doesn't say */
+	unsigned int addr_size;
+
+	/* Object files - address 0 is a real address */
+	int relocatable;
+
+} elfp_line_build;
+
+/* What a line table's header says about its program */
+typedef struct elfp_line_header
+{
+	elfp_dwarf_format format;
+	unsigned int min_inst_length;
+	int line_base;
+	unsigned int line_range;
+	unsigned int opcode_base;
+	const unsigned char *opcode_lengths;
+
+	/* Number of the first file in the file table */
+	unsigned int file_base;
+
+} elfp_line_header;
+
+/*
+ * elfp_line_grow: Makes room for one more element in a malloc()ed array.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_line_grow(void **array, unsigned long int *max, unsigned long int count,
+					unsigned long int elem_size)
+{
+	unsigned long int new_max;
+	void *new_array = NULL;
+
+	if(count < *max)
+		return 0;
+
+	new_max = (*max == 0) ? 64 : *max * 2;
+	new_array = realloc(*array, new_max * elem_size);
+	if(new_array == NULL)
+		return -1;
+
+	*array = new_array;
+	*max = new_max;
+
+	return 0;
+}
+
+/*
+ * elfp_line_row_add: Adds a row to a unit's output.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_line_row_add(elfp_line_unit *unit, unsigned long int addr,
+				unsigned int file, unsigned int line)
+{
+	elfp_line_row *row = NULL;
+
+	if(elfp_line_grow((void **)&unit->rows, &unit->max_rows, unit->n_rows,
+					sizeof(elfp_line_row)) == -1)
+		return -1;
+
+	row = unit->rows + unit->n_rows;
+	row->addr = addr;
+	row->file = file;
+	row->line = line;
+	unit->n_rows = unit->n_rows + 1;
+
+	return 0;
+}
+
+/*
+ * elfp_line_string: Gets the string a DW_LNCT_path is.
+ *
+ * @return: The string, NULL if it can't be found.
+ */
+static const char*
+elfp_line_string(elfp_line_build *build, const elfp_dwarf_value *value)
+{
+	switch(value->form)
+	{
+		case DW_FORM_string:
+			return (const char *)value->data;
+
+		case DW_FORM_line_strp:
+			return elfp_dwarf_str(&build->line_str, value->u);
+
+		case DW_FORM_strp:
+			return elfp_dwarf_str(&build->str, value->u);
+
+		/* Need .debug_str_offsets. Compilers don't use these here */
+		default:
+			return NULL;
+	}
+}
+
+/*
+ * elfp_line_entries: Reads a DWARF 5 directory / file table.
+ *
+ * 	* paths[i] and dirs[i] are the DW_LNCT_path and the
+ * 	DW_LNCT_directory_index of entry i. dirs can be NULL.
+ *
+ * @return: Number of entries, -1 if the table is broken / on failure.
+ * 	The arrays are to be freed by the caller.
+ */
+static long int
+elfp_line_entries(elfp_line_build *build, elfp_dwarf_cursor *cursor,
+		const elfp_dwarf_format *format, const char ***paths,
+		unsigned long int **dirs)
+{
+	unsigned long int contents[ELFP_LINE_FORMATS_MAX];
+	unsigned int forms[ELFP_LINE_FORMATS_MAX];
+	unsigned long int n_formats, count, i, j;
+	elfp_dwarf_value value;
+
+	*paths = NULL;
+	if(dirs != NULL)
+		*dirs = NULL;
+
+	n_formats = elfp_dwarf_u8(cursor);
+	if(n_formats > ELFP_LINE_FORMATS_MAX)
+		return -1;
+
+	for(i = 0; i < n_formats; i++)
+	{
+		contents[i] = elfp_dwarf_uleb(cursor);
+		forms[i] = elfp_dwarf_uleb(cursor);
+	}
+
+	/* Every entry takes at least a byte */
+	count = elfp_dwarf_uleb(cursor);
+	if(cursor->error != 0 ||
+		count > (unsigned long int)(cursor->end - cursor->p))
+		return -1;
+
+	if(count == 0)
+		return 0;
+
+	*paths = calloc(count, sizeof(const char *));
+	if(dirs != NULL)
+		*dirs = calloc(count, sizeof(unsigned long int));
+	if(*paths == NULL || (dirs != NULL && *dirs == NULL))
+		return -1;
+
+	for(i = 0; i < count; i++)
+	{
+		for(j = 0; j < n_formats; j++)
+		{
+			if(elfp_dwarf_form_read(cursor, forms[j], format,
+							&value) == -1)
+				return -1;
+
+			if(contents[j] == DW_LNCT_path)
+				(*paths)[i] = elfp_line_string(build, &value);
+			else if(contents[j] == DW_LNCT_directory_index &&
+								dirs != NULL)
+				(*dirs)[i] = value.u;
+		}
+	}
+
+	return count;
+}
+
+/*
+ * elfp_line_files_v5: Reads the directory and file tables of a DWARF 5
+ * 	header into the unit's file table.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_line_files_v5(elfp_line_build *build, elfp_line_unit *unit,
+		elfp_dwarf_cursor *cursor, const elfp_dwarf_format *format)
+{
+	const char **dir_paths = NULL, **file_paths = NULL;
+	unsigned long int *file_dirs = NULL;
+	long int n_dirs, n_files, i;
+	int ret = -1;
+
+	n_dirs = elfp_line_entries(build, cursor, format, &dir_paths, NULL);
+	if(n_dirs == -1)
+		goto out;
+
+	n_files = elfp_line_entries(build, cursor, format, &file_paths,
+								&file_dirs);
+	if(n_files == -1)
+		goto out;
+
+	if(n_files != 0)
+	{
+		unit->files = malloc(n_files * sizeof(elfp_line_file));
+		if(unit->files == NULL)
+			goto out;
+	}
+
+	for(i = 0; i < n_files; i++)
+	{
+		unit->files[i].name = file_paths[i];
+		unit->files[i].dir = NULL;
+		if(file_paths[i] != NULL && file_paths[i][0] != '/' &&
+					file_dirs[i] < (unsigned long int)n_dirs)
+			unit->files[i].dir = dir_paths[file_dirs[i]];
+	}
+	unit->n_files = n_files;
+	ret = 0;
+
+out:
+	free(dir_paths);
+	free(file_paths);
+	free(file_dirs);
+	return ret;
+}
+
+/*
+ * elfp_line_files_v4: Reads include_directories and file_names of a
+ * 	DWARF 2 - 4 header into the unit's file table.
+ *
+ * 	* Directory 0 is the compilation directory, which is not in the
+ * 	header. Files in it get a NULL dir.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_line_files_v4(elfp_line_unit *unit, elfp_dwarf_cursor *cursor)
+{
+	const char **dirs = NULL;
+	unsigned long int n_dirs = 0, max_dirs = 0, max_files = 0, dir;
+	const char *name = NULL;
+	elfp_line_file *file = NULL;
+
+	while(1)
+	{
+		name = elfp_dwarf_cstr(cursor);
+		if(name == NULL)
+			goto fail;
+		if(name[0] == '\0')
+			break;
+
+		if(elfp_line_grow((void **)&dirs, &max_dirs, n_dirs,
+						sizeof(const char *)) == -1)
+			goto fail;
+		dirs[n_dirs++] = name;
+	}
+
+	while(1)
+	{
+		name = elfp_dwarf_cstr(cursor);
+		if(name == NULL)
+			goto fail;
+		if(name[0] == '\0')
+			break;
+
+		dir = elfp_dwarf_uleb(cursor);
+
+		/* Modification time, size */
+		elfp_dwarf_uleb(cursor);
+		elfp_dwarf_uleb(cursor);
+
+		if(elfp_line_grow((void **)&unit->files, &max_files,
+				unit->n_files, sizeof(elfp_line_file)) == -1)
+			goto fail;
+
+		file = unit->files + unit->n_files;
+		file->name = name;
+		file->dir = NULL;
+		if(name[0] != '/' && dir >= 1 && dir <= n_dirs)
+			file->dir = dirs[dir - 1];
+		unit->n_files = unit->n_files + 1;
+	}
+
+	free(dirs);
+	return (cursor->error == 0) ? 0 : -1;
+
+fail:
+	free(dirs);
+	return -1;
+}
+
+/*
+ * elfp_line_header_read: Reads a line table's header, along with its
+ * 	file table.
+ *
+ * @arg0: What the tasks share
+ * @arg1: The unit
+ * @arg2: Cursor at the unit's start. Moved to the program's start.
+ * @arg3: Reference to an elfp_line_header. Filled up by the function.
+ *
+ * @return: 0 on success, -1 if the header is broken / not supported.
+ */
+static int
+elfp_line_header_read(elfp_line_build *build, elfp_line_unit *unit,
+		elfp_dwarf_cursor *cursor, elfp_line_header *header)
+{
+	unsigned long int length, header_length;
+	const unsigned char *program = NULL;
+	unsigned int offset_size;
+
+	length = elfp_dwarf_unit_length(cursor, &offset_size);
+	if(cursor->error != 0)
+		return -1;
+	cursor->end = cursor->p + length;
+
+	header->format.offset_size = offset_size;
+	header->format.version = elfp_dwarf_u16(cursor);
+	if(header->format.version < 2 || header->format.version > 5)
+		return -1;
+
+	if(header->format.version >= 5)
+	{
+		header->format.addr_size = elfp_dwarf_u8(cursor);
+
+		/* Segment selector size */
+		elfp_dwarf_u8(cursor);
+	}
+	else
+	{
+		header->format.addr_size = build->addr_size;
+	}
+
+	header_length = elfp_dwarf_uint(cursor, offset_size);
+	if(header_length > (unsigned long int)(cursor->end - cursor->p))
+		return -1;
+	program = cursor->p + header_length;
+
+	header->min_inst_length = elfp_dwarf_u8(cursor);
+
+	/* maximum_operations_per_instruction. Only VLIW machines have it
+	 * other than 1, and op_index is not tracked for them */
+	if(header->format.version >= 4)
+		elfp_dwarf_u8(cursor);
+
+	/* default_is_stmt */
+	elfp_dwarf_u8(cursor);
+
+	header->line_base = (signed char)elfp_dwarf_u8(cursor);
+	header->line_range = elfp_dwarf_u8(cursor);
+	header->opcode_base = elfp_dwarf_u8(cursor);
+	if(cursor->error != 0 || header->line_range == 0 ||
+						header->opcode_base == 0)
+		return -1;
+
+	header->opcode_lengths = cursor->p;
+	elfp_dwarf_skip(cursor, header->opcode_base - 1);
+
+	if(header->format.version >= 5)
+	{
+		header->file_base = 0;
+		if(elfp_line_files_v5(build, unit, cursor,
+						&header->format) == -1)
+			return -1;
+	}
+	else
+	{
+		header->file_base = 1;
+		if(elfp_line_files_v4(unit, cursor) == -1)
+			return -1;
+	}
+
+	if(cursor->error != 0)
+		return -1;
+
+	cursor->p = program;
+	return 0;
+}
+
+/*
+ * elfp_line_program_run: Runs a line number program, adding the rows it
+ * 	puts out to the unit.
+ *
+ * 	* Sequences of code which the linker threw away are left out -
+ * 	their address is the tombstone (-1), or 0 outside object files.
+ * 	* A sequence which doesn't end before the program does is left out.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_line_program_run(elfp_line_build *build, elfp_line_unit *unit,
+		elfp_dwarf_cursor *cursor, const elfp_line_header *header)
+{
+	unsigned long int addr, file, line, seq_start, len, i, tombstone;
+	unsigned long int const_add_pc;
+	const unsigned char *ext_end = NULL;
+	unsigned int op, adj, row_file;
+	int skip;
+
+	const_add_pc = ((255 - header->opcode_base) / header->line_range) *
+						header->min_inst_length;
+
+	addr = 0;
+	file = 1;
+	line = 1;
+	skip = 0;
+	seq_start = unit->n_rows;
+
+	while(cursor->p < cursor->end)
+	{
+		op = *cursor->p++;
+
+		if(op >= header->opcode_base)
+		{
+			/* Special opcode - the common case */
+			adj = op - header->opcode_base;
+			addr = addr + (adj / header->line_range) *
+						header->min_inst_length;
+			line = line + header->line_base +
+						(int)(adj % header->line_range);
+			goto row;
+		}
+
+		switch(op)
+		{
+			case 0:
+				len = elfp_dwarf_uleb(cursor);
+				if(len == 0 || len >
+				(unsigned long int)(cursor->end - cursor->p))
+				{
+					cursor->p = cursor->end;
+					break;
+				}
+				ext_end = cursor->p + len;
+				op = elfp_dwarf_u8(cursor);
+
+				if(op == DW_LNE_end_sequence)
+				{
+					/* Rows right at the end cover nothing */
+					while(unit->n_rows > seq_start &&
+					unit->rows[unit->n_rows - 1].addr == addr)
+						unit->n_rows = unit->n_rows - 1;
+
+					if(skip == 0 && unit->n_rows > seq_start &&
+						elfp_line_row_add(unit,
+						addr, ELFP_LINE_END, 0) == -1)
+						return -1;
+
+					addr = 0;
+					file = 1;
+					line = 1;
+					skip = 0;
+					seq_start = unit->n_rows;
+				}
+				else if(op == DW_LNE_set_address)
+				{
+					addr = elfp_dwarf_uint(cursor, len - 1);
+					tombstone = (len - 1 >= 8) ? ~0UL :
+						(1UL << ((len - 1) * 8)) - 1;
+					if(addr == tombstone ||
+					(addr == 0 && build->relocatable == 0))
+					{
+						/* Rows already put out go too */
+						unit->n_rows = seq_start;
+						skip = 1;
+					}
+				}
+
+				cursor->p = ext_end;
+				continue;
+
+			case DW_LNS_copy:
+				goto row;
+
+			case DW_LNS_advance_pc:
+				addr = addr + elfp_dwarf_uleb(cursor) *
+						header->min_inst_length;
+				continue;
+
+			case DW_LNS_advance_line:
+				line = line + elfp_dwarf_sleb(cursor);
+				continue;
+
+			case DW_LNS_set_file:
+				file = elfp_dwarf_uleb(cursor);
+				continue;
+
+			case DW_LNS_const_add_pc:
+				addr = addr + const_add_pc;
+				continue;
+
+			case DW_LNS_fixed_advance_pc:
+				addr = addr + elfp_dwarf_u16(cursor);
+				continue;
+
+			default:
+				/* The ones which don't change the address /
+				 * line / file: skip their operands */
+				for(i = 0; i < header->opcode_lengths[op - 1]; i++)
+					elfp_dwarf_uleb(cursor);
+				continue;
+		}
+		continue;
+
+row:
+		if(skip != 0)
+			continue;
+
+		row_file = file - header->file_base;
+		if(file < header->file_base || row_file >= unit->n_files)
+			row_file = ELFP_LINE_NO_FILE;
+
+		if(elfp_line_row_add(unit, addr, row_file, line) == -1)
+			return -1;
+	}
+
+	/* Never ended */
+	unit->n_rows = seq_start;
+
+	if(cursor->error != 0)
+		unit->broken = 1;
+
+	return 0;
+}
+
+/*
+ * elfp_line_task: Decodes a unit. Runs on a thread of the pool.
+ */
+static void
+elfp_line_task(void *arg, unsigned long int index)
+{
+	elfp_line_build *build = arg;
+	elfp_line_unit *unit = build->units + index;
+	elfp_line_header header;
+	elfp_dwarf_cursor cursor;
+
+	cursor.p = unit->start;
+	cursor.end = unit->end;
+	cursor.error = 0;
+
+	if(elfp_line_header_read(build, unit, &cursor, &header) == -1)
+	{
+		unit->broken = 1;
+		return;
+	}
+	unit->first_file = header.file_base;
+
+	/* Around 2 bytes of program per row */
+	unit->max_rows = (cursor.end - cursor.p) / 2 + 16;
+	unit->rows = malloc(unit->max_rows * sizeof(elfp_line_row));
+	if(unit->rows == NULL ||
+		elfp_line_program_run(build, unit, &cursor, &header) == -1)
+	{
+		unit->broken = 1;
+		unit->n_rows = 0;
+	}
+}
+
+/*
+ * elfp_line_run_starts: Tells if a run starts at a row - at a sequence's
+ * 	start, or where the addresses go back.
+ *
+ * @return: 1 if it does, 0 otherwise.
+ */
+static int
+elfp_line_run_starts(const elfp_line_row *rows, unsigned long int index)
+{
+	if(index == 0)
+		return 1;
+
+	return (rows[index - 1].file == ELFP_LINE_END ||
+			rows[index].addr < rows[index - 1].addr);
+}
+
+/*
+ * elfp_line_run_cmp: Orders runs by where they start, and by where they
+ * 	are in .debug_line after that.
+ */
+static int
+elfp_line_run_cmp(const void *p1, const void *p2)
+{
+	const elfp_line_run *run1 = p1;
+	const elfp_line_run *run2 = p2;
+
+	if(run1->first != run2->first)
+		return (run1->first < run2->first) ? -1 : 1;
+
+	return (run1->index < run2->index) ? -1 : 1;
+}
+
+/*
+ * elfp_line_cluster_sort: Sorts rows [start, end) by address.
+ *
+ * 	* order[] says which row each address is. It is set up to say
+ * 	"the same one" for all the rows, the first time.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_line_cluster_sort(unsigned long int *addrs, unsigned int **order,
+		unsigned long int n, unsigned long int start,
+		unsigned long int end)
+{
+	unsigned long int i;
+
+	if(*order == NULL)
+	{
+		*order = malloc(n * sizeof(unsigned int));
+		if(*order == NULL)
+		{
+			elfp_err_warn("elfp_line_cluster_sort", "malloc() failed");
+			return -1;
+		}
+
+		for(i = 0; i < n; i++)
+			(*order)[i] = i;
+	}
+
+	if(elfp_sym_radix_sort(addrs + start, *order + start,
+						end - start) == -1)
+	{
+		elfp_err_warn("elfp_line_cluster_sort", "elfp_sym_radix_sort() failed");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * elfp_line_compact: Goes over the sorted rows, keeping one per address
+ * 	and only the ones which say something new.
+ *
+ * 	* Of the rows at an address, the last one which is not the end of
+ * 	a sequence wins - a sequence can start where another ends.
+ *
+ * @arg0-3: Sorted addresses, the row each one is (NULL if they are in
+ * 	order already), file / line of rows.
+ * @arg4: Number of rows
+ * @arg5: Index to put the rows in. NULL to only count them.
+ *
+ * @return: Number of rows kept.
+ */
+static unsigned long int
+elfp_line_compact(const unsigned long int *addrs, const unsigned int *order,
+		const unsigned int *files, const unsigned int *lines,
+		unsigned long int n, elfp_main_lines *out)
+{
+	unsigned long int i, j, count;
+	unsigned int file, line, prev_file, prev_line, row;
+
+	count = 0;
+	prev_file = ELFP_LINE_END;
+	prev_line = 0;
+
+	for(i = 0; i < n; i = j)
+	{
+		file = ELFP_LINE_END;
+		line = 0;
+		for(j = i; j < n && addrs[j] == addrs[i]; j++)
+		{
+			row = (order != NULL) ? order[j] : j;
+			if(files[row] != ELFP_LINE_END)
+			{
+				file = files[row];
+				line = lines[row];
+			}
+		}
+
+		if(file == prev_file && (file == ELFP_LINE_END ||
+							line == prev_line))
+			continue;
+
+		if(out != NULL)
+		{
+			out->addrs[count] = addrs[i];
+			out->files[count] = file;
+			out->lines[count] = line;
+		}
+		count = count + 1;
+		prev_file = file;
+		prev_line = line;
+	}
+
+	return count;
+}
+
+/*
+ * elfp_line_merge: Puts the rows of all the units into one index.
+ *
+ * 	* A program puts out rows in runs of ascending addresses - a run
+ * 	per sequence, more often than not. Laid out by where the runs
+ * 	start, the rows are sorted already but for runs which overlap.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_line_merge(elfp_main *main, elfp_line_build *build,
+						elfp_main_lines *lines)
+{
+	unsigned long int *addrs = NULL;
+	unsigned int *order = NULL, *files = NULL, *line_nums = NULL;
+	unsigned long int n_rows, n_files, n_runs, i, j, k, start, last;
+	elfp_line_unit *unit = NULL;
+	elfp_line_run *runs = NULL, *run = NULL;
+	int overlap, ret = -1;
+
+	n_rows = 0;
+	n_files = 0;
+	n_runs = 0;
+	for(i = 0; i < build->n_units; i++)
+	{
+		unit = build->units + i;
+		unit->file_base = n_files;
+		n_rows = n_rows + unit->n_rows;
+		n_files = n_files + unit->n_files;
+		lines->n_broken = lines->n_broken + unit->broken;
+
+		for(j = 0; j < unit->n_rows; j++)
+		{
+			if(elfp_line_run_starts(unit->rows, j))
+				n_runs = n_runs + 1;
+		}
+	}
+
+	/* Row and file numbers have to fit in an unsigned int */
+	if(n_rows >= ELFP_LINE_NO_FILE || n_files >= ELFP_LINE_NO_FILE)
+	{
+		elfp_err_warn("elfp_line_merge", "Too many rows");
+		return -1;
+	}
+
+	if(n_files != 0)
+	{
+		lines->file_table = elfp_main_alloc(main,
+					n_files * sizeof(elfp_line_file));
+		if(lines->file_table == NULL)
+		{
+			elfp_err_warn("elfp_line_merge", "elfp_main_alloc() failed");
+			return -1;
+		}
+	}
+
+	if(build->n_units != 0)
+		lines->units = elfp_main_alloc(main,
+			build->n_units * sizeof(elfp_line_unit_files));
+	if(build->n_units != 0 && lines->units == NULL)
+	{
+		elfp_err_warn("elfp_line_merge", "elfp_main_alloc() failed");
+		return -1;
+	}
+
+	for(i = 0; i < build->n_units; i++)
+	{
+		unit = build->units + i;
+		if(unit->n_files != 0)
+			memcpy(lines->file_table + unit->file_base, unit->files,
+					unit->n_files * sizeof(elfp_line_file));
+
+		lines->units[i].offset = unit->start - build->units[0].start;
+		lines->units[i].file_base = unit->file_base;
+		lines->units[i].n_files = unit->n_files;
+		lines->units[i].first = unit->first_file;
+	}
+	lines->n_files = n_files;
+
+	if(n_rows == 0)
+		return 0;
+
+	runs = malloc(n_runs * sizeof(elfp_line_run));
+	addrs = malloc(n_rows * sizeof(unsigned long int));
+	files = malloc(n_rows * sizeof(unsigned int));
+	line_nums = malloc(n_rows * sizeof(unsigned int));
+	if(runs == NULL || addrs == NULL || files == NULL || line_nums == NULL)
+	{
+		elfp_err_warn("elfp_line_merge", "malloc() failed");
+		goto out;
+	}
+
+	for(i = 0, k = 0; i < build->n_units; i++)
+	{
+		unit = build->units + i;
+		for(j = 0; j < unit->n_rows; j++)
+		{
+			if(elfp_line_run_starts(unit->rows, j) == 0)
+			{
+				runs[k - 1].n_rows = runs[k - 1].n_rows + 1;
+				continue;
+			}
+
+			run = runs + k;
+			run->first = unit->rows[j].addr;
+			run->index = k;
+			run->rows = unit->rows + j;
+			run->n_rows = 1;
+			run->file_base = unit->file_base;
+			k = k + 1;
+		}
+	}
+
+	qsort(runs, n_runs, sizeof(elfp_line_run), elfp_line_run_cmp);
+
+	/* All the rows, with file numbers made to index file_table */
+	for(i = 0, k = 0; i < n_runs; i++)
+	{
+		run = runs + i;
+		for(j = 0; j < run->n_rows; j++, k++)
+		{
+			addrs[k] = run->rows[j].addr;
+			files[k] = run->rows[j].file;
+			if(files[k] < ELFP_LINE_NO_FILE)
+				files[k] = files[k] + run->file_base;
+			line_nums[k] = run->rows[j].line;
+		}
+	}
+
+	/* Runs overlapping the ones before them make a cluster, which is
+	 * sorted on its own. Sequences seldom overlap - clusters are few
+	 * and small */
+	start = 0;
+	last = 0;
+	overlap = 0;
+	for(i = 0, k = 0; i <= n_runs; i++)
+	{
+		run = runs + i;
+		if(i < n_runs && k != 0 && run->first < last)
+		{
+			overlap = 1;
+		}
+		else
+		{
+			if(overlap != 0 && elfp_line_cluster_sort(addrs, &order,
+						n_rows, start, k) == -1)
+				goto out;
+
+			start = k;
+			overlap = 0;
+		}
+
+		if(i == n_runs)
+			break;
+
+		k = k + run->n_rows;
+		if(run->rows[run->n_rows - 1].addr > last)
+			last = run->rows[run->n_rows - 1].addr;
+	}
+
+	lines->count = elfp_line_compact(addrs, order, files, line_nums,
+								n_rows, NULL);
+	lines->addrs = elfp_main_alloc(main,
+				lines->count * sizeof(unsigned long int));
+	lines->files = elfp_main_alloc(main,
+				lines->count * sizeof(unsigned int));
+	lines->lines = elfp_main_alloc(main,
+				lines->count * sizeof(unsigned int));
+	if(lines->addrs == NULL || lines->files == NULL || lines->lines == NULL)
+	{
+		elfp_err_warn("elfp_line_merge", "elfp_main_alloc() failed");
+		goto out;
+	}
+
+	elfp_line_compact(addrs, order, files, line_nums, n_rows, lines);
+	ret = 0;
+
+out:
+	free(runs);
+	free(addrs);
+	free(order);
+	free(files);
+	free(line_nums);
+	return ret;
+}
+
+/*
+ * elfp_line_index_build: Builds the line index of a file.
+ *
+ * 	* Called with index_lock held. The section index is built already.
+ *
+ * @return: NULL on failure, the index on success.
+ */
+static elfp_main_lines*
+elfp_line_index_build(elfp_main *main)
+{
+	elfp_main_lines *lines = NULL;
+	elfp_line_build build;
+	elfp_dwarf_cursor section;
+	unsigned long int i, max_units, length, size;
+	unsigned int offset_size;
+	unsigned short int type;
+	const unsigned char *start = NULL;
+	int ret;
+
+	lines = elfp_main_alloc(main, sizeof(elfp_main_lines));
+	if(lines == NULL)
+	{
+		elfp_err_warn("elfp_line_index_build", "elfp_main_alloc() failed");
+		return NULL;
+	}
+
+	/* Nothing to index */
+	if(elfp_dwarf_section_get(main, ".debug_line", &section) == -1)
+		return lines;
+
+	memset(&build, 0, sizeof(build));
+	elfp_dwarf_section_get(main, ".debug_line_str", &build.line_str);
+	elfp_dwarf_section_get(main, ".debug_str", &build.str);
+	build.addr_size = (elfp_main_get_class(main) == ELFCLASS32) ? 4 : 8;
+
+	type = ET_NONE;
+	elfp_main_read(main, EI_NIDENT, sizeof(type), &type);
+	build.relocatable = (type == ET_REL);
+
+	/* Where the units are. Their headers say how long they are */
+	size = section.end - section.p;
+	max_units = 0;
+	while(section.p < section.end)
+	{
+		start = section.p;
+		length = elfp_dwarf_unit_length(&section, &offset_size);
+		if(section.error != 0)
+		{
+			lines->n_broken = lines->n_broken + 1;
+			break;
+		}
+		elfp_dwarf_skip(&section, length);
+
+		if(elfp_line_grow((void **)&build.units, &max_units,
+			build.n_units, sizeof(elfp_line_unit)) == -1)
+		{
+			elfp_err_warn("elfp_line_index_build", "realloc() failed");
+			free(build.units);
+			return NULL;
+		}
+
+		memset(build.units + build.n_units, 0, sizeof(elfp_line_unit));
+		build.units[build.n_units].start = start;
+		build.units[build.n_units].end = section.p;
+		build.n_units = build.n_units + 1;
+	}
+	lines->n_units = build.n_units;
+
+	/* Small ones are over before the threads would have started */
+	ret = elfp_pool_run(build.n_units, (size >= ELFP_LINE_PARALLEL_MIN) ?
+					0 : 1, elfp_line_task, &build);
+	if(ret == 0)
+		ret = elfp_line_merge(main, &build, lines);
+
+	for(i = 0; i < build.n_units; i++)
+	{
+		free(build.units[i].files);
+		free(build.units[i].rows);
+	}
+	free(build.units);
+
+	if(ret == -1)
+	{
+		elfp_err_warn("elfp_line_index_build", "Decoding the line tables failed");
+		return NULL;
+	}
+
+	return lines;
+}
+
+elfp_main_lines*
+elfp_line_index_get(elfp_main *main)
+{
+	/* Basic check */
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_line_index_get", "NULL argument passed");
+		return NULL;
+	}
+
+	elfp_main_lines *lines = NULL;
+
+	/* Built already? */
+	lines = __atomic_load_n(&main->lines, __ATOMIC_ACQUIRE);
+	if(lines != NULL)
+		return lines;
+
+	/* The builder needs the section index, which takes index_lock
+	 * itself. Get that out of the way first */
+	if(elfp_shdr_index_get(main) == NULL)
+	{
+		elfp_err_warn("elfp_line_index_get", "elfp_shdr_index_get() failed");
+		return NULL;
+	}
+
+	/* Only one thread builds it. Others wait and use it */
+	pthread_mutex_lock(&main->index_lock);
+	lines = main->lines;
+	if(lines == NULL)
+	{
+		lines = elfp_line_index_build(main);
+		if(lines != NULL)
+			__atomic_store_n(&main->lines, lines, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&main->index_lock);
+
+	if(lines == NULL)
+		elfp_err_warn("elfp_line_index_get", "elfp_line_index_build() failed");
+
+	return lines;
+}
+
+/*
+ * elfp_line_upper: Finds the first row in [low, high) whose address is
+ * 	more than addr.
+ *
+ * @return: Index of the row, high if there is none.
+ */
+static unsigned long int
+elfp_line_upper(const elfp_main_lines *lines, unsigned long int low,
+		unsigned long int high, unsigned long int addr)
+{
+	unsigned long int middle;
+
+	while(low < high)
+	{
+		middle = low + (high - low) / 2;
+		if(lines->addrs[middle] <= addr)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low;
+}
+
+/*
+ * elfp_line_fill: Fills up an elfp_line from the row before upper.
+ *
+ * @return: 0 if the address has a line, -1 otherwise.
+ */
+static int
+elfp_line_fill(const elfp_main_lines *lines, unsigned long int upper,
+					elfp_line *line)
+{
+	const elfp_line_file *file = NULL;
+	unsigned int index;
+
+	memset(line, 0, sizeof(elfp_line));
+	if(upper == 0)
+		return -1;
+
+	index = lines->files[upper - 1];
+	if(index == ELFP_LINE_END)
+		return -1;
+
+	line->addr = lines->addrs[upper - 1];
+	line->line = lines->lines[upper - 1];
+	if(index != ELFP_LINE_NO_FILE)
+	{
+		file = lines->file_table + index;
+		line->dir = file->dir;
+		line->file = file->name;
+	}
+
+	return 0;
+}
+
+const elfp_line_file*
+elfp_line_file_get(const elfp_main_lines *lines, unsigned long int offset,
+						unsigned long int number)
+{
+	const elfp_line_unit_files *unit = NULL;
+	unsigned long int low, high, middle;
+
+	/* Units are in the order of their offsets */
+	low = 0;
+	high = lines->n_units;
+	while(low < high)
+	{
+		middle = low + (high - low) / 2;
+		if(lines->units[middle].offset < offset)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	if(low == lines->n_units || lines->units[low].offset != offset)
+		return NULL;
+
+	unit = lines->units + low;
+	if(number < unit->first || number - unit->first >= unit->n_files)
+		return NULL;
+
+	return lines->file_table + unit->file_base + (number - unit->first);
+}
+
+/*
+ * elfp_line_index_handle: Gets the line index of a handle's file.
+ *
+ * @return: NULL on failure, the index on success. The caller has to
+ * 	put the handle's elfp_main object back.
+ */
+static elfp_main_lines*
+elfp_line_index_handle(int handle)
+{
+	elfp_main *main = NULL;
+	elfp_main_lines *lines = NULL;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_line_index_handle", "elfp_main_vec_get_em() failed");
+		return NULL;
+	}
+
+	lines = elfp_line_index_get(main);
+	if(lines == NULL)
+	{
+		elfp_err_warn("elfp_line_index_handle", "elfp_line_index_get() failed");
+		elfp_main_vec_put_em(handle);
+		return NULL;
+	}
+
+	return lines;
+}
+
+/*
+ * All functions defined below are exposed to programmers.
+ *
+ * Refer to elfp.h for more details.
+ */
+
+unsigned long int
+elfp_line_count(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_line_count", "Handle failed the sanity test");
+		return 0;
+	}
+
+	elfp_main_lines *lines = NULL;
+	unsigned long int count;
+
+	lines = elfp_line_index_handle(handle);
+	if(lines == NULL)
+		return 0;
+
+	count = lines->count;
+	elfp_main_vec_put_em(handle);
+
+	return count;
+}
+
+int
+elfp_line_lookup(int handle, unsigned long int addr, elfp_line *line)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || line == NULL)
+	{
+		elfp_err_warn("elfp_line_lookup", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main_lines *lines = NULL;
+	int ret;
+
+	lines = elfp_line_index_handle(handle);
+	if(lines == NULL)
+		return -1;
+
+	ret = elfp_line_fill(lines, elfp_line_upper(lines, 0, lines->count,
+							addr), line);
+	elfp_main_vec_put_em(handle);
+
+	return ret;
+}
+
+long int
+elfp_line_lookup_many(int handle, const unsigned long int *addrs,
+			unsigned long int n, elfp_line *lines_out)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 ||
+			(n != 0 && (addrs == NULL || lines_out == NULL)))
+	{
+		elfp_err_warn("elfp_line_lookup_many", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main_lines *lines = NULL;
+	unsigned long int i, low, high, step, found;
+
+	lines = elfp_line_index_handle(handle);
+	if(lines == NULL)
+		return -1;
+
+	/* Walk the table and the addresses together. From where the last
+	 * address was found, gallop ahead to bracket the next one and
+	 * search only that. Close addresses cost a few compares */
+	found = 0;
+	low = 0;
+	for(i = 0; i < n; i++)
+	{
+		/* Out of order. Start over */
+		if(i != 0 && addrs[i] < addrs[i - 1])
+			low = 0;
+
+		high = low;
+		step = 1;
+		while(high < lines->count && lines->addrs[high] <= addrs[i])
+		{
+			low = high + 1;
+			high = high + step;
+			step = step * 2;
+		}
+		if(high > lines->count)
+			high = lines->count;
+
+		low = elfp_line_upper(lines, low, high, addrs[i]);
+		if(elfp_line_fill(lines, low, lines_out + i) == 0)
+			found = found + 1;
+	}
+
+	elfp_main_vec_put_em(handle);
+
+	return found;
+}
+
+int
+elfp_line_dump(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_line_dump", "Handle failed the sanity test");
+		return -1;
+	}
+
+	elfp_main_lines *lines = NULL;
+	const elfp_line_file *file = NULL;
+	unsigned long int i;
+
+	lines = elfp_line_index_handle(handle);
+	if(lines == NULL)
+		return -1;
+
+	printf("Line table: %lu rows, %lu files, %lu units", lines->count,
+					lines->n_files, lines->n_units);
+	if(lines->n_broken != 0)
+		printf(" (%lu broken)", lines->n_broken);
+	printf("\n");
+
+	for(i = 0; i < lines->count; i++)
+	{
+		printf("\t0x%016lx\t", lines->addrs[i]);
+		if(lines->files[i] == ELFP_LINE_END)
+		{
+			printf("(end of sequence)\n");
+			continue;
+		}
+
+		if(lines->files[i] == ELFP_LINE_NO_FILE)
+		{
+			printf("??:%u\n", lines->lines[i]);
+			continue;
+		}
+
+		file = lines->file_table + lines->files[i];
+		if(file->dir != NULL)
+			printf("%s/", file->dir);
+		printf("%s:%u\n", (file->name != NULL) ? file->name : "??",
+							lines->lines[i]);
+	}
+
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
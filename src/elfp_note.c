@@ -0,0 +1,1503 @@
+/*
+ * File: elfp_note.c
+ *
+ * Description: Parsing notes - PT_NOTE segments and SHT_NOTE sections.
+ *
+ * 	* Notes are found once per file and source, the first time they are
+ * 	asked for. Build-id, ABI tag, GNU properties and FDO package
+ * 	metadata are decoded from them.
+ * 	* elfp_note_build_id_fd() is a path of its own. It doesn't create
+ * 	an elfp_main object at all.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#include "./include/elfp_note.h"
+#include "./include/elfp_shdr.h"
+#include "./include/elfp_int.h"
+#include "./include/elfp_err.h"
+#include "./include/elfp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <elf.h>
+
+/* elfp_note_build_id_fd() reads this much from the start of the file in
+ * one go. The headers and the notes of most files are in it */
+#define ELFP_NOTE_HEAD_SIZE 4096
+
+/* Where a bunch of notes is in the file, and how they are aligned */
+typedef struct elfp_note_region
+{
+	unsigned long int offset;
+	unsigned long int size;
+	unsigned long int align;
+
+} elfp_note_region;
+
+/*
+ * elfp_note_align: Rounds up an offset to a multiple of align (4 / 8).
+ */
+static unsigned long int
+elfp_note_align(unsigned long int offset, unsigned long int align)
+{
+	return (offset + align - 1) & ~(align - 1);
+}
+
+int
+elfp_note_next(const unsigned char *buf, unsigned long int size,
+		unsigned long int *pos, unsigned long int align,
+		elfp_note *note)
+{
+	Elf64_Nhdr nhdr;
+	unsigned long int name_offset, desc_offset;
+
+	/* Elf32_Nhdr and Elf64_Nhdr are the same - three 4-byte words */
+	if(*pos > size || size - *pos < sizeof(Elf64_Nhdr))
+		return -1;
+
+	memcpy(&nhdr, buf + *pos, sizeof(Elf64_Nhdr));
+	name_offset = *pos + sizeof(Elf64_Nhdr);
+	if(nhdr.n_namesz > size - name_offset)
+		return -1;
+
+	desc_offset = elfp_note_align(name_offset + nhdr.n_namesz, align);
+	if(desc_offset > size || nhdr.n_descsz > size - desc_offset)
+		return -1;
+
+	/* The name should be NUL terminated, the NUL counted in n_namesz */
+	if(nhdr.n_namesz != 0 && buf[name_offset + nhdr.n_namesz - 1] == '\0')
+		note->name = (const char *)(buf + name_offset);
+	else
+		note->name = "";
+
+	note->type = nhdr.n_type;
+	note->desc = buf + desc_offset;
+	note->descsz = nhdr.n_descsz;
+
+	*pos = elfp_note_align(desc_offset + nhdr.n_descsz, align);
+
+	return 0;
+}
+
+/*
+ * elfp_note_regions_get: Finds where the notes of a source are.
+ *
+ * 	* On success, the caller should free() the array.
+ *
+ * @return: The regions on success, NULL on failure. *count is 0 if
+ * 	there are none.
+ */
+static elfp_note_region*
+elfp_note_regions_get(elfp_main *main, int source, unsigned long int *count)
+{
+	elfp_note_region *regions = NULL;
+	elfp_main_sections *sections = NULL;
+	const elfp_section *sec = NULL;
+	Elf64_Ehdr e64hdr;
+	Elf32_Ehdr e32hdr;
+	const Elf64_Phdr *p64hdr = NULL;
+	const Elf32_Phdr *p32hdr = NULL;
+	void *pht = NULL;
+	unsigned long int phoff, phnum, entsize, i, n;
+	unsigned long int type, offset, size, align;
+	int class, ret;
+
+	*count = 0;
+
+	/* 1. Sections */
+	if(source == ELFP_NOTES_SECTIONS)
+	{
+		sections = elfp_shdr_index_get(main);
+		if(sections == NULL)
+			return NULL;
+
+		regions = malloc((sections->count + 1) * sizeof(elfp_note_region));
+		if(regions == NULL)
+		{
+			elfp_err_warn("elfp_note_regions_get", "malloc() failed");
+			return NULL;
+		}
+
+		n = 0;
+		for(i = 0; i < sections->count; i++)
+		{
+			sec = sections->secs + i;
+			if(sec->type != SHT_NOTE || sec->size == 0)
+				continue;
+
+			regions[n].offset = sec->offset;
+			regions[n].size = sec->size;
+			regions[n].align = (sec->addralign == 8) ? 8 : 4;
+			n++;
+		}
+
+		*count = n;
+		return regions;
+	}
+
+	/* 2. Segments. Get a copy of the PHT */
+	class = elfp_main_get_class(main);
+	if(class == ELFCLASS32)
+	{
+		ret = elfp_main_read(main, 0, sizeof(Elf32_Ehdr), &e32hdr);
+		phoff = e32hdr.e_phoff;
+		phnum = e32hdr.e_phnum;
+		entsize = sizeof(Elf32_Phdr);
+		if(ret == -1 || e32hdr.e_phentsize != entsize)
+			phnum = 0;
+	}
+	else
+	{
+		ret = elfp_main_read(main, 0, sizeof(Elf64_Ehdr), &e64hdr);
+		phoff = e64hdr.e_phoff;
+		phnum = e64hdr.e_phnum;
+		entsize = sizeof(Elf64_Phdr);
+		if(ret == -1 || e64hdr.e_phentsize != entsize)
+			phnum = 0;
+	}
+
+	regions = malloc((phnum + 1) * sizeof(elfp_note_region));
+	pht = malloc(phnum * entsize + 1);
+	if(regions == NULL || pht == NULL)
+	{
+		elfp_err_warn("elfp_note_regions_get", "malloc() failed");
+		free(regions);
+		free(pht);
+		return NULL;
+	}
+
+	if(phnum == 0 || elfp_main_read(main, phoff, phnum * entsize, pht) == -1)
+	{
+		free(pht);
+		return regions;
+	}
+
+	p64hdr = pht;
+	p32hdr = pht;
+	n = 0;
+	for(i = 0; i < phnum; i++)
+	{
+		if(class == ELFCLASS32)
+		{
+			type = p32hdr[i].p_type;
+			offset = p32hdr[i].p_offset;
+			size = p32hdr[i].p_filesz;
+			align = p32hdr[i].p_align;
+		}
+		else
+		{
+			type = p64hdr[i].p_type;
+			offset = p64hdr[i].p_offset;
+			size = p64hdr[i].p_filesz;
+			align = p64hdr[i].p_align;
+		}
+
+		if(type != PT_NOTE || size == 0)
+			continue;
+
+		/* A segment which says it is bigger than the file is cut
+		 * down to what is there */
+		if(offset > main->file_size)
+			continue;
+		if(size > main->file_size - offset)
+			size = main->file_size - offset;
+
+		regions[n].offset = offset;
+		regions[n].size = size;
+		regions[n].align = (align == 8) ? 8 : 4;
+		n++;
+	}
+
+	free(pht);
+
+	*count = n;
+	return regions;
+}
+
+/*
+ * elfp_note_json_space: Skips white space of a JSON text.
+ */
+static const char*
+elfp_note_json_space(const char *p, const char *end)
+{
+	while(p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+		p++;
+
+	return p;
+}
+
+/*
+ * elfp_note_json_hex4: Decodes the 4 hex digits of a \u escape.
+ *
+ * @return: The code unit, -1 if they are not hex digits.
+ */
+static long int
+elfp_note_json_hex4(const char *p, const char *end)
+{
+	long int val = 0;
+	int i;
+
+	if(end - p < 4)
+		return -1;
+
+	for(i = 0; i < 4; i++)
+	{
+		val = val * 16;
+		if(p[i] >= '0' && p[i] <= '9')
+			val += p[i] - '0';
+		else if(p[i] >= 'a' && p[i] <= 'f')
+			val += p[i] - 'a' + 10;
+		else if(p[i] >= 'A' && p[i] <= 'F')
+			val += p[i] - 'A' + 10;
+		else
+			return -1;
+	}
+
+	return val;
+}
+
+/*
+ * elfp_note_json_string: Parses a JSON string.
+ *
+ * @arg0: Reference to an elfp_main object. NULL if the string is only
+ * 	to be skipped.
+ * @arg1: Reference to the current position, at the opening quote.
+ * 	Moved past the closing quote.
+ * @arg2: End of the text
+ * @arg3: The string, unescaped, from the arena. Not touched if @arg0
+ * 	is NULL.
+ *
+ * @return: 0 on success, -1 if it is not a valid string.
+ */
+static int
+elfp_note_json_string(elfp_main *main, const char **pos, const char *end,
+							const char **out)
+{
+	const char *p = *pos;
+	char *str = NULL;
+	unsigned long int len = 0;
+	long int code, low;
+
+	if(p >= end || *p != '"')
+		return -1;
+	p++;
+
+	/* Unescaped, it is never longer than it is in the text */
+	if(main != NULL)
+	{
+		str = elfp_main_alloc(main, end - p + 1);
+		if(str == NULL)
+			return -1;
+	}
+
+	while(p < end && *p != '"')
+	{
+		if(*p != '\\')
+		{
+			if(str != NULL)
+				str[len++] = *p;
+			p++;
+			continue;
+		}
+
+		p++;
+		if(p >= end)
+			return -1;
+
+		switch(*p)
+		{
+			case '"':
+			case '\\':
+			case '/':
+				code = *p;
+				break;
+
+			case 'b':
+				code = '\b';
+				break;
+
+			case 'f':
+				code = '\f';
+				break;
+
+			case 'n':
+				code = '\n';
+				break;
+
+			case 'r':
+				code = '\r';
+				break;
+
+			case 't':
+				code = '\t';
+				break;
+
+			case 'u':
+				code = elfp_note_json_hex4(p + 1, end);
+				if(code == -1)
+					return -1;
+				p += 4;
+
+				/* A surrogate pair is one character */
+				if(code >= 0xd800 && code <= 0xdbff && end - p >= 7 &&
+						p[1] == '\\' && p[2] == 'u')
+				{
+					low = elfp_note_json_hex4(p + 3, end);
+					if(low >= 0xdc00 && low <= 0xdfff)
+					{
+						code = 0x10000 + ((code - 0xd800) << 10) +
+								(low - 0xdc00);
+						p += 6;
+					}
+				}
+				break;
+
+			default:
+				return -1;
+		}
+		p++;
+
+		if(str == NULL)
+			continue;
+
+		/* Back to UTF-8. A \u escape takes 6 bytes of text, which
+		 * is more than its UTF-8 form ever needs */
+		if(code < 0x80)
+		{
+			str[len++] = code;
+		}
+		else if(code < 0x800)
+		{
+			str[len++] = 0xc0 | (code >> 6);
+			str[len++] = 0x80 | (code & 0x3f);
+		}
+		else if(code < 0x10000)
+		{
+			str[len++] = 0xe0 | (code >> 12);
+			str[len++] = 0x80 | ((code >> 6) & 0x3f);
+			str[len++] = 0x80 | (code & 0x3f);
+		}
+		else
+		{
+			str[len++] = 0xf0 | (code >> 18);
+			str[len++] = 0x80 | ((code >> 12) & 0x3f);
+			str[len++] = 0x80 | ((code >> 6) & 0x3f);
+			str[len++] = 0x80 | (code & 0x3f);
+		}
+	}
+
+	if(p >= end)
+		return -1;
+
+	if(str != NULL)
+	{
+		str[len] = '\0';
+		*out = str;
+	}
+
+	*pos = p + 1;
+	return 0;
+}
+
+/*
+ * elfp_note_json_skip: Skips a JSON value - a number, true, an array etc.
+ *
+ * @return: 0 on success, -1 if it is not a valid value.
+ */
+static int
+elfp_note_json_skip(const char **pos, const char *end)
+{
+	const char *p = *pos;
+	unsigned long int depth = 0;
+	int ret;
+
+	do
+	{
+		p = elfp_note_json_space(p, end);
+		if(p >= end)
+			return -1;
+
+		if(*p == '"')
+		{
+			ret = elfp_note_json_string(NULL, &p, end, NULL);
+			if(ret == -1)
+				return -1;
+		}
+		else if(*p == '{' || *p == '[')
+		{
+			depth++;
+			p++;
+		}
+		else if(*p == '}' || *p == ']')
+		{
+			if(depth == 0)
+				return -1;
+			depth--;
+			p++;
+		}
+		else if(*p == ',' || *p == ':')
+		{
+			if(depth == 0)
+				return -1;
+			p++;
+		}
+		else
+		{
+			/* A literal / number. It ends where the value does */
+			while(p < end && *p != ',' && *p != '}' && *p != ']' &&
+				*p != ' ' && *p != '\t' && *p != '\n' && *p != '\r')
+				p++;
+		}
+	} while(depth != 0);
+
+	*pos = p;
+	return 0;
+}
+
+/*
+ * elfp_note_package_decode: Decodes an NT_FDO_PACKAGING_METADATA note.
+ * 	* The descriptor is a JSON object. Its string members are picked
+ * 	up, everything else is skipped.
+ *
+ * @return: 0 on success, -1 if it is not a JSON object.
+ */
+static int
+elfp_note_package_decode(elfp_main *main, const elfp_note *note,
+						elfp_package *package)
+{
+	static const struct
+	{
+		const char *key;
+		unsigned long int offset;
+	} members[] = {
+		{"type", offsetof(elfp_package, type)},
+		{"name", offsetof(elfp_package, name)},
+		{"version", offsetof(elfp_package, version)},
+		{"architecture", offsetof(elfp_package, architecture)},
+		{"os", offsetof(elfp_package, os)},
+		{"osVersion", offsetof(elfp_package, os_version)},
+		{"debugInfoUrl", offsetof(elfp_package, debug_info_url)},
+	};
+
+	const char *desc = note->desc;
+	const char *p = NULL, *end = NULL, *key = NULL, *value = NULL;
+	unsigned long int len, i;
+	char *json = NULL;
+	int ret;
+
+	memset(package, 0, sizeof(elfp_package));
+
+	/* The descriptor is NUL terminated, and padded. Keep a terminated
+	 * copy if it isn't */
+	len = strnlen(desc, note->descsz);
+	if(len < note->descsz)
+	{
+		package->json = desc;
+	}
+	else
+	{
+		json = elfp_main_alloc(main, len + 1);
+		if(json == NULL)
+			return -1;
+		memcpy(json, desc, len);
+		json[len] = '\0';
+		package->json = json;
+	}
+
+	p = elfp_note_json_space(package->json, package->json + len);
+	end = package->json + len;
+	if(p >= end || *p != '{')
+		return -1;
+	p = elfp_note_json_space(p + 1, end);
+	if(p < end && *p == '}')
+		return 0;
+
+	while(p < end)
+	{
+		ret = elfp_note_json_string(main, &p, end, &key);
+		if(ret == -1)
+			return -1;
+
+		p = elfp_note_json_space(p, end);
+		if(p >= end || *p != ':')
+			return -1;
+		p = elfp_note_json_space(p + 1, end);
+
+		if(p < end && *p == '"')
+		{
+			ret = elfp_note_json_string(main, &p, end, &value);
+			if(ret == -1)
+				return -1;
+
+			for(i = 0; i < sizeof(members) / sizeof(members[0]); i++)
+			{
+				if(strcmp(key, members[i].key) == 0)
+				{
+					*(const char **)((char *)package +
+						members[i].offset) = value;
+					break;
+				}
+			}
+		}
+		else
+		{
+			ret = elfp_note_json_skip(&p, end);
+			if(ret == -1)
+				return -1;
+		}
+
+		p = elfp_note_json_space(p, end);
+		if(p < end && *p == '}')
+			return 0;
+		if(p >= end || *p != ',')
+			return -1;
+		p = elfp_note_json_space(p + 1, end);
+	}
+
+	return -1;
+}
+
+/*
+ * elfp_note_properties_decode: Decodes an NT_GNU_PROPERTY_TYPE_0 note.
+ *
+ * @arg0: Reference to an elfp_main object
+ * @arg1: The note
+ * @arg2: Reference to an elfp_gnu_properties. Filled up by the function.
+ */
+static void
+elfp_note_properties_decode(elfp_main *main, const elfp_note *note,
+					elfp_gnu_properties *props)
+{
+	const unsigned char *desc = note->desc;
+	unsigned long int pos, align, value;
+	uint32_t pr_type, pr_datasz, val32;
+	uint64_t val64;
+	uint16_t machine = EM_NONE;
+
+	memset(props, 0, sizeof(elfp_gnu_properties));
+
+	/* e_machine comes right after e_type, in both classes */
+	elfp_main_read(main, EI_NIDENT + 2, sizeof(machine), &machine);
+
+	/* Properties are aligned like the class' addresses */
+	align = (elfp_main_get_class(main) == ELFCLASS32) ? 4 : 8;
+
+	pos = 0;
+	while(note->descsz - pos >= 2 * sizeof(uint32_t))
+	{
+		memcpy(&pr_type, desc + pos, sizeof(pr_type));
+		memcpy(&pr_datasz, desc + pos + sizeof(pr_type), sizeof(pr_datasz));
+		pos += 2 * sizeof(uint32_t);
+		if(pr_datasz > note->descsz - pos)
+			break;
+
+		value = 0;
+		if(pr_datasz == sizeof(val32))
+		{
+			memcpy(&val32, desc + pos, sizeof(val32));
+			value = val32;
+		}
+		else if(pr_datasz == sizeof(val64))
+		{
+			memcpy(&val64, desc + pos, sizeof(val64));
+			value = val64;
+		}
+
+		props->count++;
+		switch(pr_type)
+		{
+			case GNU_PROPERTY_STACK_SIZE:
+				props->stack_size = value;
+				break;
+
+			case GNU_PROPERTY_NO_COPY_ON_PROTECTED:
+				props->no_copy_on_protected = 1;
+				break;
+
+			case GNU_PROPERTY_1_NEEDED:
+				props->needed_1 = value;
+				break;
+
+			case GNU_PROPERTY_X86_FEATURE_1_AND:
+				if(machine == EM_X86_64 || machine == EM_386)
+					props->x86_feature_1 = value;
+				break;
+
+			case GNU_PROPERTY_X86_ISA_1_NEEDED:
+				if(machine == EM_X86_64 || machine == EM_386)
+					props->x86_isa_1_needed = value;
+				break;
+
+			case GNU_PROPERTY_X86_ISA_1_USED:
+				if(machine == EM_X86_64 || machine == EM_386)
+					props->x86_isa_1_used = value;
+				break;
+
+			case GNU_PROPERTY_AARCH64_FEATURE_1_AND:
+				if(machine == EM_AARCH64)
+					props->aarch64_feature_1 = value;
+				break;
+
+			default:
+				break;
+		}
+
+		pos = elfp_note_align(pos + pr_datasz, align);
+		if(pos > note->descsz)
+			break;
+	}
+}
+
+/*
+ * elfp_note_index_build: Finds all the notes of a source.
+ *
+ * @return: NULL on failure, the index on success.
+ */
+static elfp_main_notes*
+elfp_note_index_build(elfp_main *main, int source)
+{
+	elfp_main_notes *notes = NULL;
+	elfp_note_region *regions = NULL;
+	const unsigned char *buf = NULL;
+	unsigned long int n_regions, i, pos, start, n;
+	elfp_note note;
+	int pass, ret;
+
+	notes = elfp_main_alloc(main, sizeof(elfp_main_notes));
+	if(notes == NULL)
+	{
+		elfp_err_warn("elfp_note_index_build", "elfp_main_alloc() failed");
+		return NULL;
+	}
+
+	regions = elfp_note_regions_get(main, source, &n_regions);
+	if(regions == NULL)
+	{
+		elfp_err_warn("elfp_note_index_build",
+					"elfp_note_regions_get() failed");
+		return NULL;
+	}
+
+	/* Count them first, then fill them up. Notes are few, walking
+	 * them twice costs nothing */
+	for(pass = 0; pass < 2; pass++)
+	{
+		n = 0;
+		for(i = 0; i < n_regions; i++)
+		{
+			buf = elfp_main_get_range(main, regions[i].offset,
+							regions[i].size);
+			if(buf == NULL)
+				continue;
+
+			pos = 0;
+			start = 0;
+			while(elfp_note_next(buf, regions[i].size, &pos,
+						regions[i].align, &note) == 0)
+			{
+				if(pass == 1)
+				{
+					note.offset = regions[i].offset + start;
+					notes->notes[n] = note;
+				}
+				n++;
+				start = pos;
+			}
+		}
+
+		if(pass == 1 || n == 0)
+			break;
+
+		notes->notes = elfp_main_alloc(main, n * sizeof(elfp_note));
+		if(notes->notes == NULL)
+		{
+			elfp_err_warn("elfp_note_index_build",
+						"elfp_main_alloc() failed");
+			free(regions);
+			return NULL;
+		}
+	}
+
+	free(regions);
+	notes->count = n;
+
+	/* The package metadata needs unescaping. Do it once, here */
+	for(i = 0; i < notes->count; i++)
+	{
+		if(notes->notes[i].type != NT_FDO_PACKAGING_METADATA ||
+				strcmp(notes->notes[i].name, "FDO") != 0)
+			continue;
+
+		ret = elfp_note_package_decode(main, notes->notes + i,
+							&notes->package);
+		if(ret == 0)
+			notes->has_package = 1;
+		break;
+	}
+
+	return notes;
+}
+
+elfp_main_notes*
+elfp_note_index_get(elfp_main *main, int source)
+{
+	/* Basic check */
+	if(main == NULL ||
+		(source != ELFP_NOTES_SEGMENTS && source != ELFP_NOTES_SECTIONS))
+	{
+		elfp_err_warn("elfp_note_index_get", "Invalid argument(s) passed");
+		return NULL;
+	}
+
+	elfp_main_notes *notes = NULL;
+	elfp_main_notes **slot = NULL;
+
+	slot = &main->notes[source - ELFP_NOTES_SEGMENTS];
+
+	/* Built already? */
+	notes = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+	if(notes != NULL)
+		return notes;
+
+	/* Sections need the section index, which takes index_lock itself.
+	 * Get that out of the way first. Segments need nothing else */
+	if(source == ELFP_NOTES_SECTIONS && elfp_shdr_index_get(main) == NULL)
+	{
+		elfp_err_warn("elfp_note_index_get", "elfp_shdr_index_get() failed");
+		return NULL;
+	}
+
+	/* Only one thread builds it. Others wait and use it */
+	pthread_mutex_lock(&main->index_lock);
+	notes = *slot;
+	if(notes == NULL)
+	{
+		notes = elfp_note_index_build(main, source);
+		if(notes != NULL)
+			__atomic_store_n(slot, notes, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&main->index_lock);
+
+	if(notes == NULL)
+		elfp_err_warn("elfp_note_index_get", "elfp_note_index_build() failed");
+
+	return notes;
+}
+
+/*
+ * elfp_note_source_get: Gets a handle's object and the notes of the
+ * 	source asked for. ELFP_NOTES_DEFAULT is the segments if they have
+ * 	notes, the sections otherwise.
+ *
+ * 	* On success, the caller should elfp_main_vec_put_em() the handle.
+ *
+ * @return: NULL on failure, the index on success.
+ */
+static elfp_main_notes*
+elfp_note_source_get(int handle, int source, elfp_main **main_out)
+{
+	elfp_main *main = NULL;
+	elfp_main_notes *notes = NULL;
+
+	if(source != ELFP_NOTES_DEFAULT && source != ELFP_NOTES_SEGMENTS &&
+					source != ELFP_NOTES_SECTIONS)
+	{
+		elfp_err_warn("elfp_note_source_get", "Invalid source");
+		return NULL;
+	}
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_note_source_get", "elfp_main_vec_get_em() failed");
+		return NULL;
+	}
+
+	if(source == ELFP_NOTES_DEFAULT)
+	{
+		notes = elfp_note_index_get(main, ELFP_NOTES_SEGMENTS);
+		if(notes != NULL && notes->count == 0)
+			notes = elfp_note_index_get(main, ELFP_NOTES_SECTIONS);
+	}
+	else
+		notes = elfp_note_index_get(main, source);
+
+	if(notes == NULL)
+	{
+		elfp_err_warn("elfp_note_source_get", "elfp_note_index_get() failed");
+		elfp_main_vec_put_em(handle);
+		return NULL;
+	}
+
+	*main_out = main;
+	return notes;
+}
+
+/*
+ * elfp_note_lookup: Finds the first note of an owner and type.
+ *
+ * @return: The note, NULL if there is none.
+ */
+static const elfp_note*
+elfp_note_lookup(elfp_main_notes *notes, const char *name,
+					unsigned long int type)
+{
+	unsigned long int i;
+
+	for(i = 0; i < notes->count; i++)
+	{
+		if(notes->notes[i].type == type &&
+				strcmp(notes->notes[i].name, name) == 0)
+			return notes->notes + i;
+	}
+
+	return NULL;
+}
+
+/*
+ * elfp_note_abi_tag_decode: Decodes an NT_GNU_ABI_TAG note.
+ *
+ * @return: 0 on success, -1 if the note is broken.
+ */
+static int
+elfp_note_abi_tag_decode(const elfp_note *note, elfp_abi_tag *tag)
+{
+	uint32_t words[4];
+
+	if(note->descsz < sizeof(words))
+		return -1;
+
+	memcpy(words, note->desc, sizeof(words));
+	tag->os = words[0];
+	tag->major = words[1];
+	tag->minor = words[2];
+	tag->patch = words[3];
+
+	return 0;
+}
+
+/*
+ * elfp_note_decode_abi_os: Decodes the OS of an ABI tag.
+ */
+static const char*
+elfp_note_decode_abi_os(unsigned long int os)
+{
+	switch(os)
+	{
+		case ELF_NOTE_OS_LINUX:
+			return "Linux";
+
+		case ELF_NOTE_OS_GNU:
+			return "Hurd";
+
+		case ELF_NOTE_OS_SOLARIS2:
+			return "Solaris";
+
+		case ELF_NOTE_OS_FREEBSD:
+			return "FreeBSD";
+
+		default:
+			return "Unknown";
+	}
+}
+
+/*
+ * elfp_note_dump_desc: Dumps what is known about a note's descriptor.
+ */
+static void
+elfp_note_dump_desc(elfp_main *main, elfp_main_notes *notes,
+					const elfp_note *note)
+{
+	const unsigned char *desc = note->desc;
+	elfp_gnu_properties props;
+	elfp_abi_tag tag;
+	unsigned long int i;
+
+	if(strcmp(note->name, "GNU") == 0)
+	{
+		switch(note->type)
+		{
+			case NT_GNU_BUILD_ID:
+				printf("\t\tBuild ID: ");
+				for(i = 0; i < note->descsz; i++)
+					printf("%02x", desc[i]);
+				printf("\n");
+				return;
+
+			case NT_GNU_ABI_TAG:
+				if(elfp_note_abi_tag_decode(note, &tag) == 0)
+					printf("\t\tOS: %s, ABI: %lu.%lu.%lu\n",
+						elfp_note_decode_abi_os(tag.os),
+						tag.major, tag.minor, tag.patch);
+				return;
+
+			case NT_GNU_GOLD_VERSION:
+				printf("\t\tVersion: %.*s\n", (int)note->descsz,
+							(const char *)desc);
+				return;
+
+			case NT_GNU_PROPERTY_TYPE_0:
+				elfp_note_properties_decode(main, note, &props);
+				printf("\t\tProperties: %lu\n", props.count);
+				if(props.stack_size != 0)
+					printf("\t\tStack size: 0x%lx\n", props.stack_size);
+				if(props.no_copy_on_protected != 0)
+					printf("\t\tNo copy on protected\n");
+				if(props.needed_1 != 0)
+					printf("\t\t1_needed: 0x%lx\n", props.needed_1);
+				if(props.x86_feature_1 != 0)
+					printf("\t\tx86 feature: 0x%lx\n",
+							props.x86_feature_1);
+				if(props.x86_isa_1_needed != 0)
+					printf("\t\tx86 ISA needed: 0x%lx\n",
+							props.x86_isa_1_needed);
+				if(props.x86_isa_1_used != 0)
+					printf("\t\tx86 ISA used: 0x%lx\n",
+							props.x86_isa_1_used);
+				if(props.aarch64_feature_1 != 0)
+					printf("\t\tAArch64 feature: 0x%lx\n",
+							props.aarch64_feature_1);
+				return;
+
+			default:
+				return;
+		}
+	}
+
+	if(strcmp(note->name, "FDO") == 0 &&
+			note->type == NT_FDO_PACKAGING_METADATA &&
+			notes->has_package != 0)
+		printf("\t\tPackage: %s\n", notes->package.json);
+}
+
+/*
+ * elfp_note_build_id_range: Reads a range of the file for
+ * 	elfp_note_build_id_fd(). Ranges inside the first bytes of the file,
+ * 	which are read already, are not read again.
+ * 	* Sizes come from the PHT. A range which is not inside the file is
+ * 	refused before anything is allocated for it.
+ *
+ * @return: Address of the range on success, NULL on failure. If it had
+ * 	to be read, *to_free is set and should be free()d.
+ */
+static const unsigned char*
+elfp_note_build_id_range(int fd, const unsigned char *head,
+		unsigned long int head_size, unsigned long int file_size,
+		unsigned long int offset, unsigned long int size,
+		unsigned char **to_free)
+{
+	unsigned char *buf = NULL;
+	ssize_t nread;
+
+	*to_free = NULL;
+	if(offset <= head_size && size <= head_size - offset)
+		return head + offset;
+
+	if(offset > file_size || size > file_size - offset)
+		return NULL;
+
+	buf = malloc(size + 1);
+	if(buf == NULL)
+		return NULL;
+
+	nread = pread(fd, buf, size, offset);
+	if(nread < 0 || (unsigned long int)nread != size)
+	{
+		free(buf);
+		return NULL;
+	}
+
+	*to_free = buf;
+	return buf;
+}
+
+/*
+ * All functions defined below are exposed to programmers.
+ *
+ * Refer to elfp.h for more details.
+ */
+
+unsigned long int
+elfp_note_count(int handle, int source)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_note_count", "Handle failed the sanity test");
+		return 0;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_notes *notes = NULL;
+	unsigned long int count;
+
+	notes = elfp_note_source_get(handle, source, &main);
+	if(notes == NULL)
+		return 0;
+
+	count = notes->count;
+	elfp_main_vec_put_em(handle);
+
+	return count;
+}
+
+int
+elfp_note_get(int handle, int source, unsigned long int index,
+						elfp_note *note)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || note == NULL)
+	{
+		elfp_err_warn("elfp_note_get", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_notes *notes = NULL;
+
+	notes = elfp_note_source_get(handle, source, &main);
+	if(notes == NULL)
+		return -1;
+
+	if(index >= notes->count)
+	{
+		elfp_err_warn("elfp_note_get", "Index failed the sanity test");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	*note = notes->notes[index];
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
+
+int
+elfp_note_find(int handle, const char *name, unsigned long int type,
+						elfp_note *note)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || name == NULL || note == NULL)
+	{
+		elfp_err_warn("elfp_note_find", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_notes *notes = NULL;
+	const elfp_note *found = NULL;
+
+	notes = elfp_note_source_get(handle, ELFP_NOTES_DEFAULT, &main);
+	if(notes == NULL)
+		return -1;
+
+	found = elfp_note_lookup(notes, name, type);
+	if(found != NULL)
+		*note = *found;
+	elfp_main_vec_put_em(handle);
+
+	return (found != NULL) ? 0 : -1;
+}
+
+const unsigned char*
+elfp_note_build_id(int handle, unsigned long int *size)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || size == NULL)
+	{
+		elfp_err_warn("elfp_note_build_id", "Invalid argument(s) passed");
+		return NULL;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_notes *notes = NULL;
+	const elfp_note *found = NULL;
+
+	notes = elfp_note_source_get(handle, ELFP_NOTES_DEFAULT, &main);
+	if(notes == NULL)
+		return NULL;
+
+	found = elfp_note_lookup(notes, "GNU", NT_GNU_BUILD_ID);
+	elfp_main_vec_put_em(handle);
+	if(found == NULL || found->descsz == 0)
+		return NULL;
+
+	*size = found->descsz;
+	return found->desc;
+}
+
+int
+elfp_note_abi_tag(int handle, elfp_abi_tag *tag)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || tag == NULL)
+	{
+		elfp_err_warn("elfp_note_abi_tag", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_notes *notes = NULL;
+	const elfp_note *found = NULL;
+	int ret = -1;
+
+	notes = elfp_note_source_get(handle, ELFP_NOTES_DEFAULT, &main);
+	if(notes == NULL)
+		return -1;
+
+	found = elfp_note_lookup(notes, "GNU", NT_GNU_ABI_TAG);
+	if(found != NULL)
+		ret = elfp_note_abi_tag_decode(found, tag);
+	elfp_main_vec_put_em(handle);
+
+	return ret;
+}
+
+int
+elfp_note_gnu_properties(int handle, elfp_gnu_properties *props)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || props == NULL)
+	{
+		elfp_err_warn("elfp_note_gnu_properties",
+					"Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_notes *notes = NULL;
+	const elfp_note *found = NULL;
+
+	notes = elfp_note_source_get(handle, ELFP_NOTES_DEFAULT, &main);
+	if(notes == NULL)
+		return -1;
+
+	found = elfp_note_lookup(notes, "GNU", NT_GNU_PROPERTY_TYPE_0);
+	if(found != NULL)
+		elfp_note_properties_decode(main, found, props);
+	elfp_main_vec_put_em(handle);
+
+	return (found != NULL) ? 0 : -1;
+}
+
+int
+elfp_note_package(int handle, elfp_package *package)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || package == NULL)
+	{
+		elfp_err_warn("elfp_note_package", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_notes *notes = NULL;
+	int ret = -1;
+
+	notes = elfp_note_source_get(handle, ELFP_NOTES_DEFAULT, &main);
+	if(notes == NULL)
+		return -1;
+
+	if(notes->has_package != 0)
+	{
+		*package = notes->package;
+		ret = 0;
+	}
+	elfp_main_vec_put_em(handle);
+
+	return ret;
+}
+
+int
+elfp_note_dump(int handle, int source)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_note_dump", "Handle failed the sanity test");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_notes *notes = NULL;
+	const elfp_note *note = NULL;
+	unsigned long int i;
+
+	notes = elfp_note_source_get(handle, source, &main);
+	if(notes == NULL)
+		return -1;
+
+	printf("%lu notes found\n", notes->count);
+	if(notes->count != 0)
+		printf("\tOffset\t\tOwner\t\tData size\tDescription\n");
+
+	for(i = 0; i < notes->count; i++)
+	{
+		note = notes->notes + i;
+		printf("\t0x%08lx\t%-8s\t0x%08lx\t%s\n", note->offset,
+			note->name, note->descsz,
+			elfp_note_decode_type(note->name, note->type));
+		elfp_note_dump_desc(main, notes, note);
+	}
+
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
+
+const char*
+elfp_note_decode_type(const char *name, unsigned long int type)
+{
+	if(name == NULL)
+		return "Unknown";
+
+	if(strcmp(name, "GNU") == 0)
+	{
+		switch(type)
+		{
+			case NT_GNU_ABI_TAG:
+				return "NT_GNU_ABI_TAG (ABI version tag)";
+
+			case NT_GNU_HWCAP:
+				return "NT_GNU_HWCAP (DSO-supplied software HWCAP info)";
+
+			case NT_GNU_BUILD_ID:
+				return "NT_GNU_BUILD_ID (unique build ID bitstring)";
+
+			case NT_GNU_GOLD_VERSION:
+				return "NT_GNU_GOLD_VERSION (gold version)";
+
+			case NT_GNU_PROPERTY_TYPE_0:
+				return "NT_GNU_PROPERTY_TYPE_0 (program properties)";
+
+			default:
+				return "Unknown";
+		}
+	}
+
+	if(strcmp(name, "FDO") == 0 && type == NT_FDO_PACKAGING_METADATA)
+		return "NT_FDO_PACKAGING_METADATA (package metadata)";
+
+	if(strcmp(name, "stapsdt") == 0 && type == 3)
+		return "NT_STAPSDT (SystemTap probe descriptors)";
+
+	if(strcmp(name, "Go") == 0 && type == 4)
+		return "GO BUILDID";
+
+	if(strcmp(name, "CORE") == 0 || strcmp(name, "LINUX") == 0)
+	{
+		switch(type)
+		{
+			case NT_PRSTATUS:
+				return "NT_PRSTATUS (prstatus structure)";
+
+			case NT_FPREGSET:
+				return "NT_FPREGSET (floating point registers)";
+
+			case NT_PRPSINFO:
+				return "NT_PRPSINFO (prpsinfo structure)";
+
+			case NT_AUXV:
+				return "NT_AUXV (auxiliary vector)";
+
+			case NT_SIGINFO:
+				return "NT_SIGINFO (siginfo_t data)";
+
+			case NT_FILE:
+				return "NT_FILE (mapped files)";
+
+			case NT_X86_XSTATE:
+				return "NT_X86_XSTATE (x86 XSAVE extended state)";
+
+			default:
+				return "Unknown";
+		}
+	}
+
+	return "Unknown";
+}
+
+long int
+elfp_note_build_id_fd(int fd, unsigned char *buf, unsigned long int size)
+{
+	/* Basic check */
+	if(fd < 0 || buf == NULL)
+	{
+		elfp_err_warn("elfp_note_build_id_fd", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	unsigned char head[ELFP_NOTE_HEAD_SIZE];
+	unsigned char *pht_buf = NULL, *note_buf = NULL;
+	const unsigned char *pht = NULL, *notes = NULL;
+	Elf64_Ehdr e64hdr;
+	Elf32_Ehdr e32hdr;
+	Elf64_Phdr p64hdr;
+	Elf32_Phdr p32hdr;
+	unsigned long int head_size, phoff, phnum, entsize, i, pos;
+	unsigned long int type, offset, filesz, align;
+	long int ret = 0;
+	elfp_note note;
+	struct stat st;
+	ssize_t nread;
+	int class, found = 0;
+
+	/* Ranges the PHT asks for are checked against this */
+	if(fstat(fd, &st) == -1)
+	{
+		elfp_err_warn("elfp_note_build_id_fd", "fstat() failed");
+		return -1;
+	}
+
+	/* 1. The ELF header, and whatever comes after it. Usually that has
+	 * the PHT and the notes */
+	nread = pread(fd, head, sizeof(head), 0);
+	if(nread < (ssize_t)sizeof(Elf32_Ehdr) || memcmp(head, ELFMAG, SELFMAG) != 0)
+	{
+		elfp_err_warn("elfp_note_build_id_fd", "Not an ELF file");
+		return -1;
+	}
+	head_size = nread;
+
+	class = head[EI_CLASS];
+	if(class == ELFCLASS32)
+	{
+		memcpy(&e32hdr, head, sizeof(Elf32_Ehdr));
+		phoff = e32hdr.e_phoff;
+		phnum = e32hdr.e_phnum;
+		entsize = sizeof(Elf32_Phdr);
+		if(e32hdr.e_phentsize != entsize)
+			phnum = 0;
+	}
+	else if(class == ELFCLASS64 && head_size >= sizeof(Elf64_Ehdr))
+	{
+		memcpy(&e64hdr, head, sizeof(Elf64_Ehdr));
+		phoff = e64hdr.e_phoff;
+		phnum = e64hdr.e_phnum;
+		entsize = sizeof(Elf64_Phdr);
+		if(e64hdr.e_phentsize != entsize)
+			phnum = 0;
+	}
+	else
+	{
+		elfp_err_warn("elfp_note_build_id_fd", "Invalid class");
+		return -1;
+	}
+
+	if(phnum == 0)
+		return 0;
+
+	/* 2. The PHT */
+	pht = elfp_note_build_id_range(fd, head, head_size, st.st_size, phoff,
+					phnum * entsize, &pht_buf);
+	if(pht == NULL)
+	{
+		elfp_err_warn("elfp_note_build_id_fd", "PHT can't be read");
+		return -1;
+	}
+
+	/* 3. Notes of every PT_NOTE, till the build-id turns up */
+	for(i = 0; i < phnum && found == 0; i++)
+	{
+		if(class == ELFCLASS32)
+		{
+			memcpy(&p32hdr, pht + i * entsize, sizeof(p32hdr));
+			type = p32hdr.p_type;
+			offset = p32hdr.p_offset;
+			filesz = p32hdr.p_filesz;
+			align = p32hdr.p_align;
+		}
+		else
+		{
+			memcpy(&p64hdr, pht + i * entsize, sizeof(p64hdr));
+			type = p64hdr.p_type;
+			offset = p64hdr.p_offset;
+			filesz = p64hdr.p_filesz;
+			align = p64hdr.p_align;
+		}
+
+		if(type != PT_NOTE || filesz == 0)
+			continue;
+
+		notes = elfp_note_build_id_range(fd, head, head_size, st.st_size,
+						offset, filesz, &note_buf);
+		if(notes == NULL)
+			continue;
+
+		pos = 0;
+		while(elfp_note_next(notes, filesz, &pos, (align == 8) ? 8 : 4,
+								&note) == 0)
+		{
+			if(note.type != NT_GNU_BUILD_ID ||
+					strcmp(note.name, "GNU") != 0)
+				continue;
+
+			found = 1;
+			if(note.descsz > size)
+			{
+				elfp_err_warn("elfp_note_build_id_fd",
+						"Buffer is too small");
+				ret = -1;
+				break;
+			}
+
+			memcpy(buf, note.desc, note.descsz);
+			ret = note.descsz;
+			break;
+		}
+
+		free(note_buf);
+		note_buf = NULL;
+	}
+
+	free(pht_buf);
+
+	return ret;
+}
+
+long int
+elfp_note_build_id_path(const char *path, unsigned char *buf,
+						unsigned long int size)
+{
+	/* Basic check */
+	if(path == NULL || buf == NULL)
+	{
+		elfp_err_warn("elfp_note_build_id_path", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	long int ret;
+	int fd;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if(fd == -1)
+	{
+		elfp_err_warn("elfp_note_build_id_path", "open() failed");
+		return -1;
+	}
+
+	ret = elfp_note_build_id_fd(fd, buf, size);
+	close(fd);
+
+	return ret;
+}
@@ -46,8 +46,8 @@ elfp_pht_get(int handle)
         int ret;
         elfp_main *main = NULL;
         void *pht = NULL;
-        Elf64_Ehdr *e64hdr = NULL;
-        Elf32_Ehdr *e32hdr = NULL;
+        Elf64_Ehdr e64hdr;
+        Elf32_Ehdr e32hdr;
 	unsigned long int class;
 
         /* Get the class */
@@ -58,34 +58,48 @@ elfp_pht_get(int handle)
 		return NULL;
 	}
 
+	class = elfp_main_get_class(main);
+
         /* Return based on class */
         switch(class)
         {
                 case ELFCLASS32:
-                        e32hdr = (Elf32_Ehdr *)elfp_main_get_staddr(main);
+			ret = elfp_main_read(main, 0, sizeof(Elf32_Ehdr), &e32hdr);
 			/* Check if this has no Program Headers */
-			if(e32hdr->e_phnum == 0)
+			if(ret == -1 || e32hdr.e_phnum == 0)
 			{
 				elfp_err_warn("elfp_pht_get",
 				"This ELF file has no Program Headers");
+				elfp_main_vec_put_em(handle);
 				return NULL;
 			}
-                        pht = ((unsigned char *)e32hdr + e32hdr->e_phoff);
-                        return pht;
+			pht = elfp_main_get_range(main, e32hdr.e_phoff,
+					e32hdr.e_phnum * sizeof(Elf32_Phdr));
+			break;
 
                 /*ELFCLASS64, anything else will be treated as 64-bit objects */
                 default:                                         
-			e64hdr = (Elf64_Ehdr *)elfp_main_get_staddr(main);
+			ret = elfp_main_read(main, 0, sizeof(Elf64_Ehdr), &e64hdr);
 			/* Check if this has no Program Headers */
-			if(e64hdr->e_phnum == 0)
+			if(ret == -1 || e64hdr.e_phnum == 0)
 			{
 				elfp_err_warn("elfp_pht_get",
 				"This ELF file has no Program Headers");
+				elfp_main_vec_put_em(handle);
 				return NULL;
 			}
-			pht = ((unsigned char *)e64hdr + e64hdr->e_phoff);
-			return pht;
+			pht = elfp_main_get_range(main, e64hdr.e_phoff,
+					e64hdr.e_phnum * sizeof(Elf64_Phdr));
 	}
+
+	/* The pointer outlives our reference. The caller must not let the
+	 * handle be closed while using it - refer elfp.h */
+	elfp_main_vec_put_em(handle);
+
+	if(pht == NULL)
+		elfp_err_warn("elfp_pht_get", "elfp_main_get_range() failed");
+
+	return pht;
 }
 
 int
@@ -102,12 +116,17 @@ elfp_pht_dump(int handle)
         elfp_main *main = NULL;
         unsigned long int class;
         unsigned long int phnum;
-        Elf64_Ehdr *e64hdr = NULL;
-        Elf32_Ehdr *e32hdr = NULL;
+        Elf64_Ehdr e64hdr;
+        Elf32_Ehdr e32hdr;
         unsigned int i;
         
         /* Get the class */
         main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_pht_dump", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
         class = elfp_main_get_class(main);
         /* Get the total number of headers.
          *
@@ -125,20 +144,22 @@ elfp_pht_dump(int handle)
         switch(class)
         {
                 case ELFCLASS32:
-                        e32hdr = (Elf32_Ehdr *)elfp_main_get_staddr(main);
-                        phnum = e32hdr->e_phnum;
-                        break;
-
-                case ELFCLASS64:
-                        e64hdr = (Elf64_Ehdr *)elfp_main_get_staddr(main);
-                        phnum = e64hdr->e_phnum;
+                        ret = elfp_main_read(main, 0, sizeof(Elf32_Ehdr), &e32hdr);
+                        phnum = e32hdr.e_phnum;
                         break;
 
-		/* Anything else is also considered as 64-bit object */
+		/* ELFCLASS64. Anything else is also considered as 64-bit object */
                 default:
-                        e64hdr = (Elf64_Ehdr *)elfp_main_get_staddr(main);
-                        phnum = e64hdr->e_phnum;
+                        ret = elfp_main_read(main, 0, sizeof(Elf64_Ehdr), &e64hdr);
+                        phnum = e64hdr.e_phnum;
         }
+	elfp_main_vec_put_em(handle);
+
+	if(ret == -1)
+	{
+		elfp_err_warn("elfp_pht_dump", "elfp_main_read() failed");
+		return -1;
+	}
         
         /* Check if there are any program headers */
         if(phnum == 0)
@@ -171,13 +192,18 @@ elfp_pht_dump(int handle)
 static int
 elfp_p64hdr_dump(elfp_main *main, int index)
 {
-	Elf64_Ehdr *ehdr = NULL;
+	Elf64_Ehdr ehdr;
 	unsigned int phnum;
-	Elf64_Phdr *phdr = NULL;
+	Elf64_Phdr header;
+	Elf64_Phdr *phdr = &header;
 	unsigned int i;
 
-	ehdr = (Elf64_Ehdr *)elfp_main_get_staddr(main);
-	phnum = ehdr->e_phnum;
+	if(elfp_main_read(main, 0, sizeof(Elf64_Ehdr), &ehdr) == -1)
+	{
+		elfp_err_warn("elfp_p64hdr_dump", "elfp_main_read() failed");
+		return -1;
+	}
+	phnum = ehdr.e_phnum;
 
 	/* Sanitize the index */
 	if(index < 0 || index >= phnum)
@@ -187,8 +213,12 @@ elfp_p64hdr_dump(elfp_main *main, int index)
 	}
 	
 	/* Get the header */
-	phdr = (Elf64_Phdr *)((unsigned char *)ehdr + ehdr->e_phoff);
-	phdr = phdr + index;
+	if(elfp_main_read(main, ehdr.e_phoff + index * sizeof(Elf64_Phdr),
+					sizeof(Elf64_Phdr), phdr) == -1)
+	{
+		elfp_err_warn("elfp_p64hdr_dump", "elfp_main_read() failed");
+		return -1;
+	}
 	
 	/* Dump them */
 	i = 0;
@@ -224,24 +254,33 @@ elfp_p64hdr_dump(elfp_main *main, int index)
 static int
 elfp_p32hdr_dump(elfp_main *main, int index)
 {
-	Elf32_Ehdr *ehdr = NULL;
+	Elf32_Ehdr ehdr;
 	unsigned int phnum;
-	Elf32_Phdr *phdr = NULL;
+	Elf32_Phdr header;
+	Elf32_Phdr *phdr = &header;
 	unsigned int i;
 
-	ehdr = (Elf32_Ehdr *)elfp_main_get_staddr(main);
-	phnum = ehdr->e_phnum;
+	if(elfp_main_read(main, 0, sizeof(Elf32_Ehdr), &ehdr) == -1)
+	{
+		elfp_err_warn("elfp_p32hdr_dump", "elfp_main_read() failed");
+		return -1;
+	}
+	phnum = ehdr.e_phnum;
 
 	/* Sanitize the index */
 	if(index < 0 || index >= phnum)
 	{
-		elfp_err_warn("elfp_p64hdr_dump", "Index failed the sanity test");
+		elfp_err_warn("elfp_p32hdr_dump", "Index failed the sanity test");
 		return -1;
 	}
 	
 	/* Get the header */
-	phdr = (Elf32_Phdr *)((unsigned char *)ehdr + ehdr->e_phoff);
-	phdr = phdr + index;
+	if(elfp_main_read(main, ehdr.e_phoff + index * sizeof(Elf32_Phdr),
+					sizeof(Elf32_Phdr), phdr) == -1)
+	{
+		elfp_err_warn("elfp_p32hdr_dump", "elfp_main_read() failed");
+		return -1;
+	}
 	
 	/* Dump them */
 	i = 0;
@@ -324,6 +363,8 @@ elfp_phdr_dump(int handle, int index)
 			elfp_p64hdr_dump(main, index);
 	}
 
+	elfp_main_vec_put_em(handle);
+
 	return 0;
 }
 
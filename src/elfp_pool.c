@@ -0,0 +1,125 @@
+/*
+ * File: elfp_pool.c
+ *
+ * Description: Definitions to all functions declared in elfp_pool.h
+ *
+ * 		* Internal to the tool. Users should not use these functions.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#include "./include/elfp_err.h"
+#include "./include/elfp_pool.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+/*
+ * State shared by all the workers of one elfp_pool_run() call.
+ */
+typedef struct elfp_pool_run_state
+{
+	/* Next task to be picked up */
+	unsigned long int next;
+
+	/* Total number of tasks */
+	unsigned long int n_tasks;
+
+	elfp_pool_task task;
+	void *arg;
+
+} elfp_pool_run_state;
+
+static void*
+elfp_pool_worker(void *ptr)
+{
+	elfp_pool_run_state *state = ptr;
+	unsigned long int i;
+
+	/* Keep picking up tasks till there are none left */
+	while(1)
+	{
+		i = __atomic_fetch_add(&state->next, 1, __ATOMIC_RELAXED);
+		if(i >= state->n_tasks)
+			break;
+
+		state->task(state->arg, i);
+	}
+
+	return NULL;
+}
+
+int
+elfp_pool_run(unsigned long int n_tasks, unsigned int n_threads,
+		elfp_pool_task task, void *arg)
+{
+	/* Basic check */
+	if(task == NULL)
+	{
+		elfp_err_warn("elfp_pool_run", "NULL argument passed");
+		return -1;
+	}
+
+	elfp_pool_run_state state;
+	pthread_t threads[ELFP_POOL_MAX_THREADS];
+	unsigned int n_created;
+	unsigned int i;
+	long ncpus;
+
+	if(n_tasks == 0)
+		return 0;
+
+	/* Decide how many threads to use */
+	if(n_threads == 0)
+	{
+		ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+		n_threads = (ncpus > 0) ? (unsigned int)ncpus : 1;
+	}
+
+	if(n_threads > ELFP_POOL_MAX_THREADS)
+		n_threads = ELFP_POOL_MAX_THREADS;
+
+	/* No point in having more threads than tasks */
+	if(n_threads > n_tasks)
+		n_threads = n_tasks;
+
+	state.next = 0;
+	state.n_tasks = n_tasks;
+	state.task = task;
+	state.arg = arg;
+
+	/* The calling thread is also a worker. So, create one less */
+	n_created = 0;
+	for(i = 0; i + 1 < n_threads; i++)
+	{
+		if(pthread_create(&threads[i], NULL, elfp_pool_worker, &state) != 0)
+		{
+			/* Whatever could not be picked up by the threads created so
+			 * far will be picked up by the calling thread */
+			elfp_err_warn("elfp_pool_run", "pthread_create() failed");
+			break;
+		}
+		n_created = n_created + 1;
+	}
+
+	elfp_pool_worker(&state);
+
+	/* Wait for everyone to finish */
+	for(i = 0; i < n_created; i++)
+		pthread_join(threads[i], NULL);
+
+	return 0;
+}
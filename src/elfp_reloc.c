@@ -0,0 +1,1014 @@
+/*
+ * File: elfp_reloc.c
+ *
+ * Description: Parsing relocations - REL, RELA and RELR tables, of the
+ * 	DYNAMIC segment or the sections.
+ *
+ * 	* Tables are found once per file and source, the first time they
+ * 	are asked for. Relocations are decoded straight from the file when
+ * 	they are read. Nothing is copied.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#include "./include/elfp_reloc.h"
+#include "./include/elfp_dyn.h"
+#include "./include/elfp_shdr.h"
+#include "./include/elfp_sym.h"
+#include "./include/elfp_int.h"
+#include "./include/elfp_err.h"
+#include "./include/elfp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <elf.h>
+
+/* Relocations elfp_reloc_dump() reads at a time */
+#define ELFP_RELOC_DUMP_BATCH 256
+
+/*
+ * elfp_reloc_machine: Gets e_machine of a file.
+ *
+ * @return: e_machine, EM_NONE if it can't be read.
+ */
+static unsigned int
+elfp_reloc_machine(elfp_main *main)
+{
+	uint16_t machine = EM_NONE;
+
+	/* e_machine comes right after e_type, in both classes */
+	elfp_main_read(main, EI_NIDENT + 2, sizeof(machine), &machine);
+
+	return machine;
+}
+
+/*
+ * elfp_reloc_relative_type: Gets the R_*_RELATIVE type of a machine.
+ *
+ * @return: The type, 0 if not known.
+ */
+static unsigned long int
+elfp_reloc_relative_type(unsigned int machine)
+{
+	switch(machine)
+	{
+		case EM_X86_64:
+			return R_X86_64_RELATIVE;
+
+		case EM_386:
+			return R_386_RELATIVE;
+
+		case EM_AARCH64:
+			return R_AARCH64_RELATIVE;
+
+		case EM_ARM:
+			return R_ARM_RELATIVE;
+
+		case EM_RISCV:
+			return R_RISCV_RELATIVE;
+
+		case EM_PPC64:
+			return R_PPC64_RELATIVE;
+
+		case EM_S390:
+			return R_390_RELATIVE;
+
+		default:
+			return 0;
+	}
+}
+
+/*
+ * elfp_reloc_entsize: Size of an entry of a table of a kind.
+ */
+static unsigned long int
+elfp_reloc_entsize(int class, int kind)
+{
+	switch(kind)
+	{
+		case ELFP_RELOC_REL:
+			return (class == ELFCLASS32) ? sizeof(Elf32_Rel) :
+							sizeof(Elf64_Rel);
+
+		case ELFP_RELOC_RELA:
+			return (class == ELFCLASS32) ? sizeof(Elf32_Rela) :
+							sizeof(Elf64_Rela);
+
+		default:
+			return (class == ELFCLASS32) ? sizeof(Elf32_Word) :
+							sizeof(Elf64_Xword);
+	}
+}
+
+/*
+ * elfp_reloc_table_add: Adds a table to the index, if it can be read.
+ *
+ * @arg0: Reference to an elfp_main object
+ * @arg1: The index
+ * @arg2: ELFP_RELOC_REL / ELFP_RELOC_RELA / ELFP_RELOC_RELR
+ * @arg3: Name of the table
+ * @arg4, @arg5: Where the table is in the file
+ * @arg6: Size of an entry as the file says. 0 if it doesn't.
+ * @arg7: sh_info of the section. 0 for DYNAMIC tables.
+ * @arg8: ELFP_SYMTAB_* the table's symbols are in
+ */
+static void
+elfp_reloc_table_add(elfp_main *main, elfp_main_relocs *relocs, int kind,
+		const char *name, unsigned long int offset,
+		unsigned long int size, unsigned long int entsize,
+		unsigned long int info, int symtab)
+{
+	elfp_reloc_table *table = NULL;
+	const void *data = NULL;
+	unsigned long int expected;
+
+	if(offset == 0 || size == 0)
+		return;
+
+	expected = elfp_reloc_entsize(elfp_main_get_class(main), kind);
+	if(entsize != 0 && entsize != expected)
+	{
+		elfp_err_warn("elfp_reloc_table_add", "Unexpected entry size");
+		return;
+	}
+
+	data = elfp_main_get_range(main, offset, size);
+	if(data == NULL)
+		return;
+
+	table = relocs->tables + relocs->count;
+	table->kind = kind;
+	table->name = (name != NULL) ? name : "";
+	table->offset = offset;
+	table->size = size;
+	table->count = size / expected;
+	table->info = info;
+	relocs->data[relocs->count] = data;
+	relocs->symtabs[relocs->count] = symtab;
+	relocs->count++;
+}
+
+/*
+ * elfp_reloc_index_build: Finds the relocation tables of a source.
+ *
+ * @return: NULL on failure, the index on success.
+ */
+static elfp_main_relocs*
+elfp_reloc_index_build(elfp_main *main, int source)
+{
+	elfp_main_relocs *relocs = NULL;
+	elfp_main_dynamic *dynamic = NULL;
+	elfp_main_sections *sections = NULL;
+	const elfp_section *sec = NULL;
+	const elfp_dynamic *info = NULL;
+	elfp_dyn_table rela, rel, jmprel;
+	unsigned long int max, i;
+	int kind, symtab;
+
+	relocs = elfp_main_alloc(main, sizeof(elfp_main_relocs));
+	if(relocs == NULL)
+	{
+		elfp_err_warn("elfp_reloc_index_build", "elfp_main_alloc() failed");
+		return NULL;
+	}
+
+	relocs->relative = elfp_reloc_relative_type(elfp_reloc_machine(main));
+
+	if(source == ELFP_RELOC_DYNAMIC)
+	{
+		dynamic = elfp_dyn_index_get(main);
+		if(dynamic == NULL)
+			return NULL;
+		max = 4;
+	}
+	else
+	{
+		sections = elfp_shdr_index_get(main);
+		if(sections == NULL)
+			return NULL;
+		max = sections->count;
+	}
+
+	relocs->tables = elfp_main_alloc(main, max * sizeof(elfp_reloc_table) + 1);
+	relocs->data = elfp_main_alloc(main, max * sizeof(void *) + 1);
+	relocs->symtabs = elfp_main_alloc(main, max * sizeof(int) + 1);
+	if(relocs->tables == NULL || relocs->data == NULL || relocs->symtabs == NULL)
+	{
+		elfp_err_warn("elfp_reloc_index_build", "elfp_main_alloc() failed");
+		return NULL;
+	}
+
+	/* 1. Sections */
+	if(source == ELFP_RELOC_SECTIONS)
+	{
+		for(i = 0; i < sections->count; i++)
+		{
+			sec = sections->secs + i;
+			if(sec->type == SHT_RELA)
+				kind = ELFP_RELOC_RELA;
+			else if(sec->type == SHT_REL)
+				kind = ELFP_RELOC_REL;
+			else if(sec->type == SHT_RELR)
+				kind = ELFP_RELOC_RELR;
+			else
+				continue;
+
+			symtab = ELFP_SYMTAB_STATIC;
+			if(sec->link < sections->count &&
+				sections->secs[sec->link].type == SHT_DYNSYM)
+				symtab = ELFP_SYMTAB_DYNAMIC;
+
+			elfp_reloc_table_add(main, relocs, kind, sec->name,
+				sec->offset, sec->size, sec->entsize, sec->info,
+				symtab);
+		}
+
+		return relocs;
+	}
+
+	/* 2. The DYNAMIC segment */
+	info = &dynamic->info;
+	rela = info->rela;
+	rel = info->rel;
+	jmprel = info->jmprel;
+
+	/* Some linkers count the PLT relocations in DT_RELASZ / DT_RELSZ as
+	 * well. Don't count them twice */
+	if(jmprel.size != 0)
+	{
+		if(info->pltrel == DT_RELA && jmprel.offset > rela.offset &&
+				jmprel.offset < rela.offset + rela.size)
+			rela.size = jmprel.offset - rela.offset;
+		if(info->pltrel == DT_REL && jmprel.offset > rel.offset &&
+				jmprel.offset < rel.offset + rel.size)
+			rel.size = jmprel.offset - rel.offset;
+	}
+
+	elfp_reloc_table_add(main, relocs, ELFP_RELOC_RELA, "DT_RELA",
+		rela.offset, rela.size, info->relaent, 0, ELFP_SYMTAB_DYNAMIC);
+	elfp_reloc_table_add(main, relocs, ELFP_RELOC_REL, "DT_REL",
+		rel.offset, rel.size, info->relent, 0, ELFP_SYMTAB_DYNAMIC);
+	elfp_reloc_table_add(main, relocs, ELFP_RELOC_RELR, "DT_RELR",
+		info->relr.offset, info->relr.size, 0, 0, ELFP_SYMTAB_DYNAMIC);
+
+	if(info->pltrel == DT_RELA)
+		elfp_reloc_table_add(main, relocs, ELFP_RELOC_RELA, "DT_JMPREL",
+			jmprel.offset, jmprel.size, info->relaent, 0,
+			ELFP_SYMTAB_DYNAMIC);
+	else if(info->pltrel == DT_REL)
+		elfp_reloc_table_add(main, relocs, ELFP_RELOC_REL, "DT_JMPREL",
+			jmprel.offset, jmprel.size, info->relent, 0,
+			ELFP_SYMTAB_DYNAMIC);
+
+	return relocs;
+}
+
+elfp_main_relocs*
+elfp_reloc_index_get(elfp_main *main, int source)
+{
+	/* Basic check */
+	if(main == NULL ||
+		(source != ELFP_RELOC_DYNAMIC && source != ELFP_RELOC_SECTIONS))
+	{
+		elfp_err_warn("elfp_reloc_index_get", "Invalid argument(s) passed");
+		return NULL;
+	}
+
+	elfp_main_relocs *relocs = NULL;
+	elfp_main_relocs **slot = NULL;
+	void *dep = NULL;
+
+	slot = &main->relocs[source - ELFP_RELOC_DYNAMIC];
+
+	/* Built already? */
+	relocs = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+	if(relocs != NULL)
+		return relocs;
+
+	/* The builder needs the dynamic / section index, which take
+	 * index_lock themselves. Get that out of the way first */
+	if(source == ELFP_RELOC_DYNAMIC)
+		dep = elfp_dyn_index_get(main);
+	else
+		dep = elfp_shdr_index_get(main);
+	if(dep == NULL)
+	{
+		elfp_err_warn("elfp_reloc_index_get", "Index the tables are in failed");
+		return NULL;
+	}
+
+	/* Only one thread builds it. Others wait and use it */
+	pthread_mutex_lock(&main->index_lock);
+	relocs = *slot;
+	if(relocs == NULL)
+	{
+		relocs = elfp_reloc_index_build(main, source);
+		if(relocs != NULL)
+			__atomic_store_n(slot, relocs, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&main->index_lock);
+
+	if(relocs == NULL)
+		elfp_err_warn("elfp_reloc_index_get", "elfp_reloc_index_build() failed");
+
+	return relocs;
+}
+
+/*
+ * elfp_reloc_source_get: Gets a handle's object and the relocation tables
+ * 	of the source asked for. ELFP_RELOC_DEFAULT is the DYNAMIC segment
+ * 	if it has relocations, the sections otherwise.
+ *
+ * 	* On success, the caller should elfp_main_vec_put_em() the handle.
+ *
+ * @return: NULL on failure, the index on success.
+ */
+static elfp_main_relocs*
+elfp_reloc_source_get(int handle, int source, elfp_main **main_out)
+{
+	elfp_main *main = NULL;
+	elfp_main_relocs *relocs = NULL;
+
+	if(source != ELFP_RELOC_DEFAULT && source != ELFP_RELOC_DYNAMIC &&
+					source != ELFP_RELOC_SECTIONS)
+	{
+		elfp_err_warn("elfp_reloc_source_get", "Invalid source");
+		return NULL;
+	}
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_reloc_source_get", "elfp_main_vec_get_em() failed");
+		return NULL;
+	}
+
+	if(source == ELFP_RELOC_DEFAULT)
+	{
+		relocs = elfp_reloc_index_get(main, ELFP_RELOC_DYNAMIC);
+		if(relocs != NULL && relocs->count == 0)
+			relocs = elfp_reloc_index_get(main, ELFP_RELOC_SECTIONS);
+	}
+	else
+		relocs = elfp_reloc_index_get(main, source);
+
+	if(relocs == NULL)
+	{
+		elfp_err_warn("elfp_reloc_source_get", "elfp_reloc_index_get() failed");
+		elfp_main_vec_put_em(handle);
+		return NULL;
+	}
+
+	*main_out = main;
+	return relocs;
+}
+
+/*
+ * elfp_reloc_decode: Decodes an entry of a REL / RELA table.
+ *
+ * @arg0: Reference to an iterator of the table
+ * @arg1: Index of the entry
+ * @arg2: Reference to an elfp_reloc. Filled up by the function.
+ */
+static void
+elfp_reloc_decode(const elfp_reloc_iter *iter, unsigned long int index,
+						elfp_reloc *reloc)
+{
+	const unsigned char *data = iter->data;
+	Elf64_Rela r64;
+	Elf32_Rela r32;
+
+	/* A REL entry is a RELA entry without the addend */
+	if(iter->class == ELFCLASS32)
+	{
+		if(iter->kind == ELFP_RELOC_RELA)
+			memcpy(&r32, data + index * sizeof(Elf32_Rela),
+							sizeof(Elf32_Rela));
+		else
+		{
+			memcpy(&r32, data + index * sizeof(Elf32_Rel),
+							sizeof(Elf32_Rel));
+			r32.r_addend = 0;
+		}
+
+		reloc->offset = r32.r_offset;
+		reloc->type = ELF32_R_TYPE(r32.r_info);
+		reloc->sym = ELF32_R_SYM(r32.r_info);
+		reloc->addend = r32.r_addend;
+	}
+	else
+	{
+		if(iter->kind == ELFP_RELOC_RELA)
+			memcpy(&r64, data + index * sizeof(Elf64_Rela),
+							sizeof(Elf64_Rela));
+		else
+		{
+			memcpy(&r64, data + index * sizeof(Elf64_Rel),
+							sizeof(Elf64_Rel));
+			r64.r_addend = 0;
+		}
+
+		reloc->offset = r64.r_offset;
+		reloc->type = ELF64_R_TYPE(r64.r_info);
+		reloc->sym = ELF64_R_SYM(r64.r_info);
+		reloc->addend = r64.r_addend;
+	}
+}
+
+/*
+ * elfp_reloc_relr_word: Gets a word of a RELR table.
+ */
+static unsigned long int
+elfp_reloc_relr_word(const elfp_reloc_iter *iter, unsigned long int index)
+{
+	uint64_t w64;
+	uint32_t w32;
+
+	if(iter->class == ELFCLASS32)
+	{
+		memcpy(&w32, (const unsigned char *)iter->data + index * 4, 4);
+		return w32;
+	}
+
+	memcpy(&w64, (const unsigned char *)iter->data + index * 8, 8);
+	return w64;
+}
+
+/*
+ * elfp_reloc_batch: Reads the next batch of relocations of a table.
+ * 	Either relocs or addrs is filled up.
+ *
+ * 	* RELR: An even word is an address to relocate. An odd word is a
+ * 	bitmap - bit i (from 1) says if the i'th word after the last one
+ * 	relocated is to be relocated too. Set bits are picked one by one
+ * 	with ctz(), so clear bits cost nothing.
+ *
+ * @return: Number of relocations read.
+ */
+static unsigned long int
+elfp_reloc_batch(elfp_reloc_iter *iter, elfp_reloc *relocs,
+		unsigned long int *addrs, unsigned long int max)
+{
+	unsigned long int n = 0, word, wordsize, addr, bit;
+	elfp_reloc reloc;
+
+	if(iter->kind != ELFP_RELOC_RELR)
+	{
+		for(; n < max && iter->pos < iter->count; n++, iter->pos++)
+		{
+			if(addrs == NULL)
+			{
+				elfp_reloc_decode(iter, iter->pos, relocs + n);
+			}
+			else
+			{
+				elfp_reloc_decode(iter, iter->pos, &reloc);
+				addrs[n] = reloc.offset;
+			}
+		}
+		return n;
+	}
+
+	wordsize = (iter->class == ELFCLASS32) ? 4 : 8;
+	while(n < max)
+	{
+		/* What is left of the current bitmap */
+		if(iter->bits != 0)
+		{
+			bit = __builtin_ctzl(iter->bits);
+			iter->bits = iter->bits & (iter->bits - 1);
+			addr = iter->bits_base + bit * wordsize;
+		}
+		else if(iter->pos < iter->count)
+		{
+			word = elfp_reloc_relr_word(iter, iter->pos);
+			iter->pos++;
+			if((word & 1) != 0)
+			{
+				iter->bits = word >> 1;
+				iter->bits_base = iter->base;
+				iter->base = iter->base + (wordsize * 8 - 1) * wordsize;
+				continue;
+			}
+
+			addr = word;
+			iter->base = word + wordsize;
+		}
+		else
+		{
+			break;
+		}
+
+		if(addrs != NULL)
+		{
+			addrs[n] = addr;
+		}
+		else
+		{
+			relocs[n].offset = addr;
+			relocs[n].type = iter->relative;
+			relocs[n].sym = 0;
+			relocs[n].addend = 0;
+		}
+		n++;
+	}
+
+	return n;
+}
+
+/*
+ * elfp_reloc_iter_setup: Sets up an iterator over a table of an index.
+ */
+static void
+elfp_reloc_iter_setup(elfp_main *main, elfp_main_relocs *relocs,
+		unsigned long int index, elfp_reloc_iter *iter)
+{
+	memset(iter, 0, sizeof(elfp_reloc_iter));
+	iter->data = relocs->data[index];
+	iter->count = relocs->tables[index].count;
+	iter->kind = relocs->tables[index].kind;
+	iter->class = elfp_main_get_class(main);
+	iter->relative = relocs->relative;
+}
+
+/*
+ * elfp_reloc_popcount: Number of bits set in a word.
+ * 	* __builtin_popcountl() is a call into libgcc unless the compiler
+ * 	may use the popcnt instruction, which is far slower than this.
+ */
+static unsigned long int
+elfp_reloc_popcount(uint64_t word)
+{
+	word = word - ((word >> 1) & 0x5555555555555555ULL);
+	word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+	word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+
+	return (word * 0x0101010101010101ULL) >> 56;
+}
+
+/*
+ * elfp_reloc_stats_table: Adds up the relocations of a table.
+ *
+ * 	* Only r_info of an entry is read. Loops are per class and free of
+ * 	branches, so that the compiler can vectorize them.
+ */
+static void
+elfp_reloc_stats_table(elfp_main *main, elfp_main_relocs *relocs,
+		unsigned long int index, elfp_reloc_stats *stats)
+{
+	const unsigned char *data = relocs->data[index];
+	const elfp_reloc_table *table = relocs->tables + index;
+	unsigned long int i, n = 0, symbolic = 0, type, entsize, relative;
+	uint64_t w64, odd;
+	uint32_t w32;
+	int class;
+
+	class = elfp_main_get_class(main);
+	relative = relocs->relative;
+
+	/* RELR: An address is one relocation, a bitmap as many as the bits
+	 * set in it. Nothing is expanded */
+	if(table->kind == ELFP_RELOC_RELR)
+	{
+		for(i = 0; i < table->count; i++)
+		{
+			if(class == ELFCLASS32)
+			{
+				memcpy(&w32, data + i * 4, 4);
+				w64 = w32;
+			}
+			else
+			{
+				memcpy(&w64, data + i * 8, 8);
+			}
+
+			odd = w64 & 1;
+			n += odd * elfp_reloc_popcount(w64 >> 1) + (1 - odd);
+		}
+
+		stats->total += n;
+		stats->relative += n;
+		stats->relr += n;
+		stats->relr_words += table->count;
+		if(relative < ELFP_RELOC_TYPES_MAX)
+			stats->types[relative] += n;
+		else
+			stats->other_types += n;
+		return;
+	}
+
+	/* R_*_RELATIVE is counted in types as well. Pick it up from there
+	 * in the end */
+	if(relative < ELFP_RELOC_TYPES_MAX)
+		n = stats->types[relative];
+
+	entsize = elfp_reloc_entsize(class, table->kind);
+	if(class == ELFCLASS32)
+	{
+		for(i = 0; i < table->count; i++)
+		{
+			memcpy(&w32, data + i * entsize + sizeof(Elf32_Addr), 4);
+			type = ELF32_R_TYPE(w32);
+			if(type < ELFP_RELOC_TYPES_MAX)
+				stats->types[type]++;
+			else
+				stats->other_types++;
+			symbolic += (ELF32_R_SYM(w32) != 0);
+		}
+	}
+	else
+	{
+		for(i = 0; i < table->count; i++)
+		{
+			memcpy(&w64, data + i * entsize + sizeof(Elf64_Addr), 8);
+			type = ELF64_R_TYPE(w64);
+			if(type < ELFP_RELOC_TYPES_MAX)
+				stats->types[type]++;
+			else
+				stats->other_types++;
+			symbolic += (ELF64_R_SYM(w64) != 0);
+		}
+	}
+
+	if(relative != 0 && relative < ELFP_RELOC_TYPES_MAX)
+		stats->relative += stats->types[relative] - n;
+
+	stats->total += table->count;
+	stats->symbolic += symbolic;
+	if(strcmp(table->name, "DT_JMPREL") == 0)
+		stats->plt += table->count;
+}
+
+/*
+ * All functions defined below are exposed to programmers.
+ *
+ * Refer to elfp.h for more details.
+ */
+
+unsigned long int
+elfp_reloc_table_count(int handle, int source)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_reloc_table_count", "Handle failed the sanity test");
+		return 0;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_relocs *relocs = NULL;
+	unsigned long int count;
+
+	relocs = elfp_reloc_source_get(handle, source, &main);
+	if(relocs == NULL)
+		return 0;
+
+	count = relocs->count;
+	elfp_main_vec_put_em(handle);
+
+	return count;
+}
+
+int
+elfp_reloc_table_get(int handle, int source, unsigned long int index,
+						elfp_reloc_table *table)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || table == NULL)
+	{
+		elfp_err_warn("elfp_reloc_table_get", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_relocs *relocs = NULL;
+
+	relocs = elfp_reloc_source_get(handle, source, &main);
+	if(relocs == NULL)
+		return -1;
+
+	if(index >= relocs->count)
+	{
+		elfp_err_warn("elfp_reloc_table_get", "Index failed the sanity test");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	*table = relocs->tables[index];
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
+
+int
+elfp_reloc_iter_init(int handle, int source, unsigned long int index,
+						elfp_reloc_iter *iter)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || iter == NULL)
+	{
+		elfp_err_warn("elfp_reloc_iter_init", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_relocs *relocs = NULL;
+
+	relocs = elfp_reloc_source_get(handle, source, &main);
+	if(relocs == NULL)
+		return -1;
+
+	if(index >= relocs->count)
+	{
+		elfp_err_warn("elfp_reloc_iter_init", "Index failed the sanity test");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	elfp_reloc_iter_setup(main, relocs, index, iter);
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
+
+long int
+elfp_reloc_read(int handle, elfp_reloc_iter *iter, elfp_reloc *relocs,
+						unsigned long int max)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || iter == NULL ||
+			iter->data == NULL || relocs == NULL)
+	{
+		elfp_err_warn("elfp_reloc_read", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	unsigned long int n;
+
+	/* The table is mapped as long as the handle is open */
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_reloc_read", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	n = elfp_reloc_batch(iter, relocs, NULL, max);
+	elfp_main_vec_put_em(handle);
+
+	return n;
+}
+
+long int
+elfp_reloc_read_addrs(int handle, elfp_reloc_iter *iter,
+		unsigned long int *addrs, unsigned long int max)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || iter == NULL ||
+			iter->data == NULL || addrs == NULL)
+	{
+		elfp_err_warn("elfp_reloc_read_addrs", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	unsigned long int n;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_reloc_read_addrs", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	n = elfp_reloc_batch(iter, NULL, addrs, max);
+	elfp_main_vec_put_em(handle);
+
+	return n;
+}
+
+int
+elfp_reloc_stats_get(int handle, int source, elfp_reloc_stats *stats)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || stats == NULL)
+	{
+		elfp_err_warn("elfp_reloc_stats_get", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_relocs *relocs = NULL;
+	unsigned long int i;
+
+	relocs = elfp_reloc_source_get(handle, source, &main);
+	if(relocs == NULL)
+		return -1;
+
+	memset(stats, 0, sizeof(elfp_reloc_stats));
+	for(i = 0; i < relocs->count; i++)
+		elfp_reloc_stats_table(main, relocs, i, stats);
+
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
+
+int
+elfp_reloc_dump(int handle, int source)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_reloc_dump", "Handle failed the sanity test");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_relocs *relocs = NULL;
+	elfp_main_symbols *symbols = NULL;
+	const elfp_reloc_table *table = NULL;
+	elfp_reloc *batch = NULL;
+	elfp_reloc_iter iter;
+	unsigned long int i, j, n;
+	unsigned int machine;
+	elfp_sym sym;
+
+	relocs = elfp_reloc_source_get(handle, source, &main);
+	if(relocs == NULL)
+		return -1;
+
+	batch = malloc(ELFP_RELOC_DUMP_BATCH * sizeof(elfp_reloc));
+	if(batch == NULL)
+	{
+		elfp_err_warn("elfp_reloc_dump", "malloc() failed");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	machine = elfp_reloc_machine(main);
+	printf("%lu relocation tables found\n", relocs->count);
+
+	for(i = 0; i < relocs->count; i++)
+	{
+		table = relocs->tables + i;
+		printf("\nRelocation table %s at offset 0x%lx contains %lu %s:\n",
+			table->name, table->offset, table->count,
+			(table->kind == ELFP_RELOC_RELR) ? "words" : "entries");
+		printf("\tOffset\t\t\tType\t\t\tSymbol + Addend\n");
+
+		/* Names of the symbols, if the table is there */
+		symbols = elfp_sym_index_get(main, relocs->symtabs[i]);
+
+		elfp_reloc_iter_setup(main, relocs, i, &iter);
+		while((n = elfp_reloc_batch(&iter, batch, NULL,
+					ELFP_RELOC_DUMP_BATCH)) != 0)
+		{
+			for(j = 0; j < n; j++)
+			{
+				printf("\t0x%016lx\t%-24s", batch[j].offset,
+					elfp_reloc_decode_type(machine,
+							batch[j].type));
+
+				if(batch[j].sym != 0 && symbols != NULL &&
+					batch[j].sym < symbols->count)
+				{
+					elfp_sym_decode(main, symbols, batch[j].sym,
+									&sym);
+					printf("%s", sym.name);
+				}
+				else if(batch[j].sym != 0)
+				{
+					printf("sym %lu", batch[j].sym);
+				}
+
+				if(table->kind == ELFP_RELOC_RELA)
+				{
+					if(batch[j].addend < 0)
+						printf(" - 0x%lx", -(unsigned long int)batch[j].addend);
+					else
+						printf(" + 0x%lx", batch[j].addend);
+				}
+				printf("\n");
+			}
+		}
+	}
+
+	free(batch);
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
+
+/* Names of x86-64 and i386 relocation types, by type. NULL for types
+ * which are not used */
+static const char *elfp_reloc_x86_64_names[] = {
+	"R_X86_64_NONE", "R_X86_64_64", "R_X86_64_PC32", "R_X86_64_GOT32",
+	"R_X86_64_PLT32", "R_X86_64_COPY", "R_X86_64_GLOB_DAT",
+	"R_X86_64_JUMP_SLOT", "R_X86_64_RELATIVE", "R_X86_64_GOTPCREL",
+	"R_X86_64_32", "R_X86_64_32S", "R_X86_64_16", "R_X86_64_PC16",
+	"R_X86_64_8", "R_X86_64_PC8", "R_X86_64_DTPMOD64",
+	"R_X86_64_DTPOFF64", "R_X86_64_TPOFF64", "R_X86_64_TLSGD",
+	"R_X86_64_TLSLD", "R_X86_64_DTPOFF32", "R_X86_64_GOTTPOFF",
+	"R_X86_64_TPOFF32", "R_X86_64_PC64", "R_X86_64_GOTOFF64",
+	"R_X86_64_GOTPC32", "R_X86_64_GOT64", "R_X86_64_GOTPCREL64",
+	"R_X86_64_GOTPC64", "R_X86_64_GOTPLT64", "R_X86_64_PLTOFF64",
+	"R_X86_64_SIZE32", "R_X86_64_SIZE64", "R_X86_64_GOTPC32_TLSDESC",
+	"R_X86_64_TLSDESC_CALL", "R_X86_64_TLSDESC", "R_X86_64_IRELATIVE",
+	"R_X86_64_RELATIVE64", NULL, NULL,
+	"R_X86_64_GOTPCRELX", "R_X86_64_REX_GOTPCRELX",
+};
+
+static const char *elfp_reloc_386_names[] = {
+	"R_386_NONE", "R_386_32", "R_386_PC32", "R_386_GOT32", "R_386_PLT32",
+	"R_386_COPY", "R_386_GLOB_DAT", "R_386_JMP_SLOT", "R_386_RELATIVE",
+	"R_386_GOTOFF", "R_386_GOTPC", "R_386_32PLT", NULL, NULL,
+	"R_386_TLS_TPOFF", "R_386_TLS_IE", "R_386_TLS_GOTIE",
+	"R_386_TLS_LE", "R_386_TLS_GD", "R_386_TLS_LDM", "R_386_16",
+	"R_386_PC16", "R_386_8", "R_386_PC8", "R_386_TLS_GD_32",
+	"R_386_TLS_GD_PUSH", "R_386_TLS_GD_CALL", "R_386_TLS_GD_POP",
+	"R_386_TLS_LDM_32", "R_386_TLS_LDM_PUSH", "R_386_TLS_LDM_CALL",
+	"R_386_TLS_LDM_POP", "R_386_TLS_LDO_32", "R_386_TLS_IE_32",
+	"R_386_TLS_LE_32", "R_386_TLS_DTPMOD32", "R_386_TLS_DTPOFF32",
+	"R_386_TLS_TPOFF32", "R_386_SIZE32", "R_386_TLS_GOTDESC",
+	"R_386_TLS_DESC_CALL", "R_386_TLS_DESC", "R_386_IRELATIVE",
+	"R_386_GOT32X",
+};
+
+const char*
+elfp_reloc_decode_type(unsigned int machine, unsigned long int type)
+{
+	switch(machine)
+	{
+		case EM_X86_64:
+			if(type < sizeof(elfp_reloc_x86_64_names) / sizeof(char *) &&
+					elfp_reloc_x86_64_names[type] != NULL)
+				return elfp_reloc_x86_64_names[type];
+			return "Unknown";
+
+		case EM_386:
+			if(type < sizeof(elfp_reloc_386_names) / sizeof(char *) &&
+					elfp_reloc_386_names[type] != NULL)
+				return elfp_reloc_386_names[type];
+			return "Unknown";
+
+		case EM_AARCH64:
+			switch(type)
+			{
+				case R_AARCH64_NONE:
+					return "R_AARCH64_NONE";
+
+				case R_AARCH64_ABS64:
+					return "R_AARCH64_ABS64";
+
+				case R_AARCH64_COPY:
+					return "R_AARCH64_COPY";
+
+				case R_AARCH64_GLOB_DAT:
+					return "R_AARCH64_GLOB_DAT";
+
+				case R_AARCH64_JUMP_SLOT:
+					return "R_AARCH64_JUMP_SLOT";
+
+				case R_AARCH64_RELATIVE:
+					return "R_AARCH64_RELATIVE";
+
+				case R_AARCH64_TLS_DTPMOD:
+					return "R_AARCH64_TLS_DTPMOD";
+
+				case R_AARCH64_TLS_DTPREL:
+					return "R_AARCH64_TLS_DTPREL";
+
+				case R_AARCH64_TLS_TPREL:
+					return "R_AARCH64_TLS_TPREL";
+
+				case R_AARCH64_TLSDESC:
+					return "R_AARCH64_TLSDESC";
+
+				case R_AARCH64_IRELATIVE:
+					return "R_AARCH64_IRELATIVE";
+
+				default:
+					return "Unknown";
+			}
+
+		default:
+			return "Unknown";
+	}
+}
@@ -28,6 +28,7 @@
 #include "./include/elfp_err.h"
 #include <elf.h>
 #include <string.h>
+#include <stdlib.h>
 
 /*
  * The following functions are internal to the library.
@@ -87,35 +88,33 @@ elfp_seg64_get(int handle, const char *seg_type, unsigned long int *ptr_count)
 	/* No sanity checks */
 
         int ret;
-        Elf64_Ehdr *ehdr = NULL;
+        Elf64_Ehdr ehdr;
         Elf64_Phdr *ph = NULL;
         Elf64_Phdr *pht = NULL;
 	elfp_main *main = NULL;
-        void *start_addr = NULL;
         int phnum;
         int enc_seg_type;
         int i;
-	unsigned long int count, total;
+	unsigned long int count, j;
 	void **ptr_arr = NULL;
-	elfp_ds_vector *free_vec = NULL;
-	void **temp = NULL;
 
-	/* Get the PHT */
-	pht = elfp_pht_get(handle);
-	if(pht == NULL)
-	{
-		elfp_err_warn("elfp_seg64_get", "elfp_pht_get() failed");
-		goto fail_err;
-	}
-		
+	/* Hold on to the object till we are done. Nobody can
+	 * unmap the file under us then */
+        main = elfp_main_vec_get_em(handle);
+        if(main == NULL)
+        {
+                elfp_err_warn("elfp_seg64_get", "elfp_main_vec_get_em() failed");
+                goto fail_err;
+        }
+
 	/* Get the total number of program headers */    
-        ehdr = elfp_ehdr_get(handle);    
-        if(ehdr == NULL)    
+        ret = elfp_main_read(main, 0, sizeof(Elf64_Ehdr), &ehdr);
+        if(ret == -1)    
         {    
-                elfp_err_warn("elfp_seg64_get", "elfp_ehdr_get() failed");    
+                elfp_err_warn("elfp_seg64_get", "elfp_main_read() failed");    
                 goto fail_err;   
         }    
-        phnum = ehdr->e_phnum;    
+        phnum = ehdr.e_phnum;    
             
         /* In case of corrupted headers:    
          * The upper bound is simply based on the datatype used to store the    
@@ -125,21 +124,21 @@ elfp_seg64_get(int handle, const char *seg_type, unsigned long int *ptr_count)
                 elfp_err_warn("elfp_seg64_get", "Invalid number of Program Headers");    
                 goto fail_err;
         }    
-	
-	/* Get the starting address of the ELF file mapped to memory */
-        main = elfp_main_vec_get_em(handle);
-        if(main == NULL)
-        {
-                elfp_err_warn("elfp_seg64_get", "elfp_main_vec_get_em() failed");
-                goto fail_err;
-        }
 
-        start_addr = elfp_main_get_staddr(main);
-        if(start_addr == NULL)
-        {
-                elfp_err_warn("elfp_seg64_get", "elfp_main_get_staddr() failed");
-                goto fail_err;
-        }
+	/* Get a copy of the PHT. It is needed only till we are done */
+	pht = malloc(phnum * sizeof(Elf64_Phdr));
+	if(pht == NULL)
+	{
+		elfp_err_warn("elfp_seg64_get", "malloc() failed");
+		goto fail_err;
+	}
+
+	ret = elfp_main_read(main, ehdr.e_phoff, phnum * sizeof(Elf64_Phdr), pht);
+	if(ret == -1)
+	{
+		elfp_err_warn("elfp_seg64_get", "elfp_main_read() failed");
+		goto fail_err;
+	}
 	
 	/* The user/programmer gives the segment name in string form.
          * We need to convert it into PT_XXXX form, so that it'll be easy
@@ -154,59 +153,16 @@ elfp_seg64_get(int handle, const char *seg_type, unsigned long int *ptr_count)
 	
 	/* Now comes the core part.
 	 *
-	 * 1. Allocate memory for the pointers.
-	 * 2. Add that pointer to the free-vector.
-	 * 3. Iterate through PHT and add the pointers.
+	 * 1. Count the segments of the requested type.
+	 * 2. Allocate exactly that many pointers from the arena.
+	 * 3. Iterate through PHT once more and fill the pointers.
 	 * 4. Update ptr_count
 	 */
-	
-	/* A naive way: Allocate memory for 5 segments.
-	 * realloc() to the rescue! */
-	ptr_arr = calloc(5, sizeof(void *));
-	if(ptr_arr == NULL)
-	{
-		elfp_err_warn("elfp_seg64_get", "malloc() failed");
-		goto fail_err;
-	}
-	
 	count = 0;
-	total = 5;
 	for(i = 0; i < phnum; i++)
 	{
-		ph = pht + i;
-		if(ph->p_type == enc_seg_type)
-		{	
-			/* If it has hit our limit, then */
-			if(count == total)
-			{	
-				temp = realloc(ptr_arr, (total + 5) * sizeof(void *));
-				if(temp == NULL)
-				{
-					elfp_err_warn("elfp_seg64_get", 
-					"realloc() failed. Unable to accomodate all segments of the given type");
-					/* We need to decide what to do here. Should we simply send
-					 * the segments collected so far to the caller, or should we abort
-					 * this operation, free up the memory and return an error.
-					 *
-					 * We are returning an error */
-					goto fail_free;
-				}
-				ptr_arr = temp;
-				total = total + 5;
-			}
-			/* If it is GNU_STACK, then p_flags is to be sent back
-			 * to the caller.*/
-			if(ph->p_type == PT_GNU_STACK)
-			{
-				ptr_arr[count] = (void *)(ph->p_flags);
-				count++;
-			}
-			else
-			{
-				ptr_arr[count] = (void *)(start_addr + ph->p_offset);
-				count++;
-			}
-		}
+		if(pht[i].p_type == enc_seg_type)
+			count++;
 	}
 	
 	/* What if there are no such segments?
@@ -219,39 +175,51 @@ elfp_seg64_get(int handle, const char *seg_type, unsigned long int *ptr_count)
 		
 		/* For this case, count will be 0 */
 		*ptr_count = 0;
-		free(ptr_arr);
+		free(pht);
+		elfp_main_vec_put_em(handle);
 		return NULL;
 	}
 
-	/* All set. We may have allocated more memory. Let us cut it */
-	if(count < total)
+	/* It lives as long as the handle. No need to track it */
+	ptr_arr = elfp_main_alloc(main, count * sizeof(void *));
+	if(ptr_arr == NULL)
 	{
-		temp = realloc(ptr_arr, count * sizeof(void *));
-		if(temp == NULL)
-		{
-			elfp_err_warn("elfp_seg64_get",
-			"realloc() failed. Unable to remove the extra memory allocated");
-			/* This shouldn't happen. But it may happen.
-			 * Let us just leave it. */
-		}
-		ptr_arr = temp;
+		elfp_err_warn("elfp_seg64_get", "elfp_main_alloc() failed");
+		goto fail_err;
 	}
 
-	/* Now, we have a pointer which we should add to the free address vector */
-	free_vec = elfp_main_get_freevec(main);
-	if(free_vec == NULL)
-	{
-		elfp_err_warn("elfp_seg64_get",
-				"elfp_main_get_freevec() failed");
-		goto fail_free;
-	}
-	
-	ret = elfp_ds_vector_add(free_vec, ptr_arr);
-	if(ret == -1)
+	j = 0;
+	for(i = 0; i < phnum; i++)
 	{
-		elfp_err_warn("elfp_seg64_get",
-				"elfp_ds_vector_add() failed");
-		goto fail_free;
+		ph = pht + i;
+		if(ph->p_type != enc_seg_type)
+			continue;
+
+		/* If it is GNU_STACK, then p_flags is to be sent back
+		 * to the caller.*/
+		if(ph->p_type == PT_GNU_STACK)
+		{
+			ptr_arr[j] = (void *)(unsigned long int)(ph->p_flags);
+		}
+		else
+		{
+			ptr_arr[j] = elfp_main_get_range(main,
+					ph->p_offset, ph->p_filesz);
+			if(ptr_arr[j] == NULL)
+			{
+				elfp_err_warn("elfp_seg64_get",
+				"Segment is outside the file / can't be mapped");
+
+				/* Let go of the ones mapped already */
+				while(j > 0)
+				{
+					j--;
+					elfp_main_put_range(main, ptr_arr[j]);
+				}
+				goto fail_err;
+			}
+		}
+		j++;
 	}
 	
 	/* At this point, we have an array of pointers, each pointer
@@ -259,18 +227,19 @@ elfp_seg64_get(int handle, const char *seg_type, unsigned long int *ptr_count)
 	 *
 	 * It is time to return */
 	*ptr_count = count;
+	free(pht);
+	elfp_main_vec_put_em(handle);
 	
 	return ptr_arr;
 
 
-
-fail_free:
-	free(ptr_arr);
-	
 /* For all erroneous cases, let us keep count to be 1.
  * This is how the caller identifies between no segments of that type
  * and an error which has occured here */
 fail_err:
+	free(pht);
+	if(main != NULL)
+		elfp_main_vec_put_em(handle);
 	*ptr_count = 1;
 	return NULL;
 }
@@ -282,35 +251,33 @@ elfp_seg32_get(int handle, const char *seg_type, unsigned long int *ptr_count)
 	/* No sanity checks */
 
         int ret;
-        Elf32_Ehdr *ehdr = NULL;
+        Elf32_Ehdr ehdr;
         Elf32_Phdr *ph = NULL;
 	Elf32_Phdr *pht = NULL;
         elfp_main *main = NULL;
-        void *start_addr = NULL;
         int phnum;
         int enc_seg_type;
         int i;
-	unsigned long int count, total;
+	unsigned long int count, j;
 	void **ptr_arr = NULL;
-	elfp_ds_vector *free_vec = NULL;
-	void **temp = NULL;
 	
-	/* Get the PHT */
-	pht = elfp_pht_get(handle);
-	if(pht == NULL)
-	{
-		elfp_err_warn("elfp_seg32_get", "elfp_pht_get() failed");
-		goto fail_err;
-	}
+	/* Hold on to the object till we are done. Nobody can
+	 * unmap the file under us then */
+        main = elfp_main_vec_get_em(handle);
+        if(main == NULL)
+        {
+                elfp_err_warn("elfp_seg32_get", "elfp_main_vec_get_em() failed");
+                goto fail_err;
+        }
 
 	/* Get the total number of program headers */    
-        ehdr = elfp_ehdr_get(handle);    
-        if(ehdr == NULL)    
+        ret = elfp_main_read(main, 0, sizeof(Elf32_Ehdr), &ehdr);
+        if(ret == -1)    
         {    
-                elfp_err_warn("elfp_seg32_get", "elfp_ehdr_get() failed");    
+                elfp_err_warn("elfp_seg32_get", "elfp_main_read() failed");    
                 goto fail_err;   
         }    
-        phnum = ehdr->e_phnum;    
+        phnum = ehdr.e_phnum;    
             
         /* In case of corrupted headers:    
          * The upper bound is simply based on the datatype used to store the    
@@ -318,23 +285,23 @@ elfp_seg32_get(int handle, const char *seg_type, unsigned long int *ptr_count)
         if(phnum == 0 || phnum > UINT16_MAX)    
         {    
                 elfp_err_warn("elfp_seg32_get", "Invalid number of Program Headers");    
-                goto fail_err;  
+                goto fail_err;
         }    
-	
-	/* Get the starting address of the ELF file mapped to memory */
-        main = elfp_main_vec_get_em(handle);
-        if(main == NULL)
-        {
-                elfp_err_warn("elfp_seg32_get", "elfp_main_vec_get_em() failed");
-        	goto fail_err;
-        }
 
-        start_addr = elfp_main_get_staddr(main);
-        if(start_addr == NULL)
-        {
-                elfp_err_warn("elfp_seg32_get", "elfp_main_get_staddr() failed");
-                goto fail_err;
-        }
+	/* Get a copy of the PHT. It is needed only till we are done */
+	pht = malloc(phnum * sizeof(Elf32_Phdr));
+	if(pht == NULL)
+	{
+		elfp_err_warn("elfp_seg32_get", "malloc() failed");
+		goto fail_err;
+	}
+
+	ret = elfp_main_read(main, ehdr.e_phoff, phnum * sizeof(Elf32_Phdr), pht);
+	if(ret == -1)
+	{
+		elfp_err_warn("elfp_seg32_get", "elfp_main_read() failed");
+		goto fail_err;
+	}
 	
 	/* The user/programmer gives the segment name in string form.
          * We need to convert it into PT_XXXX form, so that it'll be easy
@@ -349,59 +316,16 @@ elfp_seg32_get(int handle, const char *seg_type, unsigned long int *ptr_count)
 	
 	/* Now comes the core part.
 	 *
-	 * 1. Allocate memory for the pointers.
-	 * 2. Add that pointer to the free-vector.
-	 * 3. Iterate through PHT and add the pointers.
+	 * 1. Count the segments of the requested type.
+	 * 2. Allocate exactly that many pointers from the arena.
+	 * 3. Iterate through PHT once more and fill the pointers.
 	 * 4. Update ptr_count
 	 */
-	
-	/* A naive way: Allocate memory for 5 segments.
-	 * realloc() to the rescue! */
-	ptr_arr = calloc(5, sizeof(void *));
-	if(ptr_arr == NULL)
-	{
-		elfp_err_warn("elfp_seg32_get", "malloc() failed");
-		goto fail_err;
-	}
-	
 	count = 0;
-	total = 5;
 	for(i = 0; i < phnum; i++)
 	{
-		ph = pht + i;
-		if(ph->p_type == enc_seg_type)
-		{	
-			/* If it has hit our limit, then */
-			if(count == total)
-			{	
-				temp = realloc(ptr_arr, (total + 5) * sizeof(void *));
-				if(temp == NULL)
-				{
-					elfp_err_warn("elfp_seg32_get", 
-					"realloc() failed. Unable to accomodate all segments of the given type");
-					/* We need to decide what to do here. Should we simply send
-					 * the segments collected so far to the caller, or should we abort
-					 * this operation, free up the memory and return an error.
-					 *
-					 * We are returning an error */
-					goto fail_free;
-				}
-				ptr_arr = temp;
-				total = total + 5;
-			}
-                        /* If it is GNU_STACK, then p_flags is to be sent back
-                         * to the caller.*/
-                        if(ph->p_type == PT_GNU_STACK)
-                        {
-                                ptr_arr[count] = (void *)(ph->p_flags);
-                                count++;
-                        }
-                        else
-                        {
-                                ptr_arr[count] = (void *)(start_addr + ph->p_offset);
-                                count++;
-                        }
-		}
+		if(pht[i].p_type == enc_seg_type)
+			count++;
 	}
 	
 	/* What if there are no such segments?
@@ -414,38 +338,51 @@ elfp_seg32_get(int handle, const char *seg_type, unsigned long int *ptr_count)
 		
 		/* For this case, count will be 0 */
 		*ptr_count = 0;
-		goto fail_free;
+		free(pht);
+		elfp_main_vec_put_em(handle);
+		return NULL;
 	}
 
-	/* All set. We may have allocated more memory. Let us cut it */
-	if(count < total)
+	/* It lives as long as the handle. No need to track it */
+	ptr_arr = elfp_main_alloc(main, count * sizeof(void *));
+	if(ptr_arr == NULL)
 	{
-		temp = realloc(ptr_arr, count * sizeof(void *));
-		if(temp == NULL)
-		{
-			elfp_err_warn("elfp_seg32_get",
-			"realloc() failed. Unable to remove the extra memory allocated");
-			/* This shouldn't happen. But it may happen.
-			 * Let us just leave it. */
-		}
-		ptr_arr = temp;
+		elfp_err_warn("elfp_seg32_get", "elfp_main_alloc() failed");
+		goto fail_err;
 	}
 
-	/* Now, we have a pointer which we should add to the free address vector */
-	free_vec = elfp_main_get_freevec(main);
-	if(free_vec == NULL)
-	{
-		elfp_err_warn("elfp_seg32_get",
-				"elfp_main_get_freevec() failed");
-		goto fail_free;
-	}
-	
-	ret = elfp_ds_vector_add(free_vec, ptr_arr);
-	if(ret == -1)
+	j = 0;
+	for(i = 0; i < phnum; i++)
 	{
-		elfp_err_warn("elfp_seg32_get",
-				"elfp_ds_vector_add() failed");
-		goto fail_free;
+		ph = pht + i;
+		if(ph->p_type != enc_seg_type)
+			continue;
+
+		/* If it is GNU_STACK, then p_flags is to be sent back
+		 * to the caller.*/
+		if(ph->p_type == PT_GNU_STACK)
+		{
+			ptr_arr[j] = (void *)(unsigned long int)(ph->p_flags);
+		}
+		else
+		{
+			ptr_arr[j] = elfp_main_get_range(main,
+					ph->p_offset, ph->p_filesz);
+			if(ptr_arr[j] == NULL)
+			{
+				elfp_err_warn("elfp_seg32_get",
+				"Segment is outside the file / can't be mapped");
+
+				/* Let go of the ones mapped already */
+				while(j > 0)
+				{
+					j--;
+					elfp_main_put_range(main, ptr_arr[j]);
+				}
+				goto fail_err;
+			}
+		}
+		j++;
 	}
 	
 	/* At this point, we have an array of pointers, each pointer
@@ -453,17 +390,19 @@ elfp_seg32_get(int handle, const char *seg_type, unsigned long int *ptr_count)
 	 *
 	 * It is time to return */
 	*ptr_count = count;
+	free(pht);
+	elfp_main_vec_put_em(handle);
 	
 	return ptr_arr;
 
 
-fail_free:
-	free(ptr_arr);
-	
 /* For all erroneous cases, let us keep count to be 1.
  * This is how the caller identifies between no segments of that type
  * and an error which has occured here */
 fail_err:
+	free(pht);
+	if(main != NULL)
+		elfp_main_vec_put_em(handle);
 	*ptr_count = 1;
 	return NULL;
 }
@@ -488,7 +427,7 @@ elfp_seg_dump_gnu_stack(void **ptr_arr, unsigned long int ptr_count)
 
 	for(i = 0; i < ptr_count; i++)
 	{	
-		flags = (unsigned int)ptr_arr[i];
+		flags = (unsigned int)(unsigned long int)ptr_arr[i];
 		printf("Stack permissions: %s\n", elfp_phdr_decode_flags(flags));
 	}
 }
@@ -542,6 +481,26 @@ elfp_seg32_dump(int handle, const char *seg_type)
 			elfp_seg_dump_gnu_stack(ptr_arr, ptr_count);
 			return 0;
 
+		case PT_DYNAMIC:
+			ret = elfp_dyn_dump(handle);
+			if(ret == -1)
+			{
+				elfp_err_warn("elfp_seg32_dump",
+						"elfp_dyn_dump() failed");
+				return -1;
+			}
+			return 0;
+
+		case PT_NOTE:
+			ret = elfp_note_dump(handle, ELFP_NOTES_SEGMENTS);
+			if(ret == -1)
+			{
+				elfp_err_warn("elfp_seg32_dump",
+						"elfp_note_dump() failed");
+				return -1;
+			}
+			return 0;
+
 		default:
 			elfp_err_warn("elfp_seg32_dump",
 			"Still have to write parse code");
@@ -597,6 +556,26 @@ elfp_seg64_dump(int handle, const char *seg_type)
                         elfp_seg_dump_gnu_stack(ptr_arr, ptr_count);
                         return 0;
 
+		case PT_DYNAMIC:
+			ret = elfp_dyn_dump(handle);
+			if(ret == -1)
+			{
+				elfp_err_warn("elfp_seg64_dump",
+						"elfp_dyn_dump() failed");
+				return -1;
+			}
+			return 0;
+
+		case PT_NOTE:
+			ret = elfp_note_dump(handle, ELFP_NOTES_SEGMENTS);
+			if(ret == -1)
+			{
+				elfp_err_warn("elfp_seg64_dump",
+						"elfp_note_dump() failed");
+				return -1;
+			}
+			return 0;
+
 		default:
 			elfp_err_warn("elfp_seg64_dump",
 					"Still have to write parse code");
@@ -634,6 +613,7 @@ elfp_seg_get(int handle, const char *seg_type, unsigned long int *ptr_count)
 	}
 
 	class = elfp_main_get_class(main);
+	elfp_main_vec_put_em(handle);
 
         switch(class)
         {
@@ -687,6 +667,7 @@ elfp_seg_dump(int handle, const char *seg_type)
 	}
 	
 	class = elfp_main_get_class(main);
+	elfp_main_vec_put_em(handle);
 
 	switch(class)
 	{
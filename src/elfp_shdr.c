@@ -0,0 +1,735 @@
+/*
+ * File: elfp_shdr.c
+ *
+ * Description: Parsing the Section Header Table.
+ *
+ * 	* The table is decoded once per file into a section index, along
+ * 	with a hash index over the section names. Refer elfp_shdr.h.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#include "./include/elfp_int.h"
+#include "./include/elfp_shdr.h"
+#include "./include/elfp_err.h"
+#include "./include/elfp.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <elf.h>
+
+/*
+ * The below functions are internal to the library.
+ *
+ * Refer elfp_shdr.h for their description.
+ */
+
+unsigned int
+elfp_shdr_hash(const char *name)
+{
+	const unsigned char *c = (const unsigned char *)name;
+	unsigned int hash = 5381;
+
+	while(*c != '\0')
+	{
+		hash = hash * 33 + *c;
+		c++;
+	}
+
+	return hash;
+}
+
+/*
+ * elfp_shdr_table_info: Gets where the Section Header Table is and
+ * 	how big it is.
+ *
+ * 	* Takes care of extended numbering: If there are too many
+ * 	sections, the real count and .shstrtab's index are in the
+ * 	first section header.
+ *
+ * @return: 0 on success, -1 if there is no usable table.
+ */
+static int
+elfp_shdr_table_info(elfp_main *main, unsigned long int *shoff,
+		unsigned long int *shnum, unsigned long int *shstrndx)
+{
+	Elf64_Ehdr e64hdr;
+	Elf32_Ehdr e32hdr;
+	Elf64_Shdr s64hdr;
+	Elf32_Shdr s32hdr;
+	unsigned long int entsize;
+	int ret;
+
+	if(elfp_main_get_class(main) == ELFCLASS32)
+	{
+		ret = elfp_main_read(main, 0, sizeof(Elf32_Ehdr), &e32hdr);
+		if(ret == -1)
+			return -1;
+
+		*shoff = e32hdr.e_shoff;
+		*shnum = e32hdr.e_shnum;
+		*shstrndx = e32hdr.e_shstrndx;
+		entsize = e32hdr.e_shentsize;
+		if(*shoff == 0 || entsize != sizeof(Elf32_Shdr))
+			return -1;
+
+		if(*shnum == 0 || *shstrndx == SHN_XINDEX)
+		{
+			ret = elfp_main_read(main, *shoff, sizeof(Elf32_Shdr), &s32hdr);
+			if(ret == -1)
+				return -1;
+			if(*shnum == 0)
+				*shnum = s32hdr.sh_size;
+			if(*shstrndx == SHN_XINDEX)
+				*shstrndx = s32hdr.sh_link;
+		}
+	}
+	else
+	{
+		ret = elfp_main_read(main, 0, sizeof(Elf64_Ehdr), &e64hdr);
+		if(ret == -1)
+			return -1;
+
+		*shoff = e64hdr.e_shoff;
+		*shnum = e64hdr.e_shnum;
+		*shstrndx = e64hdr.e_shstrndx;
+		entsize = e64hdr.e_shentsize;
+		if(*shoff == 0 || entsize != sizeof(Elf64_Shdr))
+			return -1;
+
+		if(*shnum == 0 || *shstrndx == SHN_XINDEX)
+		{
+			ret = elfp_main_read(main, *shoff, sizeof(Elf64_Shdr), &s64hdr);
+			if(ret == -1)
+				return -1;
+			if(*shnum == 0)
+				*shnum = s64hdr.sh_size;
+			if(*shstrndx == SHN_XINDEX)
+				*shstrndx = s64hdr.sh_link;
+		}
+	}
+
+	/* Each header is at least 40 bytes. Anything bigger than what
+	 * the file can hold is junk */
+	if(*shnum == 0 || *shnum > main->file_size / sizeof(Elf32_Shdr))
+		return -1;
+
+	return 0;
+}
+
+/*
+ * elfp_shdr_index_build: Decodes the Section Header Table and builds
+ * 	the name index.
+ *
+ * @return: NULL on failure, the index on success.
+ */
+static elfp_main_sections*
+elfp_shdr_index_build(elfp_main *main)
+{
+	elfp_main_sections *sections = NULL;
+	elfp_section *sec = NULL;
+	Elf64_Shdr *s64hdr = NULL;
+	Elf32_Shdr *s32hdr = NULL;
+	const char *strtab = NULL;
+	unsigned long int shoff, shnum, shstrndx, strsize, i;
+	unsigned int bucket;
+	int ret;
+
+	sections = elfp_main_alloc(main, sizeof(elfp_main_sections));
+	if(sections == NULL)
+	{
+		elfp_err_warn("elfp_shdr_index_build", "elfp_main_alloc() failed");
+		return NULL;
+	}
+
+	/* No Section Header Table is not an error. The index is just empty */
+	ret = elfp_shdr_table_info(main, &shoff, &shnum, &shstrndx);
+	if(ret == -1)
+		return sections;
+
+	if(elfp_main_get_class(main) == ELFCLASS32)
+		sections->entsize = sizeof(Elf32_Shdr);
+	else
+		sections->entsize = sizeof(Elf64_Shdr);
+
+	/* Handed out to the user as it is. So, it needs to stay mapped */
+	sections->sht = elfp_main_get_range(main, shoff, shnum * sections->entsize);
+	if(sections->sht == NULL)
+		return sections;
+
+	/* Bucket count is a power of 2, so that a mask does the modulo */
+	sections->n_buckets = 16;
+	while(sections->n_buckets < shnum)
+		sections->n_buckets = sections->n_buckets * 2;
+
+	sections->secs = elfp_main_alloc(main, shnum * sizeof(elfp_section));
+	sections->buckets = elfp_main_alloc(main,
+				sections->n_buckets * sizeof(unsigned int));
+	sections->chain = elfp_main_alloc(main, shnum * sizeof(unsigned int));
+	if(sections->secs == NULL || sections->buckets == NULL ||
+						sections->chain == NULL)
+	{
+		elfp_err_warn("elfp_shdr_index_build", "elfp_main_alloc() failed");
+		return NULL;
+	}
+
+	/* 1. Decode the headers */
+	s64hdr = sections->sht;
+	s32hdr = sections->sht;
+	for(i = 0; i < shnum; i++)
+	{
+		sec = sections->secs + i;
+		sec->index = i;
+
+		if(elfp_main_get_class(main) == ELFCLASS32)
+		{
+			sec->hash = s32hdr[i].sh_name;
+			sec->type = s32hdr[i].sh_type;
+			sec->flags = s32hdr[i].sh_flags;
+			sec->addr = s32hdr[i].sh_addr;
+			sec->offset = s32hdr[i].sh_offset;
+			sec->size = s32hdr[i].sh_size;
+			sec->link = s32hdr[i].sh_link;
+			sec->info = s32hdr[i].sh_info;
+			sec->addralign = s32hdr[i].sh_addralign;
+			sec->entsize = s32hdr[i].sh_entsize;
+		}
+		else
+		{
+			sec->hash = s64hdr[i].sh_name;
+			sec->type = s64hdr[i].sh_type;
+			sec->flags = s64hdr[i].sh_flags;
+			sec->addr = s64hdr[i].sh_addr;
+			sec->offset = s64hdr[i].sh_offset;
+			sec->size = s64hdr[i].sh_size;
+			sec->link = s64hdr[i].sh_link;
+			sec->info = s64hdr[i].sh_info;
+			sec->addralign = s64hdr[i].sh_addralign;
+			sec->entsize = s64hdr[i].sh_entsize;
+		}
+	}
+
+	/* 2. Names. sh_name was parked in hash till we got .shstrtab */
+	strsize = 0;
+	if(shstrndx < shnum && sections->secs[shstrndx].type != SHT_NOBITS)
+	{
+		strtab = elfp_shdr_data_get(main, sections->secs + shstrndx);
+		if(strtab != NULL)
+			strsize = sections->secs[shstrndx].size;
+	}
+
+	for(i = 0; i < shnum; i++)
+	{
+		sec = sections->secs + i;
+		if(sec->hash < strsize &&
+			memchr(strtab + sec->hash, '\0', strsize - sec->hash) != NULL)
+			sec->name = strtab + sec->hash;
+		sec->hash = 0;
+	}
+
+	/* 3. Name index. Going backwards leaves the first section with
+	 * a given name at the head of its chain */
+	for(i = shnum; i > 0; i--)
+	{
+		sec = sections->secs + (i - 1);
+		if(sec->name == NULL)
+			continue;
+
+		sec->hash = elfp_shdr_hash(sec->name);
+		bucket = sec->hash & (sections->n_buckets - 1);
+		sections->chain[i - 1] = sections->buckets[bucket];
+		sections->buckets[bucket] = i;
+	}
+
+	sections->count = shnum;
+
+	return sections;
+}
+
+elfp_main_sections*
+elfp_shdr_index_get(elfp_main *main)
+{
+	/* Basic check */
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_shdr_index_get", "NULL argument passed");
+		return NULL;
+	}
+
+	elfp_main_sections *sections = NULL;
+
+	/* Built already? */
+	sections = __atomic_load_n(&main->sections, __ATOMIC_ACQUIRE);
+	if(sections != NULL)
+		return sections;
+
+	/* Only one thread builds it. Others wait and use it */
+	pthread_mutex_lock(&main->index_lock);
+	sections = main->sections;
+	if(sections == NULL)
+	{
+		sections = elfp_shdr_index_build(main);
+		if(sections != NULL)
+			__atomic_store_n(&main->sections, sections, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&main->index_lock);
+
+	if(sections == NULL)
+		elfp_err_warn("elfp_shdr_index_get", "elfp_shdr_index_build() failed");
+
+	return sections;
+}
+
+const elfp_section*
+elfp_shdr_find(elfp_main *main, const char *name)
+{
+	/* Basic check */
+	if(main == NULL || name == NULL)
+	{
+		elfp_err_warn("elfp_shdr_find", "Invalid argument(s) passed");
+		return NULL;
+	}
+
+	elfp_main_sections *sections = NULL;
+	elfp_section *sec = NULL;
+	unsigned int hash, i;
+
+	sections = elfp_shdr_index_get(main);
+	if(sections == NULL || sections->count == 0)
+		return NULL;
+
+	hash = elfp_shdr_hash(name);
+	for(i = sections->buckets[hash & (sections->n_buckets - 1)]; i != 0;
+						i = sections->chain[i - 1])
+	{
+		sec = sections->secs + (i - 1);
+		if(sec->hash == hash && strcmp(sec->name, name) == 0)
+			return sec;
+	}
+
+	return NULL;
+}
+
+const elfp_section*
+elfp_shdr_find_type(elfp_main *main, unsigned long int type)
+{
+	/* Basic check */
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_shdr_find_type", "NULL argument passed");
+		return NULL;
+	}
+
+	elfp_main_sections *sections = NULL;
+	unsigned long int i;
+
+	sections = elfp_shdr_index_get(main);
+	if(sections == NULL)
+		return NULL;
+
+	for(i = 0; i < sections->count; i++)
+	{
+		if(sections->secs[i].type == type)
+			return sections->secs + i;
+	}
+
+	return NULL;
+}
+
+const void*
+elfp_shdr_data_get(elfp_main *main, const elfp_section *sec)
+{
+	/* Basic check */
+	if(main == NULL || sec == NULL)
+	{
+		elfp_err_warn("elfp_shdr_data_get", "Invalid argument(s) passed");
+		return NULL;
+	}
+
+	/* Takes no space in the file */
+	if(sec->type == SHT_NOBITS)
+		return NULL;
+
+	return elfp_main_get_range(main, sec->offset, sec->size);
+}
+
+static void
+elfp_section_dump(const elfp_section *sec)
+{
+	unsigned int i = 0;
+
+	printf("%02u. Name: %s\n", i++, (sec->name != NULL) ? sec->name : "");
+	printf("%02u. Type: %s\n", i++, elfp_shdr_decode_type(sec->type));
+	printf("%02u. Flags: %s\n", i++, elfp_shdr_decode_flags(sec->flags));
+	printf("%02u. Virtual Address: 0x%lx\n", i++, sec->addr);
+	printf("%02u. Section file offset: %lu bytes\n", i++, sec->offset);
+	printf("%02u. Section size: %lu bytes\n", i++, sec->size);
+	printf("%02u. Link: %lu\n", i++, sec->link);
+	printf("%02u. Info: %lu\n", i++, sec->info);
+	printf("%02u. Alignment: 0x%lx\n", i++, sec->addralign);
+	printf("%02u. Entry size: %lu bytes\n", i++, sec->entsize);
+}
+
+/*
+ * All functions defined below are exposed to programmers.
+ *
+ * Refer to elfp.h for more details.
+ */
+
+void*
+elfp_sht_get(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_sht_get", "Handle failed the sanity test");
+		return NULL;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_sections *sections = NULL;
+	void *sht = NULL;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_sht_get", "elfp_main_vec_get_em() failed");
+		return NULL;
+	}
+
+	sections = elfp_shdr_index_get(main);
+	if(sections != NULL && sections->count != 0)
+		sht = sections->sht;
+	elfp_main_vec_put_em(handle);
+
+	if(sht == NULL)
+		elfp_err_warn("elfp_sht_get", "This ELF file has no Section Headers");
+
+	return sht;
+}
+
+unsigned long int
+elfp_sht_count(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_sht_count", "Handle failed the sanity test");
+		return 0;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_sections *sections = NULL;
+	unsigned long int count = 0;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_sht_count", "elfp_main_vec_get_em() failed");
+		return 0;
+	}
+
+	sections = elfp_shdr_index_get(main);
+	if(sections != NULL)
+		count = sections->count;
+	elfp_main_vec_put_em(handle);
+
+	return count;
+}
+
+void*
+elfp_shdr_get(int handle, unsigned long int index)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_shdr_get", "Handle failed the sanity test");
+		return NULL;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_sections *sections = NULL;
+	void *shdr = NULL;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_shdr_get", "elfp_main_vec_get_em() failed");
+		return NULL;
+	}
+
+	sections = elfp_shdr_index_get(main);
+	if(sections != NULL && index < sections->count)
+		shdr = (unsigned char *)sections->sht + index * sections->entsize;
+	elfp_main_vec_put_em(handle);
+
+	if(shdr == NULL)
+		elfp_err_warn("elfp_shdr_get", "Index failed the sanity test");
+
+	return shdr;
+}
+
+const char*
+elfp_shdr_name_get(int handle, unsigned long int index)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_shdr_name_get", "Handle failed the sanity test");
+		return NULL;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_sections *sections = NULL;
+	const char *name = NULL;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_shdr_name_get", "elfp_main_vec_get_em() failed");
+		return NULL;
+	}
+
+	sections = elfp_shdr_index_get(main);
+	if(sections != NULL && index < sections->count)
+		name = sections->secs[index].name;
+	elfp_main_vec_put_em(handle);
+
+	return name;
+}
+
+void*
+elfp_section_by_name(int handle, const char *name)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || name == NULL)
+	{
+		elfp_err_warn("elfp_section_by_name", "Invalid argument(s) passed");
+		return NULL;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_sections *sections = NULL;
+	const elfp_section *sec = NULL;
+	void *shdr = NULL;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_section_by_name", "elfp_main_vec_get_em() failed");
+		return NULL;
+	}
+
+	sec = elfp_shdr_find(main, name);
+	if(sec != NULL)
+	{
+		sections = elfp_shdr_index_get(main);
+		shdr = (unsigned char *)sections->sht + sec->index * sections->entsize;
+	}
+	elfp_main_vec_put_em(handle);
+
+	return shdr;
+}
+
+int
+elfp_shdr_dump(int handle, unsigned long int index)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_shdr_dump", "Handle failed the sanity test");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_sections *sections = NULL;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_shdr_dump", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	sections = elfp_shdr_index_get(main);
+	if(sections == NULL || index >= sections->count)
+	{
+		elfp_err_warn("elfp_shdr_dump", "Index failed the sanity test");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	elfp_section_dump(sections->secs + index);
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
+
+int
+elfp_sht_dump(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_sht_dump", "Handle failed the sanity test");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_sections *sections = NULL;
+	unsigned long int i;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_sht_dump", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	sections = elfp_shdr_index_get(main);
+	if(sections == NULL)
+	{
+		elfp_err_warn("elfp_sht_dump", "elfp_shdr_index_get() failed");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	if(sections->count == 0)
+	{
+		printf("There are no Section Headers in this file\n");
+		elfp_main_vec_put_em(handle);
+		return 0;
+	}
+
+	printf("\n==================================================\n");
+	printf("Section Header Table: \n\n");
+
+	for(i = 0; i < sections->count; i++)
+	{
+		printf("Entry %02lu: \n", i);
+		elfp_section_dump(sections->secs + i);
+		printf("---------------------------------------------\n");
+	}
+
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
+
+/*
+ * Decode functions.
+ */
+const char*
+elfp_shdr_decode_type(unsigned long int type)
+{
+	switch(type)
+	{
+		case SHT_NULL:
+			return "NULL (Section header unused)";
+
+		case SHT_PROGBITS:
+			return "PROGBITS (Program data)";
+
+		case SHT_SYMTAB:
+			return "SYMTAB (Symbol table)";
+
+		case SHT_STRTAB:
+			return "STRTAB (String table)";
+
+		case SHT_RELA:
+			return "RELA (Relocation entries with addends)";
+
+		case SHT_HASH:
+			return "HASH (Symbol hash table)";
+
+		case SHT_DYNAMIC:
+			return "DYNAMIC (Dynamic linking information)";
+
+		case SHT_NOTE:
+			return "NOTE (Notes)";
+
+		case SHT_NOBITS:
+			return "NOBITS (Program space with no data)";
+
+		case SHT_REL:
+			return "REL (Relocation entries, no addends)";
+
+		case SHT_DYNSYM:
+			return "DYNSYM (Dynamic linker symbol table)";
+
+		case SHT_INIT_ARRAY:
+			return "INIT_ARRAY (Array of constructors)";
+
+		case SHT_FINI_ARRAY:
+			return "FINI_ARRAY (Array of destructors)";
+
+		case SHT_PREINIT_ARRAY:
+			return "PREINIT_ARRAY (Array of pre-constructors)";
+
+		case SHT_GROUP:
+			return "GROUP (Section group)";
+
+		case SHT_SYMTAB_SHNDX:
+			return "SYMTAB_SHNDX (Extended section indices)";
+
+		case SHT_RELR:
+			return "RELR (Relative relocations)";
+
+		case SHT_GNU_ATTRIBUTES:
+			return "GNU_ATTRIBUTES (Object attributes)";
+
+		case SHT_GNU_HASH:
+			return "GNU_HASH (GNU-style hash table)";
+
+		case SHT_GNU_verdef:
+			return "VERDEF (Version definition section)";
+
+		case SHT_GNU_verneed:
+			return "VERNEED (Version needs section)";
+
+		case SHT_GNU_versym:
+			return "VERSYM (Version symbol table)";
+
+		case SHT_X86_64_UNWIND:
+			return "X86_64_UNWIND (Unwind information)";
+
+		/* Anything else is invalid */
+		default:
+			return "Invalid type";
+	}
+}
+
+const char*
+elfp_shdr_decode_flags(unsigned long int flags)
+{
+	/* One buffer per thread, so that threads don't step on each other */
+	static __thread char decoded[16];
+	const char letters[] = "WAXMSILOGTC";
+	const unsigned long int bits[] = {SHF_WRITE, SHF_ALLOC, SHF_EXECINSTR,
+			SHF_MERGE, SHF_STRINGS, SHF_INFO_LINK, SHF_LINK_ORDER,
+			SHF_OS_NONCONFORMING, SHF_GROUP, SHF_TLS, SHF_COMPRESSED};
+	unsigned int i, j;
+
+	j = 0;
+	for(i = 0; i < sizeof(bits) / sizeof(bits[0]); i++)
+	{
+		if(flags & bits[i])
+			decoded[j++] = letters[i];
+	}
+	decoded[j] = '\0';
+
+	return decoded;
+}
@@ -0,0 +1,662 @@
+/*
+ * File: elfp_stream.c
+ *
+ * Description: The push parser - elfp_stream_*() API.
+ *
+ * 	Refer elfp.h for functions' description and elfp_stream.h for
+ * 	the structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#include "./include/elfp_err.h"
+#include "./include/elfp_stream.h"
+#include "./include/elfp.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <elf.h>
+
+/* Drops a reference to a buffer */
+static void
+elfp_stream_buf_put(elfp_stream *stream, elfp_stream_buf *buf)
+{
+	if(buf == NULL)
+		return;
+
+	buf->refs--;
+	if(buf->refs != 0)
+		return;
+
+	stream->held = stream->held - buf->size;
+	free(buf->data);
+	free(buf);
+}
+
+static void
+elfp_stream_range_free(elfp_stream *stream, elfp_stream_range *range)
+{
+	if(range == NULL)
+		return;
+
+	elfp_stream_buf_put(stream, range->buf);
+	free(range);
+}
+
+/* Queues a range as an event */
+static void
+elfp_stream_queue(elfp_stream *stream, elfp_stream_range *range)
+{
+	range->next = NULL;
+	if(stream->events_tail == NULL)
+		stream->events_head = range;
+	else
+		stream->events_tail->next = range;
+	stream->events_tail = range;
+}
+
+/* Takes a buffer off the list of buffers still receiving bytes */
+static void
+elfp_stream_buf_unlink(elfp_stream *stream, elfp_stream_buf *buf)
+{
+	elfp_stream_buf **prev = NULL;
+
+	for(prev = &stream->bufs; *prev != NULL; prev = &(*prev)->next)
+	{
+		if(*prev == buf)
+		{
+			*prev = buf->next;
+			buf->next = NULL;
+			return;
+		}
+	}
+}
+
+/*
+ * elfp_stream_buf_get: Finds a buffer for [offset, offset + size), which
+ * 	is not fed yet.
+ * 	* A buffer covering all of it is shared.
+ * 	* Buffers overlapping it are merged into a new one, with their
+ * 	pending ranges. Completed ranges keep the old ones till polled.
+ * 	* Otherwise, a new buffer.
+ *
+ * @return: The buffer with a reference taken, NULL if it would go beyond
+ * 	ELFP_STREAM_HELD_MAX. NULL with stream->error set on failure.
+ */
+static elfp_stream_buf*
+elfp_stream_buf_get(elfp_stream *stream, unsigned long int offset,
+					unsigned long int size)
+{
+	elfp_stream_buf *buf = NULL;
+	elfp_stream_buf *new_buf = NULL;
+	elfp_stream_range *range = NULL;
+	unsigned long int start, end, fed;
+	int grown;
+
+	start = offset;
+	end = offset + size;
+
+	for(buf = stream->bufs; buf != NULL; buf = buf->next)
+	{
+		if(buf->offset <= start && end <= buf->offset + buf->size)
+		{
+			buf->refs++;
+			return buf;
+		}
+	}
+
+	/* Everything overlapping, and what overlaps that */
+	do
+	{
+		grown = 0;
+		for(buf = stream->bufs; buf != NULL; buf = buf->next)
+		{
+			if(buf->offset >= end || buf->offset + buf->size <= start)
+				continue;
+
+			if(buf->offset < start)
+			{
+				start = buf->offset;
+				grown = 1;
+			}
+			if(buf->offset + buf->size > end)
+			{
+				end = buf->offset + buf->size;
+				grown = 1;
+			}
+		}
+	} while(grown);
+
+	if(end - start > ELFP_STREAM_HELD_MAX ||
+		stream->held > ELFP_STREAM_HELD_MAX - (end - start))
+		return NULL;
+
+	new_buf = calloc(1, sizeof(elfp_stream_buf));
+	if(new_buf == NULL)
+	{
+		elfp_err_warn("elfp_stream_buf_get", "calloc() failed");
+		stream->error = 1;
+		return NULL;
+	}
+
+	new_buf->data = malloc(end - start);
+	if(new_buf->data == NULL)
+	{
+		elfp_err_warn("elfp_stream_buf_get", "malloc() failed");
+		free(new_buf);
+		stream->error = 1;
+		return NULL;
+	}
+	new_buf->offset = start;
+	new_buf->size = end - start;
+	new_buf->refs = 1;
+	stream->held = stream->held + new_buf->size;
+
+	/* Move the overlapping buffers' bytes and pending ranges over */
+	buf = stream->bufs;
+	while(buf != NULL)
+	{
+		elfp_stream_buf *next = buf->next;
+
+		if(buf->offset >= start && buf->offset + buf->size <= end)
+		{
+			if(stream->pos > buf->offset)
+			{
+				fed = stream->pos - buf->offset;
+				if(fed > buf->size)
+					fed = buf->size;
+				memcpy(new_buf->data + (buf->offset - start),
+							buf->data, fed);
+			}
+
+			elfp_stream_buf_unlink(stream, buf);
+
+			/* Completed ranges keep it, if any */
+			buf->refs++;
+			for(range = stream->pending; range != NULL; range = range->next)
+			{
+				if(range->buf != buf)
+					continue;
+
+				range->buf = new_buf;
+				new_buf->refs++;
+				buf->refs--;
+			}
+			elfp_stream_buf_put(stream, buf);
+		}
+
+		buf = next;
+	}
+
+	new_buf->next = stream->bufs;
+	stream->bufs = new_buf;
+
+	return new_buf;
+}
+
+/*
+ * elfp_stream_want: Starts waiting for a range of the input.
+ * 	* Ranges whose bytes have gone by already, segments which are too
+ * 	big, and ranges which would need more than ELFP_STREAM_HELD_MAX bytes
+ * 	held are reported as ELFP_STREAM_SKIPPED right away.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_stream_want(elfp_stream *stream, int type, unsigned long int offset,
+			unsigned long int size, unsigned long int seg_type)
+{
+	elfp_stream_range *range = NULL;
+	elfp_stream_range **prev = NULL;
+
+	if(size == 0)
+		return 0;
+
+	range = calloc(1, sizeof(elfp_stream_range));
+	if(range == NULL)
+	{
+		elfp_err_warn("elfp_stream_want", "calloc() failed");
+		return -1;
+	}
+
+	range->type = type;
+	range->offset = offset;
+	range->size = size;
+	range->seg_type = seg_type;
+
+	if(offset < stream->pos || offset + size < offset ||
+		(type == ELFP_STREAM_SEGMENT && size > ELFP_STREAM_SEGMENT_MAX))
+	{
+		range->type = ELFP_STREAM_SKIPPED;
+		elfp_stream_queue(stream, range);
+		return 0;
+	}
+
+	range->buf = elfp_stream_buf_get(stream, offset, size);
+	if(range->buf == NULL && stream->error)
+	{
+		free(range);
+		return -1;
+	}
+	if(range->buf == NULL)
+	{
+		range->type = ELFP_STREAM_SKIPPED;
+		elfp_stream_queue(stream, range);
+		return 0;
+	}
+
+	/* Keep pending ranges sorted by offset */
+	prev = &stream->pending;
+	while(*prev != NULL && (*prev)->offset <= offset)
+		prev = &(*prev)->next;
+	range->next = *prev;
+	*prev = range;
+
+	return 0;
+}
+
+/*
+ * elfp_stream_ehdr: Handles a complete ELF header.
+ *
+ * @return: 1 if the range needs more bytes, 0 if it is done, -1 if the
+ * 	header is not valid. The range is not queued then.
+ */
+static int
+elfp_stream_ehdr(elfp_stream *stream, elfp_stream_range *range)
+{
+	Elf64_Ehdr *ehdr64 = NULL;
+	Elf32_Ehdr *ehdr32 = NULL;
+	elfp_stream_buf *buf = range->buf;
+	unsigned char *new_data = NULL;
+	unsigned long int phoff, phnum, phentsize, phdr_size;
+	unsigned long int shoff, shnum, shentsize, shdr_size;
+
+	if(memcmp(buf->data, ELFMAG, SELFMAG) != 0)
+	{
+		elfp_err_warn("elfp_stream_ehdr", "Not an ELF file according to the magic characters");
+		return -1;
+	}
+
+	stream->class = buf->data[EI_CLASS];
+	if(stream->class != ELFCLASS32 && stream->class != ELFCLASS64)
+	{
+		elfp_err_warn("elfp_stream_ehdr", "Unknown class");
+		return -1;
+	}
+
+	/* Started with the smaller header. A 64-bit one is a bit bigger */
+	if(stream->class == ELFCLASS64 && range->size < sizeof(Elf64_Ehdr))
+	{
+		new_data = realloc(buf->data, sizeof(Elf64_Ehdr));
+		if(new_data == NULL)
+		{
+			elfp_err_warn("elfp_stream_ehdr", "realloc() failed");
+			return -1;
+		}
+		stream->held = stream->held + sizeof(Elf64_Ehdr) - buf->size;
+		buf->data = new_data;
+		buf->size = sizeof(Elf64_Ehdr);
+		range->size = sizeof(Elf64_Ehdr);
+
+		/* Nothing else is pending yet. Receiving again */
+		buf->next = stream->bufs;
+		stream->bufs = buf;
+		return 1;
+	}
+
+	if(stream->class == ELFCLASS32)
+	{
+		ehdr32 = (Elf32_Ehdr *)buf->data;
+		phoff = ehdr32->e_phoff;
+		phnum = ehdr32->e_phnum;
+		phentsize = ehdr32->e_phentsize;
+		shoff = ehdr32->e_shoff;
+		shnum = ehdr32->e_shnum;
+		shentsize = ehdr32->e_shentsize;
+		phdr_size = sizeof(Elf32_Phdr);
+		shdr_size = sizeof(Elf32_Shdr);
+	}
+	else
+	{
+		ehdr64 = (Elf64_Ehdr *)buf->data;
+		phoff = ehdr64->e_phoff;
+		phnum = ehdr64->e_phnum;
+		phentsize = ehdr64->e_phentsize;
+		shoff = ehdr64->e_shoff;
+		shnum = ehdr64->e_shnum;
+		shentsize = ehdr64->e_shentsize;
+		phdr_size = sizeof(Elf64_Phdr);
+		shdr_size = sizeof(Elf64_Shdr);
+	}
+
+	/* Tables are handed out as arrays of Phdr / Shdr */
+	if((phnum != 0 && phentsize != phdr_size) ||
+		(shnum != 0 && shentsize != shdr_size))
+	{
+		elfp_err_warn("elfp_stream_ehdr", "Unexpected PHT / SHT entry size");
+		return -1;
+	}
+
+	/* From here on, the range belongs to the event queue. Failures
+	 * are reported through stream->error */
+	elfp_stream_queue(stream, range);
+
+	/* PN_XNUM: The real count is in the first section header.
+	 * Only the ELF header is reported for such files */
+	if(phnum != PN_XNUM)
+	{
+		if(elfp_stream_want(stream, ELFP_STREAM_PHT, phoff,
+					phnum * phentsize, 0) == -1)
+			stream->error = 1;
+	}
+
+	if(shoff != 0)
+	{
+		if(elfp_stream_want(stream, ELFP_STREAM_SHT, shoff,
+					shnum * shentsize, 0) == -1)
+			stream->error = 1;
+	}
+
+	return 0;
+}
+
+/*
+ * elfp_stream_pht: Handles a complete PHT. Every segment other than LOAD
+ * 	and PHDR is waited for.
+ *
+ * @return: 0. Failures are reported through stream->error.
+ */
+static int
+elfp_stream_pht(elfp_stream *stream, elfp_stream_range *range)
+{
+	Elf64_Phdr *phdr64 = NULL;
+	Elf32_Phdr *phdr32 = NULL;
+	unsigned long int i, n, type, offset, size;
+	int ret;
+
+	/* Reported before the segments it describes */
+	elfp_stream_queue(stream, range);
+
+	if(stream->class == ELFCLASS32)
+		n = range->size / sizeof(Elf32_Phdr);
+	else
+		n = range->size / sizeof(Elf64_Phdr);
+
+	phdr64 = (Elf64_Phdr *)(range->buf->data +
+				(range->offset - range->buf->offset));
+	phdr32 = (Elf32_Phdr *)phdr64;
+
+	for(i = 0; i < n; i++)
+	{
+		if(stream->class == ELFCLASS32)
+		{
+			type = phdr32[i].p_type;
+			offset = phdr32[i].p_offset;
+			size = phdr32[i].p_filesz;
+		}
+		else
+		{
+			type = phdr64[i].p_type;
+			offset = phdr64[i].p_offset;
+			size = phdr64[i].p_filesz;
+		}
+
+		/* LOAD is most of the file. PHDR is the PHT itself */
+		if(type == PT_LOAD || type == PT_PHDR)
+			continue;
+
+		ret = elfp_stream_want(stream, ELFP_STREAM_SEGMENT, offset, size,
+									type);
+		if(ret == -1)
+		{
+			stream->error = 1;
+			break;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * elfp_stream_complete: Handles a range all of whose bytes are in.
+ *
+ * @return: 0 on success, -1 on error.
+ */
+static int
+elfp_stream_complete(elfp_stream *stream, elfp_stream_range *range)
+{
+	int ret;
+
+	switch(range->type)
+	{
+		case ELFP_STREAM_EHDR:
+			ret = elfp_stream_ehdr(stream, range);
+			break;
+
+		case ELFP_STREAM_PHT:
+			ret = elfp_stream_pht(stream, range);
+			break;
+
+		default:
+			elfp_stream_queue(stream, range);
+			ret = 0;
+			break;
+	}
+
+	/* The ELF header grew. Keep waiting */
+	if(ret == 1)
+	{
+		range->next = stream->pending;
+		stream->pending = range;
+		return 0;
+	}
+
+	/* Not queued. Nobody else will free it */
+	if(ret == -1)
+		elfp_stream_range_free(stream, range);
+
+	return ret;
+}
+
+elfp_stream*
+elfp_stream_new()
+{
+	elfp_stream *stream = NULL;
+	int ret;
+
+	stream = calloc(1, sizeof(elfp_stream));
+	if(stream == NULL)
+	{
+		elfp_err_warn("elfp_stream_new", "calloc() failed");
+		return NULL;
+	}
+
+	/* Class is not known yet. Start with the smaller ELF header */
+	ret = elfp_stream_want(stream, ELFP_STREAM_EHDR, 0, sizeof(Elf32_Ehdr), 0);
+	if(ret == -1)
+	{
+		elfp_err_warn("elfp_stream_new", "elfp_stream_want() failed");
+		free(stream);
+		return NULL;
+	}
+
+	return stream;
+}
+
+int
+elfp_stream_feed(elfp_stream *stream, const void *buf, unsigned long int len)
+{
+	/* Basic check */
+	if(stream == NULL || (buf == NULL && len != 0))
+	{
+		elfp_err_warn("elfp_stream_feed", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	const unsigned char *in = buf;
+	elfp_stream_range *range = NULL;
+	elfp_stream_range **prev = NULL;
+	elfp_stream_buf *sbuf = NULL;
+	elfp_stream_buf **sbuf_prev = NULL;
+	unsigned long int step, end;
+	int ret;
+
+	if(stream->error)
+		return -1;
+
+	while(len > 0 && stream->done == 0)
+	{
+		/* Go till the next point something starts / ends at */
+		step = len;
+		for(range = stream->pending; range != NULL; range = range->next)
+		{
+			end = range->offset + range->size;
+			if(range->offset > stream->pos)
+			{
+				if(range->offset - stream->pos < step)
+					step = range->offset - stream->pos;
+			}
+			else if(end - stream->pos < step)
+				step = end - stream->pos;
+		}
+
+		/* Only buffers which want these bytes keep them. Once each */
+		for(sbuf = stream->bufs; sbuf != NULL; sbuf = sbuf->next)
+		{
+			if(sbuf->offset <= stream->pos)
+				memcpy(sbuf->data + (stream->pos - sbuf->offset), in, step);
+		}
+
+		stream->pos = stream->pos + step;
+		in = in + step;
+		len = len - step;
+
+		/* Full buffers need nothing more */
+		sbuf_prev = &stream->bufs;
+		while(*sbuf_prev != NULL)
+		{
+			sbuf = *sbuf_prev;
+			if(sbuf->offset + sbuf->size <= stream->pos)
+			{
+				*sbuf_prev = sbuf->next;
+				sbuf->next = NULL;
+			}
+			else
+				sbuf_prev = &sbuf->next;
+		}
+
+		/* Handle everything that is complete now. It may
+		 * add more ranges */
+		prev = &stream->pending;
+		while(*prev != NULL)
+		{
+			range = *prev;
+			if(range->offset + range->size > stream->pos)
+			{
+				prev = &range->next;
+				continue;
+			}
+
+			*prev = range->next;
+			ret = elfp_stream_complete(stream, range);
+			if(ret == -1 || stream->error)
+			{
+				stream->error = 1;
+				return -1;
+			}
+
+			/* The list may have changed under us */
+			prev = &stream->pending;
+		}
+
+		if(stream->pending == NULL)
+			stream->done = 1;
+	}
+
+	return 0;
+}
+
+int
+elfp_stream_poll(elfp_stream *stream, elfp_stream_event *event)
+{
+	/* Basic check */
+	if(stream == NULL || event == NULL)
+	{
+		elfp_err_warn("elfp_stream_poll", "Invalid argument(s) passed");
+		return ELFP_STREAM_ERROR;
+	}
+
+	elfp_stream_range *range = NULL;
+
+	/* Last event's data is not needed anymore */
+	elfp_stream_range_free(stream, stream->polled);
+	stream->polled = NULL;
+
+	memset(event, '\0', sizeof(elfp_stream_event));
+	event->class = stream->class;
+
+	/* Events which were ready before an error are still reported */
+	range = stream->events_head;
+	if(range != NULL)
+	{
+		stream->events_head = range->next;
+		if(stream->events_head == NULL)
+			stream->events_tail = NULL;
+		stream->polled = range;
+
+		event->type = range->type;
+		event->offset = range->offset;
+		event->size = range->size;
+		event->seg_type = range->seg_type;
+		if(range->buf != NULL)
+			event->data = range->buf->data +
+					(range->offset - range->buf->offset);
+	}
+	else if(stream->error)
+		event->type = ELFP_STREAM_ERROR;
+	else if(stream->done)
+		event->type = ELFP_STREAM_DONE;
+	else
+		event->type = ELFP_STREAM_NEED_MORE;
+
+	return event->type;
+}
+
+void
+elfp_stream_free(elfp_stream *stream)
+{
+	elfp_stream_range *range = NULL;
+
+	if(stream == NULL)
+		return;
+
+	while(stream->pending != NULL)
+	{
+		range = stream->pending;
+		stream->pending = range->next;
+		elfp_stream_range_free(stream, range);
+	}
+
+	while(stream->events_head != NULL)
+	{
+		range = stream->events_head;
+		stream->events_head = range->next;
+		elfp_stream_range_free(stream, range);
+	}
+
+	elfp_stream_range_free(stream, stream->polled);
+	free(stream);
+}
@@ -0,0 +1,795 @@
+/*
+ * File: elfp_sym.c
+ *
+ * Description: Parsing the symbol tables - .symtab and .dynsym.
+ *
+ * 	* Each table is indexed once per file, the first time it is
+ * 	used. Refer elfp_sym.h.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#include "./include/elfp_int.h"
+#include "./include/elfp_shdr.h"
+#include "./include/elfp_sym.h"
+#include "./include/elfp_err.h"
+#include "./include/elfp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <elf.h>
+
+/*
+ * The below functions are internal to the library.
+ *
+ * Refer elfp_sym.h for their description.
+ */
+
+void
+elfp_sym_decode(elfp_main *main, elfp_main_symbols *symbols,
+		unsigned long int index, elfp_sym *sym)
+{
+	const Elf64_Sym *s64 = NULL;
+	const Elf32_Sym *s32 = NULL;
+	unsigned long int name;
+
+	if(elfp_main_get_class(main) == ELFCLASS32)
+	{
+		s32 = (const Elf32_Sym *)symbols->syms + index;
+		name = s32->st_name;
+		sym->value = s32->st_value;
+		sym->size = s32->st_size;
+		sym->type = ELF32_ST_TYPE(s32->st_info);
+		sym->bind = ELF32_ST_BIND(s32->st_info);
+		sym->visibility = ELF32_ST_VISIBILITY(s32->st_other);
+		sym->shndx = s32->st_shndx;
+	}
+	else
+	{
+		s64 = (const Elf64_Sym *)symbols->syms + index;
+		name = s64->st_name;
+		sym->value = s64->st_value;
+		sym->size = s64->st_size;
+		sym->type = ELF64_ST_TYPE(s64->st_info);
+		sym->bind = ELF64_ST_BIND(s64->st_info);
+		sym->visibility = ELF64_ST_VISIBILITY(s64->st_other);
+		sym->shndx = s64->st_shndx;
+	}
+
+	sym->index = index;
+
+	/* Names are checked for a terminating NUL when the index is built */
+	if(name < symbols->strsize)
+		sym->name = symbols->strtab + name;
+	else
+		sym->name = "";
+}
+
+/*
+ * elfp_sym_name_off: Offset of a symbol's name in the string table.
+ * 	0 (the empty string) if st_name is outside it, like
+ * 	elfp_sym_decode() does.
+ */
+static unsigned int
+elfp_sym_name_off(elfp_main *main, elfp_main_symbols *symbols,
+					unsigned long int index)
+{
+	unsigned long int name;
+
+	if(elfp_main_get_class(main) == ELFCLASS32)
+		name = ((const Elf32_Sym *)symbols->syms + index)->st_name;
+	else
+		name = ((const Elf64_Sym *)symbols->syms + index)->st_name;
+
+	return (name < symbols->strsize) ? name : 0;
+}
+
+/*
+ * elfp_sym_has_addr: Does the symbol stand for a location which an
+ * 	address can fall in?
+ * 	* Sections, files, TLS offsets and undefined / absolute symbols
+ * 	don't.
+ */
+static int
+elfp_sym_has_addr(elfp_sym *sym)
+{
+	if(sym->shndx == SHN_UNDEF || sym->shndx == SHN_ABS ||
+						sym->shndx == SHN_COMMON)
+		return 0;
+
+	switch(sym->type)
+	{
+		case STT_NOTYPE:
+		case STT_OBJECT:
+		case STT_FUNC:
+		case STT_GNU_IFUNC:
+			return 1;
+
+		default:
+			return 0;
+	}
+}
+
+/*
+ * elfp_sym_radix_sort: Sorts keys in ascending order, carrying vals along.
+ *
+ * 	* LSD radix sort, a byte per pass. Stable, so symbols at the same
+ * 	address stay in table order.
+ * 	* All 8 histograms are built in one go. A pass whose byte is the
+ * 	same for all keys changes nothing and is skipped - that's most of
+ * 	the upper bytes of addresses.
+ *
+ * Refer elfp_sym.h for more details.
+ */
+int
+elfp_sym_radix_sort(unsigned long int *keys, unsigned int *vals,
+				unsigned long int n)
+{
+	unsigned long int (*counts)[256] = NULL;
+	unsigned long int *tmp_keys = NULL, *src_keys, *dst_keys, *swap_keys;
+	unsigned int *tmp_vals = NULL, *src_vals, *dst_vals, *swap_vals;
+	unsigned long int i, sum, count;
+	unsigned int pass, byte;
+
+	if(n < 2)
+		return 0;
+
+	counts = calloc(8, sizeof(*counts));
+	tmp_keys = malloc(n * sizeof(unsigned long int));
+	tmp_vals = malloc(n * sizeof(unsigned int));
+	if(counts == NULL || tmp_keys == NULL || tmp_vals == NULL)
+	{
+		elfp_err_warn("elfp_sym_radix_sort", "malloc() failed");
+		free(counts);
+		free(tmp_keys);
+		free(tmp_vals);
+		return -1;
+	}
+
+	for(i = 0; i < n; i++)
+	{
+		for(pass = 0; pass < 8; pass++)
+			counts[pass][(keys[i] >> (pass * 8)) & 0xff]++;
+	}
+
+	src_keys = keys;
+	src_vals = vals;
+	dst_keys = tmp_keys;
+	dst_vals = tmp_vals;
+
+	for(pass = 0; pass < 8; pass++)
+	{
+		/* Nothing to do if all the keys fall in one bucket */
+		byte = (keys[0] >> (pass * 8)) & 0xff;
+		if(counts[pass][byte] == n)
+			continue;
+
+		/* Counts to starting positions */
+		sum = 0;
+		for(byte = 0; byte < 256; byte++)
+		{
+			count = counts[pass][byte];
+			counts[pass][byte] = sum;
+			sum = sum + count;
+		}
+
+		for(i = 0; i < n; i++)
+		{
+			byte = (src_keys[i] >> (pass * 8)) & 0xff;
+			dst_keys[counts[pass][byte]] = src_keys[i];
+			dst_vals[counts[pass][byte]] = src_vals[i];
+			counts[pass][byte]++;
+		}
+
+		swap_keys = src_keys;
+		src_keys = dst_keys;
+		dst_keys = swap_keys;
+		swap_vals = src_vals;
+		src_vals = dst_vals;
+		dst_vals = swap_vals;
+	}
+
+	/* Odd number of passes leaves the result in the temporary arrays */
+	if(src_keys != keys)
+	{
+		memcpy(keys, src_keys, n * sizeof(unsigned long int));
+		memcpy(vals, src_vals, n * sizeof(unsigned int));
+	}
+
+	free(counts);
+	free(tmp_keys);
+	free(tmp_vals);
+
+	return 0;
+}
+
+/*
+ * elfp_sym_index_build: Builds the address and name indexes of a table.
+ *
+ * @return: NULL on failure, the index on success.
+ */
+static elfp_main_symbols*
+elfp_sym_index_build(elfp_main *main, int table)
+{
+	elfp_main_symbols *symbols = NULL;
+	elfp_main_sections *sections = NULL;
+	const elfp_section *sec = NULL;
+	const elfp_section *strsec = NULL;
+	unsigned long int *keys = NULL;
+	unsigned int *vals = NULL;
+	unsigned long int entsize, i, n, bucket;
+	const char *name = NULL;
+	int names_terminated;
+	elfp_sym sym;
+	int ret;
+
+	symbols = elfp_main_alloc(main, sizeof(elfp_main_symbols));
+	if(symbols == NULL)
+	{
+		elfp_err_warn("elfp_sym_index_build", "elfp_main_alloc() failed");
+		return NULL;
+	}
+
+	/* 1. Find the table and its strings. No table is not an error,
+	 * the index is just empty */
+	sections = elfp_shdr_index_get(main);
+	if(sections == NULL)
+		return NULL;
+
+	if(table == ELFP_SYMTAB_STATIC)
+		sec = elfp_shdr_find_type(main, SHT_SYMTAB);
+	else
+		sec = elfp_shdr_find_type(main, SHT_DYNSYM);
+	if(sec == NULL || sec->link >= sections->count)
+		return symbols;
+
+	if(elfp_main_get_class(main) == ELFCLASS32)
+		entsize = sizeof(Elf32_Sym);
+	else
+		entsize = sizeof(Elf64_Sym);
+	if(sec->entsize != 0 && sec->entsize != entsize)
+	{
+		elfp_err_warn("elfp_sym_index_build", "Unexpected symbol size");
+		return symbols;
+	}
+
+	strsec = sections->secs + sec->link;
+	symbols->syms = elfp_shdr_data_get(main, sec);
+	symbols->strtab = elfp_shdr_data_get(main, strsec);
+	if(symbols->syms == NULL || symbols->strtab == NULL ||
+				sec->size / entsize > UINT32_MAX - 1)
+	{
+		symbols->syms = NULL;
+		return symbols;
+	}
+	symbols->strsize = strsec->size;
+	n = sec->size / entsize;
+
+	/* Not even one whole entry. Same as having no table */
+	if(n == 0)
+	{
+		symbols->syms = NULL;
+		symbols->strtab = NULL;
+		symbols->strsize = 0;
+		return symbols;
+	}
+
+	/* Parsers are going to walk all of it */
+	elfp_main_prefetch(main, sec->offset, sec->size);
+	elfp_main_prefetch(main, strsec->offset, strsec->size);
+
+	/* Usually the table ends with a NUL. Then every name in range is
+	 * terminated and needs no checking */
+	names_terminated = (symbols->strsize != 0 &&
+			symbols->strtab[symbols->strsize - 1] == '\0');
+
+	/* 2. Address index. Symbol 0 is always the undefined symbol */
+	keys = malloc(n * sizeof(unsigned long int));
+	vals = malloc(n * sizeof(unsigned int));
+	if(keys == NULL || vals == NULL)
+	{
+		elfp_err_warn("elfp_sym_index_build", "malloc() failed");
+		goto return_fail;
+	}
+
+	symbols->count = n;
+	symbols->n_addrs = 0;
+	for(i = 1; i < n; i++)
+	{
+		elfp_sym_decode(main, symbols, i, &sym);
+		if(elfp_sym_has_addr(&sym) == 0)
+			continue;
+
+		keys[symbols->n_addrs] = sym.value;
+		vals[symbols->n_addrs] = i;
+		symbols->n_addrs++;
+	}
+
+	ret = elfp_sym_radix_sort(keys, vals, symbols->n_addrs);
+	if(ret == -1)
+	{
+		elfp_err_warn("elfp_sym_index_build", "elfp_sym_radix_sort() failed");
+		goto return_fail;
+	}
+
+	symbols->addrs = elfp_main_alloc(main,
+			symbols->n_addrs * sizeof(unsigned long int) + 1);
+	symbols->sizes = elfp_main_alloc(main,
+			symbols->n_addrs * sizeof(unsigned long int) + 1);
+	symbols->name_offs = elfp_main_alloc(main,
+			symbols->n_addrs * sizeof(unsigned int) + 1);
+	symbols->sym_index = elfp_main_alloc(main,
+			symbols->n_addrs * sizeof(unsigned int) + 1);
+	if(symbols->addrs == NULL || symbols->sizes == NULL ||
+		symbols->name_offs == NULL || symbols->sym_index == NULL)
+	{
+		elfp_err_warn("elfp_sym_index_build", "elfp_main_alloc() failed");
+		goto return_fail;
+	}
+
+	for(i = 0; i < symbols->n_addrs; i++)
+	{
+		elfp_sym_decode(main, symbols, vals[i], &sym);
+		symbols->addrs[i] = keys[i];
+		symbols->sizes[i] = sym.size;
+		symbols->name_offs[i] = elfp_sym_name_off(main, symbols, vals[i]);
+		symbols->sym_index[i] = vals[i];
+	}
+
+	free(keys);
+	free(vals);
+	keys = NULL;
+	vals = NULL;
+
+	/* 3. Name index. Bucket count is a power of 2, so that a mask
+	 * does the modulo */
+	symbols->n_buckets = 16;
+	while(symbols->n_buckets < n)
+		symbols->n_buckets = symbols->n_buckets * 2;
+
+	symbols->buckets = elfp_main_alloc(main,
+				symbols->n_buckets * sizeof(unsigned int));
+	symbols->chain = elfp_main_alloc(main, n * sizeof(unsigned int));
+	symbols->hashes = elfp_main_alloc(main, n * sizeof(unsigned int));
+	if(symbols->buckets == NULL || symbols->chain == NULL ||
+						symbols->hashes == NULL)
+	{
+		elfp_err_warn("elfp_sym_index_build", "elfp_main_alloc() failed");
+		goto return_fail;
+	}
+
+	/* Going backwards leaves the first symbol with a given name at
+	 * the head of its chain */
+	for(i = n - 1; i > 0; i--)
+	{
+		elfp_sym_decode(main, symbols, i, &sym);
+		name = sym.name;
+		if(name[0] == '\0')
+			continue;
+
+		if(names_terminated == 0 &&
+			memchr(name, '\0', symbols->strtab + symbols->strsize - name) == NULL)
+			continue;
+
+		symbols->hashes[i] = elfp_shdr_hash(name);
+		bucket = symbols->hashes[i] & (symbols->n_buckets - 1);
+		symbols->chain[i] = symbols->buckets[bucket];
+		symbols->buckets[bucket] = i + 1;
+	}
+
+	return symbols;
+
+return_fail:
+	free(keys);
+	free(vals);
+	return NULL;
+}
+
+elfp_main_symbols*
+elfp_sym_index_get(elfp_main *main, int table)
+{
+	/* Basic check */
+	if(main == NULL ||
+		(table != ELFP_SYMTAB_STATIC && table != ELFP_SYMTAB_DYNAMIC))
+	{
+		elfp_err_warn("elfp_sym_index_get", "Invalid argument(s) passed");
+		return NULL;
+	}
+
+	elfp_main_symbols *symbols = NULL;
+	elfp_main_symbols **slot = NULL;
+
+	slot = &main->symbols[table - ELFP_SYMTAB_STATIC];
+
+	/* Built already? */
+	symbols = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+	if(symbols != NULL)
+		return symbols;
+
+	/* The builder needs the section index, which takes index_lock
+	 * itself. Get that out of the way first */
+	if(elfp_shdr_index_get(main) == NULL)
+	{
+		elfp_err_warn("elfp_sym_index_get", "elfp_shdr_index_get() failed");
+		return NULL;
+	}
+
+	/* Only one thread builds it. Others wait and use it */
+	pthread_mutex_lock(&main->index_lock);
+	symbols = *slot;
+	if(symbols == NULL)
+	{
+		symbols = elfp_sym_index_build(main, table);
+		if(symbols != NULL)
+			__atomic_store_n(slot, symbols, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&main->index_lock);
+
+	if(symbols == NULL)
+		elfp_err_warn("elfp_sym_index_get", "elfp_sym_index_build() failed");
+
+	return symbols;
+}
+
+/*
+ * elfp_sym_table_get: Gets a handle's object and the index of the table
+ * 	asked for. ELFP_SYMTAB_DEFAULT is .symtab if there is one, .dynsym
+ * 	otherwise.
+ *
+ * 	* On success, the caller should elfp_main_vec_put_em() the handle.
+ *
+ * @return: NULL on failure, the index on success.
+ */
+static elfp_main_symbols*
+elfp_sym_table_get(int handle, int table, elfp_main **main_out)
+{
+	elfp_main *main = NULL;
+	elfp_main_symbols *symbols = NULL;
+
+	if(table != ELFP_SYMTAB_DEFAULT && table != ELFP_SYMTAB_STATIC &&
+					table != ELFP_SYMTAB_DYNAMIC)
+	{
+		elfp_err_warn("elfp_sym_table_get", "Invalid table");
+		return NULL;
+	}
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_sym_table_get", "elfp_main_vec_get_em() failed");
+		return NULL;
+	}
+
+	if(table == ELFP_SYMTAB_DEFAULT)
+	{
+		symbols = elfp_sym_index_get(main, ELFP_SYMTAB_STATIC);
+		if(symbols != NULL && symbols->count == 0)
+			symbols = elfp_sym_index_get(main, ELFP_SYMTAB_DYNAMIC);
+	}
+	else
+		symbols = elfp_sym_index_get(main, table);
+
+	if(symbols == NULL)
+	{
+		elfp_err_warn("elfp_sym_table_get", "elfp_sym_index_get() failed");
+		elfp_main_vec_put_em(handle);
+		return NULL;
+	}
+
+	*main_out = main;
+	return symbols;
+}
+
+/*
+ * elfp_sym_rank: How good a symbol is to stand for an address, when many
+ * 	of them start at the same address. Higher is better.
+ */
+static int
+elfp_sym_rank(elfp_sym *sym)
+{
+	switch(sym->bind)
+	{
+		case STB_GLOBAL:
+			return 2;
+
+		case STB_WEAK:
+			return 1;
+
+		default:
+			return 0;
+	}
+}
+
+/*
+ * All functions defined below are exposed to programmers.
+ *
+ * Refer to elfp.h for more details.
+ */
+
+unsigned long int
+elfp_sym_count(int handle, int table)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_sym_count", "Handle failed the sanity test");
+		return 0;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_symbols *symbols = NULL;
+	unsigned long int count;
+
+	symbols = elfp_sym_table_get(handle, table, &main);
+	if(symbols == NULL)
+		return 0;
+
+	count = symbols->count;
+	elfp_main_vec_put_em(handle);
+
+	return count;
+}
+
+int
+elfp_sym_get(int handle, int table, unsigned long int index, elfp_sym *sym)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || sym == NULL)
+	{
+		elfp_err_warn("elfp_sym_get", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_symbols *symbols = NULL;
+
+	symbols = elfp_sym_table_get(handle, table, &main);
+	if(symbols == NULL)
+		return -1;
+
+	if(index >= symbols->count)
+	{
+		elfp_err_warn("elfp_sym_get", "Index failed the sanity test");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	elfp_sym_decode(main, symbols, index, sym);
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
+
+int
+elfp_sym_by_addr(int handle, int table, unsigned long int addr, elfp_sym *sym)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || sym == NULL)
+	{
+		elfp_err_warn("elfp_sym_by_addr", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_symbols *symbols = NULL;
+	elfp_sym candidate;
+	unsigned long int low, high, mid, start;
+	long int i;
+	int found = 0;
+
+	symbols = elfp_sym_table_get(handle, table, &main);
+	if(symbols == NULL)
+		return -1;
+
+	/* Find the first symbol starting after addr */
+	low = 0;
+	high = symbols->n_addrs;
+	while(low < high)
+	{
+		mid = low + (high - low) / 2;
+		if(symbols->addrs[mid] <= addr)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	/* The ones just before it start at the closest address. Pick the
+	 * best of them which covers addr. Symbols of size 0 are labels,
+	 * they cover everything till the next symbol */
+	if(low > 0)
+	{
+		start = symbols->addrs[low - 1];
+		for(i = low - 1; i >= 0 && symbols->addrs[i] == start; i--)
+		{
+			if(symbols->sizes[i] != 0 && addr - start >= symbols->sizes[i])
+				continue;
+
+			elfp_sym_decode(main, symbols, symbols->sym_index[i], &candidate);
+			if(found == 0 || elfp_sym_rank(&candidate) > elfp_sym_rank(sym) ||
+				(elfp_sym_rank(&candidate) == elfp_sym_rank(sym) &&
+							sym->size == 0))
+			{
+				*sym = candidate;
+				found = 1;
+			}
+		}
+	}
+
+	elfp_main_vec_put_em(handle);
+
+	return (found == 1) ? 0 : -1;
+}
+
+int
+elfp_sym_by_name(int handle, int table, const char *name, elfp_sym *sym)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || name == NULL || sym == NULL)
+	{
+		elfp_err_warn("elfp_sym_by_name", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_symbols *symbols = NULL;
+	elfp_sym candidate;
+	unsigned int hash, i;
+	int found = 0;
+
+	symbols = elfp_sym_table_get(handle, table, &main);
+	if(symbols == NULL)
+		return -1;
+
+	if(symbols->count == 0)
+	{
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	/* A definition is preferred over a reference */
+	hash = elfp_shdr_hash(name);
+	for(i = symbols->buckets[hash & (symbols->n_buckets - 1)]; i != 0;
+						i = symbols->chain[i - 1])
+	{
+		if(symbols->hashes[i - 1] != hash)
+			continue;
+
+		elfp_sym_decode(main, symbols, i - 1, &candidate);
+		if(strcmp(candidate.name, name) != 0)
+			continue;
+
+		if(found == 0 || (sym->shndx == SHN_UNDEF &&
+					candidate.shndx != SHN_UNDEF))
+		{
+			*sym = candidate;
+			found = 1;
+		}
+
+		if(sym->shndx != SHN_UNDEF)
+			break;
+	}
+
+	elfp_main_vec_put_em(handle);
+
+	return (found == 1) ? 0 : -1;
+}
+
+int
+elfp_sym_dump(int handle, int table)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_sym_dump", "Handle failed the sanity test");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	elfp_main_symbols *symbols = NULL;
+	elfp_sym sym;
+	unsigned long int i;
+
+	symbols = elfp_sym_table_get(handle, table, &main);
+	if(symbols == NULL)
+		return -1;
+
+	if(symbols->count == 0)
+	{
+		printf("There is no such symbol table in this file\n");
+		elfp_main_vec_put_em(handle);
+		return 0;
+	}
+
+	printf("\n==================================================\n");
+	printf("Symbol Table: %lu entries\n\n", symbols->count);
+	printf("%8s %18s %8s %-10s %-8s %6s %s\n", "Num", "Value", "Size",
+					"Type", "Bind", "Ndx", "Name");
+
+	for(i = 0; i < symbols->count; i++)
+	{
+		elfp_sym_decode(main, symbols, i, &sym);
+		printf("%8lu 0x%016lx %8lu %-10s %-8s %6lu %s\n", i, sym.value,
+			sym.size, elfp_sym_decode_type(sym.type),
+			elfp_sym_decode_bind(sym.bind), sym.shndx, sym.name);
+	}
+
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
+
+/*
+ * Decode functions.
+ */
+const char*
+elfp_sym_decode_type(unsigned long int type)
+{
+	switch(type)
+	{
+		case STT_NOTYPE:
+			return "NOTYPE";
+
+		case STT_OBJECT:
+			return "OBJECT";
+
+		case STT_FUNC:
+			return "FUNC";
+
+		case STT_SECTION:
+			return "SECTION";
+
+		case STT_FILE:
+			return "FILE";
+
+		case STT_COMMON:
+			return "COMMON";
+
+		case STT_TLS:
+			return "TLS";
+
+		case STT_GNU_IFUNC:
+			return "IFUNC";
+
+		/* Anything else is invalid */
+		default:
+			return "Invalid type";
+	}
+}
+
+const char*
+elfp_sym_decode_bind(unsigned long int bind)
+{
+	switch(bind)
+	{
+		case STB_LOCAL:
+			return "LOCAL";
+
+		case STB_GLOBAL:
+			return "GLOBAL";
+
+		case STB_WEAK:
+			return "WEAK";
+
+		case STB_GNU_UNIQUE:
+			return "UNIQUE";
+
+		/* Anything else is invalid */
+		default:
+			return "Invalid binding";
+	}
+}
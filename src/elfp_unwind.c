@@ -0,0 +1,1476 @@
+/*
+ * File: elfp_unwind.c
+ *
+ * Description: The unwind table. The CFA programs of .eh_frame (or
+ * 	.debug_frame) are run once into rows sorted by address, like the
+ * 	kernel's ORC tables.
+ *
+ * 	* The FDEs are sorted by where they start, and compiled a chunk a
+ * 	task on the thread pool. The chunks' rows are then merged into one
+ * 	table in the object's arena - a header, then the rows.
+ * 	* A saved table is the same bytes, so that it is searched in place
+ * 	once mapped.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#include "./include/elfp_unwind.h"
+#include "./include/elfp_frame.h"
+#include "./include/elfp_dwarf.h"
+#include "./include/elfp_shdr.h"
+#include "./include/elfp_note.h"
+#include "./include/elfp_sym.h"
+#include "./include/elfp_pool.h"
+#include "./include/elfp_int.h"
+#include "./include/elfp_err.h"
+#include "./include/elfp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <elf.h>
+
+/* FDEs compiled by one task */
+#define ELFP_UNWIND_CHUNK 1024
+
+/* More FDEs than this are compiled on many threads */
+#define ELFP_UNWIND_PARALLEL_MIN (4 * ELFP_UNWIND_CHUNK)
+
+/* Deepest DW_CFA_remember_state nesting followed */
+#define ELFP_UNWIND_STACK_MAX 16
+
+/* Call frame instructions. The first three have their operand in the
+ * low 6 bits */
+#define DW_CFA_advance_loc		0x40
+#define DW_CFA_offset			0x80
+#define DW_CFA_restore			0xc0
+#define DW_CFA_nop			0x00
+#define DW_CFA_set_loc			0x01
+#define DW_CFA_advance_loc1		0x02
+#define DW_CFA_advance_loc2		0x03
+#define DW_CFA_advance_loc4		0x04
+#define DW_CFA_offset_extended		0x05
+#define DW_CFA_restore_extended		0x06
+#define DW_CFA_undefined		0x07
+#define DW_CFA_same_value		0x08
+#define DW_CFA_register			0x09
+#define DW_CFA_remember_state		0x0a
+#define DW_CFA_restore_state		0x0b
+#define DW_CFA_def_cfa			0x0c
+#define DW_CFA_def_cfa_register		0x0d
+#define DW_CFA_def_cfa_offset		0x0e
+#define DW_CFA_def_cfa_expression	0x0f
+#define DW_CFA_expression		0x10
+#define DW_CFA_offset_extended_sf	0x11
+#define DW_CFA_def_cfa_sf		0x12
+#define DW_CFA_def_cfa_offset_sf	0x13
+#define DW_CFA_val_offset		0x14
+#define DW_CFA_val_offset_sf		0x15
+#define DW_CFA_val_expression		0x16
+#define DW_CFA_GNU_window_save		0x2d
+#define DW_CFA_GNU_args_size		0x2e
+#define DW_CFA_GNU_negative_offset_extended 0x2f
+
+/* The rules as a CFA program leaves them */
+typedef struct elfp_unwind_state
+{
+	unsigned int cfa_rule;
+	unsigned long int cfa_register;
+	long int cfa_offset;
+
+	unsigned int ra_rule;
+	long int ra_offset;
+	unsigned int fp_rule;
+	long int fp_offset;
+
+} elfp_unwind_state;
+
+/* A row as a task puts it out, with the whole address */
+typedef struct elfp_unwind_raw
+{
+	unsigned long int pc;
+
+	/* 1 for the first row of an FDE */
+	int fde_start;
+
+	elfp_unwind_entry entry;
+
+} elfp_unwind_raw;
+
+/* Rows of a chunk of FDEs, in the order of the FDEs */
+typedef struct elfp_unwind_chunk
+{
+	elfp_unwind_raw *rows;
+	unsigned long int n_rows;
+	unsigned long int max_rows;
+
+	int failed;
+
+} elfp_unwind_chunk;
+
+/* What the tasks share */
+typedef struct elfp_unwind_build
+{
+	const elfp_frame_section *section;
+
+	/* Offsets of the FDEs in the section, sorted by where they start */
+	unsigned long int *fdes;
+	unsigned long int n_fdes;
+
+	elfp_unwind_chunk *chunks;
+	unsigned long int n_chunks;
+
+	/* DWARF number of the frame pointer. ELFP_UNWIND_NO_REGISTER if
+	 * the machine's is not known */
+	unsigned long int fp_register;
+
+} elfp_unwind_build;
+
+/* A CFA program being run */
+typedef struct elfp_unwind_program
+{
+	const elfp_unwind_build *build;
+	const elfp_frame_cie *cie;
+
+	/* The section, with the CIE's address size. For DW_CFA_set_loc */
+	elfp_frame_section section;
+
+	elfp_unwind_state state;
+
+	/* What the CIE's instructions left. DW_CFA_restore goes back to it */
+	elfp_unwind_state initial;
+
+	/* Where the program is, and where the FDE ends */
+	unsigned long int loc;
+	unsigned long int end;
+
+	/* Where rows go. NULL while the CIE's instructions run */
+	elfp_unwind_chunk *chunk;
+	int fde_start;
+
+} elfp_unwind_program;
+
+/*
+ * elfp_unwind_fp_register: DWARF number of the frame pointer of a machine.
+ *
+ * @return: The number, ELFP_UNWIND_NO_REGISTER if it is not known.
+ */
+static unsigned long int
+elfp_unwind_fp_register(unsigned int machine)
+{
+	switch(machine)
+	{
+		case EM_X86_64:
+			return 6;
+
+		case EM_386:
+			return 5;
+
+		case EM_AARCH64:
+			return 29;
+
+		case EM_ARM:
+			return 11;
+
+		case EM_RISCV:
+			return 8;
+
+		default:
+			return ELFP_UNWIND_NO_REGISTER;
+	}
+}
+
+/*
+ * elfp_unwind_endian: Byte order of this machine.
+ *
+ * @return: ELFP_UNWIND_LITTLE / ELFP_UNWIND_BIG
+ */
+static unsigned int
+elfp_unwind_endian(void)
+{
+	uint16_t one = 1;
+
+	return (*(uint8_t *)&one == 1) ? ELFP_UNWIND_LITTLE : ELFP_UNWIND_BIG;
+}
+
+/*
+ * elfp_unwind_rule_fit: Fits a register rule in an entry's 16 bits. One
+ * 	which doesn't fit becomes ELFP_UNWIND_EXPR.
+ *
+ * @return: The rule to store.
+ */
+static unsigned int
+elfp_unwind_rule_fit(unsigned int rule, long int offset, int16_t *out)
+{
+	*out = 0;
+	if(rule != ELFP_UNWIND_OFFSET && rule != ELFP_UNWIND_VAL_OFFSET &&
+					rule != ELFP_UNWIND_REGISTER)
+		return rule;
+
+	if(offset < INT16_MIN || offset > INT16_MAX)
+		return ELFP_UNWIND_EXPR;
+
+	*out = offset;
+	return rule;
+}
+
+/*
+ * elfp_unwind_entry_fill: Turns the rules into an entry.
+ */
+static void
+elfp_unwind_entry_fill(const elfp_unwind_state *state, elfp_unwind_entry *entry)
+{
+	memset(entry, 0, sizeof(elfp_unwind_entry));
+
+	entry->cfa_rule = state->cfa_rule;
+	if(state->cfa_rule == ELFP_UNWIND_CFA_REGISTER)
+	{
+		if(state->cfa_register > UINT8_MAX ||
+			state->cfa_offset < INT32_MIN || state->cfa_offset > INT32_MAX)
+			entry->cfa_rule = ELFP_UNWIND_CFA_EXPR;
+		else
+		{
+			entry->cfa_register = state->cfa_register;
+			entry->cfa_offset = state->cfa_offset;
+		}
+	}
+
+	entry->ra_rule = elfp_unwind_rule_fit(state->ra_rule, state->ra_offset,
+							&entry->ra_offset);
+	entry->fp_rule = elfp_unwind_rule_fit(state->fp_rule, state->fp_offset,
+							&entry->fp_offset);
+}
+
+/*
+ * elfp_unwind_entry_same: Checks if two entries have the same rules.
+ */
+static int
+elfp_unwind_entry_same(const elfp_unwind_entry *e1, const elfp_unwind_entry *e2)
+{
+	return e1->cfa_rule == e2->cfa_rule &&
+		e1->cfa_register == e2->cfa_register &&
+		e1->cfa_offset == e2->cfa_offset &&
+		e1->ra_rule == e2->ra_rule && e1->ra_offset == e2->ra_offset &&
+		e1->fp_rule == e2->fp_rule && e1->fp_offset == e2->fp_offset;
+}
+
+/*
+ * elfp_unwind_row_put: Puts out a row of a chunk.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_unwind_row_put(elfp_unwind_chunk *chunk, unsigned long int pc,
+			int fde_start, const elfp_unwind_state *state)
+{
+	elfp_unwind_raw *rows = NULL;
+	elfp_unwind_raw *row = NULL;
+	unsigned long int max;
+
+	if(chunk->n_rows == chunk->max_rows)
+	{
+		max = (chunk->max_rows == 0) ? 256 : chunk->max_rows * 2;
+		rows = realloc(chunk->rows, max * sizeof(elfp_unwind_raw));
+		if(rows == NULL)
+			return -1;
+		chunk->rows = rows;
+		chunk->max_rows = max;
+	}
+
+	row = chunk->rows + chunk->n_rows;
+	row->pc = pc;
+	row->fde_start = fde_start;
+	elfp_unwind_entry_fill(state, &row->entry);
+	chunk->n_rows = chunk->n_rows + 1;
+
+	return 0;
+}
+
+/*
+ * elfp_unwind_emit: Puts out a row for the current rules at the current
+ * 	location. Nothing while the CIE's instructions run, or past the
+ * 	end of the FDE.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_unwind_emit(elfp_unwind_program *program)
+{
+	if(program->chunk == NULL || program->loc >= program->end)
+		return 0;
+
+	if(elfp_unwind_row_put(program->chunk, program->loc,
+			program->fde_start, &program->state) == -1)
+		return -1;
+
+	program->fde_start = 0;
+	return 0;
+}
+
+/*
+ * elfp_unwind_rule_set: Sets the rule of a register. Only the return
+ * 	address and the frame pointer are followed.
+ */
+static void
+elfp_unwind_rule_set(elfp_unwind_program *program, unsigned long int reg,
+				unsigned int rule, long int offset)
+{
+	if(reg == program->cie->ra_register)
+	{
+		program->state.ra_rule = rule;
+		program->state.ra_offset = offset;
+	}
+	else if(reg == program->build->fp_register)
+	{
+		program->state.fp_rule = rule;
+		program->state.fp_offset = offset;
+	}
+}
+
+/*
+ * elfp_unwind_rule_restore: Sets the rule of a register back to what the
+ * 	CIE said.
+ */
+static void
+elfp_unwind_rule_restore(elfp_unwind_program *program, unsigned long int reg)
+{
+	if(reg == program->cie->ra_register)
+	{
+		program->state.ra_rule = program->initial.ra_rule;
+		program->state.ra_offset = program->initial.ra_offset;
+	}
+	else if(reg == program->build->fp_register)
+	{
+		program->state.fp_rule = program->initial.fp_rule;
+		program->state.fp_offset = program->initial.fp_offset;
+	}
+}
+
+/*
+ * elfp_unwind_advance: Moves the location forward, putting out a row for
+ * 	where it was.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_unwind_advance(elfp_unwind_program *program, unsigned long int loc)
+{
+	if(elfp_unwind_emit(program) == -1)
+		return -1;
+
+	/* Going back makes no sense. Nor does going past the end */
+	if(loc < program->loc || loc > program->end)
+		loc = program->end;
+	program->loc = loc;
+
+	return 0;
+}
+
+/*
+ * elfp_unwind_program_run: Runs call frame instructions.
+ *
+ * @return: 0 on success, -1 if an instruction is not known / broken, or a
+ * 	row couldn't be put out.
+ */
+static int
+elfp_unwind_program_run(elfp_unwind_program *program,
+		const unsigned char *insns, unsigned long int size)
+{
+	elfp_unwind_state stack[ELFP_UNWIND_STACK_MAX];
+	unsigned int depth = 0;
+	elfp_dwarf_cursor cursor;
+	unsigned long int reg, value, loc;
+	unsigned int op;
+	long int offset;
+	const elfp_frame_cie *cie = program->cie;
+	elfp_unwind_state *state = &program->state;
+
+	cursor.p = insns;
+	cursor.end = insns + size;
+	cursor.error = 0;
+
+	while(cursor.p < cursor.end && cursor.error == 0 &&
+				program->loc < program->end)
+	{
+		op = elfp_dwarf_u8(&cursor);
+
+		switch(op & 0xc0)
+		{
+			case DW_CFA_advance_loc:
+				if(elfp_unwind_advance(program, program->loc +
+					(op & 0x3f) * cie->code_align) == -1)
+					return -1;
+				continue;
+
+			case DW_CFA_offset:
+				offset = elfp_dwarf_uleb(&cursor) * cie->data_align;
+				elfp_unwind_rule_set(program, op & 0x3f,
+						ELFP_UNWIND_OFFSET, offset);
+				continue;
+
+			case DW_CFA_restore:
+				elfp_unwind_rule_restore(program, op & 0x3f);
+				continue;
+		}
+
+		switch(op)
+		{
+			case DW_CFA_nop:
+			case DW_CFA_GNU_window_save:
+				break;
+
+			case DW_CFA_set_loc:
+				if(elfp_frame_pointer_read(&cursor, cie->fde_encoding,
+						&program->section, &loc) == -1 ||
+					elfp_unwind_advance(program, loc) == -1)
+					return -1;
+				break;
+
+			case DW_CFA_advance_loc1:
+				value = elfp_dwarf_u8(&cursor);
+				if(elfp_unwind_advance(program, program->loc +
+						value * cie->code_align) == -1)
+					return -1;
+				break;
+
+			case DW_CFA_advance_loc2:
+				value = elfp_dwarf_u16(&cursor);
+				if(elfp_unwind_advance(program, program->loc +
+						value * cie->code_align) == -1)
+					return -1;
+				break;
+
+			case DW_CFA_advance_loc4:
+				value = elfp_dwarf_u32(&cursor);
+				if(elfp_unwind_advance(program, program->loc +
+						value * cie->code_align) == -1)
+					return -1;
+				break;
+
+			case DW_CFA_offset_extended:
+				reg = elfp_dwarf_uleb(&cursor);
+				offset = elfp_dwarf_uleb(&cursor) * cie->data_align;
+				elfp_unwind_rule_set(program, reg,
+						ELFP_UNWIND_OFFSET, offset);
+				break;
+
+			case DW_CFA_offset_extended_sf:
+				reg = elfp_dwarf_uleb(&cursor);
+				offset = elfp_dwarf_sleb(&cursor) * cie->data_align;
+				elfp_unwind_rule_set(program, reg,
+						ELFP_UNWIND_OFFSET, offset);
+				break;
+
+			case DW_CFA_GNU_negative_offset_extended:
+				reg = elfp_dwarf_uleb(&cursor);
+				offset = -(elfp_dwarf_uleb(&cursor) * cie->data_align);
+				elfp_unwind_rule_set(program, reg,
+						ELFP_UNWIND_OFFSET, offset);
+				break;
+
+			case DW_CFA_val_offset:
+				reg = elfp_dwarf_uleb(&cursor);
+				offset = elfp_dwarf_uleb(&cursor) * cie->data_align;
+				elfp_unwind_rule_set(program, reg,
+						ELFP_UNWIND_VAL_OFFSET, offset);
+				break;
+
+			case DW_CFA_val_offset_sf:
+				reg = elfp_dwarf_uleb(&cursor);
+				offset = elfp_dwarf_sleb(&cursor) * cie->data_align;
+				elfp_unwind_rule_set(program, reg,
+						ELFP_UNWIND_VAL_OFFSET, offset);
+				break;
+
+			case DW_CFA_restore_extended:
+				elfp_unwind_rule_restore(program,
+						elfp_dwarf_uleb(&cursor));
+				break;
+
+			case DW_CFA_undefined:
+				elfp_unwind_rule_set(program, elfp_dwarf_uleb(&cursor),
+						ELFP_UNWIND_UNDEFINED, 0);
+				break;
+
+			case DW_CFA_same_value:
+				elfp_unwind_rule_set(program, elfp_dwarf_uleb(&cursor),
+						ELFP_UNWIND_SAME, 0);
+				break;
+
+			case DW_CFA_register:
+				reg = elfp_dwarf_uleb(&cursor);
+				value = elfp_dwarf_uleb(&cursor);
+				if(value > INT16_MAX)
+					elfp_unwind_rule_set(program, reg,
+							ELFP_UNWIND_EXPR, 0);
+				else
+					elfp_unwind_rule_set(program, reg,
+						ELFP_UNWIND_REGISTER, value);
+				break;
+
+			case DW_CFA_expression:
+			case DW_CFA_val_expression:
+				reg = elfp_dwarf_uleb(&cursor);
+				elfp_dwarf_skip(&cursor, elfp_dwarf_uleb(&cursor));
+				elfp_unwind_rule_set(program, reg, ELFP_UNWIND_EXPR, 0);
+				break;
+
+			case DW_CFA_remember_state:
+				if(depth == ELFP_UNWIND_STACK_MAX)
+					return -1;
+				stack[depth] = *state;
+				depth = depth + 1;
+				break;
+
+			case DW_CFA_restore_state:
+				if(depth == 0)
+					return -1;
+				depth = depth - 1;
+				*state = stack[depth];
+				break;
+
+			case DW_CFA_def_cfa:
+				state->cfa_rule = ELFP_UNWIND_CFA_REGISTER;
+				state->cfa_register = elfp_dwarf_uleb(&cursor);
+				state->cfa_offset = elfp_dwarf_uleb(&cursor);
+				break;
+
+			case DW_CFA_def_cfa_sf:
+				state->cfa_rule = ELFP_UNWIND_CFA_REGISTER;
+				state->cfa_register = elfp_dwarf_uleb(&cursor);
+				state->cfa_offset = elfp_dwarf_sleb(&cursor) *
+							cie->data_align;
+				break;
+
+			case DW_CFA_def_cfa_register:
+				state->cfa_rule = ELFP_UNWIND_CFA_REGISTER;
+				state->cfa_register = elfp_dwarf_uleb(&cursor);
+				break;
+
+			case DW_CFA_def_cfa_offset:
+				state->cfa_offset = elfp_dwarf_uleb(&cursor);
+				break;
+
+			case DW_CFA_def_cfa_offset_sf:
+				state->cfa_offset = elfp_dwarf_sleb(&cursor) *
+							cie->data_align;
+				break;
+
+			case DW_CFA_def_cfa_expression:
+				elfp_dwarf_skip(&cursor, elfp_dwarf_uleb(&cursor));
+				state->cfa_rule = ELFP_UNWIND_CFA_EXPR;
+				break;
+
+			case DW_CFA_GNU_args_size:
+				elfp_dwarf_uleb(&cursor);
+				break;
+
+			default:
+				return -1;
+		}
+	}
+
+	if(cursor.error != 0)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * elfp_unwind_fde_compile: Runs the CIE's and an FDE's instructions, and
+ * 	puts out the rows. The last one, at the end of the FDE, says no
+ * 	FDE covers the addresses after - unless another one starts there.
+ *
+ * @return: 0 on success, -1 if a row couldn't be put out.
+ */
+static int
+elfp_unwind_fde_compile(const elfp_unwind_build *build, elfp_unwind_chunk *chunk,
+		const elfp_frame_fde *fde, const elfp_frame_cie *cie)
+{
+	elfp_unwind_program program;
+	elfp_unwind_state none;
+	int ret;
+
+	memset(&program, 0, sizeof(program));
+	program.build = build;
+	program.cie = cie;
+	program.section = *build->section;
+	program.section.addr_size = cie->addr_size;
+
+	/* Nothing is known till the CIE says */
+	program.state.cfa_rule = ELFP_UNWIND_CFA_EXPR;
+	program.state.ra_rule = ELFP_UNWIND_SAME;
+	program.state.fp_rule = ELFP_UNWIND_SAME;
+
+	program.loc = fde->pc_begin;
+	program.end = fde->pc_begin + fde->pc_range;
+	ret = elfp_unwind_program_run(&program, cie->insns, cie->insns_size);
+	program.initial = program.state;
+
+	program.chunk = chunk;
+	program.fde_start = 1;
+	if(ret == 0)
+		ret = elfp_unwind_program_run(&program, fde->insns,
+							fde->insns_size);
+
+	/* What couldn't be followed needs the FDE */
+	if(ret == -1)
+	{
+		program.state.cfa_rule = ELFP_UNWIND_CFA_EXPR;
+		program.state.ra_rule = ELFP_UNWIND_EXPR;
+		program.state.fp_rule = ELFP_UNWIND_EXPR;
+	}
+
+	if(elfp_unwind_emit(&program) == -1)
+		return -1;
+
+	memset(&none, 0, sizeof(none));
+	none.cfa_rule = ELFP_UNWIND_CFA_NONE;
+
+	return elfp_unwind_row_put(chunk, program.end, 0, &none);
+}
+
+/*
+ * elfp_unwind_task: Compiles a chunk of FDEs. One task of elfp_pool_run().
+ */
+static void
+elfp_unwind_task(void *arg, unsigned long int index)
+{
+	elfp_unwind_build *build = arg;
+	elfp_unwind_chunk *chunk = build->chunks + index;
+	elfp_frame_fde fde;
+	elfp_frame_cie cie;
+	unsigned long int i, last;
+
+	last = (index + 1) * ELFP_UNWIND_CHUNK;
+	if(last > build->n_fdes)
+		last = build->n_fdes;
+
+	for(i = index * ELFP_UNWIND_CHUNK; i < last; i++)
+	{
+		/* They were read once already */
+		if(elfp_frame_fde_read(build->section, build->fdes[i], &fde,
+								&cie) == -1)
+			continue;
+
+		if(elfp_unwind_fde_compile(build, chunk, &fde, &cie) == -1)
+		{
+			chunk->failed = 1;
+			return;
+		}
+	}
+}
+
+/*
+ * elfp_unwind_section_find: Finds the section to build from. .eh_frame -
+ * 	the section, or what .eh_frame_hdr points to if the file has no
+ * 	section headers. .debug_frame if that has no FDEs.
+ *
+ * @return: 0 if found, -1 otherwise.
+ */
+static int
+elfp_unwind_section_find(elfp_main *main, elfp_frame_section *section)
+{
+	const elfp_section *sec = NULL;
+	elfp_main_eh_hdr *eh_hdr = main->eh_hdr;
+	elfp_dwarf_cursor cursor;
+	unsigned long int offset, size;
+	int is_cie;
+
+	memset(section, 0, sizeof(elfp_frame_section));
+	section->addr_size = (elfp_main_get_class(main) == ELFCLASS32) ? 4 : 8;
+
+	sec = elfp_shdr_find(main, ".eh_frame");
+	if(sec != NULL && sec->type != SHT_NOBITS &&
+		sec->offset <= main->file_size &&
+		sec->size <= main->file_size - sec->offset)
+	{
+		section->data = elfp_main_get_range(main, sec->offset, sec->size);
+		section->size = sec->size;
+		section->offset = sec->offset;
+		section->vaddr = sec->addr;
+		section->is_eh = 1;
+		if(eh_hdr != NULL && eh_hdr->available != 0)
+			section->data_base = eh_hdr->hdr.vaddr;
+	}
+	else if(eh_hdr != NULL && eh_hdr->available != 0)
+		*section = eh_hdr->eh_frame;
+
+	/* Any FDE in there? */
+	if(section->data != NULL)
+	{
+		offset = 0;
+		while((size = elfp_frame_entry_size(section, offset, &is_cie)) != 0)
+		{
+			if(is_cie == 0)
+				return 0;
+			offset = offset + size;
+		}
+	}
+
+	if(elfp_dwarf_section_get(main, ".debug_frame", &cursor) == -1)
+		return -1;
+
+	memset(section, 0, sizeof(elfp_frame_section));
+	section->data = cursor.p;
+	section->size = cursor.end - cursor.p;
+	section->addr_size = (elfp_main_get_class(main) == ELFCLASS32) ? 4 : 8;
+	section->is_eh = 0;
+
+	return 0;
+}
+
+/*
+ * elfp_unwind_fdes_sort: Lists the FDEs of a section, sorted by where they
+ * 	start. Empty ones, and ones of code the linker threw away, are left
+ * 	out.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_unwind_fdes_sort(elfp_main *main, elfp_unwind_build *build)
+{
+	const elfp_frame_section *section = build->section;
+	unsigned long int *keys = NULL;
+	unsigned int *order = NULL;
+	unsigned long int offset, size, max, i;
+	unsigned short int type;
+	elfp_frame_fde fde;
+	elfp_frame_cie cie;
+	int is_cie, relocatable;
+
+	type = ET_NONE;
+	elfp_main_read(main, EI_NIDENT, sizeof(type), &type);
+	relocatable = (type == ET_REL);
+
+	/* An entry takes at least 8 bytes - its length and CIE pointer */
+	max = section->size / 8 + 1;
+	keys = malloc(max * sizeof(unsigned long int));
+	order = malloc(max * sizeof(unsigned int));
+	build->fdes = malloc(max * sizeof(unsigned long int));
+	if(keys == NULL || order == NULL || build->fdes == NULL)
+	{
+		free(keys);
+		free(order);
+		return -1;
+	}
+
+	offset = 0;
+	while((size = elfp_frame_entry_size(section, offset, &is_cie)) != 0 &&
+							build->n_fdes < max)
+	{
+		if(is_cie == 0 &&
+			elfp_frame_fde_read(section, offset, &fde, &cie) == 0 &&
+			fde.pc_range != 0 &&
+			fde.pc_begin + fde.pc_range > fde.pc_begin &&
+			(fde.pc_begin != 0 || relocatable != 0))
+		{
+			keys[build->n_fdes] = fde.pc_begin;
+			order[build->n_fdes] = build->n_fdes;
+			build->fdes[build->n_fdes] = offset;
+			build->n_fdes = build->n_fdes + 1;
+		}
+		offset = offset + size;
+	}
+
+	/* Stable - FDEs which start at the same place stay in section order */
+	elfp_sym_radix_sort(keys, order, build->n_fdes);
+	for(i = 0; i < build->n_fdes; i++)
+		keys[i] = build->fdes[order[i]];
+	memcpy(build->fdes, keys, build->n_fdes * sizeof(unsigned long int));
+
+	free(keys);
+	free(order);
+
+	return 0;
+}
+
+/*
+ * elfp_unwind_merge: Merges the chunks' rows into the table.
+ *
+ * 	* An FDE which starts inside an earlier one cuts it short.
+ * 	* A row with the rules of the one before it is dropped.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_unwind_merge(elfp_main *main, elfp_unwind_build *build,
+		struct elfp_unwind *table, elfp_unwind_header *header)
+{
+	elfp_unwind_raw *rows = NULL;
+	elfp_unwind_raw *row = NULL;
+	elfp_unwind_entry *entries = NULL;
+	unsigned char *addr = NULL;
+	unsigned long int total, count, i, j;
+
+	total = 0;
+	for(i = 0; i < build->n_chunks; i++)
+	{
+		if(build->chunks[i].failed != 0)
+			return -1;
+		total = total + build->chunks[i].n_rows;
+	}
+
+	if(total != 0)
+	{
+		rows = malloc(total * sizeof(elfp_unwind_raw));
+		if(rows == NULL)
+			return -1;
+	}
+
+	count = 0;
+	for(i = 0; i < build->n_chunks; i++)
+	{
+		for(j = 0; j < build->chunks[i].n_rows; j++)
+		{
+			row = build->chunks[i].rows + j;
+			if(row->fde_start != 0)
+			{
+				while(count != 0 && rows[count - 1].pc >= row->pc)
+					count = count - 1;
+			}
+			else if(count != 0 && row->pc < rows[count - 1].pc)
+				continue;
+
+			if(count != 0 && rows[count - 1].pc == row->pc)
+				count = count - 1;
+			if(count != 0 && elfp_unwind_entry_same(
+					&rows[count - 1].entry, &row->entry))
+				continue;
+
+			rows[count] = *row;
+			count = count + 1;
+		}
+	}
+
+	/* Addresses are 32-bit offsets from the first */
+	if(count != 0 && rows[count - 1].pc - rows[0].pc > UINT32_MAX)
+	{
+		elfp_err_warn("elfp_unwind_merge", "The code spans more than 4GB");
+		free(rows);
+		return -1;
+	}
+
+	table->size = sizeof(elfp_unwind_header) + count * sizeof(elfp_unwind_entry);
+	addr = elfp_main_alloc(main, table->size);
+	if(addr == NULL)
+	{
+		free(rows);
+		return -1;
+	}
+
+	header->count = count;
+	if(count != 0)
+		header->base = rows[0].pc;
+	memcpy(addr, header, sizeof(elfp_unwind_header));
+
+	entries = (elfp_unwind_entry *)(addr + sizeof(elfp_unwind_header));
+	for(i = 0; i < count; i++)
+	{
+		entries[i] = rows[i].entry;
+		entries[i].pc = rows[i].pc - header->base;
+	}
+	free(rows);
+
+	table->addr = addr;
+	table->header = (const elfp_unwind_header *)addr;
+	table->entries = entries;
+	table->count = count;
+
+	return 0;
+}
+
+/*
+ * elfp_unwind_build_table: Builds the unwind table of a file.
+ *
+ * 	* Called with index_lock held. The section index, .eh_frame_hdr
+ * 	and the notes are read already.
+ *
+ * @return: NULL on failure, the table on success.
+ */
+static struct elfp_unwind*
+elfp_unwind_build_table(elfp_main *main, const void *build_id,
+				unsigned long int build_id_size)
+{
+	struct elfp_unwind *table = NULL;
+	elfp_unwind_header header;
+	elfp_unwind_build build;
+	elfp_frame_section section;
+	unsigned short int machine;
+	unsigned long int i;
+	int ret = 0;
+
+	table = elfp_main_alloc(main, sizeof(struct elfp_unwind));
+	if(table == NULL)
+	{
+		elfp_err_warn("elfp_unwind_build_table", "elfp_main_alloc() failed");
+		return NULL;
+	}
+
+	machine = EM_NONE;
+	elfp_main_read(main, EI_NIDENT + 2, sizeof(machine), &machine);
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, ELFP_UNWIND_MAGIC, sizeof(header.magic));
+	header.version = ELFP_UNWIND_VERSION;
+	header.entry_size = sizeof(elfp_unwind_entry);
+	header.machine = machine;
+	header.addr_size = (elfp_main_get_class(main) == ELFCLASS32) ? 4 : 8;
+	header.endian = elfp_unwind_endian();
+	header.fp_register = elfp_unwind_fp_register(machine);
+	if(build_id != NULL && build_id_size <= ELFP_UNWIND_BUILD_ID_MAX)
+	{
+		memcpy(header.build_id, build_id, build_id_size);
+		header.build_id_size = build_id_size;
+	}
+
+	memset(&build, 0, sizeof(build));
+	build.fp_register = header.fp_register;
+	build.section = &section;
+	if(elfp_unwind_section_find(main, &section) == 0)
+	{
+		ret = elfp_unwind_fdes_sort(main, &build);
+		if(ret == 0 && build.n_fdes != 0)
+		{
+			build.n_chunks = (build.n_fdes + ELFP_UNWIND_CHUNK - 1) /
+							ELFP_UNWIND_CHUNK;
+			build.chunks = calloc(build.n_chunks, sizeof(elfp_unwind_chunk));
+			if(build.chunks == NULL)
+				ret = -1;
+		}
+
+		/* Small ones are over before the threads would have started */
+		if(ret == 0)
+			ret = elfp_pool_run(build.n_chunks, (build.n_fdes >=
+				ELFP_UNWIND_PARALLEL_MIN) ? 0 : 1,
+				elfp_unwind_task, &build);
+	}
+
+	if(ret == 0)
+		ret = elfp_unwind_merge(main, &build, table, &header);
+
+	for(i = 0; i < build.n_chunks; i++)
+		free(build.chunks[i].rows);
+	free(build.chunks);
+	free(build.fdes);
+
+	if(ret == -1)
+	{
+		elfp_err_warn("elfp_unwind_build_table", "Compiling the FDEs failed");
+		return NULL;
+	}
+
+	return table;
+}
+
+/*
+ * elfp_unwind_build_id: Finds the build-id note of a file - in the
+ * 	segments, or the sections if there are none.
+ *
+ * @return: The build-id, NULL if there is none.
+ */
+static const void*
+elfp_unwind_build_id(elfp_main *main, unsigned long int *size)
+{
+	elfp_main_notes *notes = NULL;
+	unsigned long int i;
+	int source;
+
+	for(source = ELFP_NOTES_SEGMENTS; source <= ELFP_NOTES_SECTIONS; source++)
+	{
+		notes = elfp_note_index_get(main, source);
+		for(i = 0; notes != NULL && i < notes->count; i++)
+		{
+			if(notes->notes[i].type == NT_GNU_BUILD_ID &&
+				notes->notes[i].descsz != 0 &&
+				strcmp(notes->notes[i].name, "GNU") == 0)
+			{
+				*size = notes->notes[i].descsz;
+				return notes->notes[i].desc;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+struct elfp_unwind*
+elfp_unwind_get(elfp_main *main)
+{
+	/* Basic check */
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_unwind_get", "NULL argument passed");
+		return NULL;
+	}
+
+	struct elfp_unwind *table = NULL;
+	const void *build_id = NULL;
+	unsigned long int build_id_size = 0;
+
+	/* Built already? */
+	table = __atomic_load_n(&main->unwind, __ATOMIC_ACQUIRE);
+	if(table != NULL)
+		return table;
+
+	/* The section index, .eh_frame_hdr and the notes take index_lock
+	 * themselves. Get them out of the way first */
+	if(elfp_shdr_index_get(main) == NULL || elfp_frame_eh_hdr_get(main) == NULL)
+	{
+		elfp_err_warn("elfp_unwind_get", "Failed to get the section index / .eh_frame_hdr");
+		return NULL;
+	}
+	build_id = elfp_unwind_build_id(main, &build_id_size);
+
+	/* Only one thread builds it. Others wait and use it */
+	pthread_mutex_lock(&main->index_lock);
+	table = main->unwind;
+	if(table == NULL)
+	{
+		table = elfp_unwind_build_table(main, build_id, build_id_size);
+		if(table != NULL)
+			__atomic_store_n(&main->unwind, table, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&main->index_lock);
+
+	if(table == NULL)
+		elfp_err_warn("elfp_unwind_get", "elfp_unwind_build_table() failed");
+
+	return table;
+}
+
+/*
+ * elfp_unwind_find: Finds the row of an address.
+ *
+ * @return: 0 on success, -1 if no FDE covers the address.
+ */
+static int
+elfp_unwind_find(const struct elfp_unwind *table, unsigned long int pc,
+						elfp_unwind_row *row)
+{
+	const elfp_unwind_entry *entry = NULL;
+	unsigned long int base, low, high, middle, offset;
+
+	/* The last row is where the last FDE ends. Nothing is after it */
+	base = table->header->base;
+	if(table->count < 2 || pc < base ||
+		pc - base >= table->entries[table->count - 1].pc)
+		return -1;
+	offset = pc - base;
+
+	/* The last entry which starts at / before pc */
+	low = 0;
+	high = table->count;
+	while(low < high)
+	{
+		middle = low + (high - low) / 2;
+		if(table->entries[middle].pc <= offset)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	if(low == 0)
+		return -1;
+
+	entry = table->entries + low - 1;
+	if(entry->cfa_rule == ELFP_UNWIND_CFA_NONE)
+		return -1;
+
+	row->pc_begin = base + entry->pc;
+	row->pc_end = base + entry[1].pc;
+	row->cfa_rule = entry->cfa_rule;
+	row->cfa_register = entry->cfa_register;
+	row->cfa_offset = entry->cfa_offset;
+	row->ra_rule = entry->ra_rule;
+	row->ra_offset = entry->ra_offset;
+	row->fp_rule = entry->fp_rule;
+	row->fp_offset = entry->fp_offset;
+
+	return 0;
+}
+
+/*
+ * elfp_unwind_rule_print: Prints a register rule.
+ */
+static void
+elfp_unwind_rule_print(const char *name, unsigned int rule, long int offset)
+{
+	switch(rule)
+	{
+		case ELFP_UNWIND_UNDEFINED:
+			printf(" %s=undefined", name);
+			break;
+
+		case ELFP_UNWIND_SAME:
+			printf(" %s=same", name);
+			break;
+
+		case ELFP_UNWIND_OFFSET:
+			printf(" %s=[CFA%+ld]", name, offset);
+			break;
+
+		case ELFP_UNWIND_VAL_OFFSET:
+			printf(" %s=CFA%+ld", name, offset);
+			break;
+
+		case ELFP_UNWIND_REGISTER:
+			printf(" %s=r%ld", name, offset);
+			break;
+
+		default:
+			printf(" %s=expr", name);
+			break;
+	}
+}
+
+/*
+ * All functions defined below are exposed to programmers.
+ *
+ * Refer to elfp.h for more details.
+ */
+
+unsigned long int
+elfp_unwind_count(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_unwind_count", "Handle failed the sanity test");
+		return 0;
+	}
+
+	elfp_main *main = NULL;
+	struct elfp_unwind *table = NULL;
+	unsigned long int count = 0;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_unwind_count", "elfp_main_vec_get_em() failed");
+		return 0;
+	}
+
+	table = elfp_unwind_get(main);
+	if(table != NULL)
+		count = table->count;
+	elfp_main_vec_put_em(handle);
+
+	return count;
+}
+
+int
+elfp_unwind_lookup(int handle, unsigned long int pc, elfp_unwind_row *row)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || row == NULL)
+	{
+		elfp_err_warn("elfp_unwind_lookup", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	struct elfp_unwind *table = NULL;
+	int ret = -1;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_unwind_lookup", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	table = elfp_unwind_get(main);
+	if(table != NULL)
+		ret = elfp_unwind_find(table, pc, row);
+	elfp_main_vec_put_em(handle);
+
+	return ret;
+}
+
+int
+elfp_unwind_save(int handle, const char *path)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || path == NULL)
+	{
+		elfp_err_warn("elfp_unwind_save", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	struct elfp_unwind *table = NULL;
+	char *tmp_path = NULL;
+	unsigned long int done = 0;
+	ssize_t nwritten;
+	int fd, ret = -1;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_unwind_save", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	table = elfp_unwind_get(main);
+	if(table == NULL)
+	{
+		elfp_err_warn("elfp_unwind_save", "elfp_unwind_get() failed");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	tmp_path = malloc(strlen(path) + sizeof(".tmp"));
+	if(tmp_path == NULL)
+	{
+		elfp_err_warn("elfp_unwind_save", "malloc() failed");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+	sprintf(tmp_path, "%s.tmp", path);
+
+	fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if(fd == -1)
+	{
+		elfp_err_warn("elfp_unwind_save", "open() failed");
+		free(tmp_path);
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	while(done < table->size)
+	{
+		nwritten = write(fd, table->addr + done, table->size - done);
+		if(nwritten <= 0)
+			break;
+		done = done + nwritten;
+	}
+
+	if(close(fd) == 0 && done == table->size &&
+				rename(tmp_path, path) == 0)
+		ret = 0;
+	else
+	{
+		elfp_err_warn("elfp_unwind_save", "Writing the table failed");
+		unlink(tmp_path);
+	}
+
+	free(tmp_path);
+	elfp_main_vec_put_em(handle);
+
+	return ret;
+}
+
+int
+elfp_unwind_dump(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_unwind_dump", "Handle failed the sanity test");
+		return -1;
+	}
+
+	elfp_main *main = NULL;
+	struct elfp_unwind *table = NULL;
+	const elfp_unwind_header *header = NULL;
+	const elfp_unwind_entry *entry = NULL;
+	unsigned long int i;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_unwind_dump", "elfp_main_vec_get_em() failed");
+		return -1;
+	}
+
+	table = elfp_unwind_get(main);
+	if(table == NULL)
+	{
+		elfp_err_warn("elfp_unwind_dump", "elfp_unwind_get() failed");
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	header = table->header;
+	printf("Unwind table: %lu rows from 0x%lx, machine %u, frame pointer ",
+			table->count, (unsigned long int)header->base,
+			header->machine);
+	if(header->fp_register == ELFP_UNWIND_NO_REGISTER)
+		printf("not known");
+	else
+		printf("r%u", header->fp_register);
+	printf(", %lu bytes\n", table->size);
+
+	for(i = 0; i < table->count; i++)
+	{
+		entry = table->entries + i;
+		printf("\t0x%lx:", (unsigned long int)(header->base + entry->pc));
+
+		if(entry->cfa_rule == ELFP_UNWIND_CFA_NONE)
+		{
+			printf(" no FDE\n");
+			continue;
+		}
+
+		if(entry->cfa_rule == ELFP_UNWIND_CFA_REGISTER)
+			printf(" CFA=r%u%+d", entry->cfa_register,
+						entry->cfa_offset);
+		else
+			printf(" CFA=expr");
+
+		elfp_unwind_rule_print("RA", entry->ra_rule, entry->ra_offset);
+		if(header->fp_register != ELFP_UNWIND_NO_REGISTER)
+			elfp_unwind_rule_print("FP", entry->fp_rule,
+							entry->fp_offset);
+		printf("\n");
+	}
+
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
+
+elfp_unwind*
+elfp_unwind_open(const char *path)
+{
+	/* Basic check */
+	if(path == NULL)
+	{
+		elfp_err_warn("elfp_unwind_open", "NULL argument passed");
+		return NULL;
+	}
+
+	struct elfp_unwind *table = NULL;
+	const elfp_unwind_header *header = NULL;
+	struct stat st;
+	void *addr = NULL;
+	unsigned long int i;
+	int fd;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if(fd == -1)
+	{
+		elfp_err_warn("elfp_unwind_open", "open() failed");
+		return NULL;
+	}
+
+	if(fstat(fd, &st) == -1 ||
+		(unsigned long int)st.st_size < sizeof(elfp_unwind_header))
+	{
+		elfp_err_warn("elfp_unwind_open", "fstat() failed / too small");
+		close(fd);
+		return NULL;
+	}
+
+	/* The mapping stays even after the descriptor is gone */
+	addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(addr == MAP_FAILED)
+	{
+		elfp_err_warn("elfp_unwind_open", "mmap() failed");
+		return NULL;
+	}
+
+	table = calloc(1, sizeof(struct elfp_unwind));
+	if(table == NULL)
+	{
+		elfp_err_warn("elfp_unwind_open", "calloc() failed");
+		munmap(addr, st.st_size);
+		return NULL;
+	}
+
+	table->addr = addr;
+	table->size = st.st_size;
+	table->header = header = addr;
+	table->entries = (const elfp_unwind_entry *)(table->addr +
+						sizeof(elfp_unwind_header));
+
+	if(memcmp(header->magic, ELFP_UNWIND_MAGIC, sizeof(header->magic)) != 0 ||
+		header->version != ELFP_UNWIND_VERSION ||
+		header->entry_size != sizeof(elfp_unwind_entry) ||
+		header->endian != elfp_unwind_endian() ||
+		header->build_id_size > ELFP_UNWIND_BUILD_ID_MAX ||
+		header->count != (table->size - sizeof(elfp_unwind_header)) /
+						sizeof(elfp_unwind_entry) ||
+		(table->size - sizeof(elfp_unwind_header)) %
+						sizeof(elfp_unwind_entry) != 0)
+	{
+		elfp_err_warn("elfp_unwind_open", "Not a (supported) unwind table");
+		elfp_unwind_close(table);
+		return NULL;
+	}
+	table->count = header->count;
+
+	/* A binary search in one which is not sorted finds the wrong rows */
+	for(i = 1; i < table->count; i++)
+	{
+		if(table->entries[i].pc < table->entries[i - 1].pc)
+		{
+			elfp_err_warn("elfp_unwind_open", "Unwind table is not sorted");
+			elfp_unwind_close(table);
+			return NULL;
+		}
+	}
+
+	return table;
+}
+
+int
+elfp_unwind_table_lookup(const elfp_unwind *table, unsigned long int pc,
+						elfp_unwind_row *row)
+{
+	/* Basic check */
+	if(table == NULL || row == NULL)
+	{
+		elfp_err_warn("elfp_unwind_table_lookup", "NULL argument(s) passed");
+		return -1;
+	}
+
+	return elfp_unwind_find(table, pc, row);
+}
+
+const void*
+elfp_unwind_table_build_id(const elfp_unwind *table, unsigned long int *size)
+{
+	/* Basic check */
+	if(table == NULL || size == NULL)
+	{
+		elfp_err_warn("elfp_unwind_table_build_id", "NULL argument(s) passed");
+		return NULL;
+	}
+
+	if(table->header->build_id_size == 0)
+		return NULL;
+
+	*size = table->header->build_id_size;
+	return table->header->build_id;
+}
+
+void
+elfp_unwind_close(elfp_unwind *table)
+{
+	if(table == NULL)
+		return;
+
+	munmap((void *)table->addr, table->size);
+	free(table);
+}
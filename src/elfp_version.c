@@ -0,0 +1,865 @@
+/*
+ * File: elfp_version.c
+ *
+ * Description: Symbol versioning. The versions a file defines
+ * 	(.gnu.version_d), the ones it needs (.gnu.version_r), the version of
+ * 	every dynamic symbol (.gnu.version), and the highest version needed
+ * 	of every family of every library.
+ *
+ * 	* The tables are decoded once per file, the first time they are
+ * 	used. Lookups after that are array accesses.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#include "./include/elfp_version.h"
+#include "./include/elfp_shdr.h"
+#include "./include/elfp_dyn.h"
+#include "./include/elfp_int.h"
+#include "./include/elfp_err.h"
+#include "./include/elfp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <elf.h>
+
+/* Where the tables are. Any of them can be missing */
+typedef struct elfp_version_tables
+{
+	const unsigned char *verdef;
+	unsigned long int verdef_size;
+	unsigned long int verdef_num;
+
+	const unsigned char *verneed;
+	unsigned long int verneed_size;
+	unsigned long int verneed_num;
+
+	const unsigned char *versym;
+	unsigned long int versym_size;
+
+	const char *strtab;
+	unsigned long int strsize;
+
+} elfp_version_tables;
+
+/*
+ * elfp_version_string: Gets a string from the table's string table.
+ *
+ * @return: NULL if the offset is junk, the string otherwise.
+ */
+static const char*
+elfp_version_string(const elfp_version_tables *tables, unsigned long int offset)
+{
+	if(tables->strtab == NULL || offset >= tables->strsize)
+		return NULL;
+
+	if(memchr(tables->strtab + offset, '\0', tables->strsize - offset) == NULL)
+		return NULL;
+
+	return tables->strtab + offset;
+}
+
+/*
+ * elfp_version_sections_find: Finds the tables through the section
+ * 	headers. The string table is the one sh_link points to.
+ *
+ * @return: 0 if any of them is there, -1 otherwise.
+ */
+static int
+elfp_version_sections_find(elfp_main *main, elfp_version_tables *tables)
+{
+	elfp_main_sections *sections = main->sections;
+	const elfp_section *secs[3];
+	const elfp_section *strsec = NULL;
+	int i, found = 0;
+
+	secs[0] = elfp_shdr_find_type(main, SHT_GNU_verdef);
+	secs[1] = elfp_shdr_find_type(main, SHT_GNU_verneed);
+	secs[2] = elfp_shdr_find_type(main, SHT_GNU_versym);
+
+	for(i = 0; i < 3; i++)
+	{
+		if(secs[i] == NULL)
+			continue;
+		found = 1;
+
+		/* All of them use .dynstr. .gnu.version links to .dynsym */
+		if(tables->strtab == NULL && i != 2 &&
+				secs[i]->link < sections->count)
+		{
+			strsec = sections->secs + secs[i]->link;
+			tables->strtab = elfp_shdr_data_get(main, strsec);
+			if(tables->strtab != NULL)
+				tables->strsize = strsec->size;
+		}
+	}
+
+	if(found == 0)
+		return -1;
+
+	if(secs[0] != NULL)
+	{
+		tables->verdef = elfp_shdr_data_get(main, secs[0]);
+		tables->verdef_size = (tables->verdef != NULL) ? secs[0]->size : 0;
+		tables->verdef_num = secs[0]->info;
+	}
+
+	if(secs[1] != NULL)
+	{
+		tables->verneed = elfp_shdr_data_get(main, secs[1]);
+		tables->verneed_size = (tables->verneed != NULL) ? secs[1]->size : 0;
+		tables->verneed_num = secs[1]->info;
+	}
+
+	if(secs[2] != NULL)
+	{
+		tables->versym = elfp_shdr_data_get(main, secs[2]);
+		tables->versym_size = (tables->versym != NULL) ? secs[2]->size : 0;
+	}
+
+	return 0;
+}
+
+/*
+ * elfp_version_table_map: Maps a table the DYNAMIC segment points to,
+ * 	till the end of its segment.
+ *
+ * @return: NULL if it is not in the file, its address otherwise.
+ */
+static const unsigned char*
+elfp_version_table_map(elfp_main *main, elfp_main_dynamic *dynamic,
+			unsigned long int vaddr, unsigned long int *size)
+{
+	unsigned long int offset;
+
+	*size = 0;
+	if(vaddr == 0 ||
+		elfp_dyn_vaddr_to_offset(dynamic, vaddr, &offset, size) == -1)
+		return NULL;
+
+	return elfp_main_get_range(main, offset, *size);
+}
+
+/*
+ * elfp_version_dynamic_find: Finds the tables through the DYNAMIC segment.
+ * 	The sizes are not known - they are taken till the end of the
+ * 	segments.
+ */
+static void
+elfp_version_dynamic_find(elfp_main *main, elfp_version_tables *tables)
+{
+	elfp_main_dynamic *dynamic = main->dynamic;
+	unsigned long int i, tag, val;
+	unsigned long int verdef = 0, verneed = 0, versym = 0;
+
+	for(i = 0; i < dynamic->count; i++)
+	{
+		elfp_dyn_entry_get(main, dynamic, i, &tag, &val);
+		if(tag == DT_VERDEF)
+			verdef = val;
+		else if(tag == DT_VERDEFNUM)
+			tables->verdef_num = val;
+		else if(tag == DT_VERNEED)
+			verneed = val;
+		else if(tag == DT_VERNEEDNUM)
+			tables->verneed_num = val;
+		else if(tag == DT_VERSYM)
+			versym = val;
+	}
+
+	tables->strtab = dynamic->strtab;
+	tables->strsize = dynamic->strsize;
+	tables->verdef = elfp_version_table_map(main, dynamic, verdef,
+						&tables->verdef_size);
+	tables->verneed = elfp_version_table_map(main, dynamic, verneed,
+						&tables->verneed_size);
+	tables->versym = elfp_version_table_map(main, dynamic, versym,
+						&tables->versym_size);
+
+	/* One entry per dynamic symbol */
+	if(tables->versym_size / 2 > dynamic->syms_max)
+		tables->versym_size = dynamic->syms_max * 2;
+}
+
+/*
+ * elfp_version_defs_read: Decodes .gnu.version_d.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_version_defs_read(elfp_main *main, const elfp_version_tables *tables,
+					elfp_main_versions *versions)
+{
+	Elf64_Verdef verdef;
+	Elf64_Verdaux verdaux;
+	elfp_verdef *def = NULL;
+	unsigned long int offset, aux, max, i;
+	const unsigned char *data = tables->verdef;
+	unsigned long int size = tables->verdef_size;
+
+	/* Same layout for 32-bit and 64-bit files */
+	max = size / sizeof(Elf64_Verdef);
+	if(data == NULL || max == 0)
+		return 0;
+
+	versions->defs = elfp_main_alloc(main, max * sizeof(elfp_verdef));
+	if(versions->defs == NULL)
+		return -1;
+
+	offset = 0;
+	for(i = 0; i < tables->verdef_num && versions->n_defs < max; i++)
+	{
+		if(offset > size - sizeof(Elf64_Verdef))
+		{
+			versions->n_broken++;
+			break;
+		}
+
+		memcpy(&verdef, data + offset, sizeof(Elf64_Verdef));
+		if(verdef.vd_version != VER_DEF_CURRENT)
+		{
+			versions->n_broken++;
+			break;
+		}
+
+		def = versions->defs + versions->n_defs;
+		memset(def, 0, sizeof(elfp_verdef));
+		def->index = verdef.vd_ndx;
+		def->flags = verdef.vd_flags;
+		def->hash = verdef.vd_hash;
+
+		/* The name, then the parent */
+		aux = offset + verdef.vd_aux;
+		if(verdef.vd_cnt >= 1 && aux <= size - sizeof(Elf64_Verdaux))
+		{
+			memcpy(&verdaux, data + aux, sizeof(Elf64_Verdaux));
+			def->name = elfp_version_string(tables, verdaux.vda_name);
+
+			aux = aux + verdaux.vda_next;
+			if(verdef.vd_cnt >= 2 && verdaux.vda_next != 0 &&
+				aux <= size - sizeof(Elf64_Verdaux))
+			{
+				memcpy(&verdaux, data + aux, sizeof(Elf64_Verdaux));
+				def->parent = elfp_version_string(tables,
+							verdaux.vda_name);
+			}
+		}
+
+		if(def->name == NULL)
+			versions->n_broken++;
+		else
+			versions->n_defs++;
+
+		if(verdef.vd_next == 0)
+			break;
+		offset = offset + verdef.vd_next;
+	}
+
+	return 0;
+}
+
+/*
+ * elfp_version_needs_read: Decodes .gnu.version_r.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_version_needs_read(elfp_main *main, const elfp_version_tables *tables,
+					elfp_main_versions *versions)
+{
+	Elf64_Verneed verneed;
+	Elf64_Vernaux vernaux;
+	elfp_verneed *need = NULL;
+	unsigned long int offset, aux, max, i, j;
+	const unsigned char *data = tables->verneed;
+	unsigned long int size = tables->verneed_size;
+	const char *file = NULL;
+
+	/* Same layout for 32-bit and 64-bit files */
+	max = size / sizeof(Elf64_Vernaux);
+	if(data == NULL || max == 0)
+		return 0;
+
+	versions->needs = elfp_main_alloc(main, max * sizeof(elfp_verneed));
+	if(versions->needs == NULL)
+		return -1;
+
+	offset = 0;
+	for(i = 0; i < tables->verneed_num; i++)
+	{
+		if(offset > size - sizeof(Elf64_Verneed))
+		{
+			versions->n_broken++;
+			break;
+		}
+
+		memcpy(&verneed, data + offset, sizeof(Elf64_Verneed));
+		if(verneed.vn_version != VER_NEED_CURRENT)
+		{
+			versions->n_broken++;
+			break;
+		}
+
+		file = elfp_version_string(tables, verneed.vn_file);
+		aux = offset + verneed.vn_aux;
+		for(j = 0; j < verneed.vn_cnt && versions->n_needs < max; j++)
+		{
+			if(aux > size - sizeof(Elf64_Vernaux))
+			{
+				versions->n_broken++;
+				break;
+			}
+
+			memcpy(&vernaux, data + aux, sizeof(Elf64_Vernaux));
+			need = versions->needs + versions->n_needs;
+			need->file = file;
+			need->name = elfp_version_string(tables, vernaux.vna_name);
+			need->index = vernaux.vna_other;
+			need->flags = vernaux.vna_flags;
+			need->hash = vernaux.vna_hash;
+
+			if(file == NULL || need->name == NULL)
+				versions->n_broken++;
+			else
+				versions->n_needs++;
+
+			if(vernaux.vna_next == 0)
+				break;
+			aux = aux + vernaux.vna_next;
+		}
+
+		if(verneed.vn_next == 0)
+			break;
+		offset = offset + verneed.vn_next;
+	}
+
+	return 0;
+}
+
+/*
+ * elfp_version_family_len: Length of the family of a version - what
+ * 	comes before the number. The whole name if it has no number.
+ */
+static unsigned long int
+elfp_version_family_len(const char *name)
+{
+	const char *p = NULL;
+
+	for(p = name; *p != '\0'; p++)
+	{
+		if(*p == '_' && p[1] >= '0' && p[1] <= '9')
+			return p + 1 - name;
+	}
+
+	return p - name;
+}
+
+/*
+ * elfp_version_maxes_build: Finds the highest version of every (library,
+ * 	family) pair the file needs.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_version_maxes_build(elfp_main *main, elfp_main_versions *versions)
+{
+	const elfp_verneed *need = NULL;
+	elfp_version_family *entry = NULL;
+	unsigned long int i, j, family_len;
+
+	if(versions->n_needs == 0)
+		return 0;
+
+	versions->maxes = elfp_main_alloc(main,
+			versions->n_needs * sizeof(elfp_version_family));
+	if(versions->maxes == NULL)
+		return -1;
+
+	for(i = 0; i < versions->n_needs; i++)
+	{
+		need = versions->needs + i;
+		family_len = elfp_version_family_len(need->name);
+
+		for(j = 0; j < versions->n_maxes; j++)
+		{
+			entry = versions->maxes + j;
+			if(entry->family_len == family_len &&
+				strcmp(entry->file, need->file) == 0 &&
+				strncmp(entry->name, need->name, family_len) == 0)
+				break;
+		}
+
+		if(j == versions->n_maxes)
+		{
+			entry = versions->maxes + versions->n_maxes;
+			entry->file = need->file;
+			entry->name = need->name;
+			entry->family_len = family_len;
+			versions->n_maxes++;
+		}
+		else if(elfp_version_cmp(need->name, entry->name) > 0)
+			entry->name = need->name;
+
+		entry->n_versions++;
+	}
+
+	return 0;
+}
+
+/*
+ * elfp_version_by_index_build: Lists every version by the number
+ * 	.gnu.version refers to it by.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+static int
+elfp_version_by_index_build(elfp_main *main, elfp_main_versions *versions)
+{
+	unsigned long int i, index;
+
+	versions->n_index = 0;
+	for(i = 0; i < versions->n_defs; i++)
+	{
+		index = versions->defs[i].index & ELFP_VERSYM_INDEX;
+		if(index >= versions->n_index)
+			versions->n_index = index + 1;
+	}
+	for(i = 0; i < versions->n_needs; i++)
+	{
+		index = versions->needs[i].index & ELFP_VERSYM_INDEX;
+		if(index >= versions->n_index)
+			versions->n_index = index + 1;
+	}
+
+	if(versions->n_index == 0)
+		return 0;
+
+	versions->by_index = elfp_main_alloc(main,
+			versions->n_index * sizeof(const elfp_verneed *));
+	versions->def_by_index = elfp_main_alloc(main,
+			versions->n_index * sizeof(const elfp_verdef *));
+	if(versions->by_index == NULL || versions->def_by_index == NULL)
+		return -1;
+
+	for(i = 0; i < versions->n_defs; i++)
+	{
+		index = versions->defs[i].index & ELFP_VERSYM_INDEX;
+		versions->def_by_index[index] = versions->defs + i;
+	}
+	for(i = 0; i < versions->n_needs; i++)
+	{
+		index = versions->needs[i].index & ELFP_VERSYM_INDEX;
+		versions->by_index[index] = versions->needs + i;
+	}
+
+	return 0;
+}
+
+/*
+ * elfp_version_index_build: Decodes the version tables of a file.
+ *
+ * 	* Called with index_lock held. The section index and the dynamic
+ * 	index are built already.
+ *
+ * @return: NULL on failure, the tables on success.
+ */
+static elfp_main_versions*
+elfp_version_index_build(elfp_main *main)
+{
+	elfp_main_versions *versions = NULL;
+	elfp_version_tables tables;
+
+	versions = elfp_main_alloc(main, sizeof(elfp_main_versions));
+	if(versions == NULL)
+	{
+		elfp_err_warn("elfp_version_index_build", "elfp_main_alloc() failed");
+		return NULL;
+	}
+
+	/* The sections, or what the loader uses if there are none */
+	memset(&tables, 0, sizeof(tables));
+	if(elfp_version_sections_find(main, &tables) == -1)
+		elfp_version_dynamic_find(main, &tables);
+
+	if(elfp_version_defs_read(main, &tables, versions) == -1 ||
+		elfp_version_needs_read(main, &tables, versions) == -1 ||
+		elfp_version_maxes_build(main, versions) == -1 ||
+		elfp_version_by_index_build(main, versions) == -1)
+	{
+		elfp_err_warn("elfp_version_index_build", "elfp_main_alloc() failed");
+		return NULL;
+	}
+
+	versions->versym = tables.versym;
+	versions->n_versym = tables.versym_size / 2;
+
+	if(versions->n_broken != 0)
+		elfp_err_warn("elfp_version_index_build", "Broken version entries left out");
+
+	return versions;
+}
+
+elfp_main_versions*
+elfp_version_index_get(elfp_main *main)
+{
+	/* Basic check */
+	if(main == NULL)
+	{
+		elfp_err_warn("elfp_version_index_get", "NULL argument passed");
+		return NULL;
+	}
+
+	elfp_main_versions *versions = NULL;
+
+	/* Built already? */
+	versions = __atomic_load_n(&main->versions, __ATOMIC_ACQUIRE);
+	if(versions != NULL)
+		return versions;
+
+	/* The section index and the dynamic index take index_lock
+	 * themselves. Get them out of the way first */
+	if(elfp_shdr_index_get(main) == NULL || elfp_dyn_index_get(main) == NULL)
+	{
+		elfp_err_warn("elfp_version_index_get", "Failed to get the section / dynamic index");
+		return NULL;
+	}
+
+	/* Only one thread builds it. Others wait and use it */
+	pthread_mutex_lock(&main->index_lock);
+	versions = main->versions;
+	if(versions == NULL)
+	{
+		versions = elfp_version_index_build(main);
+		if(versions != NULL)
+			__atomic_store_n(&main->versions, versions, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&main->index_lock);
+
+	if(versions == NULL)
+		elfp_err_warn("elfp_version_index_get", "elfp_version_index_build() failed");
+
+	return versions;
+}
+
+/*
+ * elfp_version_handle_get: Gets the version tables of a handle's file.
+ * 	The handle is left held on success - the caller puts it back.
+ *
+ * @return: NULL on failure, the tables on success.
+ */
+static elfp_main_versions*
+elfp_version_handle_get(int handle, const char *caller)
+{
+	elfp_main *main = NULL;
+	elfp_main_versions *versions = NULL;
+
+	main = elfp_main_vec_get_em(handle);
+	if(main == NULL)
+	{
+		elfp_err_warn(caller, "elfp_main_vec_get_em() failed");
+		return NULL;
+	}
+
+	versions = elfp_version_index_get(main);
+	if(versions == NULL)
+	{
+		elfp_err_warn(caller, "elfp_version_index_get() failed");
+		elfp_main_vec_put_em(handle);
+		return NULL;
+	}
+
+	return versions;
+}
+
+/*
+ * All functions defined below are exposed to programmers.
+ *
+ * Refer to elfp.h for more details.
+ */
+
+int
+elfp_version_cmp(const char *version1, const char *version2)
+{
+	const unsigned char *p1 = (const unsigned char *)version1;
+	const unsigned char *p2 = (const unsigned char *)version2;
+	unsigned long int n1, n2;
+
+	while(*p1 != '\0' && *p2 != '\0')
+	{
+		/* Numbers are compared as numbers */
+		if(*p1 >= '0' && *p1 <= '9' && *p2 >= '0' && *p2 <= '9')
+		{
+			for(n1 = 0; *p1 >= '0' && *p1 <= '9'; p1++)
+				n1 = n1 * 10 + (*p1 - '0');
+			for(n2 = 0; *p2 >= '0' && *p2 <= '9'; p2++)
+				n2 = n2 * 10 + (*p2 - '0');
+
+			if(n1 != n2)
+				return (n1 < n2) ? -1 : 1;
+			continue;
+		}
+
+		if(*p1 != *p2)
+			return (*p1 < *p2) ? -1 : 1;
+		p1++;
+		p2++;
+	}
+
+	/* "2.3" is before "2.3.4" */
+	return (*p1 != '\0') - (*p2 != '\0');
+}
+
+long int
+elfp_version_max(int handle, elfp_version_family *maxes, unsigned long int max)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || (maxes == NULL && max != 0))
+	{
+		elfp_err_warn("elfp_version_max", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main_versions *versions = NULL;
+	long int count;
+
+	versions = elfp_version_handle_get(handle, "elfp_version_max");
+	if(versions == NULL)
+		return -1;
+
+	if(max > versions->n_maxes)
+		max = versions->n_maxes;
+	if(max != 0)
+		memcpy(maxes, versions->maxes, max * sizeof(elfp_version_family));
+	count = versions->n_maxes;
+	elfp_main_vec_put_em(handle);
+
+	return count;
+}
+
+unsigned long int
+elfp_verneed_count(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_verneed_count", "Handle failed the sanity test");
+		return 0;
+	}
+
+	elfp_main_versions *versions = NULL;
+	unsigned long int count;
+
+	versions = elfp_version_handle_get(handle, "elfp_verneed_count");
+	if(versions == NULL)
+		return 0;
+
+	count = versions->n_needs;
+	elfp_main_vec_put_em(handle);
+
+	return count;
+}
+
+int
+elfp_verneed_get(int handle, unsigned long int index, elfp_verneed *need)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || need == NULL)
+	{
+		elfp_err_warn("elfp_verneed_get", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main_versions *versions = NULL;
+	int ret = -1;
+
+	versions = elfp_version_handle_get(handle, "elfp_verneed_get");
+	if(versions == NULL)
+		return -1;
+
+	if(index < versions->n_needs)
+	{
+		*need = versions->needs[index];
+		ret = 0;
+	}
+	elfp_main_vec_put_em(handle);
+
+	return ret;
+}
+
+unsigned long int
+elfp_verdef_count(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_verdef_count", "Handle failed the sanity test");
+		return 0;
+	}
+
+	elfp_main_versions *versions = NULL;
+	unsigned long int count;
+
+	versions = elfp_version_handle_get(handle, "elfp_verdef_count");
+	if(versions == NULL)
+		return 0;
+
+	count = versions->n_defs;
+	elfp_main_vec_put_em(handle);
+
+	return count;
+}
+
+int
+elfp_verdef_get(int handle, unsigned long int index, elfp_verdef *def)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || def == NULL)
+	{
+		elfp_err_warn("elfp_verdef_get", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main_versions *versions = NULL;
+	int ret = -1;
+
+	versions = elfp_version_handle_get(handle, "elfp_verdef_get");
+	if(versions == NULL)
+		return -1;
+
+	if(index < versions->n_defs)
+	{
+		*def = versions->defs[index];
+		ret = 0;
+	}
+	elfp_main_vec_put_em(handle);
+
+	return ret;
+}
+
+int
+elfp_versym_get(int handle, unsigned long int index, elfp_versym *versym)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1 || versym == NULL)
+	{
+		elfp_err_warn("elfp_versym_get", "Invalid argument(s) passed");
+		return -1;
+	}
+
+	elfp_main_versions *versions = NULL;
+	uint16_t value;
+	unsigned int version;
+	int ret = -1;
+
+	versions = elfp_version_handle_get(handle, "elfp_versym_get");
+	if(versions == NULL)
+		return -1;
+
+	if(index >= versions->n_versym)
+	{
+		elfp_main_vec_put_em(handle);
+		return -1;
+	}
+
+	memcpy(&value, versions->versym + index * 2, sizeof(value));
+	version = value & ELFP_VERSYM_INDEX;
+
+	memset(versym, 0, sizeof(elfp_versym));
+	versym->index = version;
+	versym->hidden = ((value & ELFP_VERSYM_HIDDEN) != 0);
+
+	/* Local and global symbols have no version */
+	if(version == VER_NDX_LOCAL || version == VER_NDX_GLOBAL)
+		ret = 0;
+	else if(version < versions->n_index &&
+				versions->by_index[version] != NULL)
+	{
+		versym->name = versions->by_index[version]->name;
+		versym->file = versions->by_index[version]->file;
+		ret = 0;
+	}
+	else if(version < versions->n_index &&
+				versions->def_by_index[version] != NULL)
+	{
+		versym->name = versions->def_by_index[version]->name;
+		ret = 0;
+	}
+	elfp_main_vec_put_em(handle);
+
+	return ret;
+}
+
+int
+elfp_version_dump(int handle)
+{
+	/* Sanity check */
+	if(elfp_sanitize_handle(handle) == -1)
+	{
+		elfp_err_warn("elfp_version_dump", "Handle failed the sanity test");
+		return -1;
+	}
+
+	elfp_main_versions *versions = NULL;
+	const elfp_verdef *def = NULL;
+	const elfp_verneed *need = NULL;
+	const elfp_version_family *entry = NULL;
+	unsigned long int i;
+
+	versions = elfp_version_handle_get(handle, "elfp_version_dump");
+	if(versions == NULL)
+		return -1;
+
+	printf("Versions defined: %lu\n", versions->n_defs);
+	for(i = 0; i < versions->n_defs; i++)
+	{
+		def = versions->defs + i;
+		printf("\t%u: %s", def->index, def->name);
+		if(def->parent != NULL)
+			printf(", from %s", def->parent);
+		if((def->flags & VER_FLG_BASE) != 0)
+			printf(" (base)");
+		if((def->flags & VER_FLG_WEAK) != 0)
+			printf(" (weak)");
+		printf("\n");
+	}
+
+	printf("Versions needed: %lu\n", versions->n_needs);
+	for(i = 0; i < versions->n_needs; i++)
+	{
+		need = versions->needs + i;
+		printf("\t%u: %s from %s%s\n", need->index, need->name,
+			need->file, ((need->flags & VER_FLG_WEAK) != 0) ?
+							" (weak)" : "");
+	}
+
+	printf("Highest versions needed: %lu\n", versions->n_maxes);
+	for(i = 0; i < versions->n_maxes; i++)
+	{
+		entry = versions->maxes + i;
+		printf("\t%s: %s (%lu version%s of %.*s)\n", entry->file,
+			entry->name, entry->n_versions,
+			(entry->n_versions == 1) ? "" : "s",
+			(int)entry->family_len, entry->name);
+	}
+
+	printf(".gnu.version entries: %lu\n", versions->n_versym);
+
+	elfp_main_vec_put_em(handle);
+
+	return 0;
+}
@@ -41,6 +41,21 @@ elfp_init();
 void
 elfp_fini();
 
+/*
+ * elfp_set_allocator: Plugs in the caller's own allocator.
+ *
+ * @arg0: malloc() like function. NULL restores malloc().
+ * @arg1: free() like function. NULL restores free().
+ *
+ * 	* Memory handed out by the library (segment arrays etc.) is taken
+ * 	from per-handle arenas, which grow in big chunks. The chunks are
+ * 	allocated with these functions and freed by elfp_close().
+ * 	* MUST be called before any file is opened.
+ */
+void
+elfp_set_allocator(void* (*malloc_fn)(unsigned long int size),
+			void (*free_fn)(void *addr));
+
 
 /*
  * elfp_open: Opens the specfied ELF file and returns a handle.
@@ -56,16 +71,209 @@ int
 elfp_open(const char *elfp_elf_path);
 
 
+/*
+ * Flags which change the way a file is opened.
+ *
+ * ELFP_OPEN_HEADERS_ONLY: Don't map the whole file.
+ * 	* Only the ELF header and the Program Header Table are read.
+ * 	* Anything else is mapped when it is first asked for.
+ * 	* Meant for callers who mostly need e_machine, e_type, PHT etc.
+ * 	from a lot of (possibly huge) files.
+ *
+ * ELFP_OPEN_DUP_FD: Only for elfp_open_fd().
+ * 	* The library works on a duplicate of the descriptor. The caller
+ * 	keeps the one it passed and should close it.
+ * 	* Without this flag, the library takes ownership of the descriptor
+ * 	and closes it in elfp_close().
+ *
+ * ELFP_OPEN_SHARED: Share the file with other ELFP_OPEN_SHARED handles.
+ * 	* If the same file (same device, inode, size and modification time)
+ * 	is open already through another shared handle, the new handle uses
+ * 	the same mapping and everything parsed from it so far. Symlinks and
+ * 	hardlinks to a file are the same file.
+ * 	* Every handle still has to be closed. The mapping goes away with
+ * 	the last one.
+ * 	* Ignored by elfp_open_mem().
+ *
+ * By default, the library tells the kernel how it is going to use a file:
+ * 	* The file is marked for random access. A page fault brings in just
+ * 	that page, not everything around it.
+ * 	* The PHT and Section Header Table are read ahead in the background.
+ * 	Other ranges are read ahead just before a parser walks them.
+ *
+ * ELFP_OPEN_POPULATE: Read in the whole file when it is mapped.
+ * 	Opening is slower, parsing never waits for the disk later. Worth it
+ * 	only if most of the file is going to be parsed.
+ *
+ * ELFP_OPEN_NO_HINTS: Plain demand paging. No hints, no read ahead.
+ *
+ * ELFP_OPEN_WINDOWED: For files too big to be mapped in one go - cores
+ * 	bigger than the address space of a 32-bit process, for example.
+ * 	* The library reads the file through a few fixed-size windows,
+ * 	reusing the least recently used one.
+ * 	* Whatever the API hands out (ELF header, PHT, segments etc.) is
+ * 	mapped on its own and stays valid till elfp_close(). Parsers map
+ * 	the sections they need the same way. All of these together are
+ * 	kept under 64MB - ranges the library no longer needs are unmapped
+ * 	to make room. A call which needs more than that fails, with errno
+ * 	set to ENOMEM. elfp_seg_get() of a huge PT_LOAD does, for example.
+ * 	Read such ranges with elfp_read() instead.
+ * 	* Offsets are unsigned long. On a 32-bit host, the file itself still
+ * 	has to fit in 32-bit offsets.
+ */
+#define ELFP_OPEN_HEADERS_ONLY	0x1
+#define ELFP_OPEN_DUP_FD	0x2
+#define ELFP_OPEN_SHARED	0x4
+#define ELFP_OPEN_POPULATE	0x8
+#define ELFP_OPEN_NO_HINTS	0x10
+#define ELFP_OPEN_WINDOWED	0x20
+
+#define ELFP_OPEN_ALL_FLAGS	(ELFP_OPEN_HEADERS_ONLY | ELFP_OPEN_DUP_FD | \
+				ELFP_OPEN_SHARED | ELFP_OPEN_POPULATE | \
+				ELFP_OPEN_NO_HINTS | ELFP_OPEN_WINDOWED)
+
+/*
+ * elfp_open_flags: Same as elfp_open(), with control over how the file
+ * 	is opened.
+ *
+ * @arg0: Path / name of ELF File
+ * @arg1: Bitwise OR of ELFP_OPEN_* flags. 0 is same as elfp_open().
+ *
+ * @return: A non-negative integer - handle on success.
+ *              (-1) on failure.
+ */
+int
+elfp_open_flags(const char *elfp_elf_path, unsigned int flags);
+
+
+/*
+ * elfp_open_fd: Opens an ELF file which the caller has already opened.
+ *
+ * @arg0: File descriptor, opened for reading.
+ * @arg1: Bitwise OR of ELFP_OPEN_* flags.
+ * 	* Refer ELFP_OPEN_DUP_FD for who owns the descriptor.
+ *
+ * @return: A non-negative integer - handle on success.
+ *              (-1) on failure. The descriptor is not closed on failure.
+ *
+ * 	* The file offset of the descriptor is not changed.
+ */
+int
+elfp_open_fd(int fd, unsigned int flags);
+
+/*
+ * elfp_openat: Same as elfp_open_flags(), with a path relative to a
+ * 	directory descriptor. Refer openat(2).
+ *
+ * @arg0: Directory file descriptor, or AT_FDCWD.
+ * @arg1: Path / name of ELF File, relative to the directory.
+ * @arg2: Bitwise OR of ELFP_OPEN_* flags.
+ *
+ * @return: A non-negative integer - handle on success.
+ *              (-1) on failure.
+ *
+ * 	* Directory walkers can reuse the descriptor they already hold
+ * 	instead of having every full path looked up again.
+ */
+int
+elfp_openat(int dirfd, const char *elfp_elf_path, unsigned int flags);
+
+/*
+ * elfp_open_mem: Opens an ELF image which is already in memory.
+ *
+ * @arg0: Starting address of the image
+ * @arg1: Size of the image in bytes
+ * @arg2: Bitwise OR of ELFP_OPEN_* flags.
+ *
+ * @return: A non-negative integer - handle on success.
+ *              (-1) on failure.
+ *
+ * 	* The image is NOT copied. It is owned by the caller and MUST stay
+ * 	valid and unchanged till the handle is closed.
+ * 	* elfp_close() doesn't free / unmap it.
+ */
+int
+elfp_open_mem(const void *buf, unsigned long int size, unsigned int flags);
+
+
+/*
+ * elfp_open_many: Opens a batch of ELF files in parallel.
+ *
+ * @arg0: Array of paths / names of ELF files
+ * @arg1: Number of paths in the array
+ * @arg2: Array of n integers, filled by the library.
+ * 	* handles_out[i] is the handle of paths[i], (-1) if it could
+ * 	not be opened.
+ * @arg3: Array of n integers, filled by the library. Can be NULL.
+ * 	* errs_out[i] is 0 if paths[i] was opened, an errno value
+ * 	describing the failure otherwise.
+ *
+ * @return: Number of files opened successfully.
+ * 		(-1) if the arguments are invalid.
+ *
+ * 	* A failure to open one file doesn't stop the others from being
+ * 	opened.
+ * 	* Files are opened in parallel, and then get their handles all at
+ * 	once.
+ */
+int
+elfp_open_many(const char **paths, unsigned long int n,
+			int *handles_out, int *errs_out);
+
+/*
+ * elfp_open_many_flags: Same as elfp_open_many(), with control over how
+ * 	the files are opened.
+ *
+ * @arg0: Array of paths / names of ELF files
+ * @arg1: Number of paths in the array
+ * @arg2: Bitwise OR of ELFP_OPEN_* flags, for every file. 0 is same as
+ * 	elfp_open_many().
+ * @arg3: Array of n integers, filled by the library. Same as in
+ * 	elfp_open_many().
+ * @arg4: Array of n integers, filled by the library. Can be NULL. Same as
+ * 	in elfp_open_many().
+ *
+ * @return: Number of files opened successfully.
+ * 		(-1) if the arguments are invalid.
+ */
+int
+elfp_open_many_flags(const char **paths, unsigned long int n,
+		unsigned int flags, int *handles_out, int *errs_out);
+
+
 /*
  * elfp_close: Closes everything about the specified handle.
  *
  * @arg0: File handle obtained from an elfp_open call.
  *
  * @return: 0 on success, -1 on failure.
+ *
+ * 	* Calls already working on the handle in other threads finish
+ * 	safely. But every pointer the handle gave out (ELF header, PHT,
+ * 	segments, names...) goes with the last of them. A thread must not
+ * 	close a handle while another one is still using such pointers.
  */
 int
 elfp_close(int handle);
 
+/*
+ * elfp_read: Copies a range of an open file.
+ *
+ * @arg0: Handle
+ * @arg1: File offset
+ * @arg2: Size of the range in bytes
+ * @arg3: Buffer to copy into. It should have space for @arg2 bytes.
+ *
+ * @return: 0 on success, -1 on failure - the range is outside the file,
+ * 	for example.
+ *
+ * 	* With ELFP_OPEN_WINDOWED, it goes through the windows. Use it for
+ * 	segments and sections too big to be handed out as pointers.
+ */
+int
+elfp_read(int handle, unsigned long int offset, unsigned long int size,
+								void *buf);
+
 /******************************************************************************
  * Parsing the ELF Header.
  *
@@ -100,6 +308,8 @@ elfp_ehdr_dump(int handle);
  * @return: Pointer to ELF header.
  * 	* A void pointer is returned because we wouldn't know
  * 	if it is a 32-bit or 64-bit object till e_ident is parsed.
+ * 	* It points into the file's mapping. It is valid only as long as
+ * 	no thread closes the handle. Refer elfp_close().
  */
 void*
 elfp_ehdr_get(int handle);
@@ -207,6 +417,9 @@ elfp_ehdr_decode_machine(unsigned long int machine);
  *
  * It should be noted that PHT cannot be parsed without class
  * of the ELF. You may use elfp_ehdr_class_get() to get the class.
+ *
+ * It points into the file's mapping. It is valid only as long as no
+ * thread closes the handle. Refer elfp_close().
  */
 void*
 elfp_pht_get(int handle);
@@ -325,4 +538,1997 @@ elfp_seg_get(int handle, const char *seg_type, unsigned long int *ptr_count);
 int
 elfp_seg_dump(int handle, const char *seg_type);
 
+/******************************************************************************
+ * Parsing the Section Header Table(SHT)
+ *
+ * 1. elfp_sht_get: Gives a pointer to the SHT to the programmer.
+ *
+ * 2. elfp_sht_count: Number of Section Headers.
+ *
+ * 3. elfp_shdr_get: Gives a pointer to a Section Header.
+ *
+ * 4. elfp_section_by_name: Looks up a Section Header by the section's name.
+ *
+ * 5. elfp_sht_dump, elfp_shdr_dump: Dump the SHT / a Section Header.
+ *
+ * The SHT is decoded once per file, the first time any of these is
+ * called. Looking up a section by name is a hash lookup after that.
+ *
+ * Like the PHT, the class of the ELF file tells if the pointers are to
+ * Elf32_Shdr or Elf64_Shdr.
+ *****************************************************************************/
+
+/*
+ * elfp_sht_get:
+ *
+ * @arg0: Handle
+ *
+ * @return: A pointer to the SHT on success, NULL on failure / if there
+ * 	is no SHT.
+ */
+void*
+elfp_sht_get(int handle);
+
+/*
+ * elfp_sht_count:
+ *
+ * @arg0: Handle
+ *
+ * @return: Number of Section Headers. 0 on failure / if there is no SHT.
+ * 	* Files with too many sections for e_shnum are taken care of.
+ */
+unsigned long int
+elfp_sht_count(int handle);
+
+/*
+ * elfp_shdr_get:
+ *
+ * @arg0: Handle
+ * @arg1: Section Header's index in the SHT
+ *
+ * @return: A pointer to the Section Header on success, NULL on failure.
+ */
+void*
+elfp_shdr_get(int handle, unsigned long int index);
+
+/*
+ * elfp_shdr_name_get:
+ *
+ * @arg0: Handle
+ * @arg1: Section Header's index in the SHT
+ *
+ * @return: Name of the section on success, NULL on failure / if it has
+ * 	no name.
+ */
+const char*
+elfp_shdr_name_get(int handle, unsigned long int index);
+
+/*
+ * elfp_section_by_name:
+ *
+ * @arg0: Handle
+ * @arg1: Section name. Example: ".text", ".debug_info"
+ *
+ * @return: A pointer to the Section Header on success, NULL on failure /
+ * 	if there is no such section. If many sections have the same name,
+ * 	the first one.
+ */
+void*
+elfp_section_by_name(int handle, const char *name);
+
+/*
+ * elfp_sht_dump:
+ *
+ * @arg0: Handle
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_sht_dump(int handle);
+
+/*
+ * elfp_shdr_dump:
+ *
+ * @arg0: Handle
+ * @arg1: Section Header's index in the SHT
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_shdr_dump(int handle, unsigned long int index);
+
+/*
+ * elfp_shdr_decode_type: Decodes the Section type
+ *
+ * @arg0: Section type
+ *
+ * @return: Decoded string.
+ */
+const char*
+elfp_shdr_decode_type(unsigned long int type);
+
+/*
+ * elfp_shdr_decode_flags: Decodes the Section flags, the way readelf
+ * 	does: W (write), A (alloc), X (execute), M (merge), S (strings),
+ * 	I (info), L (link order), O (extra OS processing required),
+ * 	G (group), T (TLS), C (compressed).
+ *
+ * @arg0: Section flags
+ *
+ * @return: Decoded string. It is overwritten by the next call from the
+ * 	same thread.
+ */
+const char*
+elfp_shdr_decode_flags(unsigned long int flags);
+
+/******************************************************************************
+ * Parsing the symbol tables - .symtab and .dynsym
+ *
+ * 1. elfp_sym_count: Number of symbols in a table.
+ *
+ * 2. elfp_sym_get: Gets a symbol by its index in the table.
+ *
+ * 3. elfp_sym_by_addr: Gets the symbol an address falls in. Symbolizing
+ * 	a return address / PC is the usual use.
+ *
+ * 4. elfp_sym_by_name: Gets a symbol by its name.
+ *
+ * 5. elfp_sym_dump: Dumps a table.
+ *
+ * A table is indexed once per file, the first time any of these asks for
+ * it - by address (sorted) and by name (hashed). Lookups after that are a
+ * binary search / a hash lookup.
+ *
+ * A symbol table is one of the following. ELFP_SYMTAB_DEFAULT is .symtab
+ * if the file has one (it is not stripped), .dynsym otherwise.
+ *****************************************************************************/
+
+#define ELFP_SYMTAB_DEFAULT	0
+#define ELFP_SYMTAB_STATIC	1
+#define ELFP_SYMTAB_DYNAMIC	2
+
+/*
+ * A symbol, same for 32-bit and 64-bit objects.
+ *
+ * 	* name points into the file's string table. It stays valid till
+ * 	the handle is closed.
+ * 	* type, bind and visibility are STT_*, STB_* and STV_*.
+ */
+typedef struct elfp_sym
+{
+	const char *name;
+	unsigned long int value;
+	unsigned long int size;
+	unsigned int type;
+	unsigned int bind;
+	unsigned int visibility;
+	unsigned long int shndx;
+
+	/* Index in the table */
+	unsigned long int index;
+
+} elfp_sym;
+
+/*
+ * elfp_sym_count:
+ *
+ * @arg0: Handle
+ * @arg1: ELFP_SYMTAB_*
+ *
+ * @return: Number of symbols in the table, including the null symbol at
+ * 	index 0. 0 on failure / if there is no such table.
+ */
+unsigned long int
+elfp_sym_count(int handle, int table);
+
+/*
+ * elfp_sym_get:
+ *
+ * @arg0: Handle
+ * @arg1: ELFP_SYMTAB_*
+ * @arg2: Index of the symbol in the table
+ * @arg3: Reference to an elfp_sym. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_sym_get(int handle, int table, unsigned long int index, elfp_sym *sym);
+
+/*
+ * elfp_sym_by_addr:
+ *
+ * @arg0: Handle
+ * @arg1: ELFP_SYMTAB_*
+ * @arg2: Address. addr - sym->value is the offset into the symbol.
+ * @arg3: Reference to an elfp_sym. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure / if no symbol covers the address.
+ * 	* Only functions, objects and labels defined in some section are
+ * 	looked at. A label (size 0) covers everything till the next symbol.
+ * 	* If many symbols start at the same address, a global one is
+ * 	preferred over a weak one, and that over a local one.
+ */
+int
+elfp_sym_by_addr(int handle, int table, unsigned long int addr, elfp_sym *sym);
+
+/*
+ * elfp_sym_by_name:
+ *
+ * @arg0: Handle
+ * @arg1: ELFP_SYMTAB_*
+ * @arg2: Symbol name. Example: "main", "printf"
+ * @arg3: Reference to an elfp_sym. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure / if there is no such symbol. A
+ * 	definition is preferred over an undefined reference of the same name.
+ */
+int
+elfp_sym_by_name(int handle, int table, const char *name, elfp_sym *sym);
+
+/*
+ * elfp_sym_dump:
+ *
+ * @arg0: Handle
+ * @arg1: ELFP_SYMTAB_*
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_sym_dump(int handle, int table);
+
+/*
+ * elfp_sym_decode_type: Decodes the Symbol type
+ *
+ * @arg0: Symbol type
+ *
+ * @return: Decoded string.
+ */
+const char*
+elfp_sym_decode_type(unsigned long int type);
+
+/*
+ * elfp_sym_decode_bind: Decodes the Symbol binding
+ *
+ * @arg0: Symbol binding
+ *
+ * @return: Decoded string.
+ */
+const char*
+elfp_sym_decode_bind(unsigned long int bind);
+
+/******************************************************************************
+ * Parsing the DYNAMIC segment
+ *
+ * 1. elfp_dyn_dump: Dumps the DYNAMIC segment, the way readelf -d does.
+ * 	elfp_seg_dump(handle, "DYNAMIC") does the same.
+ *
+ * 2. elfp_dyn_get: Gives the decoded DYNAMIC segment - libraries needed,
+ * 	search paths, flags and where the tables it points to are.
+ *
+ * 3. elfp_dynsym_lookup: Looks up a dynamic symbol by name, the way the
+ * 	dynamic loader does - through DT_GNU_HASH, or DT_HASH if that is
+ * 	the only hash table in the file. .dynsym is never scanned. Hidden
+ * 	versions (DT_VERSYM) are passed over, so the default version of the
+ * 	symbol is what is found.
+ *
+ * The DYNAMIC segment and the PT_LOAD segments (to translate the
+ * addresses in it to file offsets) are decoded once per file, the first
+ * time any of these is called.
+ *****************************************************************************/
+
+/*
+ * A table the DYNAMIC segment points to.
+ *
+ * 	* offset is a file offset - the address in the DYNAMIC segment
+ * 	translated through the PT_LOAD segments. 0 if the file doesn't
+ * 	have the table, or it is not in the file.
+ * 	* size is what the DYNAMIC segment says, cut down to what is in
+ * 	the file. For tables whose size it doesn't say (symbols, hash
+ * 	tables), it is how much of the file there is from offset till the
+ * 	end of the segment.
+ */
+typedef struct elfp_dyn_table
+{
+	unsigned long int offset;
+	unsigned long int size;
+
+} elfp_dyn_table;
+
+/*
+ * The DYNAMIC segment, same for 32-bit and 64-bit objects.
+ *
+ * 	* Strings point into the dynamic string table. They, and the
+ * 	structure itself, stay valid till the handle is closed.
+ * 	* A string is NULL if the entry is absent / broken.
+ */
+typedef struct elfp_dynamic
+{
+	/* DT_NEEDED, in the order they appear */
+	unsigned long int n_needed;
+	const char **needed;
+
+	const char *soname;
+	const char *rpath;
+	const char *runpath;
+
+	/* DF_* and DF_1_* */
+	unsigned long int flags;
+	unsigned long int flags_1;
+
+	/* Symbols and their hash tables */
+	elfp_dyn_table symtab;
+	elfp_dyn_table strtab;
+	unsigned long int syment;
+	elfp_dyn_table hash;
+	elfp_dyn_table gnu_hash;
+
+	/* Relocations. pltrel is DT_REL / DT_RELA - the kind jmprel has */
+	elfp_dyn_table rela;
+	unsigned long int relaent;
+	unsigned long int relacount;
+	elfp_dyn_table rel;
+	unsigned long int relent;
+	unsigned long int relcount;
+	elfp_dyn_table relr;
+	elfp_dyn_table jmprel;
+	unsigned long int pltrel;
+
+	/* Initialization and termination. init and fini are file offsets
+	 * of the functions, 0 if absent. The arrays hold addresses */
+	unsigned long int init;
+	unsigned long int fini;
+	elfp_dyn_table init_array;
+	elfp_dyn_table fini_array;
+	elfp_dyn_table preinit_array;
+
+} elfp_dynamic;
+
+/*
+ * elfp_dyn_dump:
+ *
+ * @arg0: Handle
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_dyn_dump(int handle);
+
+/*
+ * elfp_dyn_get:
+ *
+ * @arg0: Handle
+ *
+ * @return: Reference to the decoded DYNAMIC segment on success. NULL on
+ * 	failure / if the file has no DYNAMIC segment (a static executable,
+ * 	an object file).
+ */
+const elfp_dynamic*
+elfp_dyn_get(int handle);
+
+/*
+ * elfp_dynsym_lookup:
+ *
+ * @arg0: Handle
+ * @arg1: Symbol name. Example: "malloc"
+ * @arg2: Reference to an elfp_sym. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure / if the file doesn't define the
+ * 	symbol. Only definitions are found, undefined references are not.
+ */
+int
+elfp_dynsym_lookup(int handle, const char *name, elfp_sym *sym);
+
+/*
+ * elfp_dyn_decode_tag: Decodes a DYNAMIC entry's tag
+ *
+ * @arg0: Tag - DT_*
+ *
+ * @return: Decoded string.
+ */
+const char*
+elfp_dyn_decode_tag(unsigned long int tag);
+
+/******************************************************************************
+ * Parsing notes
+ *
+ * 1. elfp_note_count, elfp_note_get: Walk the notes of PT_NOTE segments /
+ * 	SHT_NOTE sections, in the order they appear.
+ *
+ * 2. elfp_note_find: Gets a note by owner and type.
+ *
+ * 3. Decoded notes:
+ * 	* elfp_note_build_id: NT_GNU_BUILD_ID
+ * 	* elfp_note_abi_tag: NT_GNU_ABI_TAG
+ * 	* elfp_note_gnu_properties: NT_GNU_PROPERTY_TYPE_0
+ * 	* elfp_note_package: NT_FDO_PACKAGING_METADATA - the package a
+ * 	file was built for, as systemd / some distributions record it.
+ *
+ * 4. elfp_note_dump: Dumps the notes, the way readelf -n does.
+ * 	elfp_seg_dump(handle, "NOTE") does the same for the segments.
+ *
+ * Segments are found through the PHT. The Section Header Table is read
+ * only if sections are asked for, or the file has no notes in segments
+ * (object files). Opened with ELFP_OPEN_HEADERS_ONLY, a file is read only
+ * for its headers and the notes.
+ *
+ * 5. elfp_note_build_id_fd / elfp_note_build_id_path: Reads the build-id
+ * 	of a file without opening it through the library - no handle, no
+ * 	mapping. The ELF header, the PHT and the notes are read with a few
+ * 	pread()s, usually one. elfp_init() is not needed.
+ *****************************************************************************/
+
+/* Where notes are looked for. ELFP_NOTES_DEFAULT is the segments if the
+ * file has notes in segments, the sections otherwise */
+#define ELFP_NOTES_DEFAULT	0
+#define ELFP_NOTES_SEGMENTS	1
+#define ELFP_NOTES_SECTIONS	2
+
+/*
+ * A note.
+ *
+ * 	* name is the owner - "GNU", "FDO", "CORE" etc. Empty if the note
+ * 	has none / it is broken.
+ * 	* desc is the descriptor, descsz bytes. It is not aligned in
+ * 	memory.
+ * 	* offset is the file offset of the note's header.
+ * 	* Both pointers stay valid till the handle is closed.
+ */
+typedef struct elfp_note
+{
+	const char *name;
+	unsigned long int type;
+	const void *desc;
+	unsigned long int descsz;
+	unsigned long int offset;
+
+} elfp_note;
+
+/*
+ * NT_GNU_ABI_TAG: The oldest kernel the file runs on.
+ *
+ * 	* os is ELF_NOTE_OS_* - Linux, GNU (Hurd), Solaris, FreeBSD.
+ */
+typedef struct elfp_abi_tag
+{
+	unsigned long int os;
+	unsigned long int major;
+	unsigned long int minor;
+	unsigned long int patch;
+
+} elfp_abi_tag;
+
+/*
+ * NT_GNU_PROPERTY_TYPE_0: Properties the linker recorded.
+ *
+ * 	* A property absent from the note is 0.
+ * 	* The processor-specific ones are looked at only in files of that
+ * 	machine.
+ * 	* count is the number of properties in the note, including the
+ * 	ones not decoded here.
+ */
+typedef struct elfp_gnu_properties
+{
+	unsigned long int count;
+
+	/* GNU_PROPERTY_STACK_SIZE */
+	unsigned long int stack_size;
+
+	/* 1 if GNU_PROPERTY_NO_COPY_ON_PROTECTED is there */
+	int no_copy_on_protected;
+
+	/* GNU_PROPERTY_1_NEEDED bits */
+	unsigned long int needed_1;
+
+	/* x86: GNU_PROPERTY_X86_FEATURE_1_AND (IBT, SHSTK) and
+	 * GNU_PROPERTY_X86_ISA_1_NEEDED / _USED bits */
+	unsigned long int x86_feature_1;
+	unsigned long int x86_isa_1_needed;
+	unsigned long int x86_isa_1_used;
+
+	/* AArch64: GNU_PROPERTY_AARCH64_FEATURE_1_AND (BTI, PAC) bits */
+	unsigned long int aarch64_feature_1;
+
+} elfp_gnu_properties;
+
+/*
+ * NT_FDO_PACKAGING_METADATA: The package the file belongs to.
+ *
+ * 	* json is the descriptor as it is - a JSON object.
+ * 	* The rest are its common members. NULL if absent. Example:
+ * 	type "deb", name "systemd", version "252.5-2", architecture
+ * 	"amd64", os "debian", os_version "12".
+ * 	* Strings stay valid till the handle is closed.
+ */
+typedef struct elfp_package
+{
+	const char *json;
+
+	const char *type;
+	const char *name;
+	const char *version;
+	const char *architecture;
+	const char *os;
+	const char *os_version;
+	const char *debug_info_url;
+
+} elfp_package;
+
+/*
+ * elfp_note_count:
+ *
+ * @arg0: Handle
+ * @arg1: ELFP_NOTES_*
+ *
+ * @return: Number of notes. 0 on failure / if there are none.
+ */
+unsigned long int
+elfp_note_count(int handle, int source);
+
+/*
+ * elfp_note_get:
+ *
+ * @arg0: Handle
+ * @arg1: ELFP_NOTES_*
+ * @arg2: Index of the note
+ * @arg3: Reference to an elfp_note. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_note_get(int handle, int source, unsigned long int index,
+						elfp_note *note);
+
+/*
+ * elfp_note_find: Gets the first note of an owner and type, from
+ * 	ELFP_NOTES_DEFAULT.
+ *
+ * @arg0: Handle
+ * @arg1: Owner. Example: "GNU"
+ * @arg2: Type. Example: NT_GNU_BUILD_ID
+ * @arg3: Reference to an elfp_note. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure / if there is no such note.
+ */
+int
+elfp_note_find(int handle, const char *name, unsigned long int type,
+						elfp_note *note);
+
+/*
+ * elfp_note_build_id:
+ *
+ * @arg0: Handle
+ * @arg1: Reference to an unsigned long int. Size of the build-id is
+ * 	written here.
+ *
+ * @return: The build-id's bytes on success. NULL on failure / if the
+ * 	file has none. Valid till the handle is closed.
+ */
+const unsigned char*
+elfp_note_build_id(int handle, unsigned long int *size);
+
+/*
+ * elfp_note_abi_tag:
+ *
+ * @arg0: Handle
+ * @arg1: Reference to an elfp_abi_tag. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure / if the file has no ABI tag.
+ */
+int
+elfp_note_abi_tag(int handle, elfp_abi_tag *tag);
+
+/*
+ * elfp_note_gnu_properties:
+ *
+ * @arg0: Handle
+ * @arg1: Reference to an elfp_gnu_properties. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure / if the file has no properties.
+ */
+int
+elfp_note_gnu_properties(int handle, elfp_gnu_properties *props);
+
+/*
+ * elfp_note_package:
+ *
+ * @arg0: Handle
+ * @arg1: Reference to an elfp_package. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure / if the file has no package
+ * 	metadata.
+ */
+int
+elfp_note_package(int handle, elfp_package *package);
+
+/*
+ * elfp_note_dump:
+ *
+ * @arg0: Handle
+ * @arg1: ELFP_NOTES_*
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_note_dump(int handle, int source);
+
+/*
+ * elfp_note_decode_type: Decodes a note's type. What a type means
+ * 	depends on the owner.
+ *
+ * @arg0: Owner
+ * @arg1: Type
+ *
+ * @return: Decoded string.
+ */
+const char*
+elfp_note_decode_type(const char *name, unsigned long int type);
+
+/*
+ * elfp_note_build_id_fd:
+ *
+ * @arg0: File descriptor, opened for reading. Its file offset is not
+ * 	changed.
+ * @arg1: Buffer the build-id is copied into
+ * @arg2: Size of the buffer. 64 bytes is plenty for any build-id.
+ *
+ * @return: Size of the build-id on success. 0 if the file has none,
+ * 	-1 on failure / if the buffer is too small.
+ *
+ * 	* Only PT_NOTE segments are looked at. An object file's build-id,
+ * 	which is only in a section, needs elfp_note_build_id().
+ */
+long int
+elfp_note_build_id_fd(int fd, unsigned char *buf, unsigned long int size);
+
+/*
+ * elfp_note_build_id_path: Same as elfp_note_build_id_fd(), with a path.
+ *
+ * @arg0: Path of the file
+ * @arg1: Buffer the build-id is copied into
+ * @arg2: Size of the buffer
+ *
+ * @return: Size of the build-id on success. 0 if the file has none,
+ * 	-1 on failure / if the buffer is too small.
+ */
+long int
+elfp_note_build_id_path(const char *path, unsigned char *buf,
+						unsigned long int size);
+
+/******************************************************************************
+ * Parsing relocations
+ *
+ * 1. elfp_reloc_table_count, elfp_reloc_table_get: The REL, RELA and RELR
+ * 	tables of a file.
+ *
+ * 2. elfp_reloc_iter_init, elfp_reloc_read, elfp_reloc_read_addrs: Read
+ * 	the relocations of a table in batches - decoded, or only the
+ * 	addresses they patch. RELR tables are expanded into the relative
+ * 	relocations they pack.
+ *
+ * 3. elfp_reloc_stats_get: Counts of all the relocations of a file, per
+ * 	type. RELR bitmaps are counted without being expanded.
+ *
+ * 4. elfp_reloc_dump: Dumps the relocations, the way readelf -r does.
+ *
+ * Tables come from one of two sources:
+ * 	* The DYNAMIC segment - DT_RELA, DT_REL, DT_RELR and DT_JMPREL.
+ * 	What the dynamic loader processes.
+ * 	* The Section Header Table - SHT_RELA, SHT_REL and SHT_RELR
+ * 	sections. Object files have only these.
+ * ELFP_RELOC_DEFAULT is the DYNAMIC segment if it has relocations, the
+ * sections otherwise.
+ *****************************************************************************/
+
+#define ELFP_RELOC_DEFAULT	0
+#define ELFP_RELOC_DYNAMIC	1
+#define ELFP_RELOC_SECTIONS	2
+
+/* Kinds of relocation tables */
+#define ELFP_RELOC_REL		1
+#define ELFP_RELOC_RELA		2
+#define ELFP_RELOC_RELR		3
+
+/*
+ * A relocation table.
+ *
+ * 	* kind is ELFP_RELOC_REL / ELFP_RELOC_RELA / ELFP_RELOC_RELR.
+ * 	* name is the section's name, or "DT_RELA", "DT_JMPREL" etc. for
+ * 	tables of the DYNAMIC segment.
+ * 	* count is the number of entries in the file. For RELR, that is
+ * 	words - every word can stand for many relocations.
+ * 	* info is the index of the section the relocations apply to
+ * 	(sh_info). 0 for tables of the DYNAMIC segment.
+ */
+typedef struct elfp_reloc_table
+{
+	int kind;
+	const char *name;
+	unsigned long int offset;
+	unsigned long int size;
+	unsigned long int count;
+	unsigned long int info;
+
+} elfp_reloc_table;
+
+/*
+ * A relocation, same for 32-bit and 64-bit objects.
+ *
+ * 	* offset is r_offset - an address, or an offset in the section
+ * 	being relocated in object files.
+ * 	* sym is the index of the symbol in the table's symbol table.
+ * 	* addend is 0 for REL and RELR - their addend is in place.
+ */
+typedef struct elfp_reloc
+{
+	unsigned long int offset;
+	unsigned long int type;
+	unsigned long int sym;
+	long int addend;
+
+} elfp_reloc;
+
+/*
+ * Where elfp_reloc_read() is in a table.
+ * 	* Internal to the library. Set up by elfp_reloc_iter_init().
+ */
+typedef struct elfp_reloc_iter
+{
+	const void *data;
+	unsigned long int count;
+	unsigned long int pos;
+	int kind;
+	int class;
+	unsigned long int relative;
+
+	/* RELR: where the next bitmap starts, bits of the current one
+	 * yet to be read and where they start */
+	unsigned long int base;
+	unsigned long int bits;
+	unsigned long int bits_base;
+
+} elfp_reloc_iter;
+
+/* Relocation types below this are counted one by one */
+#define ELFP_RELOC_TYPES_MAX	2048
+
+/*
+ * Relocation counts.
+ *
+ * 	* RELR tables count as the relocations they pack.
+ * 	* relative is R_*_RELATIVE relocations, including the ones in RELR.
+ * 	The rest of them could have been packed too.
+ * 	* relr is the relocations packed in RELR tables, relr_words the
+ * 	words they take up.
+ * 	* plt is the relocations of DT_JMPREL - the ones which can be done
+ * 	lazily.
+ * 	* symbolic is the relocations which need a symbol looked up.
+ * 	* types[t] is the number of relocations of type t. Types beyond
+ * 	ELFP_RELOC_TYPES_MAX are counted in other_types.
+ */
+typedef struct elfp_reloc_stats
+{
+	unsigned long int total;
+	unsigned long int relative;
+	unsigned long int relr;
+	unsigned long int relr_words;
+	unsigned long int plt;
+	unsigned long int symbolic;
+
+	unsigned long int types[ELFP_RELOC_TYPES_MAX];
+	unsigned long int other_types;
+
+} elfp_reloc_stats;
+
+/*
+ * elfp_reloc_table_count:
+ *
+ * @arg0: Handle
+ * @arg1: ELFP_RELOC_DEFAULT / ELFP_RELOC_DYNAMIC / ELFP_RELOC_SECTIONS
+ *
+ * @return: Number of relocation tables. 0 on failure / if there are none.
+ */
+unsigned long int
+elfp_reloc_table_count(int handle, int source);
+
+/*
+ * elfp_reloc_table_get:
+ *
+ * @arg0: Handle
+ * @arg1: ELFP_RELOC_DEFAULT / ELFP_RELOC_DYNAMIC / ELFP_RELOC_SECTIONS
+ * @arg2: Index of the table
+ * @arg3: Reference to an elfp_reloc_table. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_reloc_table_get(int handle, int source, unsigned long int index,
+						elfp_reloc_table *table);
+
+/*
+ * elfp_reloc_iter_init: Gets ready to read a table from the start.
+ *
+ * @arg0: Handle
+ * @arg1: ELFP_RELOC_DEFAULT / ELFP_RELOC_DYNAMIC / ELFP_RELOC_SECTIONS
+ * @arg2: Index of the table
+ * @arg3: Reference to an elfp_reloc_iter. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_reloc_iter_init(int handle, int source, unsigned long int index,
+						elfp_reloc_iter *iter);
+
+/*
+ * elfp_reloc_read: Reads the next batch of relocations of a table.
+ *
+ * @arg0: Handle
+ * @arg1: Reference to an elfp_reloc_iter
+ * @arg2: Array of elfp_reloc. Filled up by the function.
+ * @arg3: Number of relocations the array can hold
+ *
+ * @return: Number of relocations read. 0 at the end of the table,
+ * 	-1 on failure.
+ */
+long int
+elfp_reloc_read(int handle, elfp_reloc_iter *iter, elfp_reloc *relocs,
+						unsigned long int max);
+
+/*
+ * elfp_reloc_read_addrs: Same as elfp_reloc_read(), but only the
+ * 	addresses the relocations patch (r_offset) are read.
+ *
+ * @arg0: Handle
+ * @arg1: Reference to an elfp_reloc_iter
+ * @arg2: Array of addresses. Filled up by the function.
+ * @arg3: Number of addresses the array can hold
+ *
+ * @return: Number of addresses read. 0 at the end of the table, -1 on
+ * 	failure.
+ */
+long int
+elfp_reloc_read_addrs(int handle, elfp_reloc_iter *iter,
+		unsigned long int *addrs, unsigned long int max);
+
+/*
+ * elfp_reloc_stats_get:
+ *
+ * @arg0: Handle
+ * @arg1: ELFP_RELOC_DEFAULT / ELFP_RELOC_DYNAMIC / ELFP_RELOC_SECTIONS
+ * @arg2: Reference to an elfp_reloc_stats. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_reloc_stats_get(int handle, int source, elfp_reloc_stats *stats);
+
+/*
+ * elfp_reloc_dump:
+ *
+ * @arg0: Handle
+ * @arg1: ELFP_RELOC_DEFAULT / ELFP_RELOC_DYNAMIC / ELFP_RELOC_SECTIONS
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_reloc_dump(int handle, int source);
+
+/*
+ * elfp_reloc_decode_type: Decodes a relocation's type. What a type means
+ * 	depends on the machine.
+ *
+ * @arg0: e_machine - EM_*
+ * @arg1: Type
+ *
+ * @return: Decoded string.
+ */
+const char*
+elfp_reloc_decode_type(unsigned int machine, unsigned long int type);
+
+/******************************************************************************
+ * Address -> source line
+ *
+ * From the line number programs of .debug_line - DWARF 2 to 5. What
+ * addr2line tells.
+ *
+ * 1. elfp_line_lookup: The file and line an address is from.
+ *
+ * 2. elfp_line_lookup_many: Same, for many addresses in one go. Sorted
+ * 	addresses are looked up in one walk over the table.
+ *
+ * 3. elfp_line_count, elfp_line_dump: The table itself.
+ *
+ * All the programs are run once, the first time any of these is called,
+ * into one table sorted by address. Lookups after that are searches in
+ * it. Compressed .debug_line (SHF_COMPRESSED) is not supported.
+ *****************************************************************************/
+
+/*
+ * Where an address is from.
+ *
+ * 	* addr is where the row the address falls in starts.
+ * 	* dir is the file's directory. NULL if the file has an absolute
+ * 	path / is in the compilation directory, which DWARF 4 and older
+ * 	don't put in the line table.
+ * 	* file is NULL if the line table doesn't say which file.
+ * 	* line is 0 for code which is not from any line.
+ * 	* The strings point into the file, and stay valid till the handle
+ * 	is closed.
+ */
+typedef struct elfp_line
+{
+	unsigned long int addr;
+	const char *dir;
+	const char *file;
+	unsigned long int line;
+
+} elfp_line;
+
+/*
+ * elfp_line_count:
+ *
+ * @arg0: Handle
+ *
+ * @return: Number of rows in the table. 0 on failure / if the file has
+ * 	no (usable) .debug_line.
+ */
+unsigned long int
+elfp_line_count(int handle);
+
+/*
+ * elfp_line_lookup:
+ *
+ * @arg0: Handle
+ * @arg1: Address. Example: a return address from a backtrace, less the
+ * 	load address of the file.
+ * @arg2: Reference to an elfp_line. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure / if the address has no line.
+ */
+int
+elfp_line_lookup(int handle, unsigned long int addr, elfp_line *line);
+
+/*
+ * elfp_line_lookup_many:
+ *
+ * @arg0: Handle
+ * @arg1: Array of addresses. Should be in ascending order - others work,
+ * 	but cost a search each.
+ * @arg2: Number of addresses
+ * @arg3: Array of elfp_line, one per address. Filled up by the function.
+ * 	Addresses with no line get a zeroed elfp_line.
+ *
+ * @return: Number of addresses which have a line, -1 on failure.
+ */
+long int
+elfp_line_lookup_many(int handle, const unsigned long int *addrs,
+			unsigned long int n, elfp_line *lines);
+
+/*
+ * elfp_line_dump: Dumps the table - where every row starts, and its
+ * 	file:line.
+ *
+ * @arg0: Handle
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_line_dump(int handle);
+
+/******************************************************************************
+ * Address -> function
+ *
+ * From the DIEs of .debug_info - DWARF 2 to 5. What addr2line -fi tells.
+ *
+ * 1. elfp_cu_lookup: The compilation unit an address is in. From
+ * 	.debug_aranges, for units which have a set there, from the unit's
+ * 	own DW_AT_low_pc / DW_AT_high_pc / DW_AT_ranges otherwise.
+ *
+ * 2. elfp_func_lookup: The function an address is in, and the functions
+ * 	inlined into it the address is in, innermost first.
+ *
+ * 3. elfp_cu_count, elfp_cu_get, elfp_func_count, elfp_func_dump.
+ *
+ * The units are decoded the first time any of these is called. The
+ * address ranges of DW_TAG_subprogram and DW_TAG_inlined_subroutine DIEs
+ * are collected into one index sorted by address the first time a
+ * function is asked for - the DIEs of other kinds are skipped, not read.
+ * Type units, split DWARF (.dwo) and compressed sections are not
+ * supported.
+ *****************************************************************************/
+
+/*
+ * A compilation unit.
+ *
+ * 	* index is its number in elfp_cu_get().
+ * 	* offset is where its header is in .debug_info.
+ * 	* name and comp_dir are NULL if the unit doesn't have them. They
+ * 	point into the file, and stay valid till the handle is closed.
+ */
+typedef struct elfp_cu
+{
+	unsigned long int index;
+	unsigned long int offset;
+	unsigned int version;
+	const char *name;
+	const char *comp_dir;
+
+} elfp_cu;
+
+/*
+ * A function an address is in.
+ *
+ * 	* [low, high) is the range of the function's the address is in. An
+ * 	inlined copy / a function split into hot and cold parts has many.
+ * 	* name is the plain name, linkage_name the mangled one. Either can
+ * 	be NULL.
+ * 	* inlined is 1 for a function inlined into the next frame. call_dir,
+ * 	call_file and call_line are where in that frame it was inlined -
+ * 	the next frame's file:line. call_dir is NULL when the line table
+ * 	has no directory for the file (Refer elfp_line).
+ * 	* die is where the function's DIE is in .debug_info.
+ * 	* The strings point into the file, and stay valid till the handle
+ * 	is closed.
+ */
+typedef struct elfp_func
+{
+	unsigned long int low;
+	unsigned long int high;
+	const char *name;
+	const char *linkage_name;
+	int inlined;
+	const char *call_dir;
+	const char *call_file;
+	unsigned long int call_line;
+	unsigned long int die;
+
+} elfp_func;
+
+/*
+ * elfp_cu_count:
+ *
+ * @arg0: Handle
+ *
+ * @return: Number of compilation units in .debug_info. 0 on failure / if
+ * 	the file has no (usable) .debug_info.
+ */
+unsigned long int
+elfp_cu_count(int handle);
+
+/*
+ * elfp_cu_get:
+ *
+ * @arg0: Handle
+ * @arg1: Index of the unit, 0 to elfp_cu_count() - 1
+ * @arg2: Reference to an elfp_cu. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure / if there is no such unit.
+ */
+int
+elfp_cu_get(int handle, unsigned long int index, elfp_cu *cu);
+
+/*
+ * elfp_cu_lookup:
+ *
+ * @arg0: Handle
+ * @arg1: Address
+ * @arg2: Reference to an elfp_cu. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure / if no unit covers the address.
+ */
+int
+elfp_cu_lookup(int handle, unsigned long int addr, elfp_cu *cu);
+
+/*
+ * elfp_func_count:
+ *
+ * @arg0: Handle
+ *
+ * @return: Number of function ranges in the index. 0 on failure / if
+ * 	the file has no (usable) .debug_info.
+ */
+unsigned long int
+elfp_func_count(int handle);
+
+/*
+ * elfp_func_lookup:
+ *
+ * @arg0: Handle
+ * @arg1: Address
+ * @arg2: Array of elfp_func. Filled up by the function - the innermost
+ * 	inlined function first, the function they were all inlined into
+ * 	last.
+ * @arg3: Number of elements in the array. Frames beyond it are left out.
+ *
+ * @return: Number of frames filled up - 0 if the address is not in any
+ * 	function, -1 on failure.
+ */
+long int
+elfp_func_lookup(int handle, unsigned long int addr, elfp_func *frames,
+						unsigned long int max);
+
+/*
+ * elfp_func_dump: Dumps the index - every function range, inlined ones
+ * 	under the one they were inlined into.
+ *
+ * @arg0: Handle
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_func_dump(int handle);
+
+/******************************************************************************
+ * Acceleration tables
+ *
+ * Indexes compilers and linkers leave in the file so a debugger need not
+ * read every DIE - .gdb_index (gdb-add-index, gold / lld --gdb-index),
+ * .debug_names (DWARF 5, clang -gpubnames / lld) and .debug_aranges.
+ *
+ * 1. elfp_accel_available: Which of them the file has. Callers pick a
+ * 	strategy from it - a lookup here when the table is there, the
+ * 	DIE index (elfp_cu_lookup, elfp_func_lookup) otherwise.
+ *
+ * 2. elfp_accel_lookup_name: Name -> the DIEs / units which define it.
+ * 	A hash table probe, in .debug_names if the file has it (it tells
+ * 	the DIE), in .gdb_index otherwise (it tells only the unit).
+ *
+ * 3. elfp_accel_lookup_addr: Address -> unit. A binary search in
+ * 	.gdb_index's address area, a walk over .debug_aranges without it.
+ *
+ * 4. elfp_accel_dump.
+ *
+ * Nothing is built - the tables are read in place, straight from the
+ * mapped file. Names are matched exactly; both tables hash them without
+ * case, so only the probe is case-insensitive.
+ *****************************************************************************/
+
+/* Tables a file has - elfp_accel_available() returns a mask of these */
+#define ELFP_ACCEL_GDB_INDEX	0x1
+#define ELFP_ACCEL_DEBUG_NAMES	0x2
+#define ELFP_ACCEL_ARANGES	0x4
+
+/* What a name names. The values are .gdb_index's */
+#define ELFP_ACCEL_NONE		0
+#define ELFP_ACCEL_TYPE		1
+#define ELFP_ACCEL_VARIABLE	2
+#define ELFP_ACCEL_FUNCTION	3
+#define ELFP_ACCEL_OTHER	4
+
+/*
+ * A DIE a name was found at.
+ *
+ * 	* source is the table it came from - ELFP_ACCEL_GDB_INDEX /
+ * 	ELFP_ACCEL_DEBUG_NAMES.
+ * 	* unit is where the header of the DIE's unit is in .debug_info. For
+ * 	a type unit (type_unit is 1) of DWARF 4, it is in .debug_types.
+ * 	* die is where the DIE is in .debug_info, tag its DW_TAG_*. Both
+ * 	are 0 from .gdb_index, which doesn't tell.
+ * 	* kind is one of ELFP_ACCEL_*. is_static is 1 for a name not visible
+ * 	outside its unit - .gdb_index only.
+ */
+typedef struct elfp_accel_entry
+{
+	int source;
+	int type_unit;
+	unsigned long int unit;
+	unsigned long int die;
+	unsigned int tag;
+	unsigned int kind;
+	int is_static;
+
+} elfp_accel_entry;
+
+/*
+ * elfp_accel_available:
+ *
+ * @arg0: Handle
+ *
+ * @return: Mask of ELFP_ACCEL_* - the tables the file has (and this
+ * 	library can read), 0 if none. -1 on failure.
+ */
+int
+elfp_accel_available(int handle);
+
+/*
+ * elfp_accel_lookup_name:
+ *
+ * @arg0: Handle
+ * @arg1: Name - "main", "std::vector", the way the table has it
+ * @arg2: Array of elfp_accel_entry. Filled up by the function.
+ * @arg3: Number of elements in the array. Entries beyond it are left out.
+ *
+ * @return: Number of entries the name has - can be more than @arg3.
+ * 	0 if it has none / the file has no name table, -1 on failure.
+ */
+long int
+elfp_accel_lookup_name(int handle, const char *name,
+		elfp_accel_entry *entries, unsigned long int max);
+
+/*
+ * elfp_accel_lookup_addr:
+ *
+ * @arg0: Handle
+ * @arg1: Address
+ * @arg2: Reference to an unsigned long int. The .debug_info offset of the
+ * 	unit covering the address is written into it.
+ *
+ * @return: 0 on success, -1 on failure / if no unit covers the address
+ * 	/ the file has neither .gdb_index nor .debug_aranges.
+ */
+int
+elfp_accel_lookup_addr(int handle, unsigned long int addr,
+					unsigned long int *unit);
+
+/*
+ * elfp_accel_dump: Dumps what acceleration tables the file has.
+ *
+ * @arg0: Handle
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_accel_dump(int handle);
+
+/******************************************************************************
+ * Address -> FDE
+ *
+ * The Frame Description Entry of .eh_frame which says how to unwind out of
+ * an address - through the binary search table of .eh_frame_hdr, which the
+ * PT_GNU_EH_FRAME segment points to.
+ *
+ * 1. elfp_fde_lookup: A binary search in the table, then a read of one FDE
+ * 	and its CIE. Everything is read in place - nothing is allocated,
+ * 	nothing is copied. O(log n) in the number of FDEs.
+ *
+ * 2. elfp_fde_count, elfp_fde_dump.
+ *
+ * The header is read the first time any of these is called. The pointer
+ * encodings of the LSB (DW_EH_PE_*) are understood, except text and
+ * function relative ones, which only LSDAs use. A table which is not
+ * sorted is not used. Files without .eh_frame_hdr (object files, some
+ * static binaries) have no table.
+ *****************************************************************************/
+
+/*
+ * An FDE, and what its CIE says.
+ *
+ * 	* [pc_begin, pc_end) is the range of addresses it covers.
+ * 	* fde / cie point to the entries in the file, fde_offset / cie_offset
+ * 	are where they are in it. Sizes include the length field.
+ * 	* cie_insns are the CIE's initial instructions, insns the FDE's
+ * 	instructions - the CFA program to run for pc_begin onwards.
+ * 	* The pointers stay valid till the handle is closed.
+ */
+typedef struct elfp_fde
+{
+	unsigned long int pc_begin;
+	unsigned long int pc_end;
+
+	const void *fde;
+	unsigned long int fde_offset;
+	unsigned long int fde_size;
+	const void *cie;
+	unsigned long int cie_offset;
+	unsigned long int cie_size;
+
+	const char *augmentation;
+	unsigned long int code_align;
+	long int data_align;
+	unsigned long int ra_register;
+	int signal_frame;
+
+	const void *cie_insns;
+	unsigned long int cie_insns_size;
+	const void *insns;
+	unsigned long int insns_size;
+
+} elfp_fde;
+
+/*
+ * elfp_fde_count:
+ *
+ * @arg0: Handle
+ *
+ * @return: Number of FDEs in .eh_frame_hdr's table. 0 on failure / if the
+ * 	file has no (usable) table.
+ */
+unsigned long int
+elfp_fde_count(int handle);
+
+/*
+ * elfp_fde_lookup:
+ *
+ * @arg0: Handle
+ * @arg1: Address, as the file has it (not where it is loaded)
+ * @arg2: Reference to an elfp_fde. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure / if no FDE covers the address.
+ */
+int
+elfp_fde_lookup(int handle, unsigned long int pc, elfp_fde *fde);
+
+/*
+ * elfp_fde_dump: Dumps .eh_frame_hdr's table, with the range of every FDE.
+ *
+ * @arg0: Handle
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_fde_dump(int handle);
+
+/******************************************************************************
+ * Unwind table
+ *
+ * The CFA programs of every CIE and FDE, run once into a flat table sorted
+ * by address - for every address, how to find the CFA, the return address
+ * and the frame pointer of the caller. Unwinding a frame is then a binary
+ * search and some arithmetic, with no DWARF to decode.
+ *
+ * 1. elfp_unwind_lookup: The rules at an address. The table is built the
+ * 	first time any of these is called - from .eh_frame, or .debug_frame
+ * 	if .eh_frame has no FDEs.
+ *
+ * 2. elfp_unwind_save: Writes the table to a file. elfp_unwind_open maps
+ * 	one, and elfp_unwind_table_lookup searches it in place - no handle,
+ * 	no ELF file and nothing to build. The file has the build-id of the
+ * 	ELF file it was built from, to check it against.
+ *
+ * 3. elfp_unwind_count, elfp_unwind_dump, elfp_unwind_table_build_id,
+ * 	elfp_unwind_close.
+ *
+ * Only the CFA, the return address and the frame pointer (rbp, ebp, x29,
+ * r11, s0) are followed. DWARF expressions are not evaluated - a rule which
+ * needs one, or an offset too big for the table, is ELFP_UNWIND_CFA_EXPR /
+ * ELFP_UNWIND_EXPR, and the FDE (elfp_fde_lookup) has the full story. Where
+ * FDEs overlap, the one which starts later wins, as with elfp_fde_lookup.
+ * A saved table is in the byte order of the machine which built it, and
+ * can only be opened on one with the same.
+ *****************************************************************************/
+
+/* How the CFA is found */
+#define ELFP_UNWIND_CFA_NONE		0	/* No FDE covers the address */
+#define ELFP_UNWIND_CFA_REGISTER	1	/* cfa_register + cfa_offset */
+#define ELFP_UNWIND_CFA_EXPR		2	/* Not in the table */
+
+/* Where the caller's value of a register is */
+#define ELFP_UNWIND_UNDEFINED		0	/* Lost. For the return address,
+						 * this is the outermost frame */
+#define ELFP_UNWIND_SAME		1	/* In the register itself */
+#define ELFP_UNWIND_OFFSET		2	/* Saved at CFA + offset */
+#define ELFP_UNWIND_VAL_OFFSET		3	/* It is CFA + offset */
+#define ELFP_UNWIND_REGISTER		4	/* In register number offset */
+#define ELFP_UNWIND_EXPR		5	/* Not in the table */
+
+typedef struct elfp_unwind elfp_unwind;
+
+/*
+ * The rules for [pc_begin, pc_end).
+ *
+ * 	* Registers are DWARF register numbers.
+ * 	* ra_rule / fp_rule are ELFP_UNWIND_*. ra_offset / fp_offset go with
+ * 	them - an offset from the CFA, or a register number.
+ */
+typedef struct elfp_unwind_row
+{
+	unsigned long int pc_begin;
+	unsigned long int pc_end;
+
+	unsigned int cfa_rule;
+	unsigned int cfa_register;
+	long int cfa_offset;
+
+	unsigned int ra_rule;
+	long int ra_offset;
+
+	unsigned int fp_rule;
+	long int fp_offset;
+
+} elfp_unwind_row;
+
+/*
+ * elfp_unwind_count:
+ *
+ * @arg0: Handle
+ *
+ * @return: Number of rows in the table, including the ones which mark the
+ * 	gaps between FDEs. 0 on failure / if the file has no call frame
+ * 	information.
+ */
+unsigned long int
+elfp_unwind_count(int handle);
+
+/*
+ * elfp_unwind_lookup:
+ *
+ * @arg0: Handle
+ * @arg1: Address, as the file has it (not where it is loaded)
+ * @arg2: Reference to an elfp_unwind_row. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure / if no FDE covers the address.
+ */
+int
+elfp_unwind_lookup(int handle, unsigned long int pc, elfp_unwind_row *row);
+
+/*
+ * elfp_unwind_save: Writes the table to a file, for elfp_unwind_open().
+ *
+ * @arg0: Handle
+ * @arg1: Path of the file. It is written under another name and renamed,
+ * 	so that a reader never sees half of it.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_unwind_save(int handle, const char *path);
+
+/*
+ * elfp_unwind_dump: Dumps the table, a row a line.
+ *
+ * @arg0: Handle
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_unwind_dump(int handle);
+
+/*
+ * elfp_unwind_open: Maps a table elfp_unwind_save() wrote.
+ *
+ * @arg0: Path of the file
+ *
+ * @return: The table on success, NULL on failure / if it is not a table
+ * 	(of this version, and byte order).
+ */
+elfp_unwind*
+elfp_unwind_open(const char *path);
+
+/*
+ * elfp_unwind_table_lookup: elfp_unwind_lookup(), in a mapped table.
+ *
+ * @arg0: The table
+ * @arg1: Address
+ * @arg2: Reference to an elfp_unwind_row. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure / if no FDE covers the address.
+ */
+int
+elfp_unwind_table_lookup(const elfp_unwind *table, unsigned long int pc,
+						elfp_unwind_row *row);
+
+/*
+ * elfp_unwind_table_build_id: Gets the build-id of the file a table was
+ * 	built from.
+ *
+ * @arg0: The table
+ * @arg1: Reference to the size. Filled up by the function.
+ *
+ * @return: The build-id, NULL if the file had none. It lives as long as
+ * 	the table.
+ */
+const void*
+elfp_unwind_table_build_id(const elfp_unwind *table, unsigned long int *size);
+
+/*
+ * elfp_unwind_close: Unmaps a table elfp_unwind_open() gave.
+ *
+ * @arg0: The table
+ */
+void
+elfp_unwind_close(elfp_unwind *table);
+
+/******************************************************************************
+ * Symbol versioning
+ *
+ * .gnu.version_d (the versions a file defines), .gnu.version_r (the
+ * versions it needs from the libraries it links against) and .gnu.version
+ * (the version of every dynamic symbol), the way the dynamic loader reads
+ * them.
+ *
+ * 1. elfp_version_max: The highest version a file needs of every family
+ * 	of every library - GLIBC_2.34 from libc.so.6, GLIBCXX_3.4.30 and
+ * 	CXXABI_1.3.13 from libstdc++.so.6. A file runs against a library
+ * 	only if the library defines all of them. Compare them against what
+ * 	the target has with elfp_version_cmp().
+ *
+ * 2. elfp_verneed_count / elfp_verneed_get, elfp_verdef_count /
+ * 	elfp_verdef_get, elfp_versym_get: The tables themselves.
+ *
+ * 3. elfp_version_dump.
+ *
+ * The tables are decoded the first time any of these is called, from the
+ * sections - or the DYNAMIC segment (DT_VERSYM, DT_VERNEED, DT_VERDEF) if
+ * the file has no section headers.
+ *****************************************************************************/
+
+/*
+ * A version a file defines.
+ *
+ * 	* index is what .gnu.version entries refer to it by.
+ * 	* flags are VER_FLG_BASE (the file's own name, not a version) and
+ * 	VER_FLG_WEAK.
+ * 	* parent is the version it inherits from, NULL if none.
+ */
+typedef struct elfp_verdef
+{
+	unsigned int index;
+	unsigned int flags;
+	unsigned long int hash;
+	const char *name;
+	const char *parent;
+
+} elfp_verdef;
+
+/*
+ * A version a file needs.
+ *
+ * 	* file is the library it is needed from, as DT_NEEDED has it.
+ * 	* index is what .gnu.version entries refer to it by.
+ * 	* flags are VER_FLG_WEAK - the file runs without it, with a warning.
+ */
+typedef struct elfp_verneed
+{
+	const char *file;
+	const char *name;
+	unsigned int index;
+	unsigned int flags;
+	unsigned long int hash;
+
+} elfp_verneed;
+
+/*
+ * The version of a dynamic symbol.
+ *
+ * 	* index 0 is a local symbol, 1 a global one without a version. name
+ * 	is NULL for them.
+ * 	* hidden is 1 if this is not the default version of the symbol -
+ * 	"name@VERSION" rather than "name@@VERSION".
+ * 	* file is the library the version is needed from, NULL if the file
+ * 	defines it.
+ */
+typedef struct elfp_versym
+{
+	unsigned int index;
+	int hidden;
+	const char *name;
+	const char *file;
+
+} elfp_versym;
+
+/*
+ * The highest version a file needs of a family from a library.
+ *
+ * 	* The family is what comes before the number - "GLIBC_" of
+ * 	"GLIBC_2.34". A version without a number ("GLIBC_PRIVATE") is its
+ * 	own family.
+ * 	* n_versions is the number of versions of the family the file needs
+ * 	from the library.
+ */
+typedef struct elfp_version_family
+{
+	const char *file;
+	const char *name;
+	unsigned long int family_len;
+	unsigned long int n_versions;
+
+} elfp_version_family;
+
+/*
+ * elfp_version_max:
+ *
+ * @arg0: Handle
+ * @arg1: Array of elfp_version_family. Filled up by the function, in the
+ * 	order of the libraries in .gnu.version_r.
+ * @arg2: Number of elements in the array. Entries beyond it are left out.
+ *
+ * @return: Number of (library, family) pairs - can be more than @arg2.
+ * 	0 if the file needs no versions, -1 on failure.
+ */
+long int
+elfp_version_max(int handle, elfp_version_family *maxes, unsigned long int max);
+
+/*
+ * elfp_version_cmp: Compares two versions of a family, numbers as numbers -
+ * 	"GLIBC_2.34" is after "GLIBC_2.4", which is after "GLIBC_2.2.5".
+ *
+ * @arg0, @arg1: Version names
+ *
+ * @return: < 0, 0, > 0 if the first is before / the same as / after the
+ * 	second.
+ */
+int
+elfp_version_cmp(const char *version1, const char *version2);
+
+/*
+ * elfp_verneed_count:
+ *
+ * @arg0: Handle
+ *
+ * @return: Number of versions the file needs, of all the libraries. 0 on
+ * 	failure / if there are none.
+ */
+unsigned long int
+elfp_verneed_count(int handle);
+
+/*
+ * elfp_verneed_get:
+ *
+ * @arg0: Handle
+ * @arg1: Index - the libraries in the order of .gnu.version_r, and the
+ * 	versions of every library in its order.
+ * @arg2: Reference to an elfp_verneed. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_verneed_get(int handle, unsigned long int index, elfp_verneed *need);
+
+/*
+ * elfp_verdef_count:
+ *
+ * @arg0: Handle
+ *
+ * @return: Number of versions the file defines, its base name included.
+ * 	0 on failure / if there are none.
+ */
+unsigned long int
+elfp_verdef_count(int handle);
+
+/*
+ * elfp_verdef_get:
+ *
+ * @arg0: Handle
+ * @arg1: Index, in the order of .gnu.version_d
+ * @arg2: Reference to an elfp_verdef. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_verdef_get(int handle, unsigned long int index, elfp_verdef *def);
+
+/*
+ * elfp_versym_get:
+ *
+ * @arg0: Handle
+ * @arg1: Index of the symbol in the dynamic symbol table
+ * @arg2: Reference to an elfp_versym. Filled up by the function.
+ *
+ * @return: 0 on success, -1 on failure / if the file has no .gnu.version
+ * 	/ it refers to a version which is not there.
+ */
+int
+elfp_versym_get(int handle, unsigned long int index, elfp_versym *versym);
+
+/*
+ * elfp_version_dump: Dumps the versions the file defines and needs, and
+ * 	the highest of every family.
+ *
+ * @arg0: Handle
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_version_dump(int handle);
+
+/******************************************************************************
+ * Reading ld.so.cache
+ *
+ * The table ldconfig writes, which maps sonames to the paths of the
+ * libraries in the system directories. The dynamic loader looks it up
+ * before searching the default directories.
+ *
+ * 1. elfp_ldcache_open: Maps a cache. Only the "glibc-ld.so.cache1.1"
+ * 	format is understood (glibc 2.32 and later write only that, older
+ * 	ones write it after the old table).
+ *
+ * 2. elfp_ldcache_lookup: soname -> path. A binary search in the mapped
+ * 	file - the same one the dynamic loader does.
+ *
+ * 3. elfp_ldcache_dump, elfp_ldcache_close.
+ *
+ * No handle is involved. elfp_init() is not needed.
+ *****************************************************************************/
+
+#define ELFP_LDCACHE_PATH "/etc/ld.so.cache"
+
+typedef struct elfp_ldcache elfp_ldcache;
+
+/*
+ * elfp_ldcache_open:
+ *
+ * @arg0: Path of the cache. NULL means ELFP_LDCACHE_PATH.
+ *
+ * @return: The cache on success, NULL on failure.
+ */
+elfp_ldcache*
+elfp_ldcache_open(const char *path);
+
+/*
+ * elfp_ldcache_flags: Gets the flags the cache marks libraries of a
+ * 	class and machine with.
+ *
+ * @arg0: ELFCLASS32 / ELFCLASS64
+ * @arg1: e_machine - EM_*
+ *
+ * @return: The flags. 0 if not known.
+ */
+unsigned int
+elfp_ldcache_flags(int class, unsigned int machine);
+
+/*
+ * elfp_ldcache_lookup:
+ *
+ * @arg0: The cache
+ * @arg1: soname. Example: "libc.so.6"
+ * @arg2: Flags of the library. Refer elfp_ldcache_flags(). 0 means any
+ * 	library of that soname will do.
+ * @arg3: hwcap bits of the CPU the library is for. Libraries which need
+ * 	bits not in it are skipped. 0 takes only those which need none.
+ *
+ * @return: Path of the library, NULL if the cache doesn't have it. It
+ * 	points into the cache, and stays valid till the cache is closed.
+ */
+const char*
+elfp_ldcache_lookup(elfp_ldcache *cache, const char *soname,
+		unsigned int flags, unsigned long int hwcap);
+
+/*
+ * elfp_ldcache_dump: Dumps the cache, the way ldconfig -p does.
+ *
+ * @arg0: The cache
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_ldcache_dump(elfp_ldcache *cache);
+
+/*
+ * elfp_ldcache_close:
+ *
+ * @arg0: The cache
+ */
+void
+elfp_ldcache_close(elfp_ldcache *cache);
+
+/******************************************************************************
+ * Resolving shared library dependencies
+ *
+ * What ldd tells, without running anything.
+ *
+ * 1. elfp_deps_resolve: Builds the dependency graph of a set of files -
+ * 	the files, the libraries they need, the libraries those need and
+ * 	so on.
+ *
+ * 2. elfp_deps_count, elfp_deps_get, elfp_deps_root: Walk the graph.
+ *
+ * 3. elfp_deps_dump: Dumps everything a file needs, the way ldd does.
+ *
+ * 4. elfp_deps_free: Frees up the graph.
+ *
+ * A needed library is searched for like the dynamic loader does it:
+ * 	* A name with a '/' in it is a path.
+ * 	* DT_RPATH of the file needing it, then that of the file which
+ * 	loaded it and so on up to the root - if the file needing it has no
+ * 	DT_RUNPATH.
+ * 	* DT_RUNPATH of the file needing it.
+ * 	* /etc/ld.so.cache.
+ * 	* The default directories.
+ * $ORIGIN and $LIB in search paths are expanded. Candidates of another
+ * class / machine are skipped. LD_LIBRARY_PATH is NOT looked at - the
+ * result doesn't depend on who runs it.
+ *
+ * Every file is parsed once, however many files need it. Files of one
+ * level of the graph are parsed in parallel. A file needed by many is
+ * taken to be loaded by the first of them (in graph order), and only
+ * that chain's DT_RPATHs are searched for what it needs - ld.so does the
+ * same within one process, but two roots of the graph may have loaded
+ * it differently.
+ *
+ * No handle is involved. elfp_init() is not needed.
+ *****************************************************************************/
+
+typedef struct elfp_deps elfp_deps;
+
+/*
+ * A file in the graph.
+ *
+ * 	* name is how it was asked for - a root's path, a DT_NEEDED entry.
+ * 	* path is where it was found, NULL if it wasn't.
+ * 	* err is 0 if it was found and parsed. ENOENT if it was not found,
+ * 	some other errno value if it could not be parsed.
+ * 	* names[i] is its i'th DT_NEEDED, needed[i] is the node it was
+ * 	resolved to. The node's own name can be different - the same file
+ * 	can be reached by many names.
+ */
+typedef struct elfp_dep
+{
+	const char *name;
+	const char *path;
+	int err;
+
+	unsigned long int n_needed;
+	const char **names;
+	unsigned long int *needed;
+
+} elfp_dep;
+
+/*
+ * elfp_deps_resolve:
+ *
+ * @arg0: Array of paths of files to start from
+ * @arg1: Number of paths in the array
+ * @arg2: Maximum number of threads to use. 0 means number of online CPUs.
+ *
+ * @return: The graph on success, NULL on failure. A root / library which
+ * 	can't be found or parsed is not a failure. Its node tells why.
+ */
+elfp_deps*
+elfp_deps_resolve(const char **roots, unsigned long int n_roots,
+					unsigned int n_threads);
+
+/*
+ * elfp_deps_count:
+ *
+ * @arg0: The graph
+ *
+ * @return: Number of nodes in the graph.
+ */
+unsigned long int
+elfp_deps_count(elfp_deps *deps);
+
+/*
+ * elfp_deps_get:
+ *
+ * @arg0: The graph
+ * @arg1: Index of the node
+ *
+ * @return: Reference to the node on success, NULL on failure. It stays
+ * 	valid till the graph is freed up.
+ */
+const elfp_dep*
+elfp_deps_get(elfp_deps *deps, unsigned long int index);
+
+/*
+ * elfp_deps_root:
+ *
+ * @arg0: The graph
+ * @arg1: Index of the root in the array given to elfp_deps_resolve()
+ *
+ * @return: Index of its node. (unsigned long int)-1 on failure.
+ * 	* Roots which are the same file have the same node.
+ */
+unsigned long int
+elfp_deps_root(elfp_deps *deps, unsigned long int root);
+
+/*
+ * elfp_deps_dump: Dumps all the libraries a root needs - directly or not.
+ *
+ * @arg0: The graph
+ * @arg1: Index of the root in the array given to elfp_deps_resolve()
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_deps_dump(elfp_deps *deps, unsigned long int root);
+
+/*
+ * elfp_deps_free:
+ *
+ * @arg0: The graph
+ */
+void
+elfp_deps_free(elfp_deps *deps);
+
+/******************************************************************************
+ * Parsing a stream
+ *
+ * For ELF data which can't be opened as a file - a pipe, a download in
+ * progress, output of a decompressor.
+ *
+ * 1. elfp_stream_new: Creates a parser.
+ *
+ * 2. elfp_stream_feed: Gives it the next piece of input.
+ *
+ * 3. elfp_stream_poll: Gets whatever got parsed.
+ *
+ * 4. elfp_stream_free: Cleans it up.
+ *
+ * Input is read once, from the start, in order. A structure is reported
+ * as soon as all its bytes are fed: ELF header, PHT, non-LOAD segments
+ * (INTERP, DYNAMIC, NOTE etc.) and the Section Header Table. Only bytes
+ * of structures still being waited for are kept - once, however many of
+ * them overlap - and no more than 16MB of them at a time.
+ *
+ * No handle is involved. elfp_init() is not needed.
+ *****************************************************************************/
+
+typedef struct elfp_stream elfp_stream;
+
+/*
+ * Event types
+ *
+ * ELFP_STREAM_NEED_MORE: Nothing more can be reported without more input.
+ * ELFP_STREAM_EHDR: ELF header. Elf32_Ehdr / Elf64_Ehdr.
+ * ELFP_STREAM_PHT: Program Header Table. Array of Elf32_Phdr / Elf64_Phdr.
+ * ELFP_STREAM_SEGMENT: Contents of a segment. seg_type is its p_type.
+ * ELFP_STREAM_SHT: Section Header Table. Array of Elf32_Shdr / Elf64_Shdr.
+ * ELFP_STREAM_SKIPPED: A structure which can't be reported. Its bytes
+ * 	had gone by before it was known, it is too big, or too much is held
+ * 	already. No data.
+ * ELFP_STREAM_DONE: Everything is reported. Rest of the input is not
+ * 	needed.
+ * ELFP_STREAM_ERROR: Input is not a (valid) ELF file.
+ */
+#define ELFP_STREAM_ERROR	-1
+#define ELFP_STREAM_NEED_MORE	0
+#define ELFP_STREAM_EHDR	1
+#define ELFP_STREAM_PHT		2
+#define ELFP_STREAM_SEGMENT	3
+#define ELFP_STREAM_SHT		4
+#define ELFP_STREAM_SKIPPED	5
+#define ELFP_STREAM_DONE	6
+
+typedef struct elfp_stream_event
+{
+	/* One of ELFP_STREAM_* */
+	int type;
+
+	/* Where the structure is in the input */
+	unsigned long int offset;
+	unsigned long int size;
+
+	/* ELFP_STREAM_SEGMENT, ELFP_STREAM_SKIPPED: p_type of the segment */
+	unsigned long int seg_type;
+
+	/* ELFCLASS32 / ELFCLASS64 */
+	int class;
+
+	/* The structure's bytes. Valid till the next elfp_stream_poll() */
+	const void *data;
+
+} elfp_stream_event;
+
+/*
+ * elfp_stream_new: Creates a parser.
+ *
+ * @return: Reference to a parser on success, NULL on failure.
+ */
+elfp_stream*
+elfp_stream_new();
+
+/*
+ * elfp_stream_feed: Gives the parser the next piece of input.
+ * 	* The buffer is not needed after the call returns.
+ * 	* Input fed after ELFP_STREAM_DONE is ignored.
+ *
+ * @arg0: Reference to a parser
+ * @arg1: Input
+ * @arg2: Number of bytes in the input
+ *
+ * @return: 0 on success, -1 on failure / malformed input.
+ */
+int
+elfp_stream_feed(elfp_stream *stream, const void *buf, unsigned long int len);
+
+/*
+ * elfp_stream_poll: Gets the next event.
+ * 	* Call it till it returns ELFP_STREAM_NEED_MORE, then feed more.
+ *
+ * @arg0: Reference to a parser
+ * @arg1: Reference to an event. Filled up by the function.
+ *
+ * @return: Type of the event.
+ */
+int
+elfp_stream_poll(elfp_stream *stream, elfp_stream_event *event);
+
+/*
+ * elfp_stream_free: Cleans up the parser, including data of the last
+ * 	polled event.
+ *
+ * @arg0: Reference to a parser
+ */
+void
+elfp_stream_free(elfp_stream *stream);
+
 #endif /* _ELFP_H */
@@ -0,0 +1,117 @@
+/*
+ * File: elfp_accel.h
+ *
+ * Description: The acceleration tables - .gdb_index and .debug_names.
+ * 		Where they are in the file, read in place.
+ *
+ * 		* Internal to the tool. User should not touch these structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#ifndef _ELFP_ACCEL_H
+#define _ELFP_ACCEL_H
+
+#include "./elfp_int.h"
+#include "./elfp_dwarf.h"
+
+/* A .gdb_index, versions 7 to 9. All the pointers point into it */
+typedef struct elfp_accel_gdb
+{
+	unsigned int version;
+
+	/* Units: (offset, length) pairs, type units: (offset, type offset,
+	 * signature) triples. Numbers in CU vectors count both, units first */
+	const unsigned char *cus;
+	unsigned long int n_cus;
+	const unsigned char *tus;
+	unsigned long int n_tus;
+
+	/* (low, high, unit number) triples. sorted is 1 if they are in
+	 * ascending order of low - gdb writes them so */
+	const unsigned char *addrs;
+	unsigned long int n_addrs;
+	int sorted;
+
+	/* Hash table of (name offset, CU vector offset) pairs. Both are
+	 * offsets in the constant pool. n_slots is a power of 2 */
+	const unsigned char *slots;
+	unsigned long int n_slots;
+	const unsigned char *pool;
+	unsigned long int pool_size;
+
+} elfp_accel_gdb;
+
+/* A name index of .debug_names. A section can have many, one after the
+ * other - a linker which doesn't merge them leaves one per unit */
+typedef struct elfp_accel_names
+{
+	unsigned int offset_size;
+	unsigned long int n_cus;
+	unsigned long int n_local_tus;
+	unsigned long int n_foreign_tus;
+	unsigned long int n_buckets;
+	unsigned long int n_names;
+
+	const unsigned char *cus;
+	const unsigned char *buckets;
+	const unsigned char *hashes;
+	const unsigned char *str_offsets;
+	const unsigned char *entry_offsets;
+	const unsigned char *abbrevs;
+	const unsigned char *abbrevs_end;
+	const unsigned char *pool;
+	const unsigned char *end;
+
+} elfp_accel_names;
+
+/******************************************************************************
+ * Structure: elfp_main_accel
+ *
+ * Description:
+ * 	* The acceleration tables of a file, if it has them. Only their
+ * 	headers are read - lookups read the tables in place.
+ * 	* available is a mask of ELFP_ACCEL_* (Refer elfp.h).
+ * 	* Everything comes from the object's arena.
+ *****************************************************************************/
+typedef struct elfp_main_accel
+{
+	int available;
+
+	elfp_accel_gdb gdb;
+
+	unsigned long int n_names;
+	elfp_accel_names *names;
+	elfp_dwarf_cursor str;
+
+	/* Object files - address 0 is a real address */
+	int relocatable;
+
+} elfp_main_accel;
+
+/*
+ * elfp_accel_get: Gets the acceleration tables of a file, reading their
+ * 	headers if this is the first time.
+ *
+ * @arg0: Reference to an elfp_main object
+ *
+ * @return: NULL on failure, the tables on success. A file without any
+ * 	has available set to 0.
+ */
+elfp_main_accel*
+elfp_accel_get(elfp_main *main);
+
+#endif /* _ELFP_ACCEL_H */
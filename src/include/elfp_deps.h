@@ -0,0 +1,165 @@
+/*
+ * File: elfp_deps.h
+ *
+ * Description: The dependency graph - what elfp_deps_resolve() builds.
+ *
+ * 		* Internal to the tool. User should not touch these structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#ifndef _ELFP_DEPS_H
+#define _ELFP_DEPS_H
+
+#include "./elfp_ds.h"
+#include "./elfp.h"
+
+#include <pthread.h>
+
+/* Buckets of the search cache */
+#define ELFP_DEPS_CACHE_BUCKETS 1024
+
+/* Node buckets to start with. Doubled as the graph grows */
+#define ELFP_DEPS_NODE_BUCKETS 256
+
+/******************************************************************************
+ * Structure: elfp_deps_found
+ *
+ * Description:
+ * 	* Where a needed library was found. err is 0 if it was, an errno
+ * 	value otherwise.
+ * 	* A file is identified by its device and inode, so that the same
+ * 	library reached through different paths (symlinks, /lib and
+ * 	/usr/lib) is one node.
+ *****************************************************************************/
+typedef struct elfp_deps_found
+{
+	const char *path;
+	unsigned long int dev;
+	unsigned long int ino;
+	int err;
+
+} elfp_deps_found;
+
+/******************************************************************************
+ * Structure: elfp_deps_cached
+ *
+ * Description:
+ * 	* Result of searching the default places for a name. It doesn't
+ * 	depend on who needs the library, only on its class and machine.
+ * 	So, it is searched for once per graph.
+ *****************************************************************************/
+typedef struct elfp_deps_cached
+{
+	const char *name;
+	int class;
+	unsigned int machine;
+	elfp_deps_found found;
+
+	struct elfp_deps_cached *next;
+
+} elfp_deps_cached;
+
+/******************************************************************************
+ * Structure: elfp_deps_rpath
+ *
+ * Description:
+ * 	* A DT_RPATH of the loading chain, with the $ORIGIN of the file it
+ * 	came from. The dynamic loader searches the DT_RPATH of the file
+ * 	needing a library, then that of the file which loaded it and so on
+ * 	up to the executable.
+ * 	* A file's list is its own DT_RPATH followed by its loader's list,
+ * 	so the tails are shared.
+ *****************************************************************************/
+typedef struct elfp_deps_rpath
+{
+	const char *rpath;
+	const char *origin;
+
+	const struct elfp_deps_rpath *next;
+
+} elfp_deps_rpath;
+
+/******************************************************************************
+ * Structure: elfp_deps_node
+ *
+ * Description:
+ * 	* A library / executable in the graph. dep is what the user sees.
+ * 	* found is filled up by the worker which parses the file, one
+ * 	entry per DT_NEEDED. The edges (dep.needed) are made from it once
+ * 	all workers of a level are done.
+ *****************************************************************************/
+typedef struct elfp_deps_node
+{
+	elfp_dep dep;
+
+	/* Index in the graph */
+	unsigned long int index;
+
+	unsigned long int dev;
+	unsigned long int ino;
+
+	/* Where each DT_NEEDED was found */
+	elfp_deps_found *found;
+
+	/*
+	 * DT_RPATHs of the loading chain, and the same with the node's own
+	 * in front - what the files it needs inherit. A file reached by
+	 * many parents is loaded by the first one, like ld.so does it.
+	 */
+	const elfp_deps_rpath *loader;
+	const elfp_deps_rpath *rpaths;
+
+	/* Next node in the bucket */
+	struct elfp_deps_node *next;
+
+} elfp_deps_node;
+
+/******************************************************************************
+ * Structure: elfp_deps
+ *
+ * Description:
+ * 	* The graph. Nodes are numbered in the order they are found, all of
+ * 	a level before the next one.
+ * 	* Everything comes from the arena. Workers allocate too, so it is
+ * 	protected by 'lock', along with the search cache.
+ *****************************************************************************/
+struct elfp_deps
+{
+	pthread_mutex_t lock;
+	elfp_ds_arena arena;
+
+	/* All the nodes */
+	elfp_deps_node **nodes;
+	unsigned long int count;
+	unsigned long int total;
+
+	/* Nodes hashed by file identity, or by name if not found */
+	elfp_deps_node **buckets;
+	unsigned long int n_buckets;
+
+	/* Node of every root */
+	unsigned long int *roots;
+	unsigned long int n_roots;
+
+	/* Search results of the default places */
+	elfp_deps_cached *cache[ELFP_DEPS_CACHE_BUCKETS];
+
+	/* The system's ld.so.cache. NULL if it has none */
+	elfp_ldcache *ldcache;
+};
+
+#endif /* _ELFP_DEPS_H */
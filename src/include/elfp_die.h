@@ -0,0 +1,212 @@
+/*
+ * File: elfp_die.h
+ *
+ * Description: The DIE index. What .debug_info says about where the
+ * 		units and the functions are - out-of-line and inlined.
+ *
+ * 		* Internal to the tool. User should not touch these structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#ifndef _ELFP_DIE_H
+#define _ELFP_DIE_H
+
+#include "./elfp_int.h"
+#include "./elfp_dwarf.h"
+
+/* outer / parent of a function range which is not inside any other */
+#define ELFP_DIE_NO_PARENT	0xffffffff
+
+/* An attribute of an abbreviation */
+typedef struct elfp_die_attr
+{
+	unsigned int name;
+	unsigned int form;
+	long int implicit_const;
+
+} elfp_die_attr;
+
+/* A step of skipping a DIE's attributes: bytes of fixed-size ones, then
+ * one whose size is in the value (form) - 0 if there is none */
+typedef struct elfp_die_skip
+{
+	unsigned long int bytes;
+	unsigned int form;
+
+} elfp_die_skip;
+
+/* What the function index does with DIEs of an abbreviation */
+#define ELFP_DIE_SKIP		0	/* Skip its attributes */
+#define ELFP_DIE_FUNC		1	/* Read its attributes */
+#define ELFP_DIE_SUBTREE	2	/* Jump to its sibling */
+
+/* An abbreviation of .debug_abbrev */
+typedef struct elfp_die_abbrev
+{
+	unsigned long int code;
+	unsigned int tag;
+	int has_children;
+	int action;
+
+	unsigned int n_attrs;
+	elfp_die_attr *attrs;
+
+	/* Skipping DIEs of this abbreviation. Attributes of fixed size
+	 * are skipped in one go */
+	unsigned int n_skips;
+	elfp_die_skip *skips;
+
+} elfp_die_abbrev;
+
+/* An abbreviation table. list[] is sorted by code. Compilers number
+ * them 1, 2, 3 ..., in which case code N is list[N - 1] (dense) */
+typedef struct elfp_die_abbrevs
+{
+	unsigned long int count;
+	elfp_die_abbrev *list;
+	int dense;
+
+} elfp_die_abbrevs;
+
+/* A unit of .debug_info. Offsets are .debug_info offsets */
+typedef struct elfp_die_unit
+{
+	unsigned long int offset;
+	unsigned long int die;
+	unsigned long int end;
+	elfp_dwarf_format format;
+	unsigned int unit_type;
+	unsigned long int abbrev_offset;
+
+	/* NULL if the unit could not be decoded */
+	elfp_die_abbrevs *abbrevs;
+
+	/* From the unit's DIE */
+	unsigned int tag;
+	const char *name;
+	const char *comp_dir;
+	unsigned long int base;
+	unsigned long int str_offsets_base;
+	unsigned long int addr_base;
+	unsigned long int rnglists_base;
+	int has_stmt_list;
+	unsigned long int stmt_list;
+
+	/* Ranges of the unit's DIE - the address map without aranges */
+	unsigned long int n_ranges;
+	unsigned long int *ranges;
+
+} elfp_die_unit;
+
+/******************************************************************************
+ * Structure: elfp_main_units
+ *
+ * Description:
+ * 	* The units of .debug_info, their abbreviation tables and the
+ * 	address ranges each of them covers.
+ * 	* Address map: ranges sorted by low. From .debug_aranges if the file
+ * 	has it, from the unit DIEs otherwise.
+ * 	* The .debug_* sections the DIE readers need, as cursors. Copy
+ * 	them before reading.
+ * 	* Everything comes from the object's arena.
+ *****************************************************************************/
+typedef struct elfp_main_units
+{
+	unsigned long int count;
+	elfp_die_unit *units;
+	unsigned long int n_broken;
+
+	unsigned long int n_ranges;
+	unsigned long int *range_lows;
+	unsigned long int *range_highs;
+	unsigned int *range_units;
+
+	elfp_dwarf_cursor info;
+	elfp_dwarf_cursor abbrev;
+	elfp_dwarf_cursor str;
+	elfp_dwarf_cursor line_str;
+	elfp_dwarf_cursor str_offsets;
+	elfp_dwarf_cursor addr;
+	elfp_dwarf_cursor ranges;
+	elfp_dwarf_cursor rnglists;
+
+	/* Object files - address 0 is a real address */
+	int relocatable;
+
+} elfp_main_units;
+
+/* A range of a function. lows[] of the index are kept apart */
+typedef struct elfp_die_func
+{
+	unsigned long int high;
+	unsigned long int die;
+	unsigned int outer;
+	unsigned int parent;
+	unsigned int unit;
+	unsigned int call_file;
+	unsigned int call_line;
+	int inlined;
+
+} elfp_die_func;
+
+/******************************************************************************
+ * Structure: elfp_main_funcs
+ *
+ * Description:
+ * 	* Address ranges of DW_TAG_subprogram and DW_TAG_inlined_subroutine
+ * 	DIEs, sorted by low. A function with many ranges has an entry
+ * 	for every range.
+ * 	* outer is the innermost range which starts where / before the
+ * 	entry's range does and contains that start. parent is the same,
+ * 	of the entry's unit only - where an inlined function was inlined
+ * 	into. A lookup goes up the outer links to the innermost range an
+ * 	address is in, and from there up the parent links.
+ * 	* Names are not in the index. They are read off die when asked for.
+ * 	* Everything comes from the object's arena.
+ *****************************************************************************/
+typedef struct elfp_main_funcs
+{
+	unsigned long int count;
+	unsigned long int *lows;
+	elfp_die_func *funcs;
+
+} elfp_main_funcs;
+
+/*
+ * elfp_die_units_get: Gets the unit table of a file, building it if this
+ * 	is the first time.
+ *
+ * @arg0: Reference to an elfp_main object
+ *
+ * @return: NULL on failure, the table on success. A file without
+ * 	.debug_info has an empty table.
+ */
+elfp_main_units*
+elfp_die_units_get(elfp_main *main);
+
+/*
+ * elfp_die_funcs_get: Gets the function index of a file, building it if
+ * 	this is the first time.
+ *
+ * @arg0: Reference to an elfp_main object
+ *
+ * @return: NULL on failure, the index on success.
+ */
+elfp_main_funcs*
+elfp_die_funcs_get(elfp_main *main);
+
+#endif /* _ELFP_DIE_H */
@@ -72,4 +72,88 @@ elfp_ds_vector_fini(elfp_ds_vector *vec);
 int
 elfp_ds_vector_add(elfp_ds_vector *vec, void *addr);
 
+/******************************************************************************
+ * Structure: elfp_ds_arena
+ *
+ * Description:
+ * 	* A bump-pointer allocator. Memory is taken from big chunks and is
+ * 	never freed individually.
+ * 	* Everything allocated from an arena is released in one shot by
+ * 	elfp_ds_arena_fini().
+ * 	* Nothing is allocated till the first elfp_ds_arena_alloc().
+ *****************************************************************************/
+
+#define ELFP_DS_ARENA_CHUNK_SIZE 4096
+
+/* Every allocation is aligned to this */
+#define ELFP_DS_ARENA_ALIGN 16
+
+typedef struct elfp_ds_arena_chunk
+{
+	struct elfp_ds_arena_chunk *next;
+
+	/* Usable bytes in this chunk, and bytes already handed out */
+	unsigned long int size;
+	unsigned long int used;
+
+	/* The memory itself follows the header */
+
+} elfp_ds_arena_chunk;
+
+typedef struct elfp_ds_arena
+{
+	/* Chunk allocations are bumped from. Older chunks follow it */
+	elfp_ds_arena_chunk *head;
+
+} elfp_ds_arena;
+
+/*
+ * elfp_ds_arena_init: Initializes an arena.
+ *
+ * @arg0: A reference to an elfp_ds_arena structure.
+ */
+void
+elfp_ds_arena_init(elfp_ds_arena *arena);
+
+/*
+ * elfp_ds_arena_alloc: Allocates zeroed memory from the arena.
+ *
+ * @arg0: A reference to an elfp_ds_arena structure.
+ * @arg1: Number of bytes needed.
+ *
+ * @return: NULL on failure, address of the memory on success.
+ */
+void*
+elfp_ds_arena_alloc(elfp_ds_arena *arena, unsigned long int size);
+
+/*
+ * elfp_ds_arena_fini: Frees up everything allocated from the arena.
+ *
+ * @arg0: A reference to an elfp_ds_arena structure.
+ */
+void
+elfp_ds_arena_fini(elfp_ds_arena *arena);
+
+/******************************************************************************
+ * Allocator hooks
+ *
+ * Description:
+ * 	* Memory for arena chunks is taken from these functions.
+ * 	* By default, they are malloc() and free().
+ *****************************************************************************/
+
+typedef void* (*elfp_ds_malloc_fn)(unsigned long int size);
+typedef void (*elfp_ds_free_fn)(void *addr);
+
+/*
+ * elfp_ds_set_allocator: Replaces the allocator hooks.
+ *
+ * @arg0: malloc() like function. NULL restores malloc().
+ * @arg1: free() like function. NULL restores free().
+ *
+ * 	* MUST be called before anything is allocated from an arena.
+ */
+void
+elfp_ds_set_allocator(elfp_ds_malloc_fn malloc_fn, elfp_ds_free_fn free_fn);
+
 #endif /* _ELFP_DS_H */
@@ -0,0 +1,333 @@
+/*
+ * File: elfp_dwarf.h
+ *
+ * Description: Building blocks for reading DWARF - the .debug_* sections.
+ *
+ * 		* A bounds-checked cursor over a section, and readers for the
+ * 		encodings and attribute forms all the DWARF parsers share.
+ * 		* Internal to the tool. User should not touch these structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#ifndef _ELFP_DWARF_H
+#define _ELFP_DWARF_H
+
+#include "./elfp_int.h"
+
+/* Attribute forms */
+#define DW_FORM_addr		0x01
+#define DW_FORM_block2		0x03
+#define DW_FORM_block4		0x04
+#define DW_FORM_data2		0x05
+#define DW_FORM_data4		0x06
+#define DW_FORM_data8		0x07
+#define DW_FORM_string		0x08
+#define DW_FORM_block		0x09
+#define DW_FORM_block1		0x0a
+#define DW_FORM_data1		0x0b
+#define DW_FORM_flag		0x0c
+#define DW_FORM_sdata		0x0d
+#define DW_FORM_strp		0x0e
+#define DW_FORM_udata		0x0f
+#define DW_FORM_ref_addr	0x10
+#define DW_FORM_ref1		0x11
+#define DW_FORM_ref2		0x12
+#define DW_FORM_ref4		0x13
+#define DW_FORM_ref8		0x14
+#define DW_FORM_ref_udata	0x15
+#define DW_FORM_indirect	0x16
+#define DW_FORM_sec_offset	0x17
+#define DW_FORM_exprloc		0x18
+#define DW_FORM_flag_present	0x19
+#define DW_FORM_strx		0x1a
+#define DW_FORM_addrx		0x1b
+#define DW_FORM_ref_sup4	0x1c
+#define DW_FORM_strp_sup	0x1d
+#define DW_FORM_data16		0x1e
+#define DW_FORM_line_strp	0x1f
+#define DW_FORM_ref_sig8	0x20
+#define DW_FORM_implicit_const	0x21
+#define DW_FORM_loclistx	0x22
+#define DW_FORM_rnglistx	0x23
+#define DW_FORM_ref_sup8	0x24
+#define DW_FORM_strx1		0x25
+#define DW_FORM_strx2		0x26
+#define DW_FORM_strx3		0x27
+#define DW_FORM_strx4		0x28
+#define DW_FORM_addrx1		0x29
+#define DW_FORM_addrx2		0x2a
+#define DW_FORM_addrx3		0x2b
+#define DW_FORM_addrx4		0x2c
+#define DW_FORM_GNU_addr_index	0x1f01
+#define DW_FORM_GNU_str_index	0x1f02
+#define DW_FORM_GNU_ref_alt	0x1f20
+#define DW_FORM_GNU_strp_alt	0x1f21
+
+/* Tags */
+#define DW_TAG_array_type		0x01
+#define DW_TAG_class_type		0x02
+#define DW_TAG_enumeration_type		0x04
+#define DW_TAG_compile_unit		0x11
+#define DW_TAG_structure_type		0x13
+#define DW_TAG_subroutine_type		0x15
+#define DW_TAG_typedef			0x16
+#define DW_TAG_union_type		0x17
+#define DW_TAG_inlined_subroutine	0x1d
+#define DW_TAG_base_type		0x24
+#define DW_TAG_subprogram		0x2e
+#define DW_TAG_variable			0x34
+#define DW_TAG_namespace		0x39
+#define DW_TAG_partial_unit		0x3c
+#define DW_TAG_type_unit		0x41
+#define DW_TAG_skeleton_unit		0x4a
+
+/* Attributes */
+#define DW_AT_sibling			0x01
+#define DW_AT_name			0x03
+#define DW_AT_stmt_list			0x10
+#define DW_AT_low_pc			0x11
+#define DW_AT_high_pc			0x12
+#define DW_AT_comp_dir			0x1b
+#define DW_AT_abstract_origin		0x31
+#define DW_AT_declaration		0x3c
+#define DW_AT_specification		0x47
+#define DW_AT_ranges			0x55
+#define DW_AT_call_file			0x58
+#define DW_AT_call_line			0x59
+#define DW_AT_linkage_name		0x6e
+#define DW_AT_str_offsets_base		0x72
+#define DW_AT_addr_base			0x73
+#define DW_AT_rnglists_base		0x74
+#define DW_AT_MIPS_linkage_name		0x2007
+#define DW_AT_GNU_addr_base		0x2133
+
+/* Unit types (DWARF 5) */
+#define DW_UT_compile			0x01
+#define DW_UT_type			0x02
+#define DW_UT_partial			0x03
+#define DW_UT_skeleton			0x04
+#define DW_UT_split_compile		0x05
+#define DW_UT_split_type		0x06
+
+/* Range list entries (DWARF 5) */
+#define DW_RLE_end_of_list		0x00
+#define DW_RLE_base_addressx		0x01
+#define DW_RLE_startx_endx		0x02
+#define DW_RLE_startx_length		0x03
+#define DW_RLE_offset_pair		0x04
+#define DW_RLE_base_address		0x05
+#define DW_RLE_start_end		0x06
+#define DW_RLE_start_length		0x07
+
+/* Name index (.debug_names) entry attributes */
+#define DW_IDX_compile_unit		0x01
+#define DW_IDX_type_unit		0x02
+#define DW_IDX_die_offset		0x03
+#define DW_IDX_parent			0x04
+#define DW_IDX_type_hash		0x05
+
+/* Line number program - standard opcodes */
+#define DW_LNS_copy			0x01
+#define DW_LNS_advance_pc		0x02
+#define DW_LNS_advance_line		0x03
+#define DW_LNS_set_file			0x04
+#define DW_LNS_set_column		0x05
+#define DW_LNS_negate_stmt		0x06
+#define DW_LNS_set_basic_block		0x07
+#define DW_LNS_const_add_pc		0x08
+#define DW_LNS_fixed_advance_pc		0x09
+#define DW_LNS_set_prologue_end		0x0a
+#define DW_LNS_set_epilogue_begin	0x0b
+#define DW_LNS_set_isa			0x0c
+
+/* Line number program - extended opcodes */
+#define DW_LNE_end_sequence		0x01
+#define DW_LNE_set_address		0x02
+#define DW_LNE_define_file		0x03
+#define DW_LNE_set_discriminator	0x04
+
+/* Line number header (DWARF 5) - directory / file entry contents */
+#define DW_LNCT_path			0x1
+#define DW_LNCT_directory_index		0x2
+#define DW_LNCT_timestamp		0x3
+#define DW_LNCT_size			0x4
+#define DW_LNCT_MD5			0x5
+
+/******************************************************************************
+ * Structure: elfp_dwarf_cursor
+ *
+ * Description:
+ * 	* Where a reader is in a section. Readers never go past end.
+ * 	* A read which would have gone past end returns 0, sets error and
+ * 	moves p to end - so a loop over a broken section ends by itself,
+ * 	and error can be checked once, after the loop.
+ *****************************************************************************/
+typedef struct elfp_dwarf_cursor
+{
+	const unsigned char *p;
+	const unsigned char *end;
+	int error;
+
+} elfp_dwarf_cursor;
+
+/******************************************************************************
+ * Structure: elfp_dwarf_format
+ *
+ * Description:
+ * 	* What a unit's header says about how its contents are encoded.
+ * 	* offset_size is 4 for 32-bit DWARF, 8 for 64-bit DWARF.
+ *****************************************************************************/
+typedef struct elfp_dwarf_format
+{
+	unsigned int version;
+	unsigned int offset_size;
+	unsigned int addr_size;
+
+} elfp_dwarf_format;
+
+/******************************************************************************
+ * Structure: elfp_dwarf_value
+ *
+ * Description:
+ * 	* An attribute's value, as read by elfp_dwarf_form_read().
+ * 	* Constants, addresses, offsets, references and indexes are in u.
+ * 	DW_FORM_sdata and DW_FORM_implicit_const are sign extended into it.
+ * 	* Blocks, inline strings and DW_FORM_data16 are in data / size,
+ * 	pointing into the section.
+ * 	* Nothing is resolved - a DW_FORM_strp is an offset in u.
+ *****************************************************************************/
+typedef struct elfp_dwarf_value
+{
+	unsigned int form;
+	unsigned long int u;
+	const unsigned char *data;
+	unsigned long int size;
+
+} elfp_dwarf_value;
+
+/*
+ * elfp_dwarf_section_get: Gets a .debug_* section's contents.
+ *
+ * @arg0: Reference to an elfp_main object
+ * @arg1: Section name
+ * @arg2: Reference to a cursor. Set up to cover the whole section.
+ *
+ * @return: 0 on success, -1 if the section is not there / can't be used.
+ * 	Compressed (SHF_COMPRESSED) sections can't be used.
+ */
+int
+elfp_dwarf_section_get(elfp_main *main, const char *name,
+					elfp_dwarf_cursor *cursor);
+
+/*
+ * Readers. Multi-byte values are in the file's (= host's) byte order.
+ */
+unsigned int
+elfp_dwarf_u8(elfp_dwarf_cursor *cursor);
+
+unsigned int
+elfp_dwarf_u16(elfp_dwarf_cursor *cursor);
+
+unsigned int
+elfp_dwarf_u32(elfp_dwarf_cursor *cursor);
+
+unsigned long int
+elfp_dwarf_u64(elfp_dwarf_cursor *cursor);
+
+/* A 1, 2, 4 or 8 byte value */
+unsigned long int
+elfp_dwarf_uint(elfp_dwarf_cursor *cursor, unsigned int size);
+
+unsigned long int
+elfp_dwarf_uleb(elfp_dwarf_cursor *cursor);
+
+long int
+elfp_dwarf_sleb(elfp_dwarf_cursor *cursor);
+
+/* A NUL-terminated string, in place */
+const char*
+elfp_dwarf_cstr(elfp_dwarf_cursor *cursor);
+
+void
+elfp_dwarf_skip(elfp_dwarf_cursor *cursor, unsigned long int size);
+
+/*
+ * elfp_dwarf_unit_length: Reads the initial length field of a unit.
+ *
+ * @arg0: Reference to a cursor
+ * @arg1: Reference to the offset size. Set to 4 / 8 by the function.
+ *
+ * @return: Length of the rest of the unit. 0 with the cursor's error set
+ * 	if it is broken / runs past the end of the section.
+ */
+unsigned long int
+elfp_dwarf_unit_length(elfp_dwarf_cursor *cursor, unsigned int *offset_size);
+
+/*
+ * elfp_dwarf_form_size: Size of an attribute of a form, if it is fixed.
+ *
+ * @arg0: Form - DW_FORM_*
+ * @arg1: Reference to the unit's format
+ *
+ * @return: Size in bytes, -1 if the size depends on the value / the form
+ * 	is not known.
+ */
+int
+elfp_dwarf_form_size(unsigned int form, const elfp_dwarf_format *format);
+
+/*
+ * elfp_dwarf_form_read: Reads an attribute's value.
+ *
+ * @arg0: Reference to a cursor
+ * @arg1: Form - DW_FORM_*. DW_FORM_indirect is followed.
+ * @arg2: Reference to the unit's format
+ * @arg3: Reference to an elfp_dwarf_value. Filled up by the function.
+ *
+ * @return: 0 on success, -1 if the form is not known / the value runs
+ * 	past the end.
+ */
+int
+elfp_dwarf_form_read(elfp_dwarf_cursor *cursor, unsigned int form,
+		const elfp_dwarf_format *format, elfp_dwarf_value *value);
+
+/*
+ * elfp_dwarf_form_skip: Skips an attribute's value.
+ *
+ * @arg0: Reference to a cursor
+ * @arg1: Form - DW_FORM_*
+ * @arg2: Reference to the unit's format
+ *
+ * @return: 0 on success, -1 if the form is not known / the value runs
+ * 	past the end.
+ */
+int
+elfp_dwarf_form_skip(elfp_dwarf_cursor *cursor, unsigned int form,
+				const elfp_dwarf_format *format);
+
+/*
+ * elfp_dwarf_str: Gets a string of a string section - .debug_str,
+ * 	.debug_line_str.
+ *
+ * @arg0: Reference to a cursor covering the section
+ * @arg1: Offset of the string
+ *
+ * @return: The string, NULL if the offset is junk.
+ */
+const char*
+elfp_dwarf_str(const elfp_dwarf_cursor *section, unsigned long int offset);
+
+#endif /* _ELFP_DWARF_H */
@@ -0,0 +1,143 @@
+/*
+ * File: elfp_dyn.h
+ *
+ * Description: The dynamic index. Built once per file, on first use, from
+ * 		the PT_LOAD and PT_DYNAMIC segments.
+ *
+ * 		* Internal to the tool. User should not touch these structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#ifndef _ELFP_DYN_H
+#define _ELFP_DYN_H
+
+#include "./elfp_int.h"
+#include "./elfp.h"
+
+#include <elf.h>
+
+/* RELR is newer than some elf.h out there */
+#ifndef DT_RELRSZ
+#define DT_RELRSZ	35
+#define DT_RELR		36
+#define DT_RELRENT	37
+#endif
+
+/* .gnu.version entries: the version's index, and "not the default one" */
+#define ELFP_VERSYM_INDEX	0x7fff
+#define ELFP_VERSYM_HIDDEN	0x8000
+
+/******************************************************************************
+ * Structure: elfp_load
+ *
+ * Description:
+ * 	* A PT_LOAD segment - where a range of virtual addresses comes from
+ * 	in the file.
+ *****************************************************************************/
+typedef struct elfp_load
+{
+	unsigned long int vaddr;
+	unsigned long int memsz;
+	unsigned long int offset;
+	unsigned long int filesz;
+
+} elfp_load;
+
+/******************************************************************************
+ * Structure: elfp_main_dynamic
+ *
+ * Description:
+ * 	* The PT_LOAD map, the DYNAMIC segment - decoded, and the tables
+ * 	it points to which are needed for symbol lookup.
+ * 	* Everything comes from the object's arena. A file without
+ * 	PT_DYNAMIC has count 0, and all pointers NULL.
+ *****************************************************************************/
+typedef struct elfp_main_dynamic
+{
+	/* PT_LOAD segments, in PHT order */
+	unsigned long int n_loads;
+	elfp_load *loads;
+
+	/* The DYNAMIC segment as it is in the file. count excludes DT_NULL */
+	const void *dyn;
+	unsigned long int count;
+
+	/* The same, decoded. Handed out to the user */
+	elfp_dynamic info;
+
+	/* Dynamic symbol table, as DT_SYMTAB / DT_STRTAB locate it. syms_max
+	 * is how many symbols can be there - till the end of the segment */
+	const void *syms;
+	unsigned long int syms_max;
+	const char *strtab;
+	unsigned long int strsize;
+
+	/* Hash tables. NULL if absent. *_words is the number of 32-bit
+	 * words available from the start of the table */
+	const unsigned int *gnu_hash;
+	unsigned long int gnu_hash_words;
+	const unsigned int *hash;
+	unsigned long int hash_words;
+
+	/* DT_VERSYM - a 16-bit version index per symbol. NULL if absent.
+	 * versym_count is cut down to syms_max */
+	const unsigned char *versym;
+	unsigned long int versym_count;
+
+} elfp_main_dynamic;
+
+/*
+ * elfp_dyn_index_get: Gets the dynamic index of a file, building it if
+ * 	this is the first time.
+ *
+ * @arg0: Reference to an elfp_main object
+ *
+ * @return: NULL on failure, the index on success.
+ */
+elfp_main_dynamic*
+elfp_dyn_index_get(elfp_main *main);
+
+/*
+ * elfp_dyn_vaddr_to_offset: Translates a virtual address to a file offset
+ * 	through the PT_LOAD segments.
+ *
+ * @arg0: The dynamic index
+ * @arg1: Virtual address
+ * @arg2: Reference to the offset. Filled up by the function.
+ * @arg3: Reference to the number of bytes backed by the file from there
+ * 	on, till the end of the segment. Can be NULL.
+ *
+ * @return: 0 on success, -1 if the address is not backed by the file.
+ */
+int
+elfp_dyn_vaddr_to_offset(elfp_main_dynamic *dynamic, unsigned long int vaddr,
+		unsigned long int *offset, unsigned long int *avail);
+
+/*
+ * elfp_dyn_entry_get: Gets an entry of the DYNAMIC segment.
+ *
+ * @arg0: Reference to an elfp_main object
+ * @arg1: The dynamic index
+ * @arg2: Index of the entry. Less than dynamic->count.
+ * @arg3: References to the tag and the value. Filled up by the function.
+ */
+void
+elfp_dyn_entry_get(elfp_main *main, elfp_main_dynamic *dynamic,
+		unsigned long int index, unsigned long int *tag,
+		unsigned long int *val);
+
+#endif /* _ELFP_DYN_H */
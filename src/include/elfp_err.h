@@ -25,11 +25,19 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
 
+/*
+ * errno is preserved across the warning, so that callers can still
+ * find out why the failing syscall failed.
+ */
 static void
 elfp_err_warn(const char *function_name, const char *err_msg)
 {
+	int saved_errno = errno;
+
 	fprintf(stderr, "%s: %s\n", function_name, err_msg);
+	errno = saved_errno;
 }
 
 static void
@@ -0,0 +1,211 @@
+/*
+ * File: elfp_frame.h
+ *
+ * Description: Call frame information - .eh_frame, its binary search
+ * 		table .eh_frame_hdr, and .debug_frame. Readers of CIEs and
+ * 		FDEs, in place.
+ *
+ * 		* Internal to the tool. User should not touch these structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#ifndef _ELFP_FRAME_H
+#define _ELFP_FRAME_H
+
+#include "./elfp_int.h"
+#include "./elfp_dwarf.h"
+
+/* Pointer encodings (LSB). The low 4 bits say how the value is stored,
+ * the next 3 what it is relative to */
+#define DW_EH_PE_absptr		0x00
+#define DW_EH_PE_uleb128	0x01
+#define DW_EH_PE_udata2		0x02
+#define DW_EH_PE_udata4		0x03
+#define DW_EH_PE_udata8		0x04
+#define DW_EH_PE_sleb128	0x09
+#define DW_EH_PE_sdata2		0x0a
+#define DW_EH_PE_sdata4		0x0b
+#define DW_EH_PE_sdata8		0x0c
+
+#define DW_EH_PE_pcrel		0x10
+#define DW_EH_PE_textrel	0x20
+#define DW_EH_PE_datarel	0x30
+#define DW_EH_PE_funcrel	0x40
+#define DW_EH_PE_aligned	0x50
+
+#define DW_EH_PE_indirect	0x80
+#define DW_EH_PE_omit		0xff
+
+/* A section of frame information, where it is in the file and in memory */
+typedef struct elfp_frame_section
+{
+	const unsigned char *data;
+	unsigned long int size;
+	unsigned long int offset;
+	unsigned long int vaddr;
+
+	/* 1 for .eh_frame, 0 for .debug_frame. They differ in how CIEs are
+	 * told apart and pointed at */
+	int is_eh;
+	unsigned int addr_size;
+
+	/* Base of DW_EH_PE_datarel. .eh_frame_hdr's address */
+	unsigned long int data_base;
+
+} elfp_frame_section;
+
+/* A CIE. Pointers point into the section */
+typedef struct elfp_frame_cie
+{
+	unsigned long int offset;
+	unsigned long int size;
+
+	unsigned int version;
+	const char *augmentation;
+	unsigned int addr_size;
+	unsigned long int code_align;
+	long int data_align;
+	unsigned long int ra_register;
+
+	/* From the augmentation. fde_encoding is DW_EH_PE_absptr if the
+	 * CIE doesn't say */
+	unsigned int fde_encoding;
+	unsigned int lsda_encoding;
+	int has_augmentation_data;
+	int signal_frame;
+
+	/* Initial instructions */
+	const unsigned char *insns;
+	unsigned long int insns_size;
+
+} elfp_frame_cie;
+
+/* An FDE. Pointers point into the section */
+typedef struct elfp_frame_fde
+{
+	unsigned long int offset;
+	unsigned long int size;
+	unsigned long int cie_offset;
+
+	unsigned long int pc_begin;
+	unsigned long int pc_range;
+
+	/* Call frame instructions */
+	const unsigned char *insns;
+	unsigned long int insns_size;
+
+} elfp_frame_fde;
+
+/******************************************************************************
+ * Structure: elfp_main_eh_hdr
+ *
+ * Description:
+ * 	* .eh_frame_hdr (PT_GNU_EH_FRAME) and the .eh_frame it points to.
+ * 	* table is the binary search table - n_fdes (initial location, FDE
+ * 	address) pairs sorted by initial location, both encoded with
+ * 	table_encoding. NULL if the file has none / it can't be searched.
+ * 	* Everything points into the file. The structure comes from the
+ * 	object's arena.
+ *****************************************************************************/
+typedef struct elfp_main_eh_hdr
+{
+	/* 0 if the file has no (usable) .eh_frame_hdr */
+	int available;
+
+	/* .eh_frame_hdr itself - what the table's pointers are read with */
+	elfp_frame_section hdr;
+
+	unsigned int table_encoding;
+	unsigned int entry_size;
+	unsigned long int n_fdes;
+	const unsigned char *table;
+
+	elfp_frame_section eh_frame;
+
+} elfp_main_eh_hdr;
+
+/*
+ * elfp_frame_pointer_read: Reads a pointer encoded with DW_EH_PE_*.
+ *
+ * @arg0: Reference to a cursor in a section
+ * @arg1: Encoding
+ * @arg2: The section. The cursor's position in it makes DW_EH_PE_pcrel.
+ * @arg3: Reference to the value. Filled up by the function.
+ *
+ * @return: 0 on success, -1 if the encoding is not known / the value runs
+ * 	past the end. DW_EH_PE_indirect is not followed - the value is the
+ * 	address of the pointer. DW_EH_PE_omit reads nothing and gives 0.
+ */
+int
+elfp_frame_pointer_read(elfp_dwarf_cursor *cursor, unsigned int encoding,
+		const elfp_frame_section *section, unsigned long int *value);
+
+/*
+ * elfp_frame_entry_size: Gets the size of a CIE / FDE - to walk a section.
+ *
+ * @arg0: The section
+ * @arg1: Offset of the entry in it
+ * @arg2: Reference to an int. Set to 1 for a CIE, 0 for an FDE.
+ *
+ * @return: Size of the entry, including its length. 0 at the end of the
+ * 	section / the terminator / a broken entry.
+ */
+unsigned long int
+elfp_frame_entry_size(const elfp_frame_section *section, unsigned long int offset,
+							int *is_cie);
+
+/*
+ * elfp_frame_cie_read: Reads a CIE.
+ *
+ * @arg0: The section
+ * @arg1: Offset of the CIE in it
+ * @arg2: Reference to an elfp_frame_cie. Filled up by the function.
+ *
+ * @return: 0 on success, -1 if it is not a CIE / is broken / has an
+ * 	augmentation which can't be skipped.
+ */
+int
+elfp_frame_cie_read(const elfp_frame_section *section, unsigned long int offset,
+					elfp_frame_cie *cie);
+
+/*
+ * elfp_frame_fde_read: Reads an FDE, and its CIE.
+ *
+ * @arg0: The section
+ * @arg1: Offset of the FDE in it
+ * @arg2: References to an elfp_frame_fde and an elfp_frame_cie. Filled up
+ * 	by the function.
+ *
+ * @return: 0 on success, -1 if it is not an FDE / it or its CIE is broken.
+ */
+int
+elfp_frame_fde_read(const elfp_frame_section *section, unsigned long int offset,
+			elfp_frame_fde *fde, elfp_frame_cie *cie);
+
+/*
+ * elfp_frame_eh_hdr_get: Gets .eh_frame_hdr of a file, reading its header
+ * 	if this is the first time.
+ *
+ * @arg0: Reference to an elfp_main object
+ *
+ * @return: NULL on failure, the table on success. A file without one has
+ * 	available set to 0.
+ */
+elfp_main_eh_hdr*
+elfp_frame_eh_hdr_get(elfp_main *main);
+
+#endif /* _ELFP_FRAME_H */
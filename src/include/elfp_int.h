@@ -27,6 +27,8 @@
 
 #include "elfp_ds.h"
 
+#include <pthread.h>
+
 /******************************************************************************
  * Structure: elfp_main
  *
@@ -34,16 +36,68 @@
  * 	* When a new file is opened using elfp_open(), an instance of this
  * 	structure is created.
  *****************************************************************************/
-#define ELFP_FILEPATH_SIZE 256
-#define ELFP_FREE_ADDR_VECTOR_INIT_SIZE 1000
+
+/* With ELFP_OPEN_HEADERS_ONLY, headers spanning more than this
+ * are not read upfront */
+#define ELFP_HEADERS_BUF_MAX 65536
+
+/* ELFP_OPEN_WINDOWED: Size of a window and the most windows
+ * mapped at a time */
+#define ELFP_MAIN_WINDOW_SIZE (1024 * 1024)
+#define ELFP_MAIN_WINDOWS_MAX 8
+
+/* ELFP_OPEN_WINDOWED: Most bytes of ranges mapped on demand at a time.
+ * Ranges nobody holds make way for new ones */
+#define ELFP_MAIN_MAPS_MAX (64 * 1024 * 1024)
+
+/* Internal flags, kept in elfp_main's flags along with the ELFP_OPEN_* flags.
+ *
+ * ELFP_MAIN_CALLER_BUF: start_addr is a buffer owned by the caller.
+ * 	* There is no file descriptor and nothing to unmap.
+ */
+#define ELFP_MAIN_CALLER_BUF	0x80000000
+
+/* Identity of a file, used to find shared objects. Refer ELFP_OPEN_SHARED */
+#define ELFP_MAIN_CACHE_BUCKETS 1024
+
+typedef struct elfp_main_cache_key
+{
+	unsigned long int dev;
+	unsigned long int ino;
+	unsigned long int size;
+	long int mtime_sec;
+	long int mtime_nsec;
+
+	/* Flags which change what the object looks like */
+	unsigned int flags;
+
+} elfp_main_cache_key;
+
+/* A range of the file mapped on demand */
+typedef struct elfp_main_map
+{
+	/* Page aligned file offset and size of the mapping */
+	unsigned long int offset;
+	unsigned long int size;
+
+	/* Address returned by mmap() */
+	unsigned char *addr;
+
+	/* Ranges mapped on demand: number of users holding it. Refer
+	 * elfp_main_put_range() */
+	unsigned long int refs;
+
+	struct elfp_main_map *next;
+
+} elfp_main_map;
 
 typedef struct elfp_main
 {	
 	/* File descriptor of the open file */
 	int fd;
 
-	/* File Path */
-	char path[ELFP_FILEPATH_SIZE];
+	/* File Path. Allocated, so that deep paths are not truncated */
+	char *path;
 
 	/* Other details related to file */
 	unsigned long int file_size;
@@ -54,16 +108,102 @@ typedef struct elfp_main
 	/* Handle sent to the user */
 	int handle;
 
+	/* Protects the per-file state which is built lazily -
+	 * arena, maps and friends. */
+	pthread_mutex_t lock;
+
+	/* Serializes building of the lazy indexes - sections and friends.
+	 * Builders read the file and allocate, which take 'lock'. */
+	pthread_mutex_t index_lock;
+
+	/* Section index. Built on first use, never changed after that.
+	 * Refer elfp_shdr.h */
+	struct elfp_main_sections *sections;
+
+	/* Indexes of .symtab and .dynsym, in that order. Built on first
+	 * use, never changed after that. Refer elfp_sym.h */
+	struct elfp_main_symbols *symbols[2];
+
+	/* PT_LOAD map and the DYNAMIC segment. Built on first use, never
+	 * changed after that. Refer elfp_dyn.h */
+	struct elfp_main_dynamic *dynamic;
+
+	/* Notes of PT_NOTE segments and SHT_NOTE sections, in that order.
+	 * Built on first use, never changed after that. Refer elfp_note.h */
+	struct elfp_main_notes *notes[2];
+
+	/* Relocation tables of the DYNAMIC segment and the sections, in that
+	 * order. Built on first use, never changed after that.
+	 * Refer elfp_reloc.h */
+	struct elfp_main_relocs *relocs[2];
+
+	/* Rows of the line tables of .debug_line, sorted by address. Built
+	 * on first use, never changed after that. Refer elfp_line.h */
+	struct elfp_main_lines *lines;
+
+	/* Units of .debug_info, and the address ranges of the functions in
+	 * them - inlined ones too. Built on first use, never changed after
+	 * that. Refer elfp_die.h */
+	struct elfp_main_units *units;
+	struct elfp_main_funcs *funcs;
+
+	/* Headers of the acceleration tables - .gdb_index, .debug_names.
+	 * Read on first use, never changed after that. Refer elfp_accel.h */
+	struct elfp_main_accel *accel;
+
+	/* .eh_frame_hdr and the .eh_frame it points to. Read on first use,
+	 * never changed after that. Refer elfp_frame.h */
+	struct elfp_main_eh_hdr *eh_hdr;
+
+	/* The CFA programs of .eh_frame / .debug_frame, run into a table
+	 * sorted by address. Built on first use, never changed after that.
+	 * Refer elfp_unwind.h */
+	struct elfp_unwind *unwind;
+
+	/* .gnu.version, .gnu.version_r and .gnu.version_d, decoded. Built on
+	 * first use, never changed after that. Refer elfp_version.h */
+	struct elfp_main_versions *versions;
+
 	/* Many functions allocate objects in heap and return the pointer 
 	 * to it to the user.
 	 *
-	 * Need to keep track of all this memory and free all of it in the end.
+	 * All of them come from this arena, which is freed in one shot
+	 * in the end.
 	 */
-	elfp_ds_vector free_vec;
+	elfp_ds_arena arena;
 	
 	/* class */
 	unsigned long int class;
 
+	/* ELFP_OPEN_* and ELFP_MAIN_* flags the file was opened with */
+	unsigned int flags;
+
+	/* ELFP_OPEN_HEADERS_ONLY, ELFP_OPEN_WINDOWED:
+	 * The headers read from the file. start_addr points to this. */
+	unsigned char *hdr_buf;
+	unsigned long int hdr_size;
+
+	/* ELFP_OPEN_HEADERS_ONLY, ELFP_OPEN_WINDOWED:
+	 * Ranges beyond the headers, mapped when they were first needed.
+	 * Most recently used first. maps_size is the bytes they take */
+	elfp_main_map *maps;
+	unsigned long int maps_size;
+
+	/* ELFP_OPEN_HEADERS_ONLY, ELFP_OPEN_WINDOWED:
+	 * Windows elfp_main_read() reads through. Most recently used first */
+	elfp_main_map *windows;
+	unsigned int n_windows;
+
+	/* Number of handles using this object.
+	 * More than 1 only for objects shared through ELFP_OPEN_SHARED */
+	unsigned long int refs;
+
+	/* ELFP_OPEN_SHARED: Is it in the cache, its identity there and
+	 * the next object in the same bucket */
+	int cached;
+	elfp_main_cache_key cache_key;
+	struct elfp_main *cache_next;
+
 } elfp_main;
 
 /*
@@ -71,15 +211,60 @@ typedef struct elfp_main
  * 	reference to it.
  *
  * @arg0: File path - A NULL terminated string.
+ * @arg1: ELFP_OPEN_* flags.
  *
  * @return: NULL on failure, Reference to an empty elfp_main object on success.
  */
 elfp_main*
-elfp_main_create(const char *file_path);
+elfp_main_create(const char *file_path, unsigned int flags);
+
+/*
+ * elfp_main_create_at: Same as elfp_main_create(), with a relative path
+ * 	resolved from a directory descriptor. Refer openat(2).
+ *
+ * @arg0: Directory file descriptor or AT_FDCWD
+ * @arg1: File path - A NULL terminated string.
+ * @arg2: ELFP_OPEN_* flags.
+ *
+ * @return: NULL on failure, Reference to an empty elfp_main object on success.
+ */
+elfp_main*
+elfp_main_create_at(int dirfd, const char *file_path, unsigned int flags);
+
+/*
+ * elfp_main_create_fd: Creates a new elfp_main object for a file which
+ * 	is already open.
+ *
+ * @arg0: File descriptor, opened for reading.
+ * 	* On success, it belongs to the elfp_main object. It is closed
+ * 	by elfp_main_fini().
+ * 	* On failure, it is left open.
+ * @arg1: ELFP_OPEN_* flags.
+ *
+ * @return: NULL on failure, Reference to an empty elfp_main object on success.
+ */
+elfp_main*
+elfp_main_create_fd(int fd, unsigned int flags);
+
+/*
+ * elfp_main_create_mem: Creates a new elfp_main object for an ELF image
+ * 	which is already in memory.
+ *
+ * @arg0: Starting address of the image. It is NOT copied.
+ * @arg1: Size of the image in bytes.
+ * @arg2: ELFP_OPEN_* flags.
+ *
+ * @return: NULL on failure, Reference to an empty elfp_main object on success.
+ */
+elfp_main*
+elfp_main_create_mem(const void *buf, unsigned long int size, unsigned int flags);
 
 /*
  * elfp_main_fini: Cleans up everything related to a given elfp_main object.
  *
+ * 	* It doesn't touch main_vec. Objects in main_vec are cleaned up by
+ * 	main_vec itself, when their handle is closed.
+ *
  * @arg0: Reference to an elfp_main object
  *
  * @return: 0 on success, -1 on failure.
@@ -87,6 +272,16 @@ elfp_main_create(const char *file_path);
 int
 elfp_main_fini(elfp_main *main);
 
+/*
+ * elfp_main_release: Drops a reference to an elfp_main object.
+ * 	* The object is cleaned up when the last one is dropped.
+ * 	* Shared objects are taken out of the cache then.
+ *
+ * @arg0: Reference to an elfp_main object
+ */
+void
+elfp_main_release(elfp_main *main);
+
 /*
  * elfp_main_update_handle: Updates 'handle' of elfp_main object.
  *
@@ -129,10 +324,81 @@ elfp_main_get_filesz(elfp_main *main);
 void*
 elfp_main_get_staddr(elfp_main *main);
 
+/*
+ * elfp_main_get_range: Gets the address at which a range of the file
+ * 	can be read.
+ *
+ * @arg0: Reference to an elfp_main object
+ * @arg1: File offset
+ * @arg2: Size of the range in bytes
+ *
+ * @return: NULL on failure, address of the first byte on success.
+ *
+ * 	* Every parser should use this instead of start address + offset.
+ * 	It makes sure the range is inside the file and maps it if the file
+ * 	was opened with ELFP_OPEN_HEADERS_ONLY / ELFP_OPEN_WINDOWED.
+ * 	* The address stays valid till the object is cleaned up, or till
+ * 	elfp_main_put_range() is called for it. Use it for whatever is
+ * 	handed out to the user.
+ * 	* With ELFP_OPEN_WINDOWED, all ranges mapped together stay within
+ * 	ELFP_MAIN_MAPS_MAX. It fails with ENOMEM if the range can't fit,
+ * 	even after the ones nobody holds are unmapped.
+ */
+void*
+elfp_main_get_range(elfp_main *main, unsigned long int offset,
+				unsigned long int size);
+
+/*
+ * elfp_main_put_range: Lets go of an address elfp_main_get_range() gave.
+ * 	For parsers which need a range only for a while - building an
+ * 	index, for example.
+ *
+ * @arg0: Reference to an elfp_main object
+ * @arg1: Address returned by elfp_main_get_range()
+ *
+ * 	* The range may be unmapped once nobody holds it. With
+ * 	ELFP_OPEN_WINDOWED, it is unmapped when room is needed for another.
+ */
+void
+elfp_main_put_range(elfp_main *main, const void *addr);
+
+/*
+ * elfp_main_read: Copies a range of the file.
+ * 	* Use it for whatever is needed only inside the library - headers
+ * 	looked at to find something else, for example.
+ * 	* If the whole file is not mapped, it reads through windows which
+ * 	get reused. Address space used stays bounded.
+ *
+ * @arg0: Reference to an elfp_main object
+ * @arg1: File offset
+ * @arg2: Size of the range in bytes
+ * @arg3: Buffer to copy into. It should have space for @arg2 bytes.
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_main_read(elfp_main *main, unsigned long int offset,
+			unsigned long int size, void *buf);
+
+/*
+ * elfp_main_prefetch: Starts reading a range of the file in the
+ * 	background. Parsers call it before walking a big range.
+ * 	* Only a hint. Nothing is reported if it can't be done.
+ * 	* Does nothing with ELFP_OPEN_NO_HINTS.
+ *
+ * @arg0: Reference to an elfp_main object
+ * @arg1: Offset of the range
+ * @arg2: Size of the range. It is trimmed to the end of the file.
+ */
+void
+elfp_main_prefetch(elfp_main *main, unsigned long int offset,
+				unsigned long int size);
+
 /*
  * elfp_main_get_handle: Gets the handle
  *
  * @arg0: Reference to an elfp_main object
+ * 	* A shared object has many handles. This is the latest one.
  *
  * @return: -1 on failure, handle on success.
  */
@@ -140,14 +406,18 @@ int
 elfp_main_get_handle(elfp_main *main);
 
 /*
- * elfp_main_get_freevec: Gets the reference to the free vector.
+ * elfp_main_alloc: Allocates zeroed memory which lives as long as the
+ * 	elfp_main object.
+ * 	* Safe to be called from multiple threads.
  *
  * @arg0: Reference to an elfp_main object
+ * @arg1: Number of bytes needed
  *
- * @return: NULL on failure, reference to the free vector on success.
+ * @return: NULL on failure, address of the memory on success.
+ * 	* It MUST NOT be freed. elfp_main_fini() takes care of it.
  */
-elfp_ds_vector*
-elfp_main_get_freevec(elfp_main *main);
+void*
+elfp_main_alloc(elfp_main *main, unsigned long int size);
 
 /*
  * elfp_main_get_class: Gets the class - 32-bit or 64-bit.
@@ -164,23 +434,95 @@ elfp_main_get_class(elfp_main *main);
 /******************************************************************************
  * Structure: elfp_main_vector
  *
- * Description: It is a vector of elfp_main objects.
+ * Description: It is a table of elfp_main objects.
  * 	* Essential to handle multiple files.
+ * 	* Slots of closed handles are kept in a free list and reused.
+ * 	* Every slot has a generation, which is bumped when the handle is
+ * 	closed. A handle carries the generation of its slot, so a handle
+ * 	which was closed is rejected even after the slot is reused.
+ * 	* Generations never wrap. A slot whose generation has gone past
+ * 	ELFP_HANDLE_GEN_MASK is retired - never reused till elfp_fini().
+ * 	Otherwise, a handle closed 2048 reuses ago would be valid again.
+ *
+ * A handle looks like this:
+ *
+ * 	bits 0-19: Slot index
+ * 	bits 20-30: Generation of the slot when the handle was given out
+ *
+ * The sign bit is never used. So, handles are always non-negative.
+ *
+ * Concurrency:
+ * 	* Slots live in fixed size chunks which are never moved or freed
+ * 	till elfp_fini(). A lookup never races with a resize.
+ *
+ * 	* Generation and reference count of a slot share one word which is
+ * 	only changed with compare-and-swap. A lookup takes a reference
+ * 	only if the generation still matches. No locks are taken.
+ *
+ * 	* An open handle holds one reference, every active lookup another.
+ * 	Closing a handle bumps the generation and drops the handle's
+ * 	reference. Whoever drops the last one frees the elfp_main object
+ * 	and puts the slot back in the free list. So, an object is never
+ * 	freed under an active reader.
+ *
+ * 	* Adding and freeing slots (open / close) take main_vec's lock.
  *****************************************************************************/
 
-#define ELFP_MAIN_VECTOR_INIT_SIZE 1000
+#define ELFP_HANDLE_INDEX_BITS 20
+#define ELFP_HANDLE_INDEX_MASK ((1UL << ELFP_HANDLE_INDEX_BITS) - 1)
+#define ELFP_HANDLE_GEN_MASK ((1UL << (31 - ELFP_HANDLE_INDEX_BITS)) - 1)
+
+/* Maximum number of files that can be open at the same time */
+#define ELFP_MAIN_VECTOR_MAX_SIZE (ELFP_HANDLE_INDEX_MASK + 1)
+
+/* Slots are allocated these many at a time */
+#define ELFP_MAIN_VECTOR_CHUNK_SIZE 256
+#define ELFP_MAIN_VECTOR_MAX_CHUNKS \
+		(ELFP_MAIN_VECTOR_MAX_SIZE / ELFP_MAIN_VECTOR_CHUNK_SIZE)
+
+/* Slot state: generation in the upper half, references in the lower */
+#define ELFP_SLOT_GEN_SHIFT 32
+#define ELFP_SLOT_REFS_MASK 0xffffffffUL
+
+typedef struct elfp_main_slot
+{
+	/* Generation and number of references.
+	 * Changed only atomically, as a whole */
+	unsigned long int state;
+
+	/* The object, NULL if the slot is free */
+	elfp_main *main;
+
+	/* A free slot is in the free list, a used slot in the list of
+	 * open handles. These are the neighbours in that list, -1 at the ends.
+	 * The free list only uses next.
+	 *
+	 * Protected by main_vec's lock */
+	long int next;
+	long int prev;
+
+} elfp_main_slot;
 
 typedef struct elfp_vector_main
 {
-	/* Array of pointer to elfp_main structure */
-	elfp_main **vec;
+	/* Chunks of slots. A NULL chunk is not allocated yet */
+	elfp_main_slot *chunks[ELFP_MAIN_VECTOR_MAX_CHUNKS];
+
+	/* Number of slots ever used. Slots beyond this are neither
+	 * in the free list nor in use */
+	unsigned long int used;
+
+	/* Head of the free list */
+	long int free_head;
 
-	/* Size of the vector */
-	unsigned long int total;
+	/* Head of the list of open handles */
+	long int live_head;
 
-	/* Handle of the latest opened file.
-	 * This is NOT the total number of open files. */
-	unsigned long int latest;
+	/* Number of open handles */
+	unsigned long int live;
+
+	/* Taken while adding / freeing slots */
+	pthread_mutex_t lock;
 
 } elfp_main_vector;
 
@@ -199,40 +541,73 @@ elfp_main_vec_init();
  *
  * @arg0: Reference to an elfp_main structure.
  *
- * @return: handle(a non-positive integer) on success,
+ * @return: handle(a non-negative integer) on success,
  * 		-1 on failure.
  */
 int
 elfp_main_vec_add(elfp_main *main);
 
+/*
+ * elfp_main_vec_add_many: Adds a batch of elfp_main references to main_vec,
+ * 	taking its lock once.
+ *
+ * @arg0: Array of references. NULL entries are skipped.
+ * @arg1: Number of references in the array
+ * @arg2: Array of n integers, filled by the function.
+ * 	* handles[i] is the handle of mains[i], -1 if it is NULL or could not
+ * 	be added.
+ *
+ * @return: Number of references added.
+ */
+unsigned long int
+elfp_main_vec_add_many(elfp_main **mains, unsigned long int n, int *handles);
+
 /*
  * elfp_main_vec_fini: Cleans up the main_vec.
  *	Should be called only if the library is about to be de-inited.
+ *
+ * 	* Only the handles which are still open are visited.
+ * 	* No other thread should be using the library at this point.
  */
 void
 elfp_main_vec_fini();
 
 /*
- * elfp_main_vec_inform: Informs main_vec about de-initing of a 
- * 	elfp_main object.
+ * elfp_main_vec_remove: Closes a handle.
+ *
+ * @arg0: Handle to an elfp_main object.
  *
- * @arg0: Handle to that elfp_main object.
+ * @return: 0 on success, -1 if the handle is invalid / already closed.
+ *
+ * 	* The handle becomes invalid right away. The elfp_main object is
+ * 	cleaned up once every active lookup of it is done.
  */
-void
-elfp_main_vec_inform(int handle);
+int
+elfp_main_vec_remove(int handle);
 
 /*
  * elfp_main_vec_get_em: Returns the elfp_main object corresponding to 
- * 	a given user handle.
+ * 	a given user handle, and takes a reference on it.
  *
  * @arg0: User handle, an integer.
  *
  * @return: Reference to an elfp_main object.
+ * 	NULL if the handle is invalid or has been closed.
+ *
+ * 	* Every successful call MUST be paired with elfp_main_vec_put_em()
+ * 	once the object is no longer used.
  */
-
 elfp_main*
 elfp_main_vec_get_em(int handle);
 
+/*
+ * elfp_main_vec_put_em: Drops the reference taken by elfp_main_vec_get_em().
+ *
+ * @arg0: User handle, the one passed to elfp_main_vec_get_em().
+ */
+void
+elfp_main_vec_put_em(int handle);
+
 /*
  * elfp_sanitize_handle: Sanitizes the user fed handle.
  *
@@ -0,0 +1,101 @@
+/*
+ * File: elfp_ldcache.h
+ *
+ * Description: ld.so.cache - as ldconfig writes it, in the format glibc
+ * 		calls "glibc-ld.so.cache1.1".
+ *
+ * 		* Internal to the tool. User should not touch these structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#ifndef _ELFP_LDCACHE_H
+#define _ELFP_LDCACHE_H
+
+#include <stdint.h>
+
+#define ELFP_LDCACHE_MAGIC	"glibc-ld.so.cache"
+#define ELFP_LDCACHE_VERSION	"1.1"
+
+/* Caches written by old ldconfigs start with a table in the old format,
+ * followed by the new one */
+#define ELFP_LDCACHE_OLD_MAGIC	"ld.so-1.7.0"
+
+/* flags of the header: byte order it was written in */
+#define ELFP_LDCACHE_ENDIAN_MASK	0x3
+#define ELFP_LDCACHE_ENDIAN_LITTLE	0x2
+#define ELFP_LDCACHE_ENDIAN_BIG		0x3
+
+/******************************************************************************
+ * Structure: elfp_ldcache_header
+ *
+ * Description:
+ * 	* Header of the table. Entries follow it.
+ * 	* Strings are referred to by their offset from the header.
+ *****************************************************************************/
+typedef struct elfp_ldcache_header
+{
+	char magic[17];
+	char version[3];
+	uint32_t nlibs;
+	uint32_t len_strings;
+	uint8_t flags;
+	uint8_t padding[3];
+	uint32_t extension_offset;
+	uint32_t unused[3];
+
+} elfp_ldcache_header;
+
+/******************************************************************************
+ * Structure: elfp_ldcache_entry
+ *
+ * Description:
+ * 	* A library. key is its soname, value its path.
+ * 	* Sorted by key, in descending order of elfp_ldcache_cmp().
+ *****************************************************************************/
+typedef struct elfp_ldcache_entry
+{
+	int32_t flags;
+	uint32_t key;
+	uint32_t value;
+	uint32_t osversion;
+	uint64_t hwcap;
+
+} elfp_ldcache_entry;
+
+/******************************************************************************
+ * Structure: elfp_ldcache
+ *
+ * Description:
+ * 	* An opened cache. The file is mapped, nothing is copied.
+ *****************************************************************************/
+struct elfp_ldcache
+{
+	/* The whole file */
+	const unsigned char *addr;
+	unsigned long int size;
+
+	/* The table in it */
+	const elfp_ldcache_header *header;
+	const elfp_ldcache_entry *entries;
+	unsigned long int count;
+
+	/* Strings are at (const char *)header + offset, with offset less
+	 * than this */
+	unsigned long int strings_end;
+};
+
+#endif /* _ELFP_LDCACHE_H */
@@ -0,0 +1,112 @@
+/*
+ * File: elfp_line.h
+ *
+ * Description: The line index. All the line number programs of
+ * 		.debug_line, run once into one table sorted by address.
+ *
+ * 		* Internal to the tool. User should not touch these structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#ifndef _ELFP_LINE_H
+#define _ELFP_LINE_H
+
+#include "./elfp_int.h"
+
+/* files[] of a row which ends a sequence - no line from there on */
+#define ELFP_LINE_END		0xffffffff
+
+/* files[] of a row whose file is not in its unit's file table */
+#define ELFP_LINE_NO_FILE	0xfffffffe
+
+/* A file of a unit's file table. Both point into the file / are NULL */
+typedef struct elfp_line_file
+{
+	const char *dir;
+	const char *name;
+
+} elfp_line_file;
+
+/* Where a unit's files are in the index's file table. first is the
+ * number the unit's file table starts at - 1 before DWARF 5, 0 after */
+typedef struct elfp_line_unit_files
+{
+	unsigned long int offset;
+	unsigned long int file_base;
+	unsigned long int n_files;
+	unsigned int first;
+
+} elfp_line_unit_files;
+
+/******************************************************************************
+ * Structure: elfp_main_lines
+ *
+ * Description:
+ * 	* Rows of all the line tables, one per address, sorted by it. A row
+ * 	covers addresses from its own to the next row's.
+ * 	* Rows which say what the row before them says are left out.
+ * 	* The arrays are kept apart so that a search touches only addrs.
+ * 	* files[i] is an index in file_table, or ELFP_LINE_END /
+ * 	ELFP_LINE_NO_FILE. The file tables of all the units are one after
+ * 	the other in file_table.
+ * 	* Everything comes from the object's arena.
+ *****************************************************************************/
+typedef struct elfp_main_lines
+{
+	unsigned long int count;
+	unsigned long int *addrs;
+	unsigned int *files;
+	unsigned int *lines;
+
+	unsigned long int n_files;
+	elfp_line_file *file_table;
+
+	/* Line tables in .debug_line, and how many of them were broken.
+	 * units[] is in the order they are in .debug_line */
+	unsigned long int n_units;
+	unsigned long int n_broken;
+	elfp_line_unit_files *units;
+
+} elfp_main_lines;
+
+/*
+ * elfp_line_index_get: Gets the line index of a file, building it if this
+ * 	is the first time.
+ *
+ * @arg0: Reference to an elfp_main object
+ *
+ * @return: NULL on failure, the index on success. A file without
+ * 	.debug_line has an empty index.
+ */
+elfp_main_lines*
+elfp_line_index_get(elfp_main *main);
+
+/*
+ * elfp_line_file_get: Gets a file of a line table's file table - what a
+ * 	DW_AT_decl_file / DW_AT_call_file points to.
+ *
+ * @arg0: Reference to the line index
+ * @arg1: Offset of the line table in .debug_line (DW_AT_stmt_list)
+ * @arg2: Number of the file
+ *
+ * @return: The file, NULL if there is no such file.
+ */
+const elfp_line_file*
+elfp_line_file_get(const elfp_main_lines *lines, unsigned long int offset,
+						unsigned long int number);
+
+#endif /* _ELFP_LINE_H */
@@ -0,0 +1,115 @@
+/*
+ * File: elfp_note.h
+ *
+ * Description: The note index. Notes of PT_NOTE segments / SHT_NOTE
+ * 		sections, found once and kept in the order they appear.
+ *
+ * 		* Internal to the tool. User should not touch these structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#ifndef _ELFP_NOTE_H
+#define _ELFP_NOTE_H
+
+#include "./elfp_int.h"
+#include "./elfp.h"
+
+#include <elf.h>
+
+/* Some of these are newer than some elf.h out there */
+#ifndef NT_GNU_PROPERTY_TYPE_0
+#define NT_GNU_PROPERTY_TYPE_0	5
+#endif
+
+#ifndef NT_FDO_PACKAGING_METADATA
+#define NT_FDO_PACKAGING_METADATA	0xcafe1a7e
+#endif
+
+#ifndef GNU_PROPERTY_STACK_SIZE
+#define GNU_PROPERTY_STACK_SIZE			1
+#define GNU_PROPERTY_NO_COPY_ON_PROTECTED	2
+#endif
+
+#ifndef GNU_PROPERTY_1_NEEDED
+#define GNU_PROPERTY_1_NEEDED		0xb0008000
+#endif
+
+#ifndef GNU_PROPERTY_AARCH64_FEATURE_1_AND
+#define GNU_PROPERTY_AARCH64_FEATURE_1_AND	0xc0000000
+#endif
+
+#ifndef GNU_PROPERTY_X86_FEATURE_1_AND
+#define GNU_PROPERTY_X86_FEATURE_1_AND	0xc0000002
+#endif
+
+#ifndef GNU_PROPERTY_X86_ISA_1_NEEDED
+#define GNU_PROPERTY_X86_ISA_1_USED	0xc0010002
+#define GNU_PROPERTY_X86_ISA_1_NEEDED	0xc0008002
+#endif
+
+/******************************************************************************
+ * Structure: elfp_main_notes
+ *
+ * Description:
+ * 	* All the notes of one source - PT_NOTE segments or SHT_NOTE
+ * 	sections. Names and descriptors point into the file.
+ * 	* The FDO package metadata note is decoded along with it, if there
+ * 	is one.
+ * 	* Everything comes from the object's arena. count is 0 if there
+ * 	are no notes.
+ *****************************************************************************/
+typedef struct elfp_main_notes
+{
+	unsigned long int count;
+	elfp_note *notes;
+
+	/* NT_FDO_PACKAGING_METADATA. has_package is 0 if there is none */
+	int has_package;
+	elfp_package package;
+
+} elfp_main_notes;
+
+/*
+ * elfp_note_next: Decodes a note of a buffer of notes.
+ *
+ * @arg0: The buffer - contents of a PT_NOTE segment / SHT_NOTE section
+ * @arg1: Size of the buffer
+ * @arg2: Offset of the note in the buffer. Moved to the next note.
+ * @arg3: Alignment of the notes - 4 or 8.
+ * @arg4: Reference to an elfp_note. Filled up by the function, except
+ * 	for offset.
+ *
+ * @return: 0 on success, -1 if there are no more (valid) notes.
+ */
+int
+elfp_note_next(const unsigned char *buf, unsigned long int size,
+		unsigned long int *pos, unsigned long int align,
+		elfp_note *note);
+
+/*
+ * elfp_note_index_get: Gets the notes of a file, finding them if this is
+ * 	the first time.
+ *
+ * @arg0: Reference to an elfp_main object
+ * @arg1: ELFP_NOTES_SEGMENTS / ELFP_NOTES_SECTIONS
+ *
+ * @return: NULL on failure, the index on success.
+ */
+elfp_main_notes*
+elfp_note_index_get(elfp_main *main, int source);
+
+#endif /* _ELFP_NOTE_H */
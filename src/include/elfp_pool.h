@@ -0,0 +1,60 @@
+/*
+ * File: elfp_pool.h
+ *
+ * Description: A tiny worker pool used to run independent pieces of
+ * 		work in parallel.
+ *
+ * 		* Internal to the tool. User should not touch these structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#ifndef _ELFP_POOL_H
+#define _ELFP_POOL_H
+
+/******************************************************************************
+ * elfp_pool_run
+ *
+ * Description:
+ * 	* Runs task(arg, i) for every i in [0, n_tasks).
+ * 	* Tasks are handed out one at a time from a shared counter, so a slow
+ * 	task (a cold NFS lookup, for example) doesn't hold up the others.
+ * 	* The calling thread is one of the workers. It returns only after
+ * 	all the tasks are done.
+ *****************************************************************************/
+
+/* Upper bound on the number of threads a single run can use */
+#define ELFP_POOL_MAX_THREADS 64
+
+typedef void (*elfp_pool_task)(void *arg, unsigned long int index);
+
+/*
+ * elfp_pool_run: Runs n_tasks tasks on at most n_threads threads.
+ *
+ * @arg0: Number of tasks
+ * @arg1: Maximum number of threads to use. 0 means number of online CPUs.
+ * @arg2: Function to be called for every task.
+ * @arg3: Argument passed as-is to every call of the function.
+ *
+ * @return: 0 on success, -1 on failure.
+ * 	* If no extra thread could be created, everything runs on the
+ * 	calling thread. That is not considered as a failure.
+ */
+int
+elfp_pool_run(unsigned long int n_tasks, unsigned int n_threads,
+		elfp_pool_task task, void *arg);
+
+#endif /* _ELFP_POOL_H */
@@ -0,0 +1,74 @@
+/*
+ * File: elfp_reloc.h
+ *
+ * Description: The relocation index - where the REL, RELA and RELR tables
+ * 		of a file are. Found once per source, on first use.
+ *
+ * 		* Internal to the tool. User should not touch these structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#ifndef _ELFP_RELOC_H
+#define _ELFP_RELOC_H
+
+#include "./elfp_int.h"
+#include "./elfp.h"
+
+#include <elf.h>
+
+/* RELR is newer than some elf.h out there */
+#ifndef SHT_RELR
+#define SHT_RELR	19
+#endif
+
+/******************************************************************************
+ * Structure: elfp_main_relocs
+ *
+ * Description:
+ * 	* The relocation tables of one source - the DYNAMIC segment or the
+ * 	Section Header Table.
+ * 	* data[i] is where tables[i] can be read. Tables which can't be
+ * 	read / have entries of an unexpected size are left out.
+ * 	* symtabs[i] is the ELFP_SYMTAB_* tables[i]'s symbols are in.
+ * 	* relative is the machine's R_*_RELATIVE type - what a RELR entry
+ * 	stands for. 0 if not known.
+ * 	* Everything comes from the object's arena.
+ *****************************************************************************/
+typedef struct elfp_main_relocs
+{
+	unsigned long int count;
+	elfp_reloc_table *tables;
+	const void **data;
+	int *symtabs;
+
+	unsigned long int relative;
+
+} elfp_main_relocs;
+
+/*
+ * elfp_reloc_index_get: Gets the relocation tables of a file, finding
+ * 	them if this is the first time.
+ *
+ * @arg0: Reference to an elfp_main object
+ * @arg1: ELFP_RELOC_DYNAMIC / ELFP_RELOC_SECTIONS
+ *
+ * @return: NULL on failure, the index on success.
+ */
+elfp_main_relocs*
+elfp_reloc_index_get(elfp_main *main, int source);
+
+#endif /* _ELFP_RELOC_H */
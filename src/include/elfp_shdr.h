@@ -0,0 +1,140 @@
+/*
+ * File: elfp_shdr.h
+ *
+ * Description: The section index. Built once per file, on first use, and
+ * 		used by everything that deals with sections.
+ *
+ * 		* Internal to the tool. User should not touch these structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#ifndef _ELFP_SHDR_H
+#define _ELFP_SHDR_H
+
+#include "./elfp_int.h"
+
+/******************************************************************************
+ * Structure: elfp_section
+ *
+ * Description:
+ * 	* A section header, same for 32-bit and 64-bit objects.
+ *****************************************************************************/
+typedef struct elfp_section
+{
+	/* Index in the Section Header Table */
+	unsigned long int index;
+
+	/* Name from .shstrtab. NULL if it has none / it is broken */
+	const char *name;
+
+	/* Hash of the name. Refer elfp_shdr_hash() */
+	unsigned int hash;
+
+	unsigned long int type;
+	unsigned long int flags;
+	unsigned long int addr;
+	unsigned long int offset;
+	unsigned long int size;
+	unsigned long int link;
+	unsigned long int info;
+	unsigned long int addralign;
+	unsigned long int entsize;
+
+} elfp_section;
+
+/******************************************************************************
+ * Structure: elfp_main_sections
+ *
+ * Description:
+ * 	* All the section headers, along with a hash index over their names.
+ * 	* Everything comes from the object's arena.
+ * 	* count is 0 if the file has no (usable) Section Header Table.
+ *****************************************************************************/
+typedef struct elfp_main_sections
+{
+	unsigned long int count;
+	elfp_section *secs;
+
+	/* The Section Header Table as it is in the file */
+	void *sht;
+	unsigned long int entsize;
+
+	/* Name index: buckets[hash & (n_buckets - 1)] is 1 + index of the
+	 * first section in the bucket, 0 if it is empty. chain[index] is
+	 * the same for the next one. */
+	unsigned int n_buckets;
+	unsigned int *buckets;
+	unsigned int *chain;
+
+} elfp_main_sections;
+
+/*
+ * elfp_shdr_hash: Hash of a name. Same as the one DT_GNU_HASH uses.
+ *
+ * @arg0: Name
+ *
+ * @return: Hash
+ */
+unsigned int
+elfp_shdr_hash(const char *name);
+
+/*
+ * elfp_shdr_index_get: Gets the section index of a file, building it
+ * 	if this is the first time.
+ *
+ * @arg0: Reference to an elfp_main object
+ *
+ * @return: NULL on failure, the index on success.
+ */
+elfp_main_sections*
+elfp_shdr_index_get(elfp_main *main);
+
+/*
+ * elfp_shdr_find: Looks up a section by name.
+ *
+ * @arg0: Reference to an elfp_main object
+ * @arg1: Section name
+ *
+ * @return: The first section with that name, NULL if there is none.
+ */
+const elfp_section*
+elfp_shdr_find(elfp_main *main, const char *name);
+
+/*
+ * elfp_shdr_find_type: Looks up a section by type.
+ *
+ * @arg0: Reference to an elfp_main object
+ * @arg1: Section type - SHT_*
+ *
+ * @return: The first section of that type, NULL if there is none.
+ */
+const elfp_section*
+elfp_shdr_find_type(elfp_main *main, unsigned long int type);
+
+/*
+ * elfp_shdr_data_get: Gets a section's contents.
+ *
+ * @arg0: Reference to an elfp_main object
+ * @arg1: The section
+ *
+ * @return: NULL on failure / for SHT_NOBITS, address of the contents
+ * 	on success. It stays valid till the object is cleaned up.
+ */
+const void*
+elfp_shdr_data_get(elfp_main *main, const elfp_section *sec);
+
+#endif /* _ELFP_SHDR_H */
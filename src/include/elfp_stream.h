@@ -0,0 +1,132 @@
+/*
+ * File: elfp_stream.h
+ *
+ * Description: Structures behind the push parser - elfp_stream_*() API.
+ *
+ * 		* Internal to the tool. User should not touch these structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#ifndef _ELFP_STREAM_H
+#define _ELFP_STREAM_H
+
+#include "./elfp.h"
+
+/*
+ * Segments bigger than this are not collected. Refer ELFP_STREAM_SKIPPED.
+ */
+#define ELFP_STREAM_SEGMENT_MAX (1024 * 1024)
+
+/*
+ * Bytes held at a time, in all the buffers - pending ranges plus events
+ * not polled yet. Ranges which would go beyond it are skipped.
+ */
+#define ELFP_STREAM_HELD_MAX (16 * ELFP_STREAM_SEGMENT_MAX)
+
+/******************************************************************************
+ * Structure: elfp_stream_buf
+ *
+ * Description:
+ * 	* Bytes of the input from offset, size of them. Ranges which overlap
+ * 	share one buffer - a segment inside another, the same segment
+ * 	described twice.
+ * 	* refs is the number of ranges using it, pending or queued.
+ *****************************************************************************/
+typedef struct elfp_stream_buf
+{
+	unsigned long int offset;
+	unsigned long int size;
+	unsigned char *data;
+
+	unsigned long int refs;
+
+	/* Next buffer still receiving bytes */
+	struct elfp_stream_buf *next;
+
+} elfp_stream_buf;
+
+/******************************************************************************
+ * Structure: elfp_stream_range
+ *
+ * Description:
+ * 	* A range of the input somebody is waiting for - the ELF header, the
+ * 	PHT, a segment etc.
+ * 	* Its bytes are in buf, from (offset - buf->offset). NULL for a
+ * 	skipped range.
+ * 	* Once complete, the same object is queued as an event.
+ *****************************************************************************/
+typedef struct elfp_stream_range
+{
+	/* ELFP_STREAM_* event this turns into */
+	int type;
+
+	unsigned long int offset;
+	unsigned long int size;
+
+	/* ELFP_STREAM_SEGMENT: p_type */
+	unsigned long int seg_type;
+
+	elfp_stream_buf *buf;
+
+	/* Next pending range / next event */
+	struct elfp_stream_range *next;
+
+} elfp_stream_range;
+
+/******************************************************************************
+ * Structure: elfp_stream
+ *
+ * Description:
+ * 	* Input is consumed in order. Only bytes inside a pending range are
+ * 	kept, everything else is dropped as it goes by.
+ * 	* A completed range can add more ranges - the ELF header adds the PHT
+ * 	and the Section Header Table, the PHT adds the segments.
+ * 	* Overlapping ranges share a buffer, so a byte is kept once however
+ * 	many ranges want it.
+ *****************************************************************************/
+struct elfp_stream
+{
+	/* Offset of the next byte to be fed */
+	unsigned long int pos;
+
+	/* ELFCLASS32 / ELFCLASS64. Known once the ELF header is in */
+	int class;
+
+	/* Set on malformed input */
+	int error;
+
+	/* Set when nothing more is wanted from the input */
+	int done;
+
+	/* Ranges waiting for bytes */
+	elfp_stream_range *pending;
+
+	/* Buffers of the pending ranges which still need bytes */
+	elfp_stream_buf *bufs;
+
+	/* Bytes in all the buffers. Refer ELFP_STREAM_HELD_MAX */
+	unsigned long int held;
+
+	/* Completed ranges waiting to be polled */
+	elfp_stream_range *events_head;
+	elfp_stream_range *events_tail;
+
+	/* Returned by the last elfp_stream_poll(). Freed by the next one */
+	elfp_stream_range *polled;
+};
+
+#endif /* _ELFP_STREAM_H */
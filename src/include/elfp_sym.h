@@ -0,0 +1,108 @@
+/*
+ * File: elfp_sym.h
+ *
+ * Description: The symbol index. Built once per symbol table, on first
+ * 		use, and used for address -> symbol and name -> symbol lookups.
+ *
+ * 		* Internal to the tool. User should not touch these structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#ifndef _ELFP_SYM_H
+#define _ELFP_SYM_H
+
+#include "./elfp_int.h"
+#include "./elfp.h"
+
+/******************************************************************************
+ * Structure: elfp_main_symbols
+ *
+ * Description:
+ * 	* Index over one symbol table - .symtab or .dynsym.
+ * 	* Address index: Symbols which have an address (functions, objects
+ * 	and labels in some section), sorted by address. Kept as separate
+ * 	arrays, so that a binary search only touches addrs.
+ * 	* Name index: A chained hash over all the named symbols.
+ * 	* Everything comes from the object's arena. count is 0 if there
+ * 	is no such table.
+ *****************************************************************************/
+typedef struct elfp_main_symbols
+{
+	/* The table as it is in the file and its string table */
+	const void *syms;
+	unsigned long int count;
+	const char *strtab;
+	unsigned long int strsize;
+
+	/* Address index. n_addrs entries in each array */
+	unsigned long int n_addrs;
+	unsigned long int *addrs;
+	unsigned long int *sizes;
+	unsigned int *name_offs;
+
+	/* Index of the symbol in the table - for everything else */
+	unsigned int *sym_index;
+
+	/* Name index: buckets[hash & (n_buckets - 1)] is 1 + index of the
+	 * first symbol in the bucket, 0 if it is empty. chain[index] is the
+	 * same for the next one. hashes[index] is the symbol's name hash */
+	unsigned long int n_buckets;
+	unsigned int *buckets;
+	unsigned int *chain;
+	unsigned int *hashes;
+
+} elfp_main_symbols;
+
+/*
+ * elfp_sym_index_get: Gets the index of a symbol table, building it if
+ * 	this is the first time.
+ *
+ * @arg0: Reference to an elfp_main object
+ * @arg1: ELFP_SYMTAB_STATIC / ELFP_SYMTAB_DYNAMIC
+ *
+ * @return: NULL on failure, the index on success.
+ */
+elfp_main_symbols*
+elfp_sym_index_get(elfp_main *main, int table);
+
+/*
+ * elfp_sym_decode: Decodes a symbol of a table.
+ *
+ * @arg0: Reference to an elfp_main object
+ * @arg1: The table's index
+ * @arg2: Index of the symbol in the table
+ * @arg3: Reference to an elfp_sym. Filled up by the function.
+ */
+void
+elfp_sym_decode(elfp_main *main, elfp_main_symbols *symbols,
+		unsigned long int index, elfp_sym *sym);
+
+/*
+ * elfp_sym_radix_sort: Sorts keys in ascending order, carrying vals along.
+ * 	Stable. Also used by the other address indexes.
+ *
+ * @arg0: Keys
+ * @arg1: Values, one per key
+ * @arg2: Number of keys
+ *
+ * @return: 0 on success, -1 on failure.
+ */
+int
+elfp_sym_radix_sort(unsigned long int *keys, unsigned int *vals,
+				unsigned long int n);
+
+#endif /* _ELFP_SYM_H */
@@ -0,0 +1,126 @@
+/*
+ * File: elfp_unwind.h
+ *
+ * Description: The unwind table - the CFA programs of a file's CIEs and
+ * 		FDEs, run once into a flat table sorted by address. The same
+ * 		layout in memory and in a saved file.
+ *
+ * 		* Internal to the tool. User should not touch these structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#ifndef _ELFP_UNWIND_H
+#define _ELFP_UNWIND_H
+
+#include "./elfp_int.h"
+
+#include <stdint.h>
+
+#define ELFP_UNWIND_MAGIC	"ELFPUNW"
+#define ELFP_UNWIND_VERSION	1
+
+/* Byte order the table was written in */
+#define ELFP_UNWIND_LITTLE	1
+#define ELFP_UNWIND_BIG		2
+
+/* Longest build-id a table carries */
+#define ELFP_UNWIND_BUILD_ID_MAX	64
+
+/* fp_register of machines whose frame pointer is not known */
+#define ELFP_UNWIND_NO_REGISTER		0xffff
+
+/******************************************************************************
+ * Structure: elfp_unwind_header
+ *
+ * Description:
+ * 	* Header of a table. Entries follow it, at an offset of
+ * 	sizeof(elfp_unwind_header).
+ * 	* Addresses are kept as offsets from base, so that an entry fits
+ * 	in 16 bytes.
+ * 	* The build-id of the file the table was built from is kept, so
+ * 	that a table which doesn't match the file can be caught.
+ *****************************************************************************/
+typedef struct elfp_unwind_header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t entry_size;
+	uint64_t base;
+	uint64_t count;
+
+	uint16_t machine;
+	uint8_t addr_size;
+	uint8_t endian;
+	uint16_t fp_register;
+	uint16_t build_id_size;
+	uint8_t build_id[ELFP_UNWIND_BUILD_ID_MAX];
+
+} elfp_unwind_header;
+
+/******************************************************************************
+ * Structure: elfp_unwind_entry
+ *
+ * Description:
+ * 	* The rules from one address till the next entry's.
+ * 	* Rules are ELFP_UNWIND_* of elfp.h. A CFA rule of
+ * 	ELFP_UNWIND_CFA_NONE marks addresses no FDE covers.
+ * 	* ra_offset / fp_offset are offsets from the CFA, or a register
+ * 	number for ELFP_UNWIND_REGISTER.
+ *****************************************************************************/
+typedef struct elfp_unwind_entry
+{
+	uint32_t pc;
+	int32_t cfa_offset;
+	int16_t ra_offset;
+	int16_t fp_offset;
+	uint8_t cfa_register;
+	uint8_t cfa_rule;
+	uint8_t ra_rule;
+	uint8_t fp_rule;
+
+} elfp_unwind_entry;
+
+/******************************************************************************
+ * Structure: elfp_unwind
+ *
+ * Description:
+ * 	* A table. Built from a file (from the object's arena) or read from
+ * 	a saved one (mapped - addr / size is the mapping, nothing is copied).
+ *****************************************************************************/
+struct elfp_unwind
+{
+	const unsigned char *addr;
+	unsigned long int size;
+
+	const elfp_unwind_header *header;
+	const elfp_unwind_entry *entries;
+	unsigned long int count;
+};
+
+/*
+ * elfp_unwind_get: Gets the unwind table of a file, building it if this is
+ * 	the first time.
+ *
+ * @arg0: Reference to an elfp_main object
+ *
+ * @return: NULL on failure, the table on success. A file without call
+ * 	frame information has an empty table.
+ */
+struct elfp_unwind*
+elfp_unwind_get(elfp_main *main);
+
+#endif /* _ELFP_UNWIND_H */
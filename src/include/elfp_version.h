@@ -0,0 +1,78 @@
+/*
+ * File: elfp_version.h
+ *
+ * Description: Symbol versioning - .gnu.version, .gnu.version_r and
+ * 		.gnu.version_d, decoded once per file.
+ *
+ * 		* Internal to the tool. User should not touch these structures.
+ * License:
+ *
+ *            DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ *                  Version 2, December 2004
+ *
+ * Copyright (C) 2019 Adwaith Gautham <adwait.gautham@gmail.com>
+ *
+ * Everyone is permitted to copy and distribute verbatim or modified
+ * copies of this license document, and changing it is allowed as long
+ * as the name is changed.
+ *
+ *          DO WHAT THE FUCK YOU WANT TO PUBLIC LICENSE
+ * TERMS AND CONDITIONS FOR COPYING, DISTRIBUTION AND MODIFICATION
+ *
+ * 0. You just DO WHAT THE FUCK YOU WANT TO.
+ */
+
+#ifndef _ELFP_VERSION_H
+#define _ELFP_VERSION_H
+
+#include "./elfp_int.h"
+#include "./elfp.h"
+
+/******************************************************************************
+ * Structure: elfp_main_versions
+ *
+ * Description:
+ * 	* The version tables of a file, decoded. Strings point into the
+ * 	dynamic string table.
+ * 	* by_index is every version by the number .gnu.version refers to
+ * 	it by - a definition or a need. NULL where there is none.
+ * 	* versym points into the file - n_versym 16-bit entries.
+ * 	* Everything comes from the object's arena. A file without
+ * 	versions has all the counts 0.
+ *****************************************************************************/
+typedef struct elfp_main_versions
+{
+	elfp_verdef *defs;
+	unsigned long int n_defs;
+
+	elfp_verneed *needs;
+	unsigned long int n_needs;
+
+	/* Highest version of every (library, family) pair */
+	elfp_version_family *maxes;
+	unsigned long int n_maxes;
+
+	const elfp_verneed **by_index;
+	const elfp_verdef **def_by_index;
+	unsigned long int n_index;
+
+	const unsigned char *versym;
+	unsigned long int n_versym;
+
+	/* Entries which were broken, and left out */
+	unsigned long int n_broken;
+
+} elfp_main_versions;
+
+/*
+ * elfp_version_index_get: Gets the version tables of a file, decoding them
+ * 	if this is the first time.
+ *
+ * @arg0: Reference to an elfp_main object
+ *
+ * @return: NULL on failure, the tables on success.
+ */
+elfp_main_versions*
+elfp_version_index_get(elfp_main *main);
+
+#endif /* _ELFP_VERSION_H */